@@ -158,6 +158,9 @@ struct ne_request_s {
     unsigned int method_is_head;
     unsigned int can_persist;
 
+    int expect100_timeout; /* in ms, zero to wait for the answer */
+    ne_expect100 expect100;
+
     struct timespec expiration_time;
 
     int flags[NE_REQFLAG_LAST];
@@ -386,7 +389,24 @@ static int send_request_body(ne_request *req, int retry)
     }
 
     while ((bytes = req->body_cb(req->body_ud, buffer, sizeof buffer)) > 0) {
-	int ret = ne_sock_fullwrite(sess->socket, buffer, bytes);
+	int ret;
+
+        if (req->body_length < 0) {
+            /* Unknown length: frame the block as a single chunk. */
+            char chunkhdr[20];
+            struct ne_iovec vec[3];
+
+            vec[0].base = chunkhdr;
+            vec[0].len = ne_snprintf(chunkhdr, sizeof chunkhdr, "%x" EOL,
+                                     (unsigned int)bytes);
+            vec[1].base = buffer;
+            vec[1].len = bytes;
+            vec[2].base = (char *)EOL;
+            vec[2].len = 2;
+            ret = ne_sock_fullwritev(sess->socket, vec, 3);
+        } else {
+            ret = ne_sock_fullwrite(sess->socket, buffer, bytes);
+        }
         if (ret < 0) {
             int aret = aborted(req, _("Could not send request body"), ret);
             return RETRY_RET(retry, ret, aret);
@@ -401,6 +421,15 @@ static int send_request_body(ne_request *req, int retry)
         notify_status(sess, ne_status_sending);
     }
 
+    if (bytes == 0 && req->body_length < 0) {
+        /* Terminate the chunked body: last-chunk and empty trailer. */
+        int ret = ne_sock_fullwrite(sess->socket, "0" EOL EOL, 5);
+        if (ret < 0) {
+            int aret = aborted(req, _("Could not send request body"), ret);
+            return RETRY_RET(retry, ret, aret);
+        }
+    }
+
     if (bytes == 0) {
         NE_DEBUG(NE_DBG_CORE, "Request body sent successfully");
         return NE_OK;
@@ -500,6 +529,12 @@ ne_request *ne_request_create(ne_session *sess,
 /* Set the request body length to 'length' */
 static void set_body_length(ne_request *req, ne_off_t length)
 {
+    if (length < 0) {
+        /* Length not known in advance: use chunked transfer-coding. */
+        req->body_length = -1;
+        ne_add_request_header(req, "Transfer-Encoding", "chunked");
+        return;
+    }
     req->body_length = length;
     ne_print_request_header(req, "Content-Length", "%" FMT_NE_OFF_T, length);
 }
@@ -548,6 +583,16 @@ int ne_get_request_flag(ne_request *req, ne_request_flag flag)
     return -1;
 }
 
+void ne_set_request_expect100_timeout(ne_request *req, int msec)
+{
+    req->expect100_timeout = msec;
+}
+
+ne_expect100 ne_get_request_expect100(ne_request *req)
+{
+    return req->expect100;
+}
+
 
 void ne_add_request_header(ne_request *req, const char *name,
 			   const char *value)
@@ -828,6 +873,62 @@ ssize_t ne_read_response_block(ne_request *req, char *buffer, size_t buflen)
     return readlen;
 }
 
+int ne_response_splice_capable(ne_request *req)
+{
+    struct body_reader *rdr;
+
+    if (req->resp.mode != R_CLENGTH && req->resp.mode != R_TILLEOF)
+        return 0;
+
+    for (rdr = req->body_readers; rdr!=NULL; rdr=rdr->next) {
+        if (rdr->use)
+            return 0;
+    }
+
+    return req->session->socket != NULL
+        && ne_sock_splice_capable(req->session->socket);
+}
+
+ssize_t ne_read_response_splice(ne_request *req, const int pipefd[2], int fd,
+                                size_t buflen)
+{
+    struct ne_response *const resp = &req->resp;
+    size_t willread;
+    ssize_t readlen;
+
+    if (resp->mode == R_CLENGTH) {
+        willread = resp->body.clen.remain > (off_t)buflen
+            ? buflen : (size_t)resp->body.clen.remain;
+    } else if (resp->mode == R_TILLEOF) {
+        willread = buflen;
+    } else {
+        willread = 0;
+    }
+    if (willread == 0)
+        return 0;
+
+    readlen = ne_sock_splice(req->session->socket, pipefd, fd, willread);
+
+    if (resp->mode == R_TILLEOF &&
+        (readlen == NE_SOCK_CLOSED || readlen == NE_SOCK_TRUNC)) {
+        NE_DEBUG(NE_DBG_HTTP, "Got EOF.");
+        req->can_persist = 0;
+        return 0;
+    } else if (readlen < 0) {
+        aborted(req, _("Could not splice response body"), readlen);
+        return -1;
+    }
+
+    NE_DEBUG(NE_DBG_CORE, "Spliced %" NE_FMT_SSIZE_T " bytes.", readlen);
+    if (resp->mode == R_CLENGTH)
+        resp->body.clen.remain -= readlen;
+    resp->progress += readlen;
+    req->session->status.sr.progress += readlen;
+    notify_status(req->session, ne_status_recving);
+
+    return readlen;
+}
+
 /* Build the request string, returning the buffer. */
 static ne_buffer *build_request(ne_request *req)
 {
@@ -992,13 +1093,29 @@ static int send_request(ne_request *req, const ne_buffer *request)
 	return RETRY_RET(retry, sret, aret);
     }
 
-    if (!req->flags[NE_REQFLAG_EXPECT100] && req->body_length > 0) {
+    req->expect100 = NE_EXPECT100_UNUSED;
+    if (!req->flags[NE_REQFLAG_EXPECT100] && req->body_length != 0) {
 	/* Send request body, if not using 100-continue. */
 	ret = send_request_body(req, retry);
 	if (ret) {
             return ret;
 	}
     }
+    else if (req->body_length != 0 && req->expect100_timeout > 0
+             && ne_sock_block_msec(sess->socket, req->expect100_timeout)
+                == NE_SOCK_TIMEOUT) {
+        /* No answer to the 100-continue expectation in time: the
+         * server may ignore it, send the body anyway.  Socket errors
+         * are reported when reading the status line. */
+        NE_DEBUG(NE_DBG_HTTP, "No 100 (Continue) answer after %dms, "
+                 "sending the body.", req->expect100_timeout);
+        req->expect100 = NE_EXPECT100_TIMEOUT;
+	ret = send_request_body(req, retry);
+	if (ret) {
+            return ret;
+	}
+        sentbody = 1;
+    }
 
     NE_DEBUG(NE_DBG_CORE, "Request sent; retry is %d.", retry);
 
@@ -1012,13 +1129,21 @@ static int send_request(ne_request *req, const ne_buffer *request)
 	if ((ret = discard_headers(req)) != NE_OK) break;
 
 	if (req->flags[NE_REQFLAG_EXPECT100] && (status->code == 100)
-            && req->body_length > 0 && !sentbody) {
+            && req->body_length != 0 && !sentbody) {
 	    /* Send the body after receiving the first 100 Continue */
+            req->expect100 = NE_EXPECT100_CONTINUE;
 	    if ((ret = send_request_body(req, 0)) != NE_OK) break;
 	    sentbody = 1;
 	}
     }
 
+    if (ret == NE_OK && req->flags[NE_REQFLAG_EXPECT100]
+        && req->body_length != 0 && !sentbody) {
+        /* Final answer to the expectation, e.g. an error: the body
+         * is never sent. */
+        req->expect100 = NE_EXPECT100_FINAL;
+    }
+
     return ret;
 }
 
@@ -1288,6 +1413,12 @@ int ne_begin_request(ne_request *req)
         }
     }
 
+    /* The server may still be waiting for the body which was never
+     * sent, the connection cannot be reused. */
+    if (req->expect100 == NE_EXPECT100_FINAL) {
+        req->can_persist = 0;
+    }
+
     /* Decide which method determines the response message-length per
      * 2616§4.4 (multipart/byteranges is not supported): */
 
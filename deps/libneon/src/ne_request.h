@@ -81,7 +81,9 @@ typedef ssize_t (*ne_provide_body)(void *userdata,
 /* Install a callback which is invoked as needed to provide the
  * request body, a block at a time.  The total size of the request
  * body is 'length'; the callback must ensure that it returns no more
- * than 'length' bytes in total. */
+ * than 'length' bytes in total.  If 'length' is negative, the size of
+ * the body is not known in advance: it is sent using the chunked
+ * transfer-coding until the callback signals end of body. */
 void ne_set_request_body_provider(ne_request *req, ne_off_t length,
 				  ne_provide_body provider, void *userdata);
 
@@ -212,6 +214,24 @@ int ne_abort_request(ne_request* req);
  */
 ssize_t ne_read_response_block(ne_request *req, char *buffer, size_t buflen);
 
+/* Returns non-zero if the response body can be read using
+ * ne_read_response_splice: the body is not chunked, no response body
+ * readers are in use, and the connection supports splicing. */
+int ne_response_splice_capable(ne_request *req);
+
+/* Move up to 'buflen' bytes of the response body straight from the
+ * connection into file descriptor 'fd' through the empty pipe
+ * 'pipefd', without copying them through user space.  Must only be
+ * used if ne_response_splice_capable() returns non-zero.
+ *
+ * Returns:
+ *  <0 - error, stop reading.
+ *   0 - end of response
+ *  >0 - number of bytes written to fd.
+ */
+ssize_t ne_read_response_splice(ne_request *req, const int pipefd[2], int fd,
+                                size_t buflen);
+
 /* Read response blocks until end of response; exactly equivalent to
  * calling ne_read_response_block() until it returns 0.  Returns
  * non-zero on error. */
@@ -240,6 +260,24 @@ void ne_set_request_flag(ne_request *req, ne_request_flag flag, int value);
  * flag is not supported. */
 int ne_get_request_flag(ne_request *req, ne_request_flag flag);
 
+/* Outcome of the "Expect: 100-continue" handshake of a request. */
+typedef enum ne_expect100_e {
+    NE_EXPECT100_UNUSED = 0, /* no handshake: flag unset, or no body */
+    NE_EXPECT100_CONTINUE, /* body sent after the 100 (Continue) answer */
+    NE_EXPECT100_TIMEOUT, /* no answer in time, body sent anyway */
+    NE_EXPECT100_FINAL /* final answer received, body never sent */
+} ne_expect100;
+
+/* Wait for up to 'msec' milliseconds for the 100 (Continue) answer
+ * of a request using NE_REQFLAG_EXPECT100 before sending the body
+ * anyway.  If zero (the default), the body is only sent once the
+ * answer arrives. */
+void ne_set_request_expect100_timeout(ne_request *req, int msec);
+
+/* Return the outcome of the 100-continue handshake of the last
+ * dispatch of the request. */
+ne_expect100 ne_get_request_expect100(ne_request *req);
+
 
 /**** Request hooks handling *****/
 
@@ -24,6 +24,10 @@
   Relicensed under LGPL for neon, http://www.webdav.org/neon/
 */
 
+#ifdef __linux__
+#define _GNU_SOURCE /* for splice(2) */
+#endif
+
 #include "config.h"
 
 #include <sys/types.h>
@@ -441,6 +445,53 @@ int ne_sock_block(ne_socket *sock, int n)
     return sock->ops->readable(sock, n);
 }
 
+int ne_sock_block_msec(ne_socket *sock, int msec)
+{
+    int ret;
+
+    if (sock->bufavail)
+	return 0;
+#if defined(HAVE_OPENSSL)
+    if (sock->ssl && SSL_pending(sock->ssl))
+	return 0;
+#elif defined(HAVE_GNUTLS)
+    if (sock->ssl && gnutls_record_check_pending(sock->ssl))
+	return 0;
+#endif
+
+    {
+#ifdef NE_USE_POLL
+        struct pollfd fds;
+
+        fds.fd = sock->fd;
+        fds.events = POLLIN;
+        fds.revents = 0;
+
+        do {
+            ret = poll(&fds, 1, msec);
+        } while (ret < 0 && NE_ISINTR(ne_errno));
+#else
+        fd_set rdfds;
+        struct timeval timeout;
+
+        FD_ZERO(&rdfds);
+        FD_SET(sock->fd, &rdfds);
+        timeout.tv_sec = msec / 1000;
+        timeout.tv_usec = (msec % 1000) * 1000;
+
+        do {
+            ret = select(sock->fd + 1, &rdfds, NULL, NULL, &timeout);
+        } while (ret < 0 && NE_ISINTR(ne_errno));
+#endif
+    }
+
+    if (ret < 0) {
+	set_strerror(sock, ne_errno);
+	return NE_SOCK_ERROR;
+    }
+    return (ret == 0) ? NE_SOCK_TIMEOUT : 0;
+}
+
 /* Cast address object AD to type 'sockaddr_TY' */
 #define SACAST(ty, ad) ((struct sockaddr_##ty *)(ad))
 
@@ -954,6 +1005,121 @@ ssize_t ne_sock_fullread(ne_socket *sock, char *buffer, size_t buflen)
     return 0;
 }
 
+#ifdef __linux__
+/* Write exactly 'len' bytes of 'data' to file descriptor 'fd'. */
+static ssize_t write_fd_full(ne_socket *sock, int fd, const char *data,
+                             size_t len)
+{
+    size_t done = 0;
+
+    while (done < len) {
+        ssize_t ret = write(fd, data + done, len - done);
+        if (ret < 0) {
+            if (NE_ISINTR(ne_errno)) continue;
+            set_strerror(sock, ne_errno);
+            return NE_SOCK_ERROR;
+        }
+        done += ret;
+    }
+
+    return done;
+}
+
+/* Move 'len' bytes sitting in the pipe 'pipefd' out to 'fd'.  If the
+ * destination refuses splice(2), the remainder is copied instead. */
+static ssize_t drain_pipe(ne_socket *sock, const int pipefd[2], int fd,
+                          size_t len)
+{
+    char buf[RDBUFSIZ];
+    ssize_t ret;
+
+    while (len > 0) {
+        ret = splice(pipefd[0], NULL, fd, NULL, len, SPLICE_F_MOVE);
+        if (ret > 0) {
+            len -= ret;
+            continue;
+        }
+        if (ret < 0 && NE_ISINTR(ne_errno)) continue;
+        if (ret == 0 || ne_errno != EINVAL) {
+            set_strerror(sock, ne_errno);
+            return NE_SOCK_ERROR;
+        }
+
+        do {
+            ret = read(pipefd[0], buf, len > sizeof buf ? sizeof buf : len);
+        } while (ret < 0 && NE_ISINTR(ne_errno));
+        if (ret <= 0) {
+            set_strerror(sock, ne_errno);
+            return NE_SOCK_ERROR;
+        }
+        if (write_fd_full(sock, fd, buf, ret) < 0)
+            return NE_SOCK_ERROR;
+        len -= ret;
+    }
+
+    return 0;
+}
+#endif
+
+int ne_sock_splice_capable(const ne_socket *sock)
+{
+#ifdef __linux__
+    return sock->ops == &iofns_raw;
+#else
+    return 0;
+#endif
+}
+
+ssize_t ne_sock_splice(ne_socket *sock, const int pipefd[2], int fd,
+                       size_t count)
+{
+#ifdef __linux__
+    ssize_t ret, moved;
+
+    if (sock->bufavail > 0) {
+        /* Deliver buffered data first; the kernel no longer holds it. */
+        if (count > sock->bufavail)
+            count = sock->bufavail;
+        ret = write_fd_full(sock, fd, sock->bufpos, count);
+        if (ret < 0) return ret;
+        sock->bufpos += count;
+        sock->bufavail -= count;
+        return count;
+    }
+
+    if (sock->ops != &iofns_raw) {
+        set_error(sock, _("Splice is not supported on this socket"));
+        return NE_SOCK_ERROR;
+    }
+
+    ret = wait_pending_writes(sock, sock->rdtimeout);
+    if (ret) return ret;
+    ret = readable_raw(sock, sock->rdtimeout);
+    if (ret) return ret;
+
+    do {
+        moved = splice(sock->fd, NULL, pipefd[1], NULL, count, SPLICE_F_MOVE);
+    } while (moved == -1 && NE_ISINTR(ne_errno));
+
+    if (moved == 0) {
+        set_error(sock, _("Connection closed"));
+        return NE_SOCK_CLOSED;
+    } else if (moved < 0) {
+        int errnum = ne_errno;
+        set_strerror(sock, errnum);
+        return NE_ISRESET(errnum) ? NE_SOCK_RESET : NE_SOCK_ERROR;
+    }
+
+    ret = drain_pipe(sock, pipefd, fd, moved);
+    if (ret) return ret;
+
+    return moved;
+#else
+    set_error(sock, _("Splice is not supported on this platform"));
+    return NE_SOCK_ERROR;
+#endif
+}
+
 #ifndef INADDR_NONE
 #define INADDR_NONE ((in_addr_t) -1)
 #endif
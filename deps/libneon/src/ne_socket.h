@@ -178,6 +178,9 @@ ssize_t ne_sock_peek(ne_socket *sock, char *buffer, size_t count);
  */
 int ne_sock_block(ne_socket *sock, int n);
 
+/* As ne_sock_block, waiting for up to 'msec' milliseconds. */
+int ne_sock_block_msec(ne_socket *sock, int msec);
+
 /* Write 'count' bytes of 'data' to the socket.  Guarantees to either
  * write all the bytes or to fail.  Returns 0 on success, or NE_SOCK_*
  * on error. */
@@ -208,6 +211,22 @@ ssize_t ne_sock_readline(ne_socket *sock, char *buffer, size_t len);
  * success, NE_SOCK_* on error. */
 ssize_t ne_sock_fullread(ne_socket *sock, char *buffer, size_t len);
 
+/* Returns non-zero if data can be moved out of socket 'sock' using
+ * ne_sock_splice: the platform supports splice(2) and the socket is
+ * not SSL-wrapped. */
+int ne_sock_splice_capable(const ne_socket *sock);
+
+/* Move up to 'count' bytes from the socket into file descriptor 'fd'
+ * without copying them through user space, passing the data through
+ * the pipe 'pipefd' (as created by pipe(2), and empty on entry).  Any
+ * data already held in the socket read buffer is written out first.
+ * Returns:
+ *   NE_SOCK_* on error,
+ *   >0 number of bytes written to 'fd' (may be less than 'count')
+ */
+ssize_t ne_sock_splice(ne_socket *sock, const int pipefd[2], int fd,
+                       size_t count);
+
 /* Accepts a connection from listening socket 'fd' and places the
  * socket in 'sock'.  Returns zero on success or -1 on failure. */
 int ne_sock_accept(ne_socket *sock, int fd);
@@ -150,6 +150,35 @@ struct StatInfo{
 
 
 
+///
+/// @brief FdStatistics struct
+/// @struct FdStatistics
+/// I/O accounting of a POSIX file descriptor, see DavPosix::fstatistics
+///
+struct FdStatistics{
+    FdStatistics(): bytes_read(0), bytes_written(0), requests(0), ranges_coalesced(0),
+        cache_hits(0), cache_misses(0), network_time_us(0), retries(0) {
+    }
+
+    /// bytes returned to the application by read operations
+    dav_size_t bytes_read;
+    /// bytes accepted from the application by write operations
+    dav_size_t bytes_written;
+    /// number of HTTP requests issued
+    dav_size_t requests;
+    /// number of vector read ranges merged into a neighbouring one
+    dav_size_t ranges_coalesced;
+    /// sequential reads served by the already open read-ahead stream
+    dav_size_t cache_hits;
+    /// reads which needed a new request
+    dav_size_t cache_misses;
+    /// time spent blocked in I/O operations, in microseconds
+    dav_size_t network_time_us;
+    /// number of operations retried after a failure
+    dav_size_t retries;
+};
+
+
 } // Davix
 
 
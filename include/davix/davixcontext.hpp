@@ -110,7 +110,20 @@ public:
     /// get session caching status
     bool getSessionCaching() const;
 
-    /// clear both redirect and session cache
+    /// @brief enable the caching of file metadata
+    /// @param seconds : time to live of the cached entries, 0 disables the cache (default)
+    ///
+    /// Results of stat operations and entries of directory listings are kept
+    /// for the given time and answer the next stats of the same resources.
+    /// Deletions, moves, new collections and writes made with this context
+    /// drop the entries of the resources they modify; changes made by other
+    /// clients are only seen once the entries expire.
+    void setMetadataCacheTTL(unsigned int seconds);
+
+    /// get the time to live of cached file metadata, 0 if disabled
+    unsigned int getMetadataCacheTTL() const;
+
+    /// clear the redirect, session and metadata caches
     void clearCache();
 
 private:
@@ -28,6 +28,7 @@
 #include <davixcontext.hpp>
 #include <params/davixrequestparams.hpp>
 #include <file/davix_file_info.hpp>
+#include <file/davix_compact_listing.hpp>
 #include <compat/deprecated.hpp>
 
 
@@ -75,6 +76,51 @@ public:
            std::shared_ptr<Internal> d_ptr;
     };
 
+    ///
+    /// @class MappedRegion
+    /// @brief Read-only view of a remote byte range
+    ///
+    /// The region is reserved in memory when created, but its content is
+    /// only fetched page by page when materialized. Pages which have not been
+    /// materialized yet are not accessible.
+    /// Bytes located after the end of the remote file read as zero.
+    ///
+    /// Copies share the same underlying mapping.
+    class MappedRegion{
+        friend struct DavFileInternal;
+        public:
+            MappedRegion() : d_ptr() {}
+            MappedRegion(const MappedRegion & orig) : d_ptr(orig.d_ptr){}
+
+            /// address of the first byte of the region
+            const char* data() const;
+
+            /// size of the region in bytes
+            dav_size_t size() const;
+
+            /// offset of the region in the remote file
+            dav_off_t offset() const;
+
+            /// size of the fetch granularity in bytes
+            dav_size_t pageSize() const;
+
+            /// @brief fetch the pages covering [offset, offset + count) if needed
+            ///
+            /// Missing pages are fetched with a single vectored read.
+            /// @param offset offset relative to the beginning of the region
+            /// @param count number of bytes
+            /// @return address of the byte at offset
+            /// @throw  throw @ref DavixException if error occurs
+            const char* materialize(dav_off_t offset, dav_size_t count);
+
+            /// check if [offset, offset + count) can be accessed without fetching
+            bool isMaterialized(dav_off_t offset, dav_size_t count) const;
+        private:
+           struct Internal;
+
+           std::shared_ptr<Internal> d_ptr;
+    };
+
     ///
     /// \brief default constructor
     /// \param c context
@@ -256,8 +302,41 @@ public:
     ///  @snippet example_code_snippets.cpp put callback
     void put(const RequestParams* params, const DataProviderFun & callback, dav_size_t size);
 
+    ///
+    ///  @brief Create/Replace file content from a stream of unknown size
+    ///
+    ///  @param params Davix request Parameters
+    ///  @param callback data provider callback, pulled until it returns 0
+    ///  @throw throw @ref DavixException if an error occurs
+    ///
+    ///  Set a new content for the file, without knowing its size beforehand,
+    ///  e.g. the output of a compressor or of a pipe.
+    ///  HTTP / WebDAV: the body is sent with chunked transfer-encoding.
+    ///  S3, Swift, Azure: the data is uploaded as a multi-part object, or
+    ///  with a single request if it fits in one part.
+    ///
+    ///  The callback may refuse to rewind (non-zero return for max_size == 0)
+    ///  once data has been consumed, the upload then fails instead of being
+    ///  retried.
+    void put(const RequestParams* params, const DataProviderFun & callback);
+
 #endif
 
+    ///
+    ///  @brief Abort the unfinished multi-part uploads towards the current file
+    ///
+    ///  @param params Davix request Parameters
+    ///  @return number of uploads aborted, S3, or of segments deleted, Swift
+    ///  @throw throw @ref DavixException if an error occurs
+    ///
+    ///  S3: abort every pending multi-part upload of the object.
+    ///  Swift: delete the segments of the uploads recorded by the upload journals,
+    ///  see RequestParams::setUploadJournalDir.
+    ///  The upload journals of the file are removed.
+    ///
+    ///  Protocol supported currently: S3, Swift
+    size_t abortPendingUploads(const RequestParams* params);
+
     ///
     /// @brief move
     /// @param params Davix request Parameters
@@ -341,6 +420,37 @@ public:
     ///  @snippet example_code_snippets.cpp listCollection
     Iterator  listCollection(const RequestParams* params);
 
+    ///
+    ///  @brief Collection listing into a compact container
+    ///
+    ///  Append all the entries of the collection to entries, keeping only the
+    ///  properties of its StatProperty mask. Meant for collections with a very
+    ///  large number of entries. For WebDAV, only the properties of
+    ///  entries.properties() are requested.
+    ///
+    ///  @param params Davix request parameters
+    ///  @param entries destination of the entries
+    ///  @return number of entries appended
+    ///  @throw  throw @ref DavixException if error occurs
+    size_t listCollection(const RequestParams* params, CompactListing & entries);
+
+    ///
+    ///  @brief Map a byte range of the file in memory
+    ///
+    ///  Reserve a read-only view of [offset, offset + length) of the remote file.
+    ///  Nothing is transferred until the region is materialized, and then only
+    ///  the pages which have not been fetched yet are read.
+    ///
+    ///  @param params Davix request parameters
+    ///  @param offset offset of the region in the remote file
+    ///  @param length size of the region, 0 to map up to the end of the file
+    ///  @param page_size fetch granularity, 0 for default (1 MiB). Rounded up to
+    ///                   a multiple of the system page size
+    ///  @return the mapped region
+    ///  @throw  throw @ref DavixException if error occurs
+    MappedRegion mapRegion(const RequestParams* params, dav_off_t offset,
+                           dav_size_t length, dav_size_t page_size = 0);
+
 
     ///
     ///  @brief compute checksum of the file
@@ -0,0 +1,112 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_COMPACT_LISTING_HPP
+#define DAVIX_COMPACT_LISTING_HPP
+
+#include <memory>
+#include <string>
+#include <davix_file_types.hpp>
+#include <params/davix_request_params_types.hpp>
+
+/**
+  @file davix_compact_listing.hpp
+
+  @brief compact storage of the entries of a collection listing
+*/
+
+namespace Davix{
+
+///
+/// @class CompactListing
+/// @brief Memory efficient container for the entries of a large listing
+///
+/// The names of the entries are stored one after the other in a single
+/// buffer, and each property of the StatProperty mask in a column of its own.
+/// The properties outside of the mask are not stored and read as zero,
+/// StatInfo built by @ref info() keep the default mode of the WebDAV parser.
+///
+/// Copies share nothing.
+class DAVIX_EXPORT CompactListing{
+public:
+    struct Internal;
+
+    /// create an empty listing keeping the properties of the StatProperty mask
+    explicit CompactListing(unsigned int properties = StatProperty::All);
+    CompactListing(const CompactListing & orig);
+    ~CompactListing();
+
+    CompactListing & operator=(const CompactListing & orig);
+
+    /// StatProperty mask of the properties kept
+    unsigned int properties() const;
+
+    /// number of entries
+    size_t size() const;
+
+    /// true if there is no entry
+    bool empty() const;
+
+    /// reserve memory for entries whose names add up to name_bytes
+    void reserve(size_t entries, size_t name_bytes);
+
+    /// add an entry, only the properties of the mask are kept from info
+    void push_back(const std::string & name, const StatInfo & info);
+
+    /// remove all the entries, the properties kept are unchanged
+    void clear();
+
+    /// name of entry i, null terminated, valid until the next modification
+    const char* name(size_t i) const;
+
+    /// size of the name of entry i
+    size_t nameSize(size_t i) const;
+
+    /// true if entry i is a collection, needs StatProperty::Type
+    bool isDirectory(size_t i) const;
+
+    /// size of entry i in bytes, needs StatProperty::Size
+    dav_size_t fileSize(size_t i) const;
+
+    /// modification time of entry i, needs StatProperty::Mtime
+    time_t mtime(size_t i) const;
+
+    /// creation time of entry i, needs StatProperty::Ctime
+    time_t ctime(size_t i) const;
+
+    /// POSIX rights of entry i, needs StatProperty::Mode
+    mode_t mode(size_t i) const;
+
+    /// owner UID of entry i, needs StatProperty::Owner
+    uid_t owner(size_t i) const;
+
+    /// group UID of entry i, needs StatProperty::Owner
+    gid_t group(size_t i) const;
+
+    /// properties of entry i
+    StatInfo info(size_t i) const;
+
+private:
+    std::unique_ptr<Internal> d_ptr;
+};
+
+} // Davix
+
+#endif // DAVIX_COMPACT_LISTING_HPP
@@ -106,6 +106,24 @@ public:
      */
     int get_quota(const RequestParams *params, const std::string & url, QuotaInfo* st, DavixError** err);
 
+    /**
+      @brief stat many urls in one call
+
+      Urls sharing a parent collection are looked up in a single listing of
+      it (Depth:1 PROPFIND, S3 prefix listing...) when the protocol supports
+      it, the others are stat'ed with concurrent requests, see
+      RequestParams::setMetadataConcurrency.
+
+      @param params request options, can be NULL
+      @param urls urls to stat
+      @param st receives the stat of each url, in the same order
+      @param errs receives the error of each url, NULL on success, to be freed with DavixError::clearError
+      @param err Davix error report system, set if a stat failed
+      @return 0 if all urls were stat'ed, negative value if any failed
+     */
+    int stat_bulk(const RequestParams* params, const std::vector<std::string> & urls, std::vector<StatInfo> & st,
+                  std::vector<DavixError*> & errs, DavixError** err);
+
 
     /**
       @brief open a directory for listing.
@@ -207,6 +225,20 @@ public:
     */
     int mkdir(const RequestParams* params, const std::string& url, mode_t right, DavixError** err);
 
+    /**
+      @brief create a collection and its missing parents
+
+      Behavior similar to mkdir -p: succeeds if the collection exists. The
+      deepest existing parent is found by bisection over the path.
+
+      @param params request options, can be NULL
+      @param url url of the collection to create
+      @param right default mode of the collections ( ignored currently )
+      @param err Davix error report system
+      @return 0 if success, or -1 if error occurred
+    */
+    int mkdir_parents(const RequestParams* params, const std::string& url, mode_t right, DavixError** err);
+
     /**
       @brief rename a target file or collection.
 
@@ -252,6 +284,37 @@ public:
     */
     int rmdir(const RequestParams* params, const std::string& url, DavixError** err);
 
+    /**
+      @brief remove a collection and everything below it
+
+      A single DELETE of the collection is tried first. If the server refuses
+      it, the tree is listed and deleted bottom-up, with concurrent requests,
+      see RequestParams::setMetadataConcurrency.
+
+      @param params request options, can be NULL
+      @param url collection or file to delete
+      @param err Davix error report system
+      @return 0 if success else a negative value and err is set.
+    */
+    int rmdir_recursive(const RequestParams* params, const std::string& url, DavixError** err);
+
+    /**
+      @brief remove many files in one call
+
+      S3 objects of a bucket are removed by multi-object delete requests of
+      up to 1000 keys, sent concurrently, see
+      RequestParams::setMetadataConcurrency. Other files are removed with
+      concurrent DELETE requests.
+
+      @param params request options, can be NULL
+      @param urls files to delete
+      @param errs receives the error of each url, NULL on success, to be freed with DavixError::clearError
+      @param err Davix error report system, set if a deletion failed
+      @return 0 if all files were deleted, negative value if any failed
+    */
+    int unlink_bulk(const RequestParams* params, const std::vector<std::string> & urls,
+                    std::vector<DavixError*> & errs, DavixError** err);
+
 
     /**
       @brief open a file for read/write operation in a POSIX-like approach.
@@ -270,6 +333,21 @@ public:
      */
     DAVIX_FD* open(const RequestParams* params, const std::string & url, int flags, DavixError** err);
 
+    /**
+      @brief open a file for read/write operation with already known file information.
+
+      Similar to open, but the existence check of the file is replaced by the
+      information provided by the caller: no request is sent to the server.
+
+      @param params request options, can be NULL
+      @param url url of the HTTP file to open
+      @param flags open flags, similar to the POSIX function open
+      @param info file information, the size is used for SEEK_END
+      @param err Davix Error report
+      @return Davix file descriptor in case of success, or NULL if an error occures.
+     */
+    DAVIX_FD* open(const RequestParams* params, const std::string & url, int flags, const StatInfo & info, DavixError** err);
+
 
     /**
       @brief read a file in a POSIX-like approach with HTTP(S).
@@ -357,7 +435,9 @@ public:
     /**
       @brief write a file in a POSIX-like approach with HTTP(S).
 
-      Behavior similar to the POSIX write function.
+      Behavior similar to the POSIX write function. The data is uploaded in
+      the background as it is written, so writes must be sequential, and the
+      failure of the upload may only be reported by close.
 
       @param fd davix file descriptor
       @param buf buffer with the write content
@@ -395,6 +475,9 @@ public:
 
       Note : all file descriptors MUST be closed before the destruction of the parent davix context
 
+      Completes the upload of written data. The descriptor is released even
+      if this fails.
+
       @param fd davix file descriptor
       @param err Davix Error report
       @return 0 if success, negative value if error
@@ -403,6 +486,20 @@ public:
      */
     int close(DAVIX_FD* fd, DavixError** err);
 
+    /**
+      @brief get the I/O statistics of an existing file descriptor
+
+      Counters are accumulated from the opening of the file descriptor:
+      bytes transferred, HTTP requests issued, ranges coalesced by vector operations,
+      read-ahead cache hits and misses, time spent blocked in I/O and retries.
+
+      @param fd davix file descriptor
+      @param stats statistics structure to fill
+      @param err Davix Error report
+      @return 0 if success, negative value if error
+     */
+    int fstatistics(DAVIX_FD* fd, FdStatistics* stats, DavixError** err);
+
     /**
       @brief give advise about next file operation
 
@@ -86,6 +86,34 @@ namespace S3ListingMode{
     };
 }
 
+namespace ListingOrder{
+    enum ListingOrder{
+        // entries sorted by name
+        Ordered,
+        // entries returned as soon as they are received
+        Unordered
+    };
+}
+
+namespace StatProperty{
+    enum StatProperty{
+        // collection or file
+        Type = 0x01,
+        // size in bytes
+        Size = 0x02,
+        // modification time
+        Mtime = 0x04,
+        // creation time
+        Ctime = 0x08,
+        // POSIX rights, LCGDM extension
+        Mode = 0x10,
+        // owner and group
+        Owner = 0x20,
+        // all the properties above
+        All = 0x3f
+    };
+}
+
 namespace SwiftListingMode{
     enum SwiftListingMode{
         // Full hierarchical listing (depth is 1)
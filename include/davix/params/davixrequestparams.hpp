@@ -48,6 +48,7 @@ namespace gcloud {
 }
 
 struct RequestParamsInternal;
+struct RequestParamsExplorer;
 
 
 
@@ -250,6 +251,45 @@ public:
     /// get maximun number of key entries return by S3 list object request
     unsigned long getS3MaxKey() const;
 
+    /// enable parallel S3 listings
+    ///
+    /// Recursive listings (SemiHierarchical and Flat listing modes) are split
+    /// by the common prefixes found under the listed path, and up to
+    /// getMetadataConcurrency() of them are listed at the same time.
+    /// Disabled by default.
+    void setS3ParallelListing(const bool parallel);
+
+    /// get parallel S3 listing flag
+    bool getS3ParallelListing() const;
+
+    /// prefetch the pages of S3 listings
+    ///
+    /// Pages are fetched whole by a background task, the next one as soon as
+    /// the current one has been received, instead of being parsed as they
+    /// arrive. Trades the memory of two pages and a thread per listing for
+    /// the latency of the page requests.
+    /// Disabled by default.
+    void setS3ListingPrefetch(const bool prefetch);
+
+    /// get S3 listing prefetch flag
+    bool getS3ListingPrefetch() const;
+
+    /// set the order of the entries returned by parallel listings, Ordered (key order) by default
+    void setListingOrder(const ListingOrder::ListingOrder order);
+
+    /// get the order of the entries returned by parallel listings
+    ListingOrder::ListingOrder getListingOrder() const;
+
+    /// set the properties kept by stats and listings, a mask of StatProperty values
+    ///
+    /// WebDAV PROPFIND requests only ask for these properties, plus the
+    /// resource type, and compact listings only store them.
+    /// StatProperty::All by default.
+    void setStatProperties(const unsigned int properties);
+
+    /// get the properties kept by stats and listings
+    unsigned int getStatProperties() const;
+
     /// add the CA certificate in the directory 'path' as trusted certificate
     void addCertificateAuthorityPath(const std::string & path);
 
@@ -334,6 +374,129 @@ public:
     /// get whether 100-continue support is enabled
     bool get100ContinueSupport() const;
 
+    /// set how long uploads wait for the 100 (Continue) answer of the server
+    /// before sending the body anyway. A final answer (e.g. 403, 507) arriving
+    /// first fails the request before any body byte is sent. Hosts which
+    /// never answer are remembered by the Context, and later uploads to them
+    /// skip the handshake. A zero timeout waits for the answer indefinitely.
+    /// DEFAULT : 1s
+    void set100ContinueTimeout(struct timespec* timeout);
+
+    /// get the wait for the 100 (Continue) answer
+    const struct timespec* get100ContinueTimeout() const;
+
+    /// set the size in bytes of the in-memory buffer used by POSIX write().
+    /// Written data is streamed to the server in the background as it
+    /// arrives; write() blocks once this many bytes are waiting to be sent.
+    void setWriteBufferSize(const dav_size_t size);
+
+    /// get the size of the POSIX write-behind buffer
+    dav_size_t getWriteBufferSize() const;
+
+    /// enable or disable the existence check done when a file is opened with DavPosix
+    /// default: enabled
+    ///
+    /// When disabled, open() does not issue any request: existence and size of the
+    /// file are learned from the first read. A missing file is then reported by
+    /// the first read instead of open().
+    /// O_CREAT | O_EXCL always requires the check. A file opened with O_CREAT and
+    /// never written nor read is checked, and created if missing, by close().
+    void setStatOnOpen(const bool value);
+
+    /// get the existence check on open status
+    bool getStatOnOpen() const;
+
+    /// set the maximum number of parts sent concurrently by multi-part uploads
+    /// default: 4
+    ///
+    /// One more part is read from the data source while the others are sent,
+    /// the memory used by an upload is bounded by (parts + 1) * part size.
+    /// It is also kept within 1/8 of the available memory: fewer parts are
+    /// buffered when they are large, one at least.
+    void setUploadConcurrency(const unsigned int parts);
+
+    /// get the maximum number of parts sent concurrently by multi-part uploads
+    unsigned int getUploadConcurrency() const;
+
+    /// set the maximum number of requests sent concurrently by bulk metadata operations
+    /// default: 16
+    void setMetadataConcurrency(const unsigned int requests);
+
+    /// get the maximum number of requests sent concurrently by bulk metadata operations
+    unsigned int getMetadataConcurrency() const;
+
+    /// set the part size of multi-part uploads: S3 parts, Swift segments and Azure blocks
+    /// default: 0, automatic
+    ///
+    /// The automatic size is the smallest one keeping the object within the
+    /// part count limit of the protocol, at least 8 MiB. Streams of unknown size
+    /// start with 8 MiB parts, growing as the stream goes on up to 1/8 of the
+    /// available memory.
+    /// An explicit size too small to fit the object in the part count limit is
+    /// raised, sizes above the limit of the protocol are clamped. Uploads with
+    /// a size below the minimum of the protocol, 5 MiB for S3, fail with
+    /// StatusCode::InvalidArgument.
+    void setUploadPartSize(const dav_size_t size);
+
+    /// get the part size of multi-part uploads, 0 if automatic
+    dav_size_t getUploadPartSize() const;
+
+    /// set the object size above which S3 and Swift uploads use multi-part
+    /// default: 512 MiB
+    void setMultipartThreshold(const dav_size_t size);
+
+    /// get the object size above which S3 and Swift uploads use multi-part
+    dav_size_t getMultipartThreshold() const;
+
+    /// enable resumable S3 and Swift multi-part uploads
+    /// default: empty, disabled
+    ///
+    /// The progress of each multi-part upload is recorded in a small journal
+    /// file in dir. When an upload fails, retrying it from the same unmodified
+    /// file skips the parts already stored on the server, once checked
+    /// against their MD5 etag: parts with another kind of etag are sent again.
+    /// Uploads from a pipe or a callback are never resumed, their source
+    /// can't be identified.
+    /// DavFile::abortPendingUploads cancels an unfinished upload instead.
+    void setUploadJournalDir(const std::string & dir);
+
+    /// get the directory of the resumable upload journals
+    const std::string & getUploadJournalDir() const;
+
+    /// check each uploaded Swift segment against the etag returned by the server
+    /// default: false
+    ///
+    /// The MD5 sum of the segment data is compared with the etag of the
+    /// response, a mismatch fails the upload before the manifest is committed.
+    /// So does an etag which is not a plain MD5 sum, as it can't be verified.
+    void setVerifySegmentChecksums(const bool verify);
+
+    /// get the Swift segment checksum verification flag
+    bool getVerifySegmentChecksums() const;
+
+    /// upload regular files given to DavFile::put from a memory mapping
+    /// default: false
+    ///
+    /// Multi-part uploads then send the parts straight from the page cache
+    /// instead of reading them into buffers first. The file must not be
+    /// truncated during the upload: the process would be killed by SIGBUS.
+    void setMmapUploads(const bool value);
+
+    /// get the memory mapped upload flag
+    bool getMmapUploads() const;
+
+    /// verify whole file transfers with the given checksum algorithm: adler32, md5 or crc32c
+    /// default: empty, disabled
+    ///
+    /// The checksum is computed while the data is uploaded by DavFile::put or
+    /// downloaded by DavFile::get and DavFile::getToFd, then compared with the
+    /// one reported by the server. A mismatch is reported as
+    /// StatusCode::ChecksumMismatch.
+    void setTransferChecksum(const std::string & algorithm);
+
+    /// get the transfer checksum algorithm
+    const std::string & getTransferChecksum() const;
+
 #ifdef __DAVIX_HAS_STD_FUNCTION
     ///
     /// @brief setTransfertMonitorCb
@@ -431,6 +594,7 @@ public:
     /// @param delay the delay in seconds
     void setAcceptedRetryDelay(int delay);
 private:
+    friend struct RequestParamsExplorer;
 
    // dptr
     RequestParamsInternal* d_ptr;
@@ -155,6 +155,12 @@ enum Code {
     /// Insufficient storage
     InsufficientStorage = 0x27,
 
+    /// Checksum of the transferred data differs from the server one
+    ChecksumMismatch = 0x28,
+
+    /// Some of the items of a bulk operation failed, see their own errors
+    PartialFailure = 0x29,
+
     /// Undefined error
     UnknowError = 0x100
 
@@ -37,6 +37,10 @@ Uri tokenizeRequest(const RequestParams & params, const std::string & method, co
 
 Uri s3UriTransformer(const Uri & original_url, const RequestParams & params, const bool addDelimiter);
 
+// listing of the keys of the bucket of original_url starting with prefix, after marker if not empty
+Uri s3ListingUri(const Uri & original_url, const RequestParams & params, const std::string & prefix,
+                 const bool addDelimiter, const std::string & marker);
+
 time_t s3TimeConverter(std::string &s3time);
 
 std::string hexPrinter(const unsigned char* data, dav_size_t nbytes);
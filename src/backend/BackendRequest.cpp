@@ -237,6 +237,20 @@ dav_ssize_t BackendRequest::readToFd(int fd, dav_size_t read_size, DavixError**
   dav_ssize_t ret=1, total=0;
   dav_size_t chunk_size = DAVIX_BLOCK_SIZE;
   read_size = (read_size==0)?(std::numeric_limits<dav_size_t>::max()):read_size;
+
+  // plain-text body, straight from the socket to fd: no need to copy it around
+  if(canSpliceToFd(fd)) {
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_HTTP, "Davix::BackendRequest::readToFd: zero-copy transfer to fd {}", fd);
+
+    while(read_size > 0 && (ret = spliceBlockToFd(fd, std::min<dav_size_t>(DAVIX_MAX_BLOCK_SIZE, read_size), err)) > 0) {
+      read_size -= ret;
+      total += ret;
+    }
+
+    if(total > 0) return total;
+    return ret;
+  }
+
   std::vector<char> buffer(chunk_size);
 
   while( (ret = readBlock(&buffer[0],
@@ -69,6 +69,14 @@ public:
   //----------------------------------------------------------------------------
   virtual dav_ssize_t readBlock(char* buffer, dav_size_t max_size, DavixError** err) = 0;
 
+  //----------------------------------------------------------------------------
+  // Zero-copy read members - implementations need to override.
+  // Move a block of max_size bytes (at max) of the response body into fd
+  // without going through userspace, if canSpliceToFd allows it.
+  //----------------------------------------------------------------------------
+  virtual bool canSpliceToFd(int fd) const = 0;
+  virtual dav_ssize_t spliceBlockToFd(int fd, dav_size_t max_size, DavixError** err) = 0;
+
   //----------------------------------------------------------------------------
   // Get a specific response header
   //----------------------------------------------------------------------------
@@ -0,0 +1,70 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "Continue100Cache.hpp"
+#include <algorithm>
+#include "SessionFactory.hpp"
+#include <utils/davix_uri.hpp>
+#include <params/davixrequestparams.hpp>
+#include <utils/davix_logger_internal.hpp>
+
+namespace Davix {
+
+//------------------------------------------------------------------------------
+// Wait for the 100 (Continue) answer configured in params, in milliseconds
+//------------------------------------------------------------------------------
+int continue100WaitMs(const RequestParams &params) {
+  const struct timespec* timeout = params.get100ContinueTimeout();
+  if(timeout->tv_sec == 0 && timeout->tv_nsec == 0) {
+    return 0;
+  }
+
+  // a short, non-zero wait must not turn into an indefinite one
+  return std::max<long>(1, timeout->tv_sec * 1000 + timeout->tv_nsec / 1000000);
+}
+
+//------------------------------------------------------------------------------
+// How the host of uri answered its last handshake
+//------------------------------------------------------------------------------
+Continue100Cache::Support Continue100Cache::get(const Uri &uri) const {
+  std::lock_guard<std::mutex> lock(_mtx);
+
+  std::map<std::string, Support>::const_iterator it = _hosts.find(SessionFactory::makeSessionKey(uri));
+  if(it == _hosts.end()) {
+    return Unknown;
+  }
+  return it->second;
+}
+
+//------------------------------------------------------------------------------
+// Record the outcome of a handshake with the host of uri
+//------------------------------------------------------------------------------
+void Continue100Cache::set(const Uri &uri, Support support) {
+  const std::string key = SessionFactory::makeSessionKey(uri);
+
+  std::lock_guard<std::mutex> lock(_mtx);
+  Support &entry = _hosts[key];
+  if(entry != support && support == NoAnswer) {
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_HTTP, "{} does not answer 100-continue expectations, not waiting for it anymore", key);
+  }
+  entry = support;
+}
+
+}
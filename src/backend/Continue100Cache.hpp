@@ -0,0 +1,71 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_BACKEND_CONTINUE100_CACHE_HPP
+#define DAVIX_BACKEND_CONTINUE100_CACHE_HPP
+
+#include <map>
+#include <mutex>
+#include <string>
+
+namespace Davix {
+
+class Uri;
+class RequestParams;
+
+//------------------------------------------------------------------------------
+// Wait for the 100 (Continue) answer configured in params, in milliseconds,
+// 0 to wait for it indefinitely
+//------------------------------------------------------------------------------
+int continue100WaitMs(const RequestParams &params);
+
+//------------------------------------------------------------------------------
+// Remembers, per host, how servers answered "Expect: 100-continue".
+//
+// Uploads to hosts which never send the interim 100 (Continue) answer would
+// wait for it on every request, so the handshake is skipped for them once
+// they have been seen ignoring it.
+//------------------------------------------------------------------------------
+class Continue100Cache {
+public:
+  enum Support {
+    Unknown,   // no upload to this host yet
+    Supported, // answered the expectation, with a 100 or an early final status
+    NoAnswer   // the body had to be sent without an answer
+  };
+
+  //----------------------------------------------------------------------------
+  // How the host of uri answered its last handshake
+  //----------------------------------------------------------------------------
+  Support get(const Uri &uri) const;
+
+  //----------------------------------------------------------------------------
+  // Record the outcome of a handshake with the host of uri
+  //----------------------------------------------------------------------------
+  void set(const Uri &uri, Support support);
+
+private:
+  mutable std::mutex _mtx;
+  std::map<std::string, Support> _hosts;
+};
+
+}
+
+#endif
@@ -25,9 +25,15 @@
 #include <neon/neonsession.hpp>
 #include <ne_redirect.h>
 #include <ne_request.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #define DBG(message) std::cerr << __FILE__ << ":" << __LINE__ << " -- " << #message << " = " << message << std::endl;
 
+// size requested for the kernel pipe used by zero-copy reads
+#define SPLICE_PIPE_SIZE (1 << 20)
+
 namespace Davix {
 
 //------------------------------------------------------------------------------
@@ -125,13 +131,17 @@ StandaloneNeonRequest::StandaloneNeonRequest(NEONSessionFactory &sessionFactory,
 : _session_factory(sessionFactory), _reuse_session(reuseSession), _bound_hooks(boundHooks),
   _uri(uri), _verb(verb), _params(params), _state(RequestState::kNotStarted),
   _headers(headers), _req_flag(reqFlag), _content_provider(contentProvider),
-  _deadline(deadline), _neon_req(NULL), _total_read_size(0), _last_read(-1) {}
+  _deadline(deadline), _neon_req(NULL), _total_read_size(0), _last_read(-1) {
+
+  _splice_pipe[0] = _splice_pipe[1] = -1;
+}
 
 //------------------------------------------------------------------------------
 // Destructor
 //------------------------------------------------------------------------------
 StandaloneNeonRequest::~StandaloneNeonRequest() {
   markCompleted();
+  closeSplicePipe();
 
   if(_neon_req) {
     ne_request_destroy(_neon_req);
@@ -239,12 +249,16 @@ Status StandaloneNeonRequest::startRequest() {
   //----------------------------------------------------------------------------
   // Setup flags
   //----------------------------------------------------------------------------
-  ne_set_request_flag(_neon_req, NE_REQFLAG_EXPECT100, _params.get100ContinueSupport() &&
-            (_req_flag & RequestFlag::SupportContinue100));
+  Continue100Cache &continue100 = _session_factory.getContinue100Cache();
+  const bool expect100 = _content_provider && _params.get100ContinueSupport() &&
+            (_req_flag & RequestFlag::SupportContinue100) &&
+            continue100.get(_uri) != Continue100Cache::NoAnswer;
+
+  ne_set_request_flag(_neon_req, NE_REQFLAG_EXPECT100, expect100);
   ne_set_request_flag(_neon_req, NE_REQFLAG_IDEMPOTENT, _req_flag & RequestFlag::IdempotentRequest);
 
-  if( (_req_flag & RequestFlag::SupportContinue100) == true) {
-    _session->do_not_reuse_this_session();
+  if(expect100) {
+    ne_set_request_expect100_timeout(_neon_req, continue100WaitMs(_params));
   }
 
   //----------------------------------------------------------------------------
@@ -271,6 +285,28 @@ Status StandaloneNeonRequest::startRequest() {
     return st;
   }
 
+  //----------------------------------------------------------------------------
+  // Remember how the server answered the expectation. A final answer came
+  // before the body, e.g. an error: the body was never sent, and neon does
+  // not reuse the connection.
+  //----------------------------------------------------------------------------
+  if(expect100) {
+    switch(ne_get_request_expect100(_neon_req)) {
+      case NE_EXPECT100_FINAL:
+        DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_HTTP, "Server answered {} to the 100-continue expectation, request body not sent", ne_get_status(_neon_req)->code);
+        continue100.set(_uri, (ne_get_status(_neon_req)->code == 417) ? Continue100Cache::NoAnswer : Continue100Cache::Supported);
+        break;
+      case NE_EXPECT100_CONTINUE:
+        continue100.set(_uri, Continue100Cache::Supported);
+        break;
+      case NE_EXPECT100_TIMEOUT:
+        continue100.set(_uri, Continue100Cache::NoAnswer);
+        break;
+      default:
+        break;
+    }
+  }
+
   //----------------------------------------------------------------------------
   // Connection OK, we're good to go
   //----------------------------------------------------------------------------
@@ -336,6 +372,109 @@ dav_ssize_t StandaloneNeonRequest::readBlock(char* buffer, dav_size_t max_size,
   return _last_read;
 }
 
+//------------------------------------------------------------------------------
+// Can the kernel splice data into this fd? Appending files are refused by
+// splice(2) on a number of kernels, don't bother with them.
+//------------------------------------------------------------------------------
+static bool isSpliceDestination(int fd) {
+#ifdef __linux__
+  struct stat st;
+  if(fstat(fd, &st) != 0) {
+    return false;
+  }
+
+  int flags = fcntl(fd, F_GETFL);
+  if(flags < 0 || (flags & O_APPEND)) {
+    return false;
+  }
+
+  return S_ISREG(st.st_mode) || S_ISFIFO(st.st_mode) || S_ISSOCK(st.st_mode);
+#else
+  (void) fd;
+  return false;
+#endif
+}
+
+//------------------------------------------------------------------------------
+// Can the response body be moved into the given fd without going through
+// userspace buffers? Requires a plain-text connection, and a response body
+// which is not chunk-encoded.
+//------------------------------------------------------------------------------
+bool StandaloneNeonRequest::canSpliceToFd(int fd) const {
+  if(!_neon_req || _state != RequestState::kStarted) {
+    return false;
+  }
+
+  return ne_response_splice_capable(_neon_req) && isSpliceDestination(fd);
+}
+
+//------------------------------------------------------------------------------
+// Zero-copy read function - move a block of max_size bytes (at max) from
+// the connection into fd.
+//------------------------------------------------------------------------------
+dav_ssize_t StandaloneNeonRequest::spliceToFd(int fd, dav_size_t max_size, Status& st) {
+
+  if(!_neon_req) {
+    st = Status(davix_scope_http_request(), StatusCode::AlreadyRunning, "Request has not been started yet");
+    return -1;
+  }
+
+  if(max_size == 0) {
+    return 0;
+  }
+
+  if(_last_read == 0) {
+    return 0;
+  }
+
+  st = checkTimeout();
+  if(!st.ok()) {
+    return -1;
+  }
+
+  if(_splice_pipe[0] < 0) {
+#ifdef __linux__
+    if(pipe2(_splice_pipe, O_CLOEXEC) != 0) {
+      _splice_pipe[0] = _splice_pipe[1] = -1;
+      st = Status(davix_scope_http_request(), StatusCode::SystemError, std::string("Impossible to create splice pipe: ").append(strerror(errno)));
+      return -1;
+    }
+
+    // best effort, a bigger pipe means fewer trips through the kernel
+    fcntl(_splice_pipe[1], F_SETPIPE_SZ, SPLICE_PIPE_SIZE);
+#else
+    st = Status(davix_scope_http_request(), StatusCode::OperationNonSupported, "Zero-copy reads are not supported on this platform");
+    return -1;
+#endif
+  }
+
+  _last_read = ne_read_response_splice(_neon_req, _splice_pipe, fd, max_size);
+  if(_last_read < 0) {
+    st = Status(davix_scope_http_request(), StatusCode::ConnectionProblem, std::string("Invalid zero-copy read in request: ").append(getSessionError()));
+    _session->do_not_reuse_this_session();
+    markCompleted();
+    closeSplicePipe();
+    return -1;
+  }
+
+  DAVIX_SLOG(DAVIX_LOG_TRACE, DAVIX_LOG_HTTP, "StandaloneNeonRequest::spliceToFd moved {} bytes", _last_read);
+
+  _total_read_size += _last_read;
+  return _last_read;
+}
+
+//------------------------------------------------------------------------------
+// Close the pipe used for zero-copy reads, if any
+//------------------------------------------------------------------------------
+void StandaloneNeonRequest::closeSplicePipe() {
+  for(size_t i = 0; i < 2; i++) {
+    if(_splice_pipe[i] >= 0) {
+      close(_splice_pipe[i]);
+      _splice_pipe[i] = -1;
+    }
+  }
+}
+
 //------------------------------------------------------------------------------
 // Check request state
 //------------------------------------------------------------------------------
@@ -107,6 +107,18 @@ public:
   //----------------------------------------------------------------------------
   virtual dav_ssize_t readBlock(char* buffer, dav_size_t max_size, Status& st);
 
+  //----------------------------------------------------------------------------
+  // Can the response body be moved into the given fd without going through
+  // userspace buffers?
+  //----------------------------------------------------------------------------
+  virtual bool canSpliceToFd(int fd) const;
+
+  //----------------------------------------------------------------------------
+  // Zero-copy read function - move a block of max_size bytes (at max) from
+  // the connection into fd.
+  //----------------------------------------------------------------------------
+  virtual dav_ssize_t spliceToFd(int fd, dav_size_t max_size, Status& st);
+
   //----------------------------------------------------------------------------
   // Check request state
   //----------------------------------------------------------------------------
@@ -155,6 +167,7 @@ private:
   ne_request* _neon_req;
   dav_ssize_t _total_read_size;
   dav_ssize_t _last_read;
+  int _splice_pipe[2];
 
   //----------------------------------------------------------------------------
   // Check if timeout has passed
@@ -166,6 +179,11 @@ private:
   //----------------------------------------------------------------------------
   void markCompleted();
 
+  //----------------------------------------------------------------------------
+  // Close the pipe used for zero-copy reads, if any
+  //----------------------------------------------------------------------------
+  void closeSplicePipe();
+
   //----------------------------------------------------------------------------
   // Create davix error object based on errors in the current session,
   // or request
@@ -77,6 +77,18 @@ public:
   //----------------------------------------------------------------------------
   virtual dav_ssize_t readBlock(char* buffer, dav_size_t max_size, Status& st) = 0;
 
+  //----------------------------------------------------------------------------
+  // Can the response body be moved into the given fd without going through
+  // userspace buffers? Only meaningful once the request has been started.
+  //----------------------------------------------------------------------------
+  virtual bool canSpliceToFd(int fd) const = 0;
+
+  //----------------------------------------------------------------------------
+  // Zero-copy read function - move a block of max_size bytes (at max) from
+  // the connection into fd. Only valid if canSpliceToFd returned true.
+  //----------------------------------------------------------------------------
+  virtual dav_ssize_t spliceToFd(int fd, dav_size_t max_size, Status& st) = 0;
+
   //----------------------------------------------------------------------------
   // Check request state
   //----------------------------------------------------------------------------
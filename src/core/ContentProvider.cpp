@@ -20,13 +20,25 @@
 */
 
 #include "ContentProvider.hpp"
+#include <utils/checksum_calculator.hpp>
 #include <fcntl.h>
 #include <string.h>
 #include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include <sstream>
+#include <algorithm>
 
 #define SSTR(message) static_cast<std::ostringstream&>(std::ostringstream().flush() << message).str()
 
+//------------------------------------------------------------------------------
+// Fingerprint of len bytes of a regular file starting from offset: identity,
+// size and modification time of the file
+//------------------------------------------------------------------------------
+static std::string fileFingerprint(const struct stat &st, off_t offset, size_t len) {
+  return SSTR(st.st_dev << ":" << st.st_ino << ":" << st.st_size << ":" << st.st_mtime << ":" << offset << "+" << len);
+}
+
 namespace Davix {
 
 //------------------------------------------------------------------------------
@@ -98,6 +110,13 @@ ssize_t BufferContentProvider::getSize() {
   return _count;
 }
 
+//------------------------------------------------------------------------------
+// getContiguousData implementation.
+//------------------------------------------------------------------------------
+const char* BufferContentProvider::getContiguousData() {
+  return _buffer;
+}
+
 //------------------------------------------------------------------------------
 // Constructor
 //------------------------------------------------------------------------------
@@ -140,6 +159,161 @@ ssize_t OwnedBufferContentProvider::getSize() {
   return _provider.getSize();
 }
 
+//------------------------------------------------------------------------------
+// getContiguousData implementation.
+//------------------------------------------------------------------------------
+const char* OwnedBufferContentProvider::getContiguousData() {
+  return _provider.getContiguousData();
+}
+
+//------------------------------------------------------------------------------
+// MmapContentProvider constructor
+//------------------------------------------------------------------------------
+MmapContentProvider::MmapContentProvider(int fd, off_t offset, size_t maxLen)
+: _mapping(MAP_FAILED), _mapping_len(0), _provider(NULL, 0) {
+
+  struct stat st;
+  if(::fstat(fd, &st) != 0) {
+    _errc = errno;
+    _errMsg = strerror(_errc);
+    return;
+  }
+
+  if(!S_ISREG(st.st_mode)) {
+    _errc = ENODEV;
+    _errMsg = "Only regular files can be mapped";
+    return;
+  }
+
+  if(offset < 0 || offset >= st.st_size) {
+    _errc = ERANGE;
+    _errMsg = SSTR("Invalid offset (" << offset << ") given, fd contains only " << st.st_size << " bytes");
+    return;
+  }
+
+  size_t len = st.st_size - offset;
+  if(maxLen != 0) {
+    len = std::min(len, maxLen);
+  }
+
+  // mappings start on a page boundary
+  const off_t pageSize = ::sysconf(_SC_PAGESIZE);
+  const off_t mapOffset = offset - (offset % pageSize);
+  _mapping_len = len + (offset - mapOffset);
+
+  _mapping = ::mmap(NULL, _mapping_len, PROT_READ, MAP_PRIVATE, fd, mapOffset);
+  if(_mapping == MAP_FAILED) {
+    _errc = errno;
+    _errMsg = strerror(_errc);
+    return;
+  }
+
+  // parts are read concurrently by the upload workers, not from start to
+  // end: keep the default read-ahead, MADV_SEQUENTIAL would drop the pages
+  // behind the part read furthest
+  ::madvise(_mapping, _mapping_len, MADV_NORMAL);
+  _provider = BufferContentProvider(static_cast<const char*>(_mapping) + (offset - mapOffset), len);
+  _fingerprint = fileFingerprint(st, offset, len);
+}
+
+//------------------------------------------------------------------------------
+// Destructor
+//------------------------------------------------------------------------------
+MmapContentProvider::~MmapContentProvider() {
+  if(_mapping != MAP_FAILED) {
+    ::munmap(_mapping, _mapping_len);
+  }
+}
+
+//------------------------------------------------------------------------------
+// pullBytes implementation.
+//------------------------------------------------------------------------------
+ssize_t MmapContentProvider::pullBytes(char* target, size_t requestedBytes) {
+  if(!ok()) {
+    return - _errc;
+  }
+
+  return _provider.pullBytes(target, requestedBytes);
+}
+
+//------------------------------------------------------------------------------
+// Rewind implementation.
+//------------------------------------------------------------------------------
+bool MmapContentProvider::rewind() {
+  if(!ok()) {
+    return false;
+  }
+
+  return _provider.rewind();
+}
+
+//------------------------------------------------------------------------------
+// getSize implementation.
+//------------------------------------------------------------------------------
+ssize_t MmapContentProvider::getSize() {
+  return _provider.getSize();
+}
+
+//------------------------------------------------------------------------------
+// getContiguousData implementation.
+//------------------------------------------------------------------------------
+const char* MmapContentProvider::getContiguousData() {
+  return _provider.getContiguousData();
+}
+
+//------------------------------------------------------------------------------
+// getSourceFingerprint implementation.
+//------------------------------------------------------------------------------
+std::string MmapContentProvider::getSourceFingerprint() {
+  return _fingerprint;
+}
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+ChecksumContentProvider::ChecksumContentProvider(ContentProvider &provider, ChecksumCalculator &checksum)
+: _provider(provider), _checksum(checksum) {
+  _errc = _provider.getErrc();
+  _errMsg = _provider.getError();
+}
+
+//------------------------------------------------------------------------------
+// pullBytes implementation.
+//------------------------------------------------------------------------------
+ssize_t ChecksumContentProvider::pullBytes(char* target, size_t requestedBytes) {
+  ssize_t retval = _provider.pullBytes(target, requestedBytes);
+  if(retval > 0) {
+    _checksum.update(target, retval);
+  }
+  else if(retval < 0) {
+    _errc = _provider.getErrc();
+    _errMsg = _provider.getError();
+  }
+  return retval;
+}
+
+//------------------------------------------------------------------------------
+// Rewind implementation.
+//------------------------------------------------------------------------------
+bool ChecksumContentProvider::rewind() {
+  _checksum.reset();
+  return _provider.rewind();
+}
+
+//------------------------------------------------------------------------------
+// getSize implementation.
+//------------------------------------------------------------------------------
+ssize_t ChecksumContentProvider::getSize() {
+  return _provider.getSize();
+}
+
+//------------------------------------------------------------------------------
+// getSourceFingerprint implementation.
+//------------------------------------------------------------------------------
+std::string ChecksumContentProvider::getSourceFingerprint() {
+  return _provider.getSourceFingerprint();
+}
+
 //------------------------------------------------------------------------------
 // FdContentProvider constructor
 //------------------------------------------------------------------------------
@@ -235,6 +409,17 @@ ssize_t FdContentProvider::getSize() {
   return _target_len;
 }
 
+//------------------------------------------------------------------------------
+// getSourceFingerprint implementation.
+//------------------------------------------------------------------------------
+std::string FdContentProvider::getSourceFingerprint() {
+  struct stat st;
+  if(!ok() || ::fstat(_fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    return std::string();
+  }
+  return fileFingerprint(st, _offset, _target_len);
+}
+
 //------------------------------------------------------------------------------
 // Constructor
 //------------------------------------------------------------------------------
@@ -247,6 +432,12 @@ CallbackContentProvider::CallbackContentProvider(HttpBodyProvider provider, dav_
 CallbackContentProvider::CallbackContentProvider(DataProviderFun provider, dav_size_t len)
 : _providerFun(provider), _len(len) {}
 
+//----------------------------------------------------------------------------
+// Constructor
+//----------------------------------------------------------------------------
+CallbackContentProvider::CallbackContentProvider(DataProviderFun provider)
+: _providerFun(provider), _len(-1), _udata(NULL) {}
+
 //------------------------------------------------------------------------------
 // pullBytes implementation.
 //------------------------------------------------------------------------------
@@ -285,7 +476,12 @@ bool CallbackContentProvider::rewind() {
   }
 
   if(_providerFun) {
-    _providerFun(NULL, 0);
+    // streams which cannot be replayed refuse to rewind once consumed
+    if(_providerFun(NULL, 0) != 0) {
+      _errc = ESPIPE;
+      _errMsg = "Data provider callback cannot rewind";
+      return false;
+    }
   }
   else {
     _provider(_udata, NULL, 0);
@@ -301,4 +497,102 @@ ssize_t CallbackContentProvider::getSize() {
   return _len;
 }
 
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+PipeContentProvider::PipeContentProvider(size_t capacity)
+: _ring(std::max<size_t>(capacity, 1)), _head(0), _used(0), _consumed(0),
+  _closed(false), _cancelled(false) {}
+
+//------------------------------------------------------------------------------
+// Producer side: append count bytes, blocking while the pipe is full.
+//------------------------------------------------------------------------------
+bool PipeContentProvider::push(const char* buf, size_t count) {
+  std::unique_lock<std::mutex> lock(_mtx);
+
+  while(count > 0) {
+    _cv.wait(lock, [this] { return _cancelled || _used < _ring.size(); });
+    if(_cancelled) {
+      return false;
+    }
+
+    size_t tail = (_head + _used) % _ring.size();
+    size_t chunk = std::min(count, _ring.size() - _used);
+    chunk = std::min(chunk, _ring.size() - tail);
+
+    memcpy(_ring.data() + tail, buf, chunk);
+    _used += chunk;
+    buf += chunk;
+    count -= chunk;
+    _cv.notify_all();
+  }
+
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Producer side: signal end of data.
+//------------------------------------------------------------------------------
+void PipeContentProvider::close() {
+  std::lock_guard<std::mutex> lock(_mtx);
+  _closed = true;
+  _cv.notify_all();
+}
+
+//------------------------------------------------------------------------------
+// Either side: stop the transfer.
+//------------------------------------------------------------------------------
+void PipeContentProvider::cancel() {
+  std::lock_guard<std::mutex> lock(_mtx);
+  _cancelled = true;
+  _cv.notify_all();
+}
+
+//------------------------------------------------------------------------------
+// Total number of bytes pulled by the consumer so far.
+//------------------------------------------------------------------------------
+size_t PipeContentProvider::getConsumed() {
+  std::lock_guard<std::mutex> lock(_mtx);
+  return _consumed;
+}
+
+//------------------------------------------------------------------------------
+// pullBytes implementation.
+//------------------------------------------------------------------------------
+ssize_t PipeContentProvider::pullBytes(char* target, size_t requestedBytes) {
+  std::unique_lock<std::mutex> lock(_mtx);
+  _cv.wait(lock, [this] { return _used > 0 || _closed || _cancelled; });
+
+  if(_cancelled) {
+    _errc = ECANCELED;
+    _errMsg = "Pipe cancelled by consumer";
+    return -_errc;
+  }
+
+  size_t chunk = std::min(requestedBytes, _used);
+  chunk = std::min(chunk, _ring.size() - _head);
+
+  memcpy(target, _ring.data() + _head, chunk);
+  _head = (_head + chunk) % _ring.size();
+  _used -= chunk;
+  _consumed += chunk;
+  _cv.notify_all();
+  return chunk;
+}
+
+//------------------------------------------------------------------------------
+// Rewind implementation - only possible before anything has been consumed.
+//------------------------------------------------------------------------------
+bool PipeContentProvider::rewind() {
+  std::lock_guard<std::mutex> lock(_mtx);
+  return _consumed == 0;
+}
+
+//------------------------------------------------------------------------------
+// getSize implementation - unknown until the producer is done.
+//------------------------------------------------------------------------------
+ssize_t PipeContentProvider::getSize() {
+  return -1;
+}
+
 }
@@ -25,9 +25,14 @@
 #include <request/httprequest.hpp>
 #include "stdlib.h"
 #include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
 
 namespace Davix {
 
+class ChecksumCalculator;
+
 //------------------------------------------------------------------------------
 // Abstract ContentProvider interface to provide the raw bytes for HTTP body
 // content.
@@ -76,12 +81,31 @@ public:
   // Get total size - should return a constant throughout the lifetime of this
   // object.
   //
-  // Return -1 if size is not known beforehand. davix does not currently
-  // support this option with libneon, as we don't have chunked encoding
-  // for uploads yet.
+  // Return -1 if size is not known beforehand. Plain HTTP uploads are then
+  // sent with chunked transfer-encoding.
   //----------------------------------------------------------------------------
   virtual ssize_t getSize() = 0;
 
+  //----------------------------------------------------------------------------
+  // Get the whole contents, if they are addressable in memory: a pointer to
+  // getSize() bytes, valid for the lifetime of this object and independent
+  // of the current position. Multi-part uploads send slices of it without
+  // copying them.
+  //
+  // Return NULL if the contents can only be pulled.
+  //----------------------------------------------------------------------------
+  virtual const char* getContiguousData() { return NULL; }
+
+  //----------------------------------------------------------------------------
+  // Identify the source of the contents, so that an interrupted upload is
+  // only resumed from the same unmodified source: a string changing whenever
+  // the source does.
+  //
+  // Return an empty string if the source can't be identified, uploads from
+  // it are then never resumed.
+  //----------------------------------------------------------------------------
+  virtual std::string getSourceFingerprint() { return std::string(); }
+
   //----------------------------------------------------------------------------
   // Is the object ok?
   //----------------------------------------------------------------------------
@@ -127,6 +151,11 @@ public:
   //----------------------------------------------------------------------------
   ssize_t getSize();
 
+  //----------------------------------------------------------------------------
+  // getContiguousData implementation.
+  //----------------------------------------------------------------------------
+  const char* getContiguousData();
+
 private:
   const char* _buffer;
   size_t _count;
@@ -164,6 +193,11 @@ public:
   //----------------------------------------------------------------------------
   ssize_t getSize();
 
+  //----------------------------------------------------------------------------
+  // getContiguousData implementation.
+  //----------------------------------------------------------------------------
+  const char* getContiguousData();
+
 private:
   std::string _contents;
   BufferContentProvider _provider;
@@ -196,6 +230,11 @@ public:
   //----------------------------------------------------------------------------
   ssize_t getSize();
 
+  //----------------------------------------------------------------------------
+  // getSourceFingerprint implementation, regular files only.
+  //----------------------------------------------------------------------------
+  std::string getSourceFingerprint();
+
 private:
   int _fd;
   ssize_t _fd_size;
@@ -205,6 +244,102 @@ private:
   size_t _bytes_provided;
 };
 
+//------------------------------------------------------------------------------
+// Content provider mapping a regular file in memory - no ownership on the
+// underlying file descriptor. The contents are handed out without copies
+// through getContiguousData(). The file must not be truncated while this
+// object is alive.
+//
+// Check ok() after construction: files which can't be mapped (pipes,
+// sockets, empty files) are reported as errors, use a FdContentProvider
+// for them instead.
+//------------------------------------------------------------------------------
+class MmapContentProvider : public ContentProvider {
+public:
+  //----------------------------------------------------------------------------
+  // Constructor. Map maxLen bytes starting from the given offset. With
+  // maxLen = 0, map the entire rest of the file.
+  //----------------------------------------------------------------------------
+  MmapContentProvider(int fd, off_t offset = 0, size_t maxLen = 0);
+
+  //----------------------------------------------------------------------------
+  // Destructor, unmaps the file
+  //----------------------------------------------------------------------------
+  ~MmapContentProvider();
+
+  //----------------------------------------------------------------------------
+  // pullBytes implementation.
+  //----------------------------------------------------------------------------
+  ssize_t pullBytes(char* target, size_t requestedBytes);
+
+  //----------------------------------------------------------------------------
+  // Rewind implementation.
+  //----------------------------------------------------------------------------
+  bool rewind();
+
+  //----------------------------------------------------------------------------
+  // getSize implementation.
+  //----------------------------------------------------------------------------
+  ssize_t getSize();
+
+  //----------------------------------------------------------------------------
+  // getContiguousData implementation.
+  //----------------------------------------------------------------------------
+  const char* getContiguousData();
+
+  //----------------------------------------------------------------------------
+  // getSourceFingerprint implementation.
+  //----------------------------------------------------------------------------
+  std::string getSourceFingerprint();
+
+private:
+  MmapContentProvider(const MmapContentProvider&);
+  MmapContentProvider& operator=(const MmapContentProvider&);
+
+  void* _mapping;
+  size_t _mapping_len;
+  BufferContentProvider _provider;
+  std::string _fingerprint;
+};
+
+//------------------------------------------------------------------------------
+// Content provider feeding the contents pulled from another provider to a
+// checksum calculator - no ownership on either. Rewinding resets the
+// checksum. The contents are not exposed through getContiguousData(), so that
+// every byte sent goes through the checksum.
+//------------------------------------------------------------------------------
+class ChecksumContentProvider : public ContentProvider {
+public:
+  //----------------------------------------------------------------------------
+  // Constructor
+  //----------------------------------------------------------------------------
+  ChecksumContentProvider(ContentProvider &provider, ChecksumCalculator &checksum);
+
+  //----------------------------------------------------------------------------
+  // pullBytes implementation.
+  //----------------------------------------------------------------------------
+  ssize_t pullBytes(char* target, size_t requestedBytes);
+
+  //----------------------------------------------------------------------------
+  // Rewind implementation.
+  //----------------------------------------------------------------------------
+  bool rewind();
+
+  //----------------------------------------------------------------------------
+  // getSize implementation.
+  //----------------------------------------------------------------------------
+  ssize_t getSize();
+
+  //----------------------------------------------------------------------------
+  // getSourceFingerprint implementation.
+  //----------------------------------------------------------------------------
+  std::string getSourceFingerprint();
+
+private:
+  ContentProvider &_provider;
+  ChecksumCalculator &_checksum;
+};
+
 //------------------------------------------------------------------------------
 // Content provider based on a HttpBodyProvider callback.
 //------------------------------------------------------------------------------
@@ -221,6 +356,12 @@ public:
   //----------------------------------------------------------------------------
   CallbackContentProvider(DataProviderFun provider, dav_size_t len);
 
+  //----------------------------------------------------------------------------
+  // Constructor, for contents of unknown size: the callback is pulled until
+  // it returns 0.
+  //----------------------------------------------------------------------------
+  CallbackContentProvider(DataProviderFun provider);
+
   //----------------------------------------------------------------------------
   // pullBytes implementation.
   //----------------------------------------------------------------------------
@@ -241,10 +382,73 @@ private:
   HttpBodyProvider _provider;
   DataProviderFun  _providerFun;
 
-  dav_size_t _len;
+  dav_ssize_t _len;
   void *_udata;
 };
 
+//------------------------------------------------------------------------------
+// Content provider fed by another thread through a bounded in-memory pipe.
+// The producer blocks in push() while the pipe is full, the consumer blocks
+// in pullBytes() while it is empty. Size is unknown, and the contents can
+// only be rewound as long as nothing has been pulled yet.
+//------------------------------------------------------------------------------
+class PipeContentProvider : public ContentProvider {
+public:
+  //----------------------------------------------------------------------------
+  // Constructor, capacity is the maximum number of buffered bytes.
+  //----------------------------------------------------------------------------
+  PipeContentProvider(size_t capacity);
+
+  //----------------------------------------------------------------------------
+  // Producer side: append count bytes, blocking while the pipe is full.
+  // Returns false if the consumer has given up, in which case the data
+  // was not queued.
+  //----------------------------------------------------------------------------
+  bool push(const char* buf, size_t count);
+
+  //----------------------------------------------------------------------------
+  // Producer side: signal end of data.
+  //----------------------------------------------------------------------------
+  void close();
+
+  //----------------------------------------------------------------------------
+  // Either side: stop the transfer, a blocked producer is woken up and the
+  // consumer fails with ECANCELED.
+  //----------------------------------------------------------------------------
+  void cancel();
+
+  //----------------------------------------------------------------------------
+  // Total number of bytes pulled by the consumer so far.
+  //----------------------------------------------------------------------------
+  size_t getConsumed();
+
+  //----------------------------------------------------------------------------
+  // pullBytes implementation.
+  //----------------------------------------------------------------------------
+  ssize_t pullBytes(char* target, size_t requestedBytes);
+
+  //----------------------------------------------------------------------------
+  // Rewind implementation.
+  //----------------------------------------------------------------------------
+  bool rewind();
+
+  //----------------------------------------------------------------------------
+  // getSize implementation.
+  //----------------------------------------------------------------------------
+  ssize_t getSize();
+
+private:
+  std::mutex _mtx;
+  std::condition_variable _cv;
+
+  std::vector<char> _ring;
+  size_t _head;
+  size_t _used;
+  size_t _consumed;
+  bool _closed;
+  bool _cancelled;
+};
+
 }
 
 #endif
@@ -0,0 +1,220 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "MetadataCache.hpp"
+#include <utils/davix_logger_internal.hpp>
+#include <utils/stringutils.hpp>
+#include <functional>
+
+namespace Davix {
+
+static void stripTrailingSlashes(std::string & path) {
+  while(path.size() > 1 && path[path.size()-1] == '/') {
+    path.erase(path.size()-1);
+  }
+}
+
+static Chrono::TimePoint now() {
+  return Chrono::Clock(Chrono::Clock::Monolitic).now();
+}
+
+MetadataCache::MetadataCache(size_t maxEntries)
+: _ttl(0), _maxPerShard(std::max<size_t>(1, maxEntries / DAVIX_METADATA_CACHE_SHARDS)) {
+
+}
+
+void MetadataCache::setTTL(unsigned int seconds) {
+  DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CORE, "Metadata caching {}, time to live {}s", (seconds > 0 ? "ENABLED" : "DISABLED"), seconds);
+  _ttl = seconds;
+  if(seconds == 0) {
+    clear();
+  }
+}
+
+unsigned int MetadataCache::getTTL() const {
+  return _ttl;
+}
+
+std::string MetadataCache::makeKey(const Uri & uri) {
+  if(uri.getStatus() != StatusCode::OK) {
+    return std::string();
+  }
+
+  Uri u(uri);
+  u.httpizeProtocol();
+
+  std::string host = u.getHost();
+  std::string path = Uri::unescapeString(u.getPath());
+  stripTrailingSlashes(path);
+  if(path.empty()) {
+    path = "/";
+  }
+
+  std::string key = fmt::format("{}://{}:{}{}", u.getProtocol(), StrUtil::toLower(host), httpUriGetPort(u), path);
+  if(!u.getQuery().empty()) {
+    key += "?";
+    key += u.getQuery();
+  }
+  return key;
+}
+
+std::string MetadataCache::makeChildKey(const std::string & key, const std::string & name) {
+  // listing entry names are unescaped already, like the paths of keys
+  std::string child(name);
+  stripTrailingSlashes(child);
+
+  if(!key.empty() && key[key.size()-1] == '/') {
+    return key + child;
+  }
+  return key + "/" + child;
+}
+
+std::string MetadataCache::makeParentKey(const std::string & key) {
+  const std::string::size_type scheme = key.find("://");
+  if(scheme == std::string::npos || key.find('?') != std::string::npos) {
+    return std::string();
+  }
+
+  // keys always have a path, the root one ends with its only slash
+  const std::string::size_type root = key.find('/', scheme + 3);
+  const std::string::size_type pos = key.rfind('/');
+  if(root == std::string::npos || root + 1 == key.size()) {
+    return std::string();
+  }
+  return key.substr(0, (pos == root) ? root + 1 : pos);
+}
+
+MetadataCache::Shard & MetadataCache::getShard(const std::string & key) {
+  return _shards[std::hash<std::string>()(key) % DAVIX_METADATA_CACHE_SHARDS];
+}
+
+bool MetadataCache::find(const std::string & key, StatInfo & info) {
+  if(!isActive() || key.empty()) {
+    return false;
+  }
+
+  Shard & shard = getShard(key);
+  std::lock_guard<std::mutex> lock(shard.mtx);
+
+  std::unordered_map<std::string, EntryList::iterator>::iterator it = shard.index.find(key);
+  if(it == shard.index.end()) {
+    return false;
+  }
+
+  if(it->second->expiry < now()) {
+    shard.lru.erase(it->second);
+    shard.index.erase(it);
+    return false;
+  }
+
+  shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+  info = it->second->info;
+  return true;
+}
+
+void MetadataCache::insert(const std::string & key, const StatInfo & info) {
+  const unsigned int ttl = getTTL();
+  if(ttl == 0 || key.empty()) {
+    return;
+  }
+
+  Chrono::TimePoint expiry = now();
+  expiry += Chrono::Duration(ttl);
+
+  Shard & shard = getShard(key);
+  std::lock_guard<std::mutex> lock(shard.mtx);
+
+  std::unordered_map<std::string, EntryList::iterator>::iterator it = shard.index.find(key);
+  if(it != shard.index.end()) {
+    it->second->info = info;
+    it->second->expiry = expiry;
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    return;
+  }
+
+  if(shard.index.size() >= _maxPerShard) {
+    shard.index.erase(shard.lru.back().key);
+    shard.lru.pop_back();
+  }
+
+  Entry entry;
+  entry.key = key;
+  entry.info = info;
+  entry.expiry = expiry;
+  shard.lru.push_front(std::move(entry));
+  shard.index[key] = shard.lru.begin();
+}
+
+void MetadataCache::erase(const std::string & key, bool recursive) {
+  if(key.empty()) {
+    return;
+  }
+
+  {
+    Shard & shard = getShard(key);
+    std::lock_guard<std::mutex> lock(shard.mtx);
+    std::unordered_map<std::string, EntryList::iterator>::iterator it = shard.index.find(key);
+    if(it != shard.index.end()) {
+      shard.lru.erase(it->second);
+      shard.index.erase(it);
+    }
+  }
+
+  if(!recursive) {
+    return;
+  }
+
+  // entries below a collection are spread over all the shards
+  const std::string prefix = (key[key.size()-1] == '/') ? key : key + "/";
+  for(size_t i = 0; i < DAVIX_METADATA_CACHE_SHARDS; i++) {
+    Shard & shard = _shards[i];
+    std::lock_guard<std::mutex> lock(shard.mtx);
+
+    EntryList::iterator it = shard.lru.begin();
+    while(it != shard.lru.end()) {
+      if(it->key.compare(0, prefix.size(), prefix) == 0) {
+        shard.index.erase(it->key);
+        it = shard.lru.erase(it);
+      }
+      else {
+        it++;
+      }
+    }
+  }
+}
+
+void MetadataCache::clear() {
+  for(size_t i = 0; i < DAVIX_METADATA_CACHE_SHARDS; i++) {
+    std::lock_guard<std::mutex> lock(_shards[i].mtx);
+    _shards[i].index.clear();
+    _shards[i].lru.clear();
+  }
+}
+
+size_t MetadataCache::size() const {
+  size_t total = 0;
+  for(size_t i = 0; i < DAVIX_METADATA_CACHE_SHARDS; i++) {
+    std::lock_guard<std::mutex> lock(_shards[i].mtx);
+    total += _shards[i].index.size();
+  }
+  return total;
+}
+
+}
@@ -0,0 +1,108 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_CORE_METADATA_CACHE_HPP
+#define DAVIX_CORE_METADATA_CACHE_HPP
+
+#include <davix_internal.hpp>
+#include <libs/alibxx/chrono/timepoint.hpp>
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+namespace Davix {
+
+//------------------------------------------------------------------------------
+// Cache of the StatInfo of remote resources, shared by all the operations of
+// a context.
+//
+// Entries expire after a time to live, 0 (default) disables the cache. The
+// cache is split in shards with their own lock and least recently used list,
+// so that concurrent operations rarely contend.
+//------------------------------------------------------------------------------
+class MetadataCache : NonCopyable {
+public:
+  MetadataCache(size_t maxEntries = DAVIX_METADATA_CACHE_SIZE);
+
+  void setTTL(unsigned int seconds);
+  unsigned int getTTL() const;
+
+  bool isActive() const { return getTTL() > 0; }
+
+  //----------------------------------------------------------------------------
+  // Normalised cache key of uri: same resource, same key, whatever the
+  // protocol alias, host case, escaping or trailing slashes. Empty if the
+  // uri is invalid.
+  //----------------------------------------------------------------------------
+  static std::string makeKey(const Uri & uri);
+
+  //----------------------------------------------------------------------------
+  // Key of the entry name, as returned by a listing (unescaped), of the
+  // collection key
+  //----------------------------------------------------------------------------
+  static std::string makeChildKey(const std::string & key, const std::string & name);
+
+  //----------------------------------------------------------------------------
+  // Key of the collection containing key, empty for the root
+  //----------------------------------------------------------------------------
+  static std::string makeParentKey(const std::string & key);
+
+  //----------------------------------------------------------------------------
+  // Look up a valid entry, false if none
+  //----------------------------------------------------------------------------
+  bool find(const std::string & key, StatInfo & info);
+
+  void insert(const std::string & key, const StatInfo & info);
+
+  //----------------------------------------------------------------------------
+  // Drop the entry of key, and of all the resources below it when recursive
+  //----------------------------------------------------------------------------
+  void erase(const std::string & key, bool recursive = false);
+
+  void clear();
+
+  size_t size() const;
+
+private:
+  struct Entry {
+    std::string key;
+    StatInfo info;
+    Chrono::TimePoint expiry;
+  };
+
+  typedef std::list<Entry> EntryList;
+
+  struct Shard {
+    mutable std::mutex mtx;
+    EntryList lru; // most recently used first
+    std::unordered_map<std::string, EntryList::iterator> index;
+  };
+
+  Shard & getShard(const std::string & key);
+
+  std::atomic<unsigned int> _ttl;
+  size_t _maxPerShard;
+  Shard _shards[DAVIX_METADATA_CACHE_SHARDS];
+};
+
+}
+
+#endif // DAVIX_CORE_METADATA_CACHE_HPP
@@ -25,6 +25,7 @@
 #include "../backend/SessionFactory.hpp"
 #include <status/DavixStatus.hpp>
 #include <core/SessionPool.hpp>
+#include <backend/Continue100Cache.hpp>
 
 namespace Davix {
 
@@ -60,6 +61,11 @@ public:
     //--------------------------------------------------------------------------
     bool getSessionCaching() const;
 
+    //--------------------------------------------------------------------------
+    // Outcome of the 100-continue handshakes with each host
+    //--------------------------------------------------------------------------
+    Continue100Cache& getContinue100Cache() { return _continue100_cache; }
+
 private:
     //--------------------------------------------------------------------------
     // Retrieve cached handle, if possible
@@ -81,6 +87,8 @@ private:
     // Session pool
     //--------------------------------------------------------------------------
     SessionPool<CurlHandlePtr> _session_pool;
+
+    Continue100Cache _continue100_cache;
 };
 
 }
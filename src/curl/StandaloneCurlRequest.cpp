@@ -27,6 +27,7 @@
 #include <core/ContentProvider.hpp>
 #include <curl/curl.h>
 #include <auth/davixx509cred_internal.hpp>
+#include <climits>
 
 #define SSTR(message) static_cast<std::ostringstream&>(std::ostringstream().flush() << message).str()
 #define DBG(message) std::cerr << __FILE__ << ":" << __LINE__ << " -- " << #message << " = " << message << std::endl;
@@ -155,7 +156,8 @@ size_t read_callback(char *buffer, size_t size, size_t nitems, void *userdata) {
 
   if(retval < 0) {
     DAVIX_SLOG(DAVIX_LOG_WARNING, DAVIX_LOG_HTTP, "Content provider reported an errc={}", retval);
-    return 0;
+    // returning 0 would end a chunked body early as if it were complete
+    return CURL_READFUNC_ABORT;
   }
 
   return retval;
@@ -171,7 +173,8 @@ StandaloneCurlRequest::StandaloneCurlRequest(CurlSessionFactory &sessionFactory,
 : _session_factory(sessionFactory), _reuse_session(reuseSession), _bound_hooks(boundHooks),
   _uri(uri), _verb(verb), _params(params), _headers(headers), _req_flag(reqFlag),
   _content_provider(contentProvider), _deadline(deadline), _state(RequestState::kNotStarted),
-  _chunklist(NULL), _received_headers(false) {}
+  _chunklist(NULL), _received_headers(false), _expect100(false),
+  _interim_response(false), _received_continue100(false) {}
 
 //------------------------------------------------------------------------------
 // Destructor
@@ -361,13 +364,27 @@ Status StandaloneCurlRequest::startRequest() {
   //----------------------------------------------------------------------------
   for(size_t i = 0; i < _headers.size(); i++) {
     _chunklist = curl_slist_append(_chunklist, SSTR(_headers[i].first << ": " << _headers[i].second).c_str());
+  }
 
-    if(_content_provider && _params.get100ContinueSupport() && (_req_flag & RequestFlag::SupportContinue100) ) {
-      _chunklist = curl_slist_append(_chunklist, "Expect: 100-continue");
-    }
-    else {
-      _chunklist = curl_slist_append(_chunklist, "Expect:");
-    }
+  //----------------------------------------------------------------------------
+  // Ask for 100-continue, unless the host is known to ignore it
+  //----------------------------------------------------------------------------
+  _expect100 = _content_provider && _params.get100ContinueSupport() &&
+    (_req_flag & RequestFlag::SupportContinue100) &&
+    _session_factory.getContinue100Cache().get(_uri) != Continue100Cache::NoAnswer;
+
+  if(_expect100) {
+    const int waitMs = continue100WaitMs(_params);
+    _chunklist = curl_slist_append(_chunklist, "Expect: 100-continue");
+    curl_easy_setopt(handle, CURLOPT_EXPECT_100_TIMEOUT_MS, (waitMs == 0) ? LONG_MAX : (long) waitMs);
+  }
+  else {
+    _chunklist = curl_slist_append(_chunklist, "Expect:");
+  }
+
+  // libcurl only streams bodies of unknown size when asked to
+  if(_content_provider && _content_provider->getSize() < 0) {
+    _chunklist = curl_slist_append(_chunklist, "Transfer-Encoding: chunked");
   }
 
   _chunklist = curl_slist_append(_chunklist, SSTR("User-Agent: " << Davix::RequestParams().getUserAgent() << " libcurl/" << getCurlVersion()).c_str());
@@ -402,6 +419,7 @@ Status StandaloneCurlRequest::startRequest() {
     }
 
     if(still_running == 0) {
+      recordContinue100();
       return checkErrors();
     }
 
@@ -411,11 +429,39 @@ Status StandaloneCurlRequest::startRequest() {
       // to readBlock() mode.
       //------------------------------------------------------------------------
       _state = RequestState::kStarted;
+      recordContinue100();
       return checkErrors();
     }
   }
 }
 
+//------------------------------------------------------------------------------
+// Remember how the server answered the 100-continue expectation. libcurl
+// stops sending the body, and closes the connection, when a final answer
+// arrives first.
+//------------------------------------------------------------------------------
+void StandaloneCurlRequest::recordContinue100() {
+  if(!_expect100 || getStatusCode() == 0) {
+    return;
+  }
+
+  Continue100Cache &cache = _session_factory.getContinue100Cache();
+  if(_received_continue100) {
+    cache.set(_uri, Continue100Cache::Supported);
+    return;
+  }
+
+  curl_off_t uploaded = 0;
+  curl_easy_getinfo(_session->getHandle()->handle, CURLINFO_SIZE_UPLOAD_T, &uploaded);
+  if(uploaded == 0 && _content_provider->getSize() != 0) {
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_HTTP, "Server answered {} to the 100-continue expectation, request body not sent", getStatusCode());
+    cache.set(_uri, (getStatusCode() == 417) ? Continue100Cache::NoAnswer : Continue100Cache::Supported);
+    return;
+  }
+
+  cache.set(_uri, Continue100Cache::NoAnswer);
+}
+
 //------------------------------------------------------------------------------
 // Check internal mhandle errors
 //------------------------------------------------------------------------------
@@ -519,9 +565,11 @@ dav_ssize_t StandaloneCurlRequest::readBlock(char* buffer, dav_size_t max_size,
   }
 
   //----------------------------------------------------------------------------
-  // Keep some data cached inside the response buffer, but not too much
+  // Only drive the transfer when the buffered data cannot satisfy the read:
+  // a slow consumer leaves the rest of the response in the socket, instead
+  // of accumulating it in memory
   //----------------------------------------------------------------------------
-  if(_response_buffer.size() <= 33554432) {
+  if(_response_buffer.size() < max_size) {
     int still_running = 0;
     st = performBlockingRound(still_running);
   }
@@ -537,6 +585,26 @@ Status StandaloneCurlRequest::endRequest() {
   return Status();
 }
 
+//------------------------------------------------------------------------------
+// Can the response body be moved into the given fd without going through
+// userspace buffers? Never with libcurl, data is always handed to us in
+// write callbacks.
+//------------------------------------------------------------------------------
+bool StandaloneCurlRequest::canSpliceToFd(int fd) const {
+  (void) fd;
+  return false;
+}
+
+//------------------------------------------------------------------------------
+// Zero-copy read function - not supported by the libcurl backend.
+//------------------------------------------------------------------------------
+dav_ssize_t StandaloneCurlRequest::spliceToFd(int fd, dav_size_t max_size, Status& st) {
+  (void) fd;
+  (void) max_size;
+  st = Status(davix_scope_http_request(), StatusCode::OperationNonSupported, "Zero-copy reads are not supported by the libcurl backend");
+  return -1;
+}
+
 //------------------------------------------------------------------------------
 // Check request state
 //------------------------------------------------------------------------------
@@ -582,7 +650,8 @@ void StandaloneCurlRequest::doNotReuseSession() {
 // Has the underlying session been used before?
 //------------------------------------------------------------------------------
 bool StandaloneCurlRequest::isRecycledSession() const {
-
+  // libcurl recycles connections on its own, and re-connects when needed
+  return false;
 }
 
 //------------------------------------------------------------------------------
@@ -614,7 +683,7 @@ std::string StandaloneCurlRequest::getSessionError() const {
 // Block until all response headers have been received
 //------------------------------------------------------------------------------
 Status StandaloneCurlRequest::readResponseHeaders() {
-
+  return Status();
 }
 
 //------------------------------------------------------------------------------
@@ -622,10 +691,32 @@ Status StandaloneCurlRequest::readResponseHeaders() {
 //------------------------------------------------------------------------------
 void StandaloneCurlRequest::feedResponseHeader(const std::string &header) {
   if(header == "\r\n") {
+    if(_interim_response) {
+      _interim_response = false;
+      return;
+    }
+
     _received_headers = true;
     return;
   }
 
+  //----------------------------------------------------------------------------
+  // Interim 1xx answers, and their headers, are not part of the response
+  //----------------------------------------------------------------------------
+  if(header.compare(0, 5, "HTTP/") == 0) {
+    size_t space = header.find(' ');
+    int code = (space == std::string::npos) ? 0 : atoi(header.c_str() + space + 1);
+
+    _interim_response = (code >= 100 && code < 200);
+    if(code == 100) {
+      _received_continue100 = true;
+    }
+  }
+
+  if(_interim_response) {
+    return;
+  }
+
   HeaderlineParser parser(header);
   _response_headers.push_back(std::pair<std::string, std::string>(parser.getKey(), parser.getValue()));
 }
@@ -87,6 +87,18 @@ public:
   //----------------------------------------------------------------------------
   virtual dav_ssize_t readBlock(char* buffer, dav_size_t max_size, Status& st);
 
+  //----------------------------------------------------------------------------
+  // Can the response body be moved into the given fd without going through
+  // userspace buffers?
+  //----------------------------------------------------------------------------
+  virtual bool canSpliceToFd(int fd) const;
+
+  //----------------------------------------------------------------------------
+  // Zero-copy read function - move a block of max_size bytes (at max) from
+  // the connection into fd.
+  //----------------------------------------------------------------------------
+  virtual dav_ssize_t spliceToFd(int fd, dav_size_t max_size, Status& st);
+
   //----------------------------------------------------------------------------
   // Check request state
   //----------------------------------------------------------------------------
@@ -165,6 +177,19 @@ private:
   std::vector<std::pair<std::string, std::string > > _response_headers;
   bool _received_headers;
 
+  //----------------------------------------------------------------------------
+  // 100-continue handshake: whether it was asked for, whether an interim
+  // answer is being received, whether the 100 (Continue) answer arrived
+  //----------------------------------------------------------------------------
+  bool _expect100;
+  bool _interim_response;
+  bool _received_continue100;
+
+  //----------------------------------------------------------------------------
+  // Remember how the server answered the 100-continue expectation
+  //----------------------------------------------------------------------------
+  void recordContinue100();
+
   ResponseBuffer _response_buffer;
 
   //----------------------------------------------------------------------------
@@ -33,6 +33,7 @@ namespace Davix {
 
 /// @cond HIDDEN_SYMBOLS
 
+class MetadataCache;
 class RedirectionResolver;
 class SessionFactory;
 
@@ -41,6 +42,7 @@ struct ContextExplorer{
 
 static SessionFactory & SessionFactoryFromContext(Context & c);
 static RedirectionResolver & RedirectionResolverFromContext(Context &c);
+static MetadataCache & MetadataCacheFromContext(Context &c);
 
 };
 
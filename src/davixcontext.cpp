@@ -28,6 +28,7 @@
 #include <backend/SessionFactory.hpp>
 #include <davix_context_internal.hpp>
 #include <core/RedirectionResolver.hpp>
+#include <core/MetadataCache.hpp>
 
 #include <curl/curl.h>
 
@@ -52,6 +53,7 @@ struct ContextInternal
     ContextInternal():
         _fsess(new SessionFactory()),
         _redirectionResolver(new RedirectionResolver(!redirCachingDisabled())),
+        _metadataCache(new MetadataCache()),
         _hook_list()
     {
             DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CORE, "libdavix path {}, version: {}", getLibPath(), version());
@@ -60,8 +62,10 @@ struct ContextInternal
     ContextInternal(const ContextInternal & orig) :
         _fsess(new SessionFactory()),
         _redirectionResolver(new RedirectionResolver(!redirCachingDisabled())),
+        _metadataCache(new MetadataCache()),
         _hook_list(orig._hook_list)
     {
+        _metadataCache->setTTL(orig._metadataCache->getTTL());
     }
 
     virtual ~ContextInternal(){}
@@ -77,6 +81,7 @@ struct ContextInternal
 
     std::unique_ptr<SessionFactory>  _fsess;
     std::unique_ptr<RedirectionResolver> _redirectionResolver;
+    std::unique_ptr<MetadataCache> _metadataCache;
     HookList _hook_list;
 };
 
@@ -120,8 +125,17 @@ bool Context::getSessionCaching() const{
     return _intern->_fsess->getSessionCaching();
 }
 
+void Context::setMetadataCacheTTL(unsigned int seconds){
+    _intern->_metadataCache->setTTL(seconds);
+}
+
+unsigned int Context::getMetadataCacheTTL() const{
+    return _intern->_metadataCache->getTTL();
+}
+
 void Context::clearCache() {
   _intern->_fsess.reset(new SessionFactory());
+  _intern->_metadataCache->clear();
 }
 
 HttpRequest* Context::createRequest(const std::string & url, DavixError** err){
@@ -154,6 +168,10 @@ RedirectionResolver & ContextExplorer::RedirectionResolverFromContext(Context &c
     return *c._intern->getRedirectionResolver();
 }
 
+MetadataCache & ContextExplorer::MetadataCacheFromContext(Context &c) {
+    return *c._intern->_metadataCache;
+}
+
 LibPath::LibPath(){
     Dl_info shared_lib_infos;
 
@@ -0,0 +1,192 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include <davix_internal.hpp>
+#include <file/davix_compact_listing.hpp>
+#include <vector>
+
+namespace Davix{
+
+struct CompactListing::Internal{
+    Internal(unsigned int props) : properties(props & StatProperty::All) {}
+
+    unsigned int properties;
+
+    // names, null terminated, and offset of each of them
+    std::vector<char> names;
+    std::vector<size_t> offsets;
+
+    // one column per property kept, empty otherwise
+    std::vector<bool> directories;
+    std::vector<dav_size_t> sizes;
+    std::vector<time_t> mtimes;
+    std::vector<time_t> ctimes;
+    std::vector<mode_t> modes;
+    std::vector<uid_t> owners;
+    std::vector<gid_t> groups;
+
+    bool has(StatProperty::StatProperty property) const{
+        return (properties & property) != 0;
+    }
+
+    void check(size_t i) const{
+        if(i >= offsets.size()){
+            throw DavixException(davix_scope_directory_listing_str(), StatusCode::InvalidArgument,
+                                 fmt::format("Entry {} out of range, the listing has {} entries", i, offsets.size()));
+        }
+    }
+};
+
+
+CompactListing::CompactListing(unsigned int properties) :
+    d_ptr(new Internal(properties))
+{
+
+}
+
+CompactListing::CompactListing(const CompactListing & orig) :
+    d_ptr(new Internal(*orig.d_ptr))
+{
+
+}
+
+CompactListing::~CompactListing(){
+
+}
+
+CompactListing & CompactListing::operator=(const CompactListing & orig){
+    if(this != &orig){
+        *d_ptr = *orig.d_ptr;
+    }
+    return *this;
+}
+
+unsigned int CompactListing::properties() const{
+    return d_ptr->properties;
+}
+
+size_t CompactListing::size() const{
+    return d_ptr->offsets.size();
+}
+
+bool CompactListing::empty() const{
+    return d_ptr->offsets.empty();
+}
+
+void CompactListing::reserve(size_t entries, size_t name_bytes){
+    Internal & in = *d_ptr;
+    in.names.reserve(name_bytes + entries);
+    in.offsets.reserve(entries);
+    if(in.has(StatProperty::Type))  in.directories.reserve(entries);
+    if(in.has(StatProperty::Size))  in.sizes.reserve(entries);
+    if(in.has(StatProperty::Mtime)) in.mtimes.reserve(entries);
+    if(in.has(StatProperty::Ctime)) in.ctimes.reserve(entries);
+    if(in.has(StatProperty::Mode))  in.modes.reserve(entries);
+    if(in.has(StatProperty::Owner)){
+        in.owners.reserve(entries);
+        in.groups.reserve(entries);
+    }
+}
+
+void CompactListing::push_back(const std::string & name, const StatInfo & info){
+    Internal & in = *d_ptr;
+    in.offsets.push_back(in.names.size());
+    in.names.insert(in.names.end(), name.begin(), name.end());
+    in.names.push_back('\0');
+
+    if(in.has(StatProperty::Type))  in.directories.push_back(S_ISDIR(info.mode));
+    if(in.has(StatProperty::Size))  in.sizes.push_back(info.size);
+    if(in.has(StatProperty::Mtime)) in.mtimes.push_back(info.mtime);
+    if(in.has(StatProperty::Ctime)) in.ctimes.push_back(info.ctime);
+    if(in.has(StatProperty::Mode))  in.modes.push_back(info.mode);
+    if(in.has(StatProperty::Owner)){
+        in.owners.push_back(info.owner);
+        in.groups.push_back(info.group);
+    }
+}
+
+void CompactListing::clear(){
+    *d_ptr = Internal(d_ptr->properties);
+}
+
+const char* CompactListing::name(size_t i) const{
+    d_ptr->check(i);
+    return &d_ptr->names[d_ptr->offsets[i]];
+}
+
+size_t CompactListing::nameSize(size_t i) const{
+    d_ptr->check(i);
+    const size_t end = (i + 1 < d_ptr->offsets.size()) ? d_ptr->offsets[i+1] : d_ptr->names.size();
+    return end - d_ptr->offsets[i] - 1;
+}
+
+bool CompactListing::isDirectory(size_t i) const{
+    d_ptr->check(i);
+    return d_ptr->has(StatProperty::Type) && d_ptr->directories[i];
+}
+
+dav_size_t CompactListing::fileSize(size_t i) const{
+    d_ptr->check(i);
+    return (d_ptr->has(StatProperty::Size)) ? d_ptr->sizes[i] : 0;
+}
+
+time_t CompactListing::mtime(size_t i) const{
+    d_ptr->check(i);
+    return (d_ptr->has(StatProperty::Mtime)) ? d_ptr->mtimes[i] : 0;
+}
+
+time_t CompactListing::ctime(size_t i) const{
+    d_ptr->check(i);
+    return (d_ptr->has(StatProperty::Ctime)) ? d_ptr->ctimes[i] : 0;
+}
+
+mode_t CompactListing::mode(size_t i) const{
+    d_ptr->check(i);
+    return (d_ptr->has(StatProperty::Mode)) ? d_ptr->modes[i] : 0;
+}
+
+uid_t CompactListing::owner(size_t i) const{
+    d_ptr->check(i);
+    return (d_ptr->has(StatProperty::Owner)) ? d_ptr->owners[i] : 0;
+}
+
+gid_t CompactListing::group(size_t i) const{
+    d_ptr->check(i);
+    return (d_ptr->has(StatProperty::Owner)) ? d_ptr->groups[i] : 0;
+}
+
+StatInfo CompactListing::info(size_t i) const{
+    StatInfo st;
+    if(d_ptr->has(StatProperty::Mode)){
+        st.mode = mode(i);
+    }
+    else{
+        // default of the WebDAV parser
+        st.mode = 0777 | ((isDirectory(i)) ? S_IFDIR : S_IFREG);
+    }
+    st.size = fileSize(i);
+    st.mtime = mtime(i);
+    st.ctime = ctime(i);
+    st.owner = owner(i);
+    st.group = group(i);
+    return st;
+}
+
+} // Davix
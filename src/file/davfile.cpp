@@ -23,12 +23,67 @@
 #include <core/ContentProvider.hpp>
 #include <file/davfile.hpp>
 #include <fileops/chain_factory.hpp>
+#include <fileops/S3IO.hpp>
+#include <fileops/SwiftIO.hpp>
+#include <utils/checksum_calculator.hpp>
+#include <utils/davix_logger_internal.hpp>
+
+#include <algorithm>
+#include <sys/mman.h>
+#include <unistd.h>
 
 namespace Davix{
 
 
 DavFile::Iterator createIterator(DavFile::DavFileInternal& f, const RequestParams * params);
 
+// default fetch granularity of mapped regions
+static const dav_size_t default_map_page_size = 1024 * 1024;
+
+// checksum verifying a whole file transfer, NULL if not requested
+static ChecksumCalculator* createTransferChecksum(const IOChainContext & io_context){
+    const std::string & algorithm = io_context._reqparams->getTransferChecksum();
+    if(algorithm.empty())
+        return NULL;
+
+    ChecksumCalculator* checksum = ChecksumCalculator::create(algorithm);
+    if(checksum == NULL)
+        throw DavixException(davix_scope_io_buff(), StatusCode::InvalidArgument, fmt::format("Unsupported transfer checksum algorithm {}", algorithm));
+    return checksum;
+}
+
+// compare the checksum of the transferred data with the server one
+static void verifyTransferChecksum(HttpIOChain & chain, IOChainContext & io_context, const ChecksumCalculator & checksum){
+    std::string remote;
+    try{
+        chain.checksum(io_context, remote, checksum.getAlgorithm());
+    }catch(DavixException & e){
+        if(e.code() != StatusCode::OperationNonSupported)
+            throw;
+        DAVIX_SLOG(DAVIX_LOG_WARNING, DAVIX_LOG_CHAIN, "Unable to verify the transfer of {}: {}", io_context._uri, e.what());
+        return;
+    }
+
+    if(!checksum.matches(remote))
+        throw DavixException(davix_scope_io_buff(), StatusCode::ChecksumMismatch,
+                             fmt::format("{} checksum mismatch for {}: transferred {}, server reports {}", checksum.getAlgorithm(), io_context._uri, checksum.digest(), remote));
+
+    DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_CHAIN, "Transfer of {} verified, {} checksum {}", io_context._uri, checksum.getAlgorithm(), checksum.digest());
+}
+
+// upload the contents of provider, verifying them when requested
+static void putFromProvider(HttpIOChain & chain, IOChainContext & io_context, ContentProvider & provider){
+    std::unique_ptr<ChecksumCalculator> checksum(createTransferChecksum(io_context));
+    if(!checksum){
+        chain.writeFromProvider(io_context, provider);
+        return;
+    }
+
+    ChecksumContentProvider checked(provider, *checksum);
+    chain.writeFromProvider(io_context, checked);
+    verifyTransferChecksum(chain, io_context, *checksum);
+}
+
 
 struct DavFile::DavFileInternal{
 
@@ -51,12 +106,19 @@ struct DavFile::DavFileInternal{
 
     DavFile::Iterator createIterator(const RequestParams * params);
 
+    DavFile::MappedRegion createMappedRegion(const RequestParams * params, dav_off_t offset, dav_size_t length, dav_size_t page_size);
+
 
     static void check_iterator(DavFile::Iterator::Internal* ptr){
         if(ptr == NULL)
             throw DavixException(davix_scope_directory_listing_str(), StatusCode::InvalidArgument, "Usage of an invalid Iterator");
     }
 
+    static void check_region(DavFile::MappedRegion::Internal* ptr){
+        if(ptr == NULL)
+            throw DavixException(davix_scope_io_buff(), StatusCode::InvalidArgument, "Usage of an invalid MappedRegion");
+    }
+
 
 };
 
@@ -80,6 +142,181 @@ struct DavFile::Iterator::Internal{
 
 
 
+struct DavFile::MappedRegion::Internal{
+
+    Internal(DavFile::DavFileInternal & f, const RequestParams* p, dav_off_t offset, dav_size_t length, dav_size_t page_size) :
+        uri(f._u),
+        params((p)?(*p):(f._params)),
+        io_chain(),
+        io_context(f._c, uri, &params),
+        region_offset(offset),
+        region_size(length),
+        page_size(page_size),
+        mapped_size(0),
+        base(NULL),
+        pages(),
+        mtx()
+    {
+        f.getIOChain(io_chain);
+
+        if(region_size == 0){
+            StatInfo info;
+            io_chain.statInfo(io_context, info);
+            if(info.size <= static_cast<dav_size_t>(region_offset))
+                throw DavixException(davix_scope_io_buff(), StatusCode::InvalidArgument, "Mapped region starts after the end of file");
+            region_size = info.size - region_offset;
+        }
+
+        const dav_size_t sys_page = static_cast<dav_size_t>(sysconf(_SC_PAGESIZE));
+        if(this->page_size == 0)
+            this->page_size = default_map_page_size;
+        this->page_size = ((this->page_size + sys_page - 1) / sys_page) * sys_page;
+
+        const dav_size_t npages = (region_size + this->page_size - 1) / this->page_size;
+        mapped_size = npages * this->page_size;
+
+        // reserve only, the kernel backs pages when they get materialized
+        void* addr = mmap(NULL, mapped_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if(addr == MAP_FAILED)
+            throw DavixException(davix_scope_io_buff(), StatusCode::SystemError, std::string("Unable to reserve mapped region: ") + strerror(errno));
+        base = static_cast<char*>(addr);
+        pages.assign(npages, false);
+    }
+
+    ~Internal(){
+        if(base)
+            munmap(base, mapped_size);
+    }
+
+    void checkRange(dav_off_t offset, dav_size_t count) const{
+        if(offset < 0 || static_cast<dav_size_t>(offset) > region_size || count > region_size - offset)
+            throw DavixException(davix_scope_io_buff(), StatusCode::InvalidArgument, "Range outside of mapped region");
+    }
+
+    void protect(dav_size_t first, dav_size_t last, int prot){
+        if(mprotect(base + first * page_size, (last - first) * page_size, prot) != 0)
+            throw DavixException(davix_scope_io_buff(), StatusCode::SystemError, std::string("Unable to change mapped region protection: ") + strerror(errno));
+    }
+
+    void materialize(dav_off_t offset, dav_size_t count){
+        if(count == 0)
+            return;
+
+        std::lock_guard<std::mutex> l(mtx);
+        const dav_size_t first = offset / page_size;
+        const dav_size_t last = (offset + count - 1) / page_size + 1;
+
+        // one vector element per run of missing pages
+        std::vector<std::pair<dav_size_t, dav_size_t> > runs;
+        for(dav_size_t i = first; i < last; ++i){
+            if(pages[i])
+                continue;
+            if(runs.empty() == false && runs.back().second == i)
+                runs.back().second = i + 1;
+            else
+                runs.push_back(std::make_pair(i, i + 1));
+        }
+
+        if(runs.empty())
+            return;
+
+        std::vector<DavIOVecInput> in(runs.size());
+        std::vector<DavIOVecOuput> out(runs.size());
+        for(size_t i = 0; i < runs.size(); ++i){
+            const dav_size_t start = runs[i].first * page_size;
+            const dav_size_t end = std::min(runs[i].second * page_size, region_size);
+            in[i].diov_buffer = base + start;
+            in[i].diov_offset = region_offset + start;
+            in[i].diov_size = end - start;
+            protect(runs[i].first, runs[i].second, PROT_READ | PROT_WRITE);
+        }
+
+        DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Materialize {} page run(s) of mapped region {}", runs.size(), uri);
+        try{
+            io_chain.preadVec(io_context, &in[0], &out[0], in.size());
+        }catch(...){
+            for(size_t i = 0; i < runs.size(); ++i)
+                protect(runs[i].first, runs[i].second, PROT_NONE);
+            throw;
+        }
+
+        for(size_t i = 0; i < runs.size(); ++i){
+            protect(runs[i].first, runs[i].second, PROT_READ);
+            std::fill(pages.begin() + runs[i].first, pages.begin() + runs[i].second, true);
+        }
+    }
+
+    bool isMaterialized(dav_off_t offset, dav_size_t count){
+        if(count == 0)
+            return true;
+
+        std::lock_guard<std::mutex> l(mtx);
+        const dav_size_t first = offset / page_size;
+        const dav_size_t last = (offset + count - 1) / page_size + 1;
+        return std::find(pages.begin() + first, pages.begin() + last, false) == pages.begin() + last;
+    }
+
+    Uri uri;
+    RequestParams params;
+    HttpIOChain io_chain;
+    IOChainContext io_context;
+
+    dav_off_t region_offset;
+    dav_size_t region_size;
+    dav_size_t page_size;
+    dav_size_t mapped_size;
+    char* base;
+
+    // pages already fetched
+    std::vector<bool> pages;
+    std::mutex mtx;
+};
+
+
+DavFile::MappedRegion DavFile::DavFileInternal::createMappedRegion(const RequestParams * params, dav_off_t offset, dav_size_t length, dav_size_t page_size){
+    if(offset < 0)
+        throw DavixException(davix_scope_io_buff(), StatusCode::InvalidArgument, "Negative offset for mapped region");
+
+    DavFile::MappedRegion region;
+    region.d_ptr.reset(new DavFile::MappedRegion::Internal(*this, params, offset, length, page_size));
+    return region;
+}
+
+
+const char* DavFile::MappedRegion::data() const{
+    DavFileInternal::check_region(d_ptr.get());
+    return d_ptr->base;
+}
+
+dav_size_t DavFile::MappedRegion::size() const{
+    DavFileInternal::check_region(d_ptr.get());
+    return d_ptr->region_size;
+}
+
+dav_off_t DavFile::MappedRegion::offset() const{
+    DavFileInternal::check_region(d_ptr.get());
+    return d_ptr->region_offset;
+}
+
+dav_size_t DavFile::MappedRegion::pageSize() const{
+    DavFileInternal::check_region(d_ptr.get());
+    return d_ptr->page_size;
+}
+
+const char* DavFile::MappedRegion::materialize(dav_off_t offset, dav_size_t count){
+    DavFileInternal::check_region(d_ptr.get());
+    d_ptr->checkRange(offset, count);
+    d_ptr->materialize(offset, count);
+    return d_ptr->base + offset;
+}
+
+bool DavFile::MappedRegion::isMaterialized(dav_off_t offset, dav_size_t count) const{
+    DavFileInternal::check_region(d_ptr.get());
+    d_ptr->checkRange(offset, count);
+    return d_ptr->isMaterialized(offset, count);
+}
+
+
 DavFile::Iterator DavFile::DavFileInternal::createIterator(const RequestParams * params){
     DavFile::Iterator it;
     it.d_ptr.reset(new DavFile::Iterator::Internal(*this, params));
@@ -183,6 +420,18 @@ void DavFile::deletion(const RequestParams *params){
     d_ptr->getIOChain(chain).deleteResource(io_context);
 }
 
+size_t DavFile::abortPendingUploads(const RequestParams *params){
+    IOChainContext io_context = d_ptr->getIOContext(params);
+    switch(io_context._reqparams->getProtocol()){
+        case RequestProtocol::AwsS3:
+            return S3IO().abortPendingUploads(io_context);
+        case RequestProtocol::Swift:
+            return SwiftIO().abortPendingUploads(io_context);
+        default:
+            throw DavixException(davix_scope_io_buff(), StatusCode::OperationNonSupported, "Multi-part uploads are only supported by S3 and Swift");
+    }
+}
+
 dav_ssize_t DavFile::getToFd(const RequestParams* params,
                         int fd,
                         DavixError** err) throw(){
@@ -199,7 +448,16 @@ dav_ssize_t DavFile::getToFd(const RequestParams* params,
     TRY_DAVIX{
         HttpIOChain chain;
         IOChainContext io_context = d_ptr->getIOContext(params);
-        return d_ptr->getIOChain(chain).readToFd(io_context, fd, size_read);
+
+        // only whole files can be verified
+        std::unique_ptr<ChecksumCalculator> checksum(size_read == 0 ? createTransferChecksum(io_context) : NULL);
+        io_context._checksum = checksum.get();
+
+        HttpIOChain & head = d_ptr->getIOChain(chain);
+        dav_ssize_t ret = head.readToFd(io_context, fd, size_read);
+        if(checksum)
+            verifyTransferChecksum(head, io_context, *checksum);
+        return ret;
     }CATCH_DAVIX(err)
     return -1;
 }
@@ -220,7 +478,15 @@ dav_ssize_t DavFile::get(const RequestParams* params,
                         std::vector<char> & buffer){
     HttpIOChain chain;
     IOChainContext io_context = d_ptr->getIOContext(params);
-    return d_ptr->getIOChain(chain).readFull(io_context, buffer);
+
+    std::unique_ptr<ChecksumCalculator> checksum(createTransferChecksum(io_context));
+    io_context._checksum = checksum.get();
+
+    HttpIOChain & head = d_ptr->getIOChain(chain);
+    dav_ssize_t ret = head.readFull(io_context, buffer);
+    if(checksum)
+        verifyTransferChecksum(head, io_context, *checksum);
+    return ret;
 }
 
 
@@ -239,8 +505,18 @@ void DavFile::put(const RequestParams *params, int fd, dav_size_t size_write){
     HttpIOChain chain;
     IOChainContext io_context = d_ptr->getIOContext(params);
 
+    // on request, regular files are mapped, multi-part uploads then send
+    // the parts straight from the page cache
+    if(io_context._reqparams->getMmapUploads()) {
+        MmapContentProvider mapped(fd, 0, size_write);
+        if(mapped.ok()) {
+            putFromProvider(d_ptr->getIOChain(chain), io_context, mapped);
+            return;
+        }
+    }
+
     FdContentProvider provider(fd, 0, size_write);
-    d_ptr->getIOChain(chain).writeFromProvider(io_context, provider);
+    putFromProvider(d_ptr->getIOChain(chain), io_context, provider);
 }
 
 void DavFile::put(const RequestParams *params, const DataProviderFun &callback, dav_size_t size_write){
@@ -248,7 +524,15 @@ void DavFile::put(const RequestParams *params, const DataProviderFun &callback,
     IOChainContext io_context = d_ptr->getIOContext(params);
 
     CallbackContentProvider provider(callback, size_write);
-    d_ptr->getIOChain(chain).writeFromProvider(io_context, provider);
+    putFromProvider(d_ptr->getIOChain(chain), io_context, provider);
+}
+
+void DavFile::put(const RequestParams *params, const DataProviderFun &callback){
+    HttpIOChain chain;
+    IOChainContext io_context = d_ptr->getIOContext(params);
+
+    CallbackContentProvider provider(callback);
+    putFromProvider(d_ptr->getIOChain(chain), io_context, provider);
 }
 
 void DavFile::put(const RequestParams *params, const char *buffer, dav_size_t size_write){
@@ -256,7 +540,7 @@ void DavFile::put(const RequestParams *params, const char *buffer, dav_size_t si
     IOChainContext io_context = d_ptr->getIOContext(params);
 
     BufferContentProvider provider(buffer, size_write);
-    d_ptr->getIOChain(chain).writeFromProvider(io_context, provider);
+    putFromProvider(d_ptr->getIOChain(chain), io_context, provider);
 }
 
 void DavFile::move(const RequestParams *params, DavFile & destination){
@@ -313,6 +597,28 @@ DavFile::Iterator DavFile::listCollection(const RequestParams *params){
     return d_ptr->createIterator(params);
 }
 
+size_t DavFile::listCollection(const RequestParams *params, CompactListing & entries){
+    // ask only for the properties kept by entries
+    RequestParams listing_params((params)?(*params):(d_ptr->_params));
+    listing_params.setStatProperties(entries.properties());
+
+    HttpIOChain chain;
+    IOChainContext io_context = d_ptr->getIOContext(&listing_params);
+    HttpIOChain & head = d_ptr->getIOChain(chain);
+
+    const size_t initial = entries.size();
+    std::string name;
+    StatInfo info;
+    while(head.nextSubItem(io_context, name, info)){
+        entries.push_back(name, info);
+    }
+    return entries.size() - initial;
+}
+
+DavFile::MappedRegion DavFile::mapRegion(const RequestParams *params, dav_off_t offset, dav_size_t length, dav_size_t page_size){
+    return d_ptr->createMappedRegion(params, offset, length, page_size);
+}
+
 int DavFile::checksum(const RequestParams *params, std::string & checksm, const std::string & chk_algo, DavixError **err) throw(){
     TRY_DAVIX{
         HttpIOChain chain;
@@ -24,9 +24,14 @@
 #include <core/ContentProvider.hpp>
 #include <status/davixstatusrequest.hpp>
 #include <fileops/chain_factory.hpp>
+#include <fileops/BulkDelete.hpp>
+#include <fileops/BulkStat.hpp>
+#include <fileops/RecursiveOps.hpp>
 #include <xml/davpropxmlparser.hpp>
 #include <utils/stringutils.hpp>
 #include <file/davposix.hpp>
+#include <params/davix_request_params_internal.hpp>
+#include <chrono>
 
 using namespace StrUtil;
 
@@ -102,8 +107,10 @@ private:
 
 struct Davix_fd{
     Davix_fd(Davix::Context & context, const Davix::Uri & uri, const Davix::RequestParams * params) : _uri(uri), _params(params),
-        io_handler(), io_context(Davix::getIOContext(context, _uri, &_params)){
+        io_handler(), io_context(Davix::getIOContext(context, _uri, &_params)), stats(){
         Davix::getIOChain(io_handler);
+        io_context._stats = &stats;
+        Davix::RequestParamsExplorer::setRequestCounter(_params, &stats.requests);
     }
     virtual ~Davix_fd(){
         try{
@@ -117,12 +124,29 @@ struct Davix_fd{
     Davix::RequestParams _params;
     Davix::HttpIOChain io_handler;
     Davix::IOChainContext io_context;
+    Davix::IOChainStats stats;
 };
 
 
 namespace Davix {
 
 
+// account the time spent in a blocking I/O call of a file descriptor
+struct FdIOTimer{
+    FdIOTimer(Davix_fd* fd) : _fd(fd), _start(std::chrono::steady_clock::now()){}
+
+    ~FdIOTimer(){
+        if(_fd){
+            _fd->stats.network_time_us += std::chrono::duration_cast<std::chrono::microseconds>(
+                std::chrono::steady_clock::now() - _start).count();
+        }
+    }
+
+    Davix_fd* _fd;
+    std::chrono::steady_clock::time_point _start;
+};
+
+
 
 static void toDirent(struct dirent * d, const std::string & filename, const StatInfo & info){
     StrUtil::copy_std_string_to_buff(d->d_name, NAME_MAX, filename);
@@ -318,6 +342,20 @@ int DavPosix::mkdir(const RequestParams * _params, const std::string &url, mode_
 }
 
 
+int DavPosix::mkdir_parents(const RequestParams * _params, const std::string &url, mode_t right, DavixError** err){
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_POSIX, " -> davix_mkdir_parents");
+    (void) right;
+    int ret=-1;
+
+    TRY_DAVIX{
+        RequestParams params(_params);
+        makeParentCollections(*context, params, Uri(url));
+        ret = 0;
+    }CATCH_DAVIX(err)
+    return ret;
+}
+
+
 int DavPosix::stat(const RequestParams * params, const std::string & url, struct stat* st, DavixError** err){
     DAVIX_SCOPE_TRACE(DAVIX_LOG_POSIX, fun_stat);
 
@@ -352,6 +390,25 @@ int DavPosix::get_quota(const RequestParams *params, const std::string & url, Qu
     return -1;
 }
 
+int DavPosix::stat_bulk(const RequestParams* params, const std::vector<std::string> & urls, std::vector<StatInfo> & st,
+                        std::vector<DavixError*> & errs, DavixError** err){
+    TRY_DAVIX{
+        std::vector<Uri> uris(urls.begin(), urls.end());
+        RequestParams p(params);
+        bulkStat(*context, p, uris, st, errs);
+
+        size_t failed = 0;
+        for(size_t i = 0; i < errs.size(); i++){
+            if(errs[i] != NULL)
+                failed++;
+        }
+        if(failed > 0)
+            throw DavixException(davix_scope_stat_str(), StatusCode::PartialFailure, fmt::format("stat of {} out of {} urls failed", failed, urls.size()));
+        return 0;
+    }CATCH_DAVIX(err)
+    return -1;
+}
+
 int davix_remove_posix(Context* context, const RequestParams * params, const std::string & url, bool directory, DavixError** err){
     DavixError* tmp_err = NULL;
     int ret = -1;
@@ -427,6 +484,42 @@ int DavPosix::rmdir(const RequestParams * params, const std::string &uri, DavixE
 }
 
 
+int DavPosix::rmdir_recursive(const RequestParams * _params, const std::string &url, DavixError** err){
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_POSIX, " -> davix_rmdir_recursive");
+    int ret=-1;
+    DavixError* tmp_err=NULL;
+
+    TRY_DAVIX{
+        RequestParams params(_params);
+        recursiveDelete(*context, params, Uri(url));
+        ret = 0;
+    }CATCH_DAVIX(&tmp_err)
+
+    DavixError::propagatePrefixedError(err, tmp_err, "DavPosix::rmdir_recursive ");
+    return ret;
+}
+
+
+int DavPosix::unlink_bulk(const RequestParams* params, const std::vector<std::string> & urls,
+                          std::vector<DavixError*> & errs, DavixError** err){
+    TRY_DAVIX{
+        std::vector<Uri> uris(urls.begin(), urls.end());
+        RequestParams p(params);
+        bulkDelete(*context, p, uris, errs);
+
+        size_t failed = 0;
+        for(size_t i = 0; i < errs.size(); i++){
+            if(errs[i] != NULL)
+                failed++;
+        }
+        if(failed > 0)
+            throw DavixException(davix_scope_rm_str(), StatusCode::PartialFailure, fmt::format("deletion of {} out of {} urls failed", failed, urls.size()));
+        return 0;
+    }CATCH_DAVIX(err)
+    return -1;
+}
+
+
 
 ////////////////////////////////////////////////////
 //////////////////// Davix POSIX I/O
@@ -443,8 +536,8 @@ inline int davix_check_rw_fd(DAVIX_FD* fd, DavixError** err){
 }
 
 
-DAVIX_FD* DavPosix::open(const RequestParams * _params, const std::string & url, int flags, DavixError** err){
-    DAVIX_SCOPE_TRACE(DAVIX_LOG_POSIX, fun_open);
+static DAVIX_FD* davix_posix_open(Context* context, const RequestParams * _params, const std::string & url,
+                                  int flags, const StatInfo* info, DavixError** err){
     DavixError* tmp_err=NULL;
     Davix_fd* fd = NULL;
 
@@ -456,7 +549,9 @@ DAVIX_FD* DavPosix::open(const RequestParams * _params, const std::string & url,
             throw DavixException(davix_scope_http_request(), uri.getStatus(), " Uri invalid in Davix::Open");
         }
         fd = new Davix_fd(*context, uri, _params);
+        fd->io_context._open_stat = info;
         fd->io_handler.open(fd->io_context, flags);
+        fd->io_context._open_stat = NULL;
     }CATCH_DAVIX(&tmp_err)
 
     if(tmp_err){
@@ -468,6 +563,18 @@ DAVIX_FD* DavPosix::open(const RequestParams * _params, const std::string & url,
 }
 
 
+DAVIX_FD* DavPosix::open(const RequestParams * _params, const std::string & url, int flags, DavixError** err){
+    DAVIX_SCOPE_TRACE(DAVIX_LOG_POSIX, fun_open);
+    return davix_posix_open(context, _params, url, flags, NULL, err);
+}
+
+
+DAVIX_FD* DavPosix::open(const RequestParams * _params, const std::string & url, int flags, const StatInfo & info, DavixError** err){
+    DAVIX_SCOPE_TRACE(DAVIX_LOG_POSIX, fun_open);
+    return davix_posix_open(context, _params, url, flags, &info, err);
+}
+
+
 ssize_t DavPosix::read(DAVIX_FD* fd, void* buf, size_t count, Davix::DavixError** err){
     DAVIX_SCOPE_TRACE(DAVIX_LOG_POSIX, fun_read);
 
@@ -476,7 +583,10 @@ ssize_t DavPosix::read(DAVIX_FD* fd, void* buf, size_t count, Davix::DavixError*
 
     TRY_DAVIX{
         if( davix_check_rw_fd(fd, &tmp_err) ==0){
+            FdIOTimer timer(fd);
             ret = (ssize_t) fd->io_handler.read(fd->io_context, buf, (dav_size_t) count);
+            if(ret > 0)
+                fd->stats.bytes_read += ret;
         }
     }CATCH_DAVIX(&tmp_err)
 
@@ -496,7 +606,10 @@ dav_ssize_t DavPosix::pread64(DAVIX_FD *fd, void *buf, dav_size_t count, dav_off
 
     TRY_DAVIX{
         if( davix_check_rw_fd(fd, &tmp_err) ==0){
+            FdIOTimer timer(fd);
             ret = fd->io_handler.pread(fd->io_context, buf, count, offset);
+            if(ret > 0)
+                fd->stats.bytes_read += ret;
         }
     }CATCH_DAVIX(&tmp_err)
 
@@ -533,7 +646,10 @@ dav_ssize_t DavPosix::preadVec(DAVIX_FD* fd, const DavIOVecInput * input_vec,
 
     TRY_DAVIX{
         if( davix_check_rw_fd(fd, &tmp_err) ==0){
+            FdIOTimer timer(fd);
             ret = fd->io_handler.preadVec(fd->io_context, input_vec, output_vec, count_vec);
+            if(ret > 0)
+                fd->stats.bytes_read += ret;
         }
     }CATCH_DAVIX(&tmp_err)
 
@@ -548,8 +664,10 @@ ssize_t DavPosix::write(DAVIX_FD* fd, const void* buf, size_t count, Davix::Davi
 
     TRY_DAVIX{
         if( davix_check_rw_fd(fd, &tmp_err) ==0){
-            BufferContentProvider provider( (const char*) buf, count);
-            ret = (ssize_t) fd->io_handler.writeFromProvider(fd->io_context, provider);
+            FdIOTimer timer(fd);
+            ret = (ssize_t) fd->io_handler.write(fd->io_context, buf, count);
+            if(ret > 0)
+                fd->stats.bytes_written += ret;
         }
     }CATCH_DAVIX(&tmp_err)
 
@@ -582,14 +700,48 @@ dav_off_t DavPosix::lseek64(DAVIX_FD *fd, dav_off_t offset, int flags, DavixErro
 }
 
 
-int DavPosix::close(DAVIX_FD* fd, Davix::DavixError** err){
+int DavPosix::fstatistics(DAVIX_FD* fd, FdStatistics* stats, DavixError** err){
+    DAVIX_SCOPE_TRACE(DAVIX_LOG_POSIX, fun_fstatistics);
+    int ret = -1;
+    DavixError* tmp_err=NULL;
+
     TRY_DAVIX{
-        if(fd){
-            fd->io_handler.resetIO(fd->io_context);
-            delete fd;
-            fd = NULL;
+        if(stats == NULL)
+            throw DavixException(davix_scope_io_buff(), StatusCode::InvalidArgument, "Argument stats NULL");
+
+        if( davix_check_rw_fd(fd, &tmp_err) ==0){
+            stats->bytes_read = fd->stats.bytes_read;
+            stats->bytes_written = fd->stats.bytes_written;
+            stats->requests = fd->stats.requests;
+            stats->ranges_coalesced = fd->stats.ranges_coalesced;
+            stats->cache_hits = fd->stats.cache_hits;
+            stats->cache_misses = fd->stats.cache_misses;
+            stats->network_time_us = fd->stats.network_time_us;
+            stats->retries = fd->stats.retries;
+            ret = 0;
         }
-    }CATCH_DAVIX(err)
+    }CATCH_DAVIX(&tmp_err)
+
+    DavixError::propagateError(err, tmp_err);
+    return ret;
+}
+
+
+int DavPosix::close(DAVIX_FD* fd, Davix::DavixError** err){
+    DavixError* tmp_err=NULL;
+
+    if(fd){
+        // reports the status of write-behind uploads
+        TRY_DAVIX{
+            fd->io_handler.resetIO(fd->io_context);
+        }CATCH_DAVIX(&tmp_err)
+        delete fd;
+    }
+
+    if(tmp_err){
+        DavixError::propagateError(err, tmp_err);
+        return -1;
+    }
     return 0;
 }
 
@@ -22,6 +22,7 @@
 #include "AzureIO.hpp"
 #include <utils/davix_logger_internal.hpp>
 #include <core/ContentProvider.hpp>
+#include <fileops/PartUploader.hpp>
 
 #include <iomanip>
 #include <uuid/uuid.h>
@@ -131,35 +132,46 @@ dav_ssize_t AzureIO::writeFromProvider(IOChainContext & iocontext, ContentProvid
   std::vector<std::string> blockIDs;
 
   DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Azure write: size {}, splitting into blocks", provider.getSize());
-  std::vector<char> buffer;
+  const dav_size_t MAX_BLOCK_SIZE = 1024 * 1024 * 100; // 100 MB
+  const size_t MAX_BLOCKS = 50000;
 
-  const dav_size_t MAX_CHUNK_SIZE = 1024 * 1024 * 100; // 100 MB
-  buffer.resize(std::min(MAX_CHUNK_SIZE, (dav_size_t) provider.getSize()) + 10);
+  const dav_size_t blockSize = computeUploadPartSize(*iocontext._reqparams, provider.getSize(), 1, MAX_BLOCK_SIZE, MAX_BLOCKS);
 
   // generate UUID to use as blockid prefix
   std::string prefix = get_uuid();
 
-  size_t blockid = 0;
-  size_t remaining = provider.getSize();
-  while(remaining > 0) {
-    size_t toRead = std::min( (dav_size_t) provider.getSize(), MAX_CHUNK_SIZE);
-    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Azure write: toRead from cb {}", toRead);
+  // blocks are put concurrently, their order is only set by the committed block list
+  PartUploader uploader([this, &iocontext, &prefix](const char* data, dav_size_t size, size_t blockNumber) {
+    std::string id = stringifyBlockID(prefix, blockNumber - 1);
+    writeChunk(iocontext, data, size, id);
+    return id;
+  }, blockSize, iocontext._reqparams->getUploadConcurrency());
+  if(provider.getSize() < 0) {
+    uploader.growPartSize(MAX_BLOCK_SIZE, MAX_BLOCKS);
+  }
 
-    size_t bytesRead = provider.pullBytes(buffer.data(), toRead);
+  PartReader reader(provider, uploader);
+
+  size_t blockid = 0;
+  dav_size_t total = 0;
+  while(true) {
+    // fill a whole block, the provider may hand out data in smaller pieces
+    dav_size_t bytesRead = reader.next();
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Azure write: bytesRead from cb {}", bytesRead);
-    if(bytesRead == 0) break; // EOF?
+    if(bytesRead == 0) break; // EOF
 
-    blockIDs.push_back(stringifyBlockID(prefix, blockid));
-    writeChunk(iocontext, buffer.data(), bytesRead, blockIDs.back());
     blockid++;
+    reader.submit(blockid);
+    total += bytesRead;
 
-    remaining -= bytesRead;
-    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Azure write: remaining bytes {}", remaining);
+    if(bytesRead < reader.partSize()) break; // EOF
+    if(provider.getSize() >= 0 && total >= (dav_size_t) provider.getSize()) break; // all data sent
   }
 
-  // Now let's commit the blobs
+  // Now let's commit the blobs, in block order
+  blockIDs = uploader.finish();
   commitChunks(iocontext, blockIDs);
-  return provider.getSize();
+  return total;
 
 }
 
@@ -0,0 +1,253 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "BulkDelete.hpp"
+#include <core/MetadataCache.hpp>
+#include <davix_context_internal.hpp>
+#include <fileops/chain_factory.hpp>
+#include <fileops/TaskPool.hpp>
+#include <utils/davix_logger_internal.hpp>
+#include <utils/davix_s3_utils.hpp>
+#include <utils/stringutils.hpp>
+#include <xml/s3deleteparser.hpp>
+#include <map>
+
+namespace Davix{
+
+static std::string xmlEscape(const std::string & str) {
+  std::string escaped;
+  escaped.reserve(str.size());
+  for(std::string::const_iterator it = str.begin(); it != str.end(); it++) {
+    switch(*it) {
+      case '&':  escaped += "&amp;";  break;
+      case '<':  escaped += "&lt;";   break;
+      case '>':  escaped += "&gt;";   break;
+      case '"':  escaped += "&quot;"; break;
+      case '\'': escaped += "&apos;"; break;
+      default:   escaped += *it;
+    }
+  }
+  return escaped;
+}
+
+std::string s3DeleteRequestBody(const std::vector<std::string> & keys) {
+  // not quiet: the answer lists every key, the missing ones are retried
+  std::string body("<?xml version=\"1.0\" encoding=\"UTF-8\"?><Delete><Quiet>false</Quiet>");
+  for(std::vector<std::string>::const_iterator it = keys.begin(); it != keys.end(); it++) {
+    body += "<Object><Key>";
+    body += xmlEscape(*it);
+    body += "</Key></Object>";
+  }
+  body += "</Delete>";
+  return body;
+}
+
+StatusCode::Code s3DeleteStatusCode(const FileDeleteStatus & status) {
+  if(!status.error) {
+    return StatusCode::OK;
+  }
+  if(status.error_code == "AccessDenied") {
+    return StatusCode::PermissionRefused;
+  }
+  if(status.error_code == "NoSuchKey" || status.error_code == "NoSuchBucket") {
+    return StatusCode::FileNotFound;
+  }
+  return StatusCode::RemoteError;
+}
+
+namespace {
+
+//------------------------------------------------------------------------------
+// S3 objects of a bulk delete sharing a bucket
+//------------------------------------------------------------------------------
+struct DeleteGroup {
+  Uri uri; // multi-object delete request of the bucket
+  RequestParams params;
+  // index in the request -> key
+  std::vector<std::pair<size_t, std::string> > members;
+};
+
+class BulkDelete : NonCopyable {
+public:
+  BulkDelete(Context & context, const RequestParams & params, const std::vector<Uri> & urls,
+             std::vector<DavixError*> & errors)
+  : _context(context), _params(params), _urls(urls), _errors(errors),
+    _pool(params.getMetadataConcurrency()) {}
+
+  void run() {
+    std::map<std::string, DeleteGroup> groups;
+
+    for(size_t i = 0; i < _urls.size(); i++) {
+      RequestParams params(_params);
+      configureRequestParamsProto(_urls[i], params);
+
+      Uri uri;
+      std::string key;
+      if(params.getProtocol() != RequestProtocol::AwsS3 || !splitBucket(_urls[i], params, uri, key)) {
+        addDelete(i);
+        continue;
+      }
+
+      DeleteGroup & group = groups[uri.getString()];
+      if(group.members.empty()) {
+        group.uri = uri;
+        group.params = params;
+      }
+      group.members.push_back(std::make_pair(i, key));
+    }
+
+    for(std::map<std::string, DeleteGroup>::iterator it = groups.begin(); it != groups.end(); it++) {
+      DeleteGroup* group = &it->second;
+      for(size_t begin = 0; begin < group->members.size(); begin += DAVIX_S3_DELETE_BATCH_SIZE) {
+        const size_t end = std::min<size_t>(begin + DAVIX_S3_DELETE_BATCH_SIZE, group->members.size());
+        _pool.add([this, group, begin, end]{ deleteBatch(*group, begin, end); });
+      }
+    }
+
+    // groups are referenced by the tasks until here
+    _pool.wait();
+  }
+
+private:
+  //----------------------------------------------------------------------------
+  // Multi-object delete request of the bucket of uri, and key of the object,
+  // false if uri is not an object
+  //----------------------------------------------------------------------------
+  static bool splitBucket(const Uri & uri, const RequestParams & params, Uri & request, std::string & key) {
+    if(uri.getStatus() != StatusCode::OK || !uri.getQuery().empty() || !uri.getFragment().empty()) {
+      return false;
+    }
+
+    key = Uri::unescapeString(S3::extract_s3_path(uri, params.getAwsAlternate()));
+    if(key.size() <= 1) {
+      return false;
+    }
+    key.erase(0, 1);
+
+    Uri bucket(uri);
+    bucket.setPath(params.getAwsAlternate() ? "/" + S3::extract_s3_bucket(uri, true) + "/" : std::string("/"));
+    request = Uri(bucket.getString() + "?delete");
+    return true;
+  }
+
+  void addDelete(size_t index) {
+    _pool.add([this, index]{ remove(index); });
+  }
+
+  void remove(size_t index) {
+    TRY_DAVIX{
+      HttpIOChain chain;
+      IOChainContext io_context(_context, _urls[index], &_params);
+      ChainFactory::instanceChain(CreationFlags(), chain).deleteResource(io_context);
+    }CATCH_DAVIX(&_errors[index])
+  }
+
+  void deleteBatch(const DeleteGroup & group, size_t begin, size_t end) {
+    std::vector<std::string> keys;
+    std::multimap<std::string, size_t> pending;
+    for(size_t i = begin; i < end; i++) {
+      keys.push_back(group.members[i].second);
+      pending.insert(std::make_pair(group.members[i].second, group.members[i].first));
+    }
+
+    DavixError* tmp_err = NULL;
+    TRY_DAVIX{
+      std::string body = s3DeleteRequestBody(keys);
+      std::string md5;
+      S3::calculateMD5(body, md5);
+
+      PostRequest req(_context, group.uri, &tmp_err);
+      checkDavixError(&tmp_err);
+      req.setParameters(group.params);
+      // required by multi-object deletes
+      req.addHeaderField("Content-MD5", md5);
+      req.setRequestBody(body);
+      req.executeRequest(&tmp_err);
+      checkDavixError(&tmp_err);
+
+      if(!httpcodeIsValid(req.getRequestCode())) {
+        httpcodeToDavixException(req.getRequestCode(), davix_scope_rm_str(), fmt::format("during multi-object delete of {} keys", keys.size()));
+      }
+
+      std::vector<char> & answer = req.getAnswerContentVec();
+      S3DeleteParser parser;
+      parser.parseChunk(answer.data(), answer.size());
+
+      std::deque<FileDeleteStatus> & statuses = parser.getDeleteStatus();
+      for(std::deque<FileDeleteStatus>::iterator it = statuses.begin(); it != statuses.end(); it++) {
+        std::multimap<std::string, size_t>::iterator entry = pending.find(it->filename);
+        if(entry == pending.end()) {
+          continue;
+        }
+
+        if(it->error) {
+          DavixError::setupError(&_errors[entry->second], davix_scope_rm_str(), s3DeleteStatusCode(*it),
+                                 fmt::format("{}: {} ({})", _urls[entry->second], it->message, it->error_code));
+        }
+        pending.erase(entry);
+      }
+    }CATCH_DAVIX(&tmp_err)
+
+    if(tmp_err) {
+      DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_CHAIN, "Multi-object delete of {} keys in {} failed: {}", keys.size(), group.uri, tmp_err->getErrMsg());
+      for(std::multimap<std::string, size_t>::iterator it = pending.begin(); it != pending.end(); it++) {
+        _errors[it->second] = tmp_err->clone();
+      }
+      DavixError::clearError(&tmp_err);
+      return;
+    }
+
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Multi-object delete in {}: {} of {} keys answered", group.uri, keys.size() - pending.size(), keys.size());
+    for(std::multimap<std::string, size_t>::iterator it = pending.begin(); it != pending.end(); it++) {
+      addDelete(it->second);
+    }
+  }
+
+  Context & _context;
+  const RequestParams & _params;
+  const std::vector<Uri> & _urls;
+  std::vector<DavixError*> & _errors;
+
+  TaskPool _pool;
+};
+
+}
+
+void bulkDelete(Context & context, const RequestParams & params, const std::vector<Uri> & urls,
+                std::vector<DavixError*> & errors) {
+  for(size_t i = 0; i < errors.size(); i++) {
+    DavixError::clearError(&errors[i]);
+  }
+  errors.assign(urls.size(), NULL);
+
+  BulkDelete(context, params, urls, errors).run();
+
+  // multi-object deletes bypass the chain and its cache invalidation
+  MetadataCache & cache = ContextExplorer::MetadataCacheFromContext(context);
+  if(cache.isActive()) {
+    for(size_t i = 0; i < urls.size(); i++) {
+      const std::string key = MetadataCache::makeKey(urls[i]);
+      cache.erase(key);
+      cache.erase(MetadataCache::makeParentKey(key));
+    }
+  }
+}
+
+}
@@ -0,0 +1,54 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_BULK_DELETE_HPP
+#define DAVIX_BULK_DELETE_HPP
+
+#include <davix_internal.hpp>
+#include <utils/davix_fileproperties.hpp>
+#include <vector>
+
+namespace Davix{
+
+//------------------------------------------------------------------------------
+// Delete many resources in one call, errors[i] receives the result of
+// urls[i] and stays NULL on success.
+//
+// S3 objects are grouped by bucket and deleted by multi-object delete
+// requests of at most DAVIX_S3_DELETE_BATCH_SIZE keys. The keys missing from
+// the answer of a batch, and all the other resources, are deleted one by one.
+// At most params.getMetadataConcurrency() requests are sent at the same time.
+//------------------------------------------------------------------------------
+void bulkDelete(Context & context, const RequestParams & params, const std::vector<Uri> & urls,
+                std::vector<DavixError*> & errors);
+
+//------------------------------------------------------------------------------
+// Body of a S3 multi-object delete request of keys
+//------------------------------------------------------------------------------
+std::string s3DeleteRequestBody(const std::vector<std::string> & keys);
+
+//------------------------------------------------------------------------------
+// Error of a key reported by a S3 multi-object delete answer
+//------------------------------------------------------------------------------
+StatusCode::Code s3DeleteStatusCode(const FileDeleteStatus & status);
+
+}
+
+#endif // DAVIX_BULK_DELETE_HPP
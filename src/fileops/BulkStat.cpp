@@ -0,0 +1,205 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "BulkStat.hpp"
+#include <fileops/chain_factory.hpp>
+#include <fileops/TaskPool.hpp>
+#include <neon/neonrequest.hpp>
+#include <utils/davix_logger_internal.hpp>
+#include <map>
+
+namespace Davix{
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Resources of a bulk stat sharing a parent collection
+//------------------------------------------------------------------------------
+struct StatGroup {
+  Uri parent;
+  RequestParams params;
+  // index in the request -> name in the collection
+  std::vector<std::pair<size_t, std::string> > members;
+};
+
+class BulkStat : NonCopyable {
+public:
+  BulkStat(Context & context, const RequestParams & params, const std::vector<Uri> & urls,
+           std::vector<StatInfo> & infos, std::vector<DavixError*> & errors)
+  : _context(context), _params(params), _urls(urls), _infos(infos), _errors(errors),
+    _pool(params.getMetadataConcurrency()) {}
+
+  void run() {
+    std::map<std::string, StatGroup> groups;
+
+    for(size_t i = 0; i < _urls.size(); i++) {
+      RequestParams params(_params);
+      configureRequestParamsProto(_urls[i], params);
+
+      Uri parent;
+      std::string name;
+      if(!listable(params.getProtocol()) || !bulkStatSplitParent(_urls[i], parent, name)) {
+        addStat(i);
+        continue;
+      }
+
+      const std::string key = fmt::format("{}\n{}", (int) params.getProtocol(), parent.getString());
+      StatGroup & group = groups[key];
+      if(group.members.empty()) {
+        group.parent = parent;
+        group.params = params;
+      }
+      group.members.push_back(std::make_pair(i, name));
+    }
+
+    for(std::map<std::string, StatGroup>::iterator it = groups.begin(); it != groups.end(); it++) {
+      if(it->second.members.size() >= DAVIX_BULK_STAT_LISTING_THRESHOLD) {
+        StatGroup* group = &it->second;
+        _pool.add([this, group]{ listGroup(*group); });
+      }
+      else {
+        for(size_t i = 0; i < it->second.members.size(); i++) {
+          addStat(it->second.members[i].first);
+        }
+      }
+    }
+
+    // groups are referenced by the tasks until here
+    _pool.wait();
+  }
+
+private:
+  static bool listable(RequestProtocol::Protocol protocol) {
+    return protocol == RequestProtocol::Webdav || protocol == RequestProtocol::AwsS3
+        || protocol == RequestProtocol::Gcloud || protocol == RequestProtocol::Swift
+        || protocol == RequestProtocol::Azure;
+  }
+
+  void addStat(size_t index) {
+    _pool.add([this, index]{ stat(index); });
+  }
+
+  void stat(size_t index) {
+    TRY_DAVIX{
+      HttpIOChain chain;
+      IOChainContext io_context(_context, _urls[index], &_params);
+      ChainFactory::instanceChain(CreationFlags(), chain).statInfo(io_context, _infos[index]);
+    }CATCH_DAVIX(&_errors[index])
+  }
+
+  //----------------------------------------------------------------------------
+  // Stat the members of a group from a listing of their parent, the ones
+  // missing from it are stat'ed one by one: the listing may be partial
+  // (S3 pages), or the resource may not exist. The listing stops once all
+  // the members are found, or after DAVIX_BULK_STAT_LISTING_RATIO entries
+  // per member, when the collection is much larger than the group
+  //----------------------------------------------------------------------------
+  void listGroup(StatGroup & group) {
+    std::map<std::string, size_t> pending;
+    for(size_t i = 0; i < group.members.size(); i++) {
+      if(!pending.insert(std::make_pair(group.members[i].second, group.members[i].first)).second) {
+        addStat(group.members[i].first); // duplicate
+      }
+    }
+
+    DavixError* tmp_err = NULL;
+    TRY_DAVIX{
+      HttpIOChain chain;
+      IOChainContext io_context(_context, group.parent, &group.params);
+      HttpIOChain & head = ChainFactory::instanceChain(CreationFlags(), chain);
+
+      const size_t max_entries = group.members.size() * DAVIX_BULK_STAT_LISTING_RATIO;
+      size_t entries = 0;
+      std::string name;
+      StatInfo info;
+      while(!pending.empty() && entries < max_entries && head.nextSubItem(io_context, name, info)) {
+        entries++;
+
+        // S3 common prefixes carry a trailing slash
+        while(name.size() > 1 && name[name.size()-1] == '/') {
+          name.erase(name.size()-1);
+        }
+
+        // listing entries are unescaped already
+        std::map<std::string, size_t>::iterator it = pending.find(name);
+        if(it != pending.end()) {
+          _infos[it->second] = info;
+          pending.erase(it);
+        }
+      }
+    }CATCH_DAVIX(&tmp_err)
+
+    if(tmp_err) {
+      DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_CHAIN, "Listing of {} failed, stat of its entries one by one: {}", group.parent, tmp_err->getErrMsg());
+      DavixError::clearError(&tmp_err);
+    }
+    else {
+      DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Listing of {} found {} of {} entries", group.parent, group.members.size() - pending.size(), group.members.size());
+    }
+
+    for(std::map<std::string, size_t>::iterator it = pending.begin(); it != pending.end(); it++) {
+      addStat(it->second);
+    }
+  }
+
+  Context & _context;
+  const RequestParams & _params;
+  const std::vector<Uri> & _urls;
+  std::vector<StatInfo> & _infos;
+  std::vector<DavixError*> & _errors;
+
+  TaskPool _pool;
+};
+
+}
+
+bool bulkStatSplitParent(const Uri & uri, Uri & parent, std::string & name) {
+  if(uri.getStatus() != StatusCode::OK || !uri.getQuery().empty() || !uri.getFragment().empty()) {
+    return false;
+  }
+
+  std::string path = uri.getPath();
+  while(path.size() > 1 && path[path.size()-1] == '/') {
+    path.erase(path.size()-1);
+  }
+
+  const std::string::size_type pos = path.rfind('/');
+  if(pos == std::string::npos || pos + 1 >= path.size()) {
+    return false;
+  }
+
+  name = Uri::unescapeString(path.substr(pos+1));
+  parent = uri;
+  parent.setPath(path.substr(0, pos+1));
+  return true;
+}
+
+void bulkStat(Context & context, const RequestParams & params, const std::vector<Uri> & urls,
+              std::vector<StatInfo> & infos, std::vector<DavixError*> & errors) {
+  infos.assign(urls.size(), StatInfo());
+  for(size_t i = 0; i < errors.size(); i++) {
+    DavixError::clearError(&errors[i]);
+  }
+  errors.assign(urls.size(), NULL);
+
+  BulkStat(context, params, urls, infos, errors).run();
+}
+
+}
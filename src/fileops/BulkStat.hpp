@@ -0,0 +1,52 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_BULK_STAT_HPP
+#define DAVIX_BULK_STAT_HPP
+
+#include <davix_internal.hpp>
+#include <vector>
+
+namespace Davix{
+
+//------------------------------------------------------------------------------
+// Stat many resources in one call, infos[i] and errors[i] receive the result
+// of urls[i]; errors[i] stays NULL on success.
+//
+// Resources are grouped by parent collection. When the protocol supports
+// listings (WebDAV, S3, Swift, Azure), a collection holding enough of them is
+// listed once and the listing entries are used as their stat, up to
+// DAVIX_BULK_STAT_LISTING_RATIO entries per resource looked up. The resources
+// missing from the listing, and all the others, are stat'ed one by one.
+// At most params.getMetadataConcurrency() requests are sent at the same time,
+// over the pooled connections of the context.
+//------------------------------------------------------------------------------
+void bulkStat(Context & context, const RequestParams & params, const std::vector<Uri> & urls,
+              std::vector<StatInfo> & infos, std::vector<DavixError*> & errors);
+
+//------------------------------------------------------------------------------
+// Parent collection and unescaped last path segment of uri, false if it has
+// none or cannot be looked up in a listing of its parent (query, fragment)
+//------------------------------------------------------------------------------
+bool bulkStatSplitParent(const Uri & uri, Uri & parent, std::string & name);
+
+}
+
+#endif // DAVIX_BULK_STAT_HPP
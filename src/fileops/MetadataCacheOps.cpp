@@ -0,0 +1,155 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "MetadataCacheOps.hpp"
+#include <core/MetadataCache.hpp>
+#include <davix_context_internal.hpp>
+#include <utils/davix_logger_internal.hpp>
+
+namespace Davix{
+
+static MetadataCache & getCache(IOChainContext & iocontext){
+    return ContextExplorer::MetadataCacheFromContext(iocontext._context);
+}
+
+// stats restricted to some properties are served by the cache, but not cached
+static bool isComplete(IOChainContext & iocontext){
+    return (iocontext._reqparams->getStatProperties() & StatProperty::All) == StatProperty::All;
+}
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Drops the entries of a resource and of its parent once the modifying
+// operation is over, whether it succeeded or not
+//------------------------------------------------------------------------------
+class Invalidation : NonCopyable {
+public:
+    Invalidation(MetadataCache & cache, const Uri & uri, bool recursive = false)
+    : _cache(cache), _key(cache.isActive() ? MetadataCache::makeKey(uri) : std::string()), _recursive(recursive) {}
+
+    ~Invalidation(){
+        if(_key.empty()){
+            return;
+        }
+        _cache.erase(_key, _recursive);
+        _cache.erase(MetadataCache::makeParentKey(_key));
+    }
+
+private:
+    MetadataCache & _cache;
+    std::string _key;
+    bool _recursive;
+};
+
+}
+
+MetadataCacheOps::MetadataCacheOps() : _written(false){
+
+}
+
+MetadataCacheOps::~MetadataCacheOps(){
+
+}
+
+void MetadataCacheOps::deleteResource(IOChainContext & iocontext){
+    Invalidation invalidation(getCache(iocontext), iocontext._uri, true);
+    HttpIOChain::deleteResource(iocontext);
+}
+
+void MetadataCacheOps::makeCollection(IOChainContext & iocontext){
+    Invalidation invalidation(getCache(iocontext), iocontext._uri);
+    HttpIOChain::makeCollection(iocontext);
+}
+
+void MetadataCacheOps::move(IOChainContext & iocontext, const std::string & target_url){
+    Invalidation source(getCache(iocontext), iocontext._uri, true);
+    Invalidation target(getCache(iocontext), Uri(target_url), true);
+    HttpIOChain::move(iocontext, target_url);
+}
+
+StatInfo & MetadataCacheOps::statInfo(IOChainContext & iocontext, StatInfo & st_info){
+    MetadataCache & cache = getCache(iocontext);
+    if(!cache.isActive()){
+        return HttpIOChain::statInfo(iocontext, st_info);
+    }
+
+    const std::string key = MetadataCache::makeKey(iocontext._uri);
+    if(cache.find(key, st_info)){
+        DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Metadata of {} found in cache", key);
+        return st_info;
+    }
+
+    HttpIOChain::statInfo(iocontext, st_info);
+    if(isComplete(iocontext)){
+        cache.insert(key, st_info);
+    }
+    return st_info;
+}
+
+bool MetadataCacheOps::nextSubItem(IOChainContext & iocontext, std::string & entry_name, StatInfo & info){
+    if(!HttpIOChain::nextSubItem(iocontext, entry_name, info)){
+        return false;
+    }
+
+    MetadataCache & cache = getCache(iocontext);
+    if(cache.isActive() && isComplete(iocontext) && !entry_name.empty()){
+        if(_listingKey.empty()){
+            _listingKey = MetadataCache::makeKey(iocontext._uri);
+        }
+        if(_listingKey.find('?') == std::string::npos){
+            cache.insert(MetadataCache::makeChildKey(_listingKey, entry_name), info);
+        }
+    }
+    return true;
+}
+
+bool MetadataCacheOps::open(IOChainContext & iocontext, int flags){
+    if((flags & (O_WRONLY | O_RDWR | O_CREAT | O_TRUNC)) == 0){
+        return HttpIOChain::open(iocontext, flags);
+    }
+
+    Invalidation invalidation(getCache(iocontext), iocontext._uri);
+    return HttpIOChain::open(iocontext, flags);
+}
+
+void MetadataCacheOps::resetIO(IOChainContext & iocontext){
+    if(!_written){
+        HttpIOChain::resetIO(iocontext);
+        return;
+    }
+
+    _written = false;
+    Invalidation invalidation(getCache(iocontext), iocontext._uri);
+    HttpIOChain::resetIO(iocontext);
+}
+
+dav_ssize_t MetadataCacheOps::write(IOChainContext & iocontext, const void* buf, dav_size_t count){
+    _written = true;
+    Invalidation invalidation(getCache(iocontext), iocontext._uri);
+    return HttpIOChain::write(iocontext, buf, count);
+}
+
+dav_ssize_t MetadataCacheOps::writeFromProvider(IOChainContext & iocontext, ContentProvider &provider){
+    Invalidation invalidation(getCache(iocontext), iocontext._uri);
+    return HttpIOChain::writeFromProvider(iocontext, provider);
+}
+
+}
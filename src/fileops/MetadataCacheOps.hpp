@@ -0,0 +1,70 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_METADATA_CACHE_OPS_HPP
+#define DAVIX_METADATA_CACHE_OPS_HPP
+
+#include <fileops/httpiochain.hpp>
+
+namespace Davix{
+
+class MetadataCache;
+
+//------------------------------------------------------------------------------
+// Metadata cache chain element.
+//
+// Answers stats from the metadata cache of the context, fills it with the
+// results of stats and with every entry of listings, and drops the entries
+// of the resources modified through the chain: deletions, moves, new
+// collections and writes.
+//------------------------------------------------------------------------------
+class MetadataCacheOps: public HttpIOChain{
+public:
+    MetadataCacheOps();
+    virtual ~MetadataCacheOps();
+
+    virtual void deleteResource(IOChainContext & iocontext);
+
+    virtual void makeCollection(IOChainContext & iocontext);
+
+    virtual void move(IOChainContext & iocontext, const std::string & target_url);
+
+    virtual StatInfo & statInfo(IOChainContext & iocontext, StatInfo & st_info);
+
+    virtual bool nextSubItem(IOChainContext & iocontext, std::string & entry_name, StatInfo & info);
+
+    virtual bool open(IOChainContext & iocontext, int flags);
+
+    virtual void resetIO(IOChainContext & iocontext);
+
+    virtual dav_ssize_t write(IOChainContext & iocontext, const void* buf, dav_size_t count);
+
+    virtual dav_ssize_t writeFromProvider(IOChainContext & iocontext, ContentProvider &provider);
+
+private:
+    // key of the collection being listed
+    std::string _listingKey;
+    // pending writes of a POSIX file, invalidated again once flushed by resetIO
+    bool _written;
+};
+
+}
+
+#endif // DAVIX_METADATA_CACHE_OPS_HPP
@@ -0,0 +1,335 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "PartUploader.hpp"
+#include <utils/davix_logger_internal.hpp>
+#include <unistd.h>
+
+namespace Davix{
+
+static dav_size_t availableMemory() {
+#ifdef _SC_AVPHYS_PAGES
+  long pages = sysconf(_SC_AVPHYS_PAGES);
+  long pageSize = sysconf(_SC_PAGESIZE);
+  if(pages > 0 && pageSize > 0) {
+    return static_cast<dav_size_t>(pages) * static_cast<dav_size_t>(pageSize);
+  }
+#endif
+  return 0; // unknown
+}
+
+dav_size_t uploadMemoryBudget() {
+  return availableMemory() / DAVIX_UPLOAD_MEMORY_FRACTION;
+}
+
+dav_size_t computeUploadPartSize(const RequestParams &params, dav_ssize_t objectSize,
+                                 dav_size_t minPartSize, dav_size_t maxPartSize, size_t maxParts) {
+  dav_size_t partSize = params.getUploadPartSize();
+
+  // smallest part size respecting the part count limit, rounded up to 1 MiB
+  dav_size_t needed = 0;
+  if(objectSize >= 0) {
+    const dav_size_t MiB = 1024 * 1024;
+    needed = (objectSize + maxParts - 1) / maxParts;
+    needed = (needed + MiB - 1) / MiB * MiB;
+  }
+
+  if(partSize == 0) {
+    // the final size may be unknown: start small, the parts grow with the stream
+    partSize = std::max<dav_size_t>(DAVIX_MIN_UPLOAD_PART_SIZE, needed);
+  }
+  else {
+    if(partSize < minPartSize) {
+      throw DavixException(davix_scope_io_buff(), StatusCode::InvalidArgument,
+        fmt::format("Upload part size of {} bytes is below the minimum of {} bytes", partSize, minPartSize));
+    }
+    if(partSize < needed) {
+      DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_CHAIN, "Upload part size of {} bytes raised to {} to fit in {} parts", partSize, needed, maxParts);
+      partSize = needed;
+    }
+  }
+
+  partSize = std::min(partSize, maxPartSize);
+  if(objectSize >= 0) {
+    partSize = std::min(partSize, (dav_size_t) objectSize);
+  }
+
+  DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Using parts of {} bytes to upload an object of size {}", partSize, objectSize);
+  return partSize;
+}
+
+PartUploader::PartUploader(const PartWriter &writer, dav_size_t partSize, size_t maxInFlight)
+: _writer(writer), _partSize(partSize), _maxInFlight(std::max<size_t>(1, maxInFlight)),
+  _maxPartSize(partSize), _maxParts(0), _memoryBudget(uploadMemoryBudget()),
+  _allocatedBuffers(0), _running(0), _closed(false) {
+
+}
+
+void PartUploader::setMemoryBudget(dav_size_t budget) {
+  _memoryBudget = budget;
+}
+
+void PartUploader::growPartSize(dav_size_t maxPartSize, size_t maxParts) {
+  _maxPartSize = std::max(_partSize, maxPartSize);
+  _maxParts = maxParts;
+}
+
+dav_size_t PartUploader::getPartSize(size_t partNumber) const {
+  // quadruple the part size each time the number of parts left is halved
+  dav_size_t partSize = _partSize;
+  size_t left = _maxParts / 2;
+  while(left > 0 && partNumber > _maxParts - left && partSize < _maxPartSize) {
+    partSize *= 4;
+    left /= 2;
+  }
+  // grown parts stay within the memory budget
+  dav_size_t maxPartSize = _maxPartSize;
+  if(_memoryBudget > 0) {
+    maxPartSize = std::min(maxPartSize, std::max(_partSize, _memoryBudget));
+  }
+  return std::min(partSize, maxPartSize);
+}
+
+size_t PartUploader::getMaxBuffers(dav_size_t partSize) const {
+  size_t maxBuffers = _maxInFlight + 1;
+  if(_memoryBudget > 0 && partSize > 0) {
+    maxBuffers = std::min<dav_size_t>(maxBuffers, std::max<dav_size_t>(1, _memoryBudget / partSize));
+  }
+  return maxBuffers;
+}
+
+PartUploader::~PartUploader() {
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _queue.clear();
+  }
+  stop();
+}
+
+void PartUploader::rethrowOnFailure() {
+  if(_error) {
+    std::rethrow_exception(_error);
+  }
+}
+
+std::vector<char> PartUploader::acquireBuffer(size_t partNumber) {
+  const dav_size_t partSize = getPartSize(partNumber);
+  const size_t maxBuffers = getMaxBuffers(partSize);
+
+  std::unique_lock<std::mutex> lock(_mtx);
+  while(true) {
+    rethrowOnFailure();
+
+    // fewer buffers once the parts have grown
+    while(_allocatedBuffers > maxBuffers && !_freeBuffers.empty()) {
+      _freeBuffers.pop_back();
+      _allocatedBuffers--;
+    }
+    if(!_freeBuffers.empty() || _allocatedBuffers < maxBuffers) {
+      break;
+    }
+    _cv.wait(lock);
+  }
+
+  if(!_freeBuffers.empty()) {
+    std::vector<char> buffer(std::move(_freeBuffers.back()));
+    _freeBuffers.pop_back();
+    lock.unlock();
+    if(buffer.size() < partSize) {
+      // the parts have grown
+      std::vector<char>().swap(buffer);
+      buffer.resize(partSize);
+    }
+    return buffer;
+  }
+
+  _allocatedBuffers++;
+  lock.unlock();
+  return std::vector<char>(partSize);
+}
+
+void PartUploader::submit(std::vector<char> &&buffer, dav_size_t size, size_t partNumber) {
+  Part part;
+  part.buffer = std::move(buffer);
+  part.data = NULL;
+  part.size = size;
+  part.partNumber = partNumber;
+  enqueue(std::move(part));
+}
+
+void PartUploader::submit(const char* data, dav_size_t size, size_t partNumber) {
+  Part part;
+  part.data = data;
+  part.size = size;
+  part.partNumber = partNumber;
+  enqueue(std::move(part));
+}
+
+void PartUploader::enqueue(Part &&part) {
+  std::lock_guard<std::mutex> lock(_mtx);
+  rethrowOnFailure();
+
+  _queue.push_back(std::move(part));
+
+  // start a new worker only when all the existing ones are busy
+  if(_workers.size() < _maxInFlight && _running + _queue.size() > _workers.size()) {
+    _workers.emplace_back(&PartUploader::worker, this);
+  }
+  _cv.notify_all();
+}
+
+void PartUploader::addCompleted(size_t partNumber, const std::string &result) {
+  std::lock_guard<std::mutex> lock(_mtx);
+  _results[partNumber] = result;
+}
+
+std::vector<std::string> PartUploader::finish() {
+  stop();
+  rethrowOnFailure();
+
+  std::vector<std::string> results;
+  results.reserve(_results.size());
+  for(std::map<size_t, std::string>::iterator it = _results.begin(); it != _results.end(); it++) {
+    results.push_back(it->second);
+  }
+  return results;
+}
+
+void PartUploader::stop() {
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _closed = true;
+    _cv.notify_all();
+  }
+
+  for(size_t i = 0; i < _workers.size(); i++) {
+    if(_workers[i].joinable()) {
+      _workers[i].join();
+    }
+  }
+}
+
+void PartUploader::worker() {
+  std::unique_lock<std::mutex> lock(_mtx);
+
+  while(true) {
+    _cv.wait(lock, [this]{ return _closed || _error || !_queue.empty(); });
+    if(_error || _queue.empty()) {
+      return;
+    }
+
+    Part part(std::move(_queue.front()));
+    _queue.pop_front();
+    _running++;
+    lock.unlock();
+
+    std::string result;
+    std::exception_ptr error;
+    try {
+      result = _writer(part.data ? part.data : part.buffer.data(), part.size, part.partNumber);
+    }
+    catch(...) {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    _running--;
+    if(error) {
+      DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Upload of part #{} failed, cancelling the remaining parts", part.partNumber);
+      if(!_error) {
+        _error = error;
+      }
+      _queue.clear();
+    }
+    else {
+      _results[part.partNumber] = result;
+    }
+
+    if(!part.data) {
+      _freeBuffers.push_back(std::move(part.buffer));
+    }
+    _cv.notify_all();
+  }
+}
+
+PartReader::PartReader(ContentProvider &provider, PartUploader &uploader)
+: _provider(provider), _uploader(uploader), _contents(provider.getContiguousData()),
+  _contentsSize(0), _offset(0), _data(NULL), _size(0), _parts(0), _partSize(0) {
+
+  if(_contents && _provider.getSize() >= 0) {
+    _contentsSize = _provider.getSize();
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Data provider contents are in memory, sending parts without copies");
+  }
+  else {
+    _contents = NULL;
+  }
+}
+
+dav_size_t PartReader::next() {
+  _parts++;
+  _partSize = _uploader.getPartSize(_parts);
+  const dav_size_t partSize = _partSize;
+
+  if(_contents) {
+    _data = _contents + _offset;
+    _size = std::min(partSize, _contentsSize - _offset);
+    _offset += _size;
+    return _size;
+  }
+
+  // parts handed over to the uploader take their buffer with them
+  if(_buffer.empty()) {
+    _buffer = _uploader.acquireBuffer(_parts);
+  }
+  else if(_buffer.size() < partSize) {
+    // kept from a part which was not submitted, the parts have grown since
+    _buffer.resize(partSize);
+  }
+
+  _data = _buffer.data();
+  _size = 0;
+  while(_size < partSize) {
+    dav_ssize_t bytesRead = _provider.pullBytes(_buffer.data() + _size, partSize - _size);
+    if(bytesRead < 0) {
+      throw DavixException(davix_scope_io_buff(), StatusCode::InvalidFileHandle, fmt::format("Error when reading from callback: {}", bytesRead));
+    }
+
+    if(bytesRead == 0) {
+      DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Reached data provider EOF, received 0 bytes, even though asked for {}", partSize - _size);
+      break; // EOF
+    }
+    _size += bytesRead;
+  }
+
+  DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Retrieved {} bytes from data provider", _size);
+  return _size;
+}
+
+void PartReader::submit(size_t partNumber) {
+  if(_contents) {
+    _uploader.submit(_data, _size, partNumber);
+    return;
+  }
+
+  _uploader.submit(std::move(_buffer), _size, partNumber);
+  _buffer = std::vector<char>();
+}
+
+}
@@ -0,0 +1,213 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_PART_UPLOADER_HPP
+#define DAVIX_PART_UPLOADER_HPP
+
+#include <davix_internal.hpp>
+#include <core/ContentProvider.hpp>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Davix{
+
+//------------------------------------------------------------------------------
+// Part size to use for uploading an object of objectSize bytes (-1 if unknown),
+// for a protocol accepting at most maxParts parts of minPartSize to maxPartSize
+// bytes, the last part excepted. An explicit part size too small to fit in
+// maxParts parts is raised, one below minPartSize throws InvalidArgument.
+// Uploads of unknown size start with small parts, see
+// PartUploader::growPartSize.
+//------------------------------------------------------------------------------
+dav_size_t computeUploadPartSize(const RequestParams &params, dav_ssize_t objectSize,
+                                 dav_size_t minPartSize, dav_size_t maxPartSize, size_t maxParts);
+
+//------------------------------------------------------------------------------
+// Memory the part buffers of an upload may use, a fraction of the available
+// memory, 0 if unknown
+//------------------------------------------------------------------------------
+dav_size_t uploadMemoryBudget();
+
+//------------------------------------------------------------------------------
+// Uploads the parts of a multi-part object concurrently.
+//
+// The caller fills part buffers obtained through acquireBuffer() and hands
+// them back with submit(); at most maxInFlight parts are sent at the same
+// time by background workers, and at most maxInFlight + 1 buffers exist, so
+// reading the next part overlaps with the network transfers while memory
+// stays bounded. Large parts get fewer buffers, to stay within
+// uploadMemoryBudget().
+//------------------------------------------------------------------------------
+class PartUploader : NonCopyable {
+public:
+  //----------------------------------------------------------------------------
+  // Sends a single part, returns the identifier of the stored part (etag).
+  // Called concurrently from the worker threads.
+  //----------------------------------------------------------------------------
+  typedef std::function<std::string (const char* data, dav_size_t size, size_t partNumber)> PartWriter;
+
+  PartUploader(const PartWriter &writer, dav_size_t partSize, size_t maxInFlight);
+
+  //----------------------------------------------------------------------------
+  // Cancels the parts not yet started and waits for the running ones
+  //----------------------------------------------------------------------------
+  ~PartUploader();
+
+  //----------------------------------------------------------------------------
+  // Grow the part size geometrically as the part count approaches maxParts,
+  // up to maxPartSize, for uploads whose size is unknown: small streams keep
+  // small buffers, large ones still fit within the part count limit.
+  //----------------------------------------------------------------------------
+  void growPartSize(dav_size_t maxPartSize, size_t maxParts);
+
+  //----------------------------------------------------------------------------
+  // Bound the memory of the part buffers, uploadMemoryBudget() by default, 0
+  // for no bound. Parts grow up to the budget, and buffers are allocated while
+  // they fit in it, one at least.
+  //----------------------------------------------------------------------------
+  void setMemoryBudget(dav_size_t budget);
+
+  //----------------------------------------------------------------------------
+  // Get an empty buffer for part partNumber, blocks while all buffers are in
+  // use. Rethrows the error of a failed part.
+  //----------------------------------------------------------------------------
+  std::vector<char> acquireBuffer(size_t partNumber = 1);
+
+  //----------------------------------------------------------------------------
+  // Queue the first size bytes of buffer as part partNumber
+  //----------------------------------------------------------------------------
+  void submit(std::vector<char> &&buffer, dav_size_t size, size_t partNumber);
+
+  //----------------------------------------------------------------------------
+  // Queue size bytes of memory owned by the caller as part partNumber, data
+  // must stay valid until finish() returns
+  //----------------------------------------------------------------------------
+  void submit(const char* data, dav_size_t size, size_t partNumber);
+
+  //----------------------------------------------------------------------------
+  // Record the identifier of a part stored by a previous upload attempt
+  //----------------------------------------------------------------------------
+  void addCompleted(size_t partNumber, const std::string &result);
+
+  //----------------------------------------------------------------------------
+  // Wait for all submitted parts, return their identifiers ordered by part
+  // number. Rethrows the error of the first failed part.
+  //----------------------------------------------------------------------------
+  std::vector<std::string> finish();
+
+  //----------------------------------------------------------------------------
+  // Size of part partNumber
+  //----------------------------------------------------------------------------
+  dav_size_t getPartSize(size_t partNumber = 1) const;
+
+private:
+  struct Part {
+    std::vector<char> buffer;
+    const char* data;
+    dav_size_t size;
+    size_t partNumber;
+  };
+
+  void enqueue(Part &&part);
+  void worker();
+  void stop();
+  void rethrowOnFailure();
+  size_t getMaxBuffers(dav_size_t partSize) const;
+
+  PartWriter _writer;
+  dav_size_t _partSize;
+  size_t _maxInFlight;
+
+  // growth of the part size, disabled when _maxParts is 0
+  dav_size_t _maxPartSize;
+  size_t _maxParts;
+  dav_size_t _memoryBudget;
+
+  std::mutex _mtx;
+  std::condition_variable _cv;
+  std::deque<Part> _queue;
+  std::vector<std::vector<char> > _freeBuffers;
+  size_t _allocatedBuffers;
+  size_t _running;
+  bool _closed;
+  std::exception_ptr _error;
+  std::map<size_t, std::string> _results;
+
+  std::vector<std::thread> _workers;
+};
+
+//------------------------------------------------------------------------------
+// Splits the contents of a provider into the parts of a multi-part upload.
+//
+// When the provider exposes its contents in memory (buffers, mapped files),
+// parts are slices of it and are sent without copies. Otherwise each part is
+// pulled into a buffer of the uploader.
+//------------------------------------------------------------------------------
+class PartReader : NonCopyable {
+public:
+  PartReader(ContentProvider &provider, PartUploader &uploader);
+
+  //----------------------------------------------------------------------------
+  // Read the next part, returns its size: less than the part size at the end
+  // of the contents, 0 once they are exhausted
+  //----------------------------------------------------------------------------
+  dav_size_t next();
+
+  //----------------------------------------------------------------------------
+  // Contents of the part returned by next()
+  //----------------------------------------------------------------------------
+  const char* data() const { return _data; }
+
+  //----------------------------------------------------------------------------
+  // Size asked for the part returned by next(), the contents are exhausted
+  // when the part is smaller
+  //----------------------------------------------------------------------------
+  dav_size_t partSize() const { return _partSize; }
+
+  //----------------------------------------------------------------------------
+  // Hand the part returned by next() over to the uploader
+  //----------------------------------------------------------------------------
+  void submit(size_t partNumber);
+
+private:
+  ContentProvider &_provider;
+  PartUploader &_uploader;
+
+  const char* _contents;
+  dav_size_t _contentsSize;
+  dav_size_t _offset;
+
+  std::vector<char> _buffer;
+  const char* _data;
+  dav_size_t _size;
+
+  size_t _parts;
+  dav_size_t _partSize;
+};
+
+}
+
+#endif // DAVIX_PART_UPLOADER_HPP
@@ -0,0 +1,288 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "RecursiveOps.hpp"
+#include <fileops/chain_factory.hpp>
+#include <fileops/TaskPool.hpp>
+#include <neon/neonrequest.hpp>
+#include <utils/davix_logger_internal.hpp>
+#include <utils/stringutils.hpp>
+#include <deque>
+#include <mutex>
+
+namespace Davix{
+
+static void deleteResource(Context & context, const RequestParams & params, const Uri & url) {
+  HttpIOChain chain;
+  IOChainContext io_context(context, url, &params);
+  ChainFactory::instanceChain(CreationFlags(), chain).deleteResource(io_context);
+}
+
+static void makeCollection(Context & context, const RequestParams & params, const Uri & url) {
+  HttpIOChain chain;
+  IOChainContext io_context(context, url, &params);
+  ChainFactory::instanceChain(CreationFlags(), chain).makeCollection(io_context);
+}
+
+//------------------------------------------------------------------------------
+// Stat of url, false if it does not exist
+//------------------------------------------------------------------------------
+static bool statResource(Context & context, const RequestParams & params, const Uri & url, StatInfo & info) {
+  try {
+    HttpIOChain chain;
+    IOChainContext io_context(context, url, &params);
+    ChainFactory::instanceChain(CreationFlags(), chain).statInfo(io_context, info);
+    return true;
+  }
+  catch(DavixException & e) {
+    if(e.code() != StatusCode::FileNotFound) {
+      throw;
+    }
+    return false;
+  }
+}
+
+//------------------------------------------------------------------------------
+// Whether the collection url exists, typed_stat if the stat tells collections
+// from files
+//------------------------------------------------------------------------------
+static bool collectionExists(Context & context, const RequestParams & params, const Uri & url, bool typed_stat) {
+  StatInfo info;
+  if(!statResource(context, params, url, info)) {
+    return false;
+  }
+  if(typed_stat && !S_ISDIR(info.mode)) {
+    throw DavixException(davix_scope_mkdir_str(), StatusCode::IsNotADirectory, fmt::format("{} is not a collection", url));
+  }
+  return true;
+}
+
+namespace {
+
+//------------------------------------------------------------------------------
+// Bottom-up deletion of a tree: a collection is deleted once its listing is
+// done and all its entries are deleted
+//------------------------------------------------------------------------------
+class RecursiveDelete : NonCopyable {
+public:
+  RecursiveDelete(Context & context, const RequestParams & params)
+  : _context(context), _params(params), _deleted(0), _pool(params.getMetadataConcurrency()) {}
+
+  void run(const Uri & url) {
+    Node* root = addNode(url, NULL);
+    _pool.add([this, root]{ list(root); });
+    _pool.wait();
+
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Recursive deletion of {}: {} resources deleted one by one", url, _deleted);
+  }
+
+private:
+  struct Node {
+    Uri uri;
+    Node* parent;
+    size_t pending; // entries not deleted yet, plus one while listing
+  };
+
+  Node* addNode(const Uri & uri, Node* parent) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    Node node;
+    node.uri = uri;
+    node.uri.ensureTrailingSlash();
+    node.parent = parent;
+    node.pending = 1;
+    _nodes.push_back(node);
+    return &_nodes.back();
+  }
+
+  void list(Node* node) {
+    std::vector<std::pair<Uri, bool> > entries;
+    {
+      HttpIOChain chain;
+      IOChainContext io_context(_context, node->uri, &_params);
+      HttpIOChain & head = ChainFactory::instanceChain(CreationFlags(), chain);
+
+      std::string name;
+      StatInfo info;
+      while(head.nextSubItem(io_context, name, info)) {
+        Uri child(node->uri);
+        child.addPathSegment(Uri::escapeString(name));
+        entries.push_back(std::make_pair(child, S_ISDIR(info.mode)));
+      }
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(_mtx);
+      node->pending += entries.size();
+    }
+
+    for(size_t i = 0; i < entries.size(); i++) {
+      if(entries[i].second) {
+        Node* child = addNode(entries[i].first, node);
+        _pool.add([this, child]{ list(child); });
+      }
+      else {
+        const Uri uri = entries[i].first;
+        _pool.add([this, uri, node]{ remove(uri); release(node); });
+      }
+    }
+    release(node);
+  }
+
+  void remove(const Uri & uri) {
+    deleteResource(_context, _params, uri);
+    std::lock_guard<std::mutex> lock(_mtx);
+    _deleted++;
+  }
+
+  void release(Node* node) {
+    {
+      std::lock_guard<std::mutex> lock(_mtx);
+      if(--node->pending > 0) {
+        return;
+      }
+    }
+
+    // empty now
+    _pool.add([this, node]{
+      remove(node->uri);
+      if(node->parent != NULL) {
+        release(node->parent);
+      }
+    });
+  }
+
+  Context & _context;
+  const RequestParams & _params;
+
+  std::mutex _mtx;
+  std::deque<Node> _nodes;
+  size_t _deleted;
+
+  TaskPool _pool;
+};
+
+}
+
+void recursiveDelete(Context & context, const RequestParams & params, const Uri & url) {
+  std::exception_ptr error;
+  try {
+    deleteResource(context, params, url);
+    return;
+  }
+  catch(DavixException & e) {
+    if(e.code() == StatusCode::FileNotFound) {
+      throw;
+    }
+    DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_CHAIN, "Deletion of {} failed, deleting its entries first: {}", url, e.what());
+    error = std::current_exception();
+  }
+
+  try {
+    RecursiveDelete(context, params).run(url);
+  }
+  catch(DavixException & e) {
+    // only collections can be emptied first
+    if(e.code() == StatusCode::IsNotADirectory) {
+      std::rethrow_exception(error);
+    }
+    throw;
+  }
+}
+
+std::vector<Uri> collectionPath(const Uri & url) {
+  std::vector<Uri> path;
+  const std::vector<std::string> segments = StrUtil::tokenSplit(url.getPath(), "/");
+
+  std::string current("/");
+  Uri collection(url);
+  collection.setPath(current);
+  path.push_back(collection);
+
+  for(std::vector<std::string>::const_iterator it = segments.begin(); it != segments.end(); it++) {
+    current += *it + "/";
+    collection.setPath(current);
+    path.push_back(collection);
+  }
+  return path;
+}
+
+void makeParentCollections(Context & context, const RequestParams & params, const Uri & url) {
+  const std::vector<Uri> path = collectionPath(url);
+
+  // HEAD based stats cannot tell collections from files
+  RequestParams proto_params(params);
+  configureRequestParamsProto(url, proto_params);
+  const bool typed_stat = (proto_params.getProtocol() == RequestProtocol::Webdav);
+
+  // deepest existing collection, the root always exists
+  size_t low = 0, high = path.size() - 1;
+  size_t stats = 0;
+  try {
+    while(low < high) {
+      const size_t mid = (low + high + 1) / 2;
+      stats++;
+      if(collectionExists(context, params, path[mid], typed_stat)) {
+        low = mid;
+      }
+      else {
+        high = mid - 1;
+      }
+    }
+  }
+  catch(DavixException & e) {
+    if(e.code() != StatusCode::PermissionRefused) {
+      throw;
+    }
+
+    // ancestors hidden from the client, walk up from the leaf instead: an
+    // unreadable collection is taken as existing
+    DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_CHAIN, "Stat refused while looking for the deepest collection of {}, walking up from it: {}", url, e.what());
+    for(low = path.size() - 1; low > 0; low--) {
+      stats++;
+      try {
+        if(collectionExists(context, params, path[low], typed_stat)) {
+          break;
+        }
+      }
+      catch(DavixException & e) {
+        if(e.code() != StatusCode::PermissionRefused) {
+          throw;
+        }
+        break;
+      }
+    }
+  }
+
+  DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Deepest existing collection of {} found with {} stats: {}", url, stats, path[low]);
+
+  for(size_t i = low + 1; i < path.size(); i++) {
+    try {
+      makeCollection(context, params, path[i]);
+    }
+    catch(DavixException & e) {
+      // created concurrently
+      if(e.code() != StatusCode::FileExist) {
+        throw;
+      }
+    }
+  }
+}
+
+}
@@ -0,0 +1,57 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_RECURSIVE_OPS_HPP
+#define DAVIX_RECURSIVE_OPS_HPP
+
+#include <davix_internal.hpp>
+#include <vector>
+
+namespace Davix{
+
+//------------------------------------------------------------------------------
+// Delete a resource and, for a collection, everything below it.
+//
+// A single DELETE of the collection is tried first, WebDAV servers delete
+// collections recursively. If it is refused, the tree is listed and deleted
+// bottom-up: the entries of a collection are deleted concurrently, and the
+// collection itself once it is empty. At most params.getMetadataConcurrency()
+// requests are sent at the same time.
+//------------------------------------------------------------------------------
+void recursiveDelete(Context & context, const RequestParams & params, const Uri & url);
+
+//------------------------------------------------------------------------------
+// Create a collection and its missing parents, succeeds if it exists already.
+//
+// The deepest existing ancestor is found by bisection over the path, with a
+// logarithmic number of stats, then the missing collections are created
+// below it. If a stat is refused, the path is walked up from url instead.
+//------------------------------------------------------------------------------
+void makeParentCollections(Context & context, const RequestParams & params, const Uri & url);
+
+//------------------------------------------------------------------------------
+// Collections on the path of url, from its root to url itself, all with a
+// trailing slash
+//------------------------------------------------------------------------------
+std::vector<Uri> collectionPath(const Uri & url);
+
+}
+
+#endif // DAVIX_RECURSIVE_OPS_HPP
@@ -23,6 +23,11 @@
 #include <core/ContentProvider.hpp>
 #include <utils/davix_logger_internal.hpp>
 #include <xml/S3MultiPartInitiationParser.hpp>
+#include <fileops/PartUploader.hpp>
+#include <fileops/UploadJournal.hpp>
+#include <xml/S3MultiPartListParser.hpp>
+#include <utils/davix_s3_utils.hpp>
+#include <set>
 
 #define SSTR(message) static_cast<std::ostringstream&>(std::ostringstream().flush() << message).str()
 
@@ -36,7 +41,7 @@ static bool is_s3_operation(IOChainContext & context){
   return false;
 }
 
-static bool should_use_s3_multipart(IOChainContext & context, dav_size_t size) {
+static bool should_use_s3_multipart(IOChainContext & context, dav_ssize_t size) {
   bool is_s3 = is_s3_operation(context);
 
   if(!is_s3) return false;
@@ -46,9 +51,17 @@ static bool should_use_s3_multipart(IOChainContext & context, dav_size_t size) {
     return true;
   }
 
-  return size > (1024 * 1024 * 512); // 512 MB
+  // size not known in advance: stream it part by part
+  if(size < 0) return true;
+
+  return (dav_size_t) size > context._reqparams->getMultipartThreshold();
 }
 
+// limits of S3 multi-part uploads
+static const dav_size_t S3_MIN_PART_SIZE = 5ULL * 1024 * 1024; // 5 MB, the last part excepted
+static const dav_size_t S3_MAX_PART_SIZE = 5ULL * 1024 * 1024 * 1024; // 5 GB
+static const size_t S3_MAX_PARTS = 10000;
+
 S3IO::S3IO() {
 
 }
@@ -158,12 +171,152 @@ void S3IO::commitChunks(IOChainContext & iocontext,  const Uri &url, const std::
   checkDavixError(&tmp_err);
 }
 
+std::map<size_t, S3MultiPartListParser::Part> S3IO::listParts(IOChainContext & iocontext, const std::string &uploadId) {
+  std::map<size_t, S3MultiPartListParser::Part> parts;
+  std::string marker;
+
+  while(true) {
+    Uri url(iocontext._uri);
+    url.addQueryParam("uploadId", uploadId);
+    if(!marker.empty()) {
+      url.addQueryParam("part-number-marker", marker);
+    }
+
+    DavixError * tmp_err=NULL;
+    GetRequest req(iocontext._context, url, &tmp_err);
+    checkDavixError(&tmp_err);
+
+    req.setParameters(iocontext._reqparams);
+    req.executeRequest(&tmp_err);
+    if(!tmp_err && httpcodeIsValid(req.getRequestCode()) == false){
+      httpcodeToDavixError(req.getRequestCode(), davix_scope_io_buff(),
+        "list parts error: ", &tmp_err);
+    }
+    checkDavixError(&tmp_err);
+
+    S3MultiPartListParser parser;
+    if(parser.parseChunk(req.getAnswerContent()) != 0) {
+      throw DavixException("S3::MultiPart", StatusCode::InvalidServerResponse, "Unable to parse server response for list parts");
+    }
+
+    for(std::vector<S3MultiPartListParser::Part>::const_iterator it = parser.getParts().begin(); it != parser.getParts().end(); it++) {
+      parts[it->partNumber] = *it;
+    }
+
+    if(!parser.isTruncated() || parser.getNextPartNumberMarker().empty() || parser.getNextPartNumberMarker() == marker) {
+      break;
+    }
+    marker = parser.getNextPartNumberMarker();
+  }
+
+  DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Multi-part upload {} has {} stored parts", uploadId, parts.size());
+  return parts;
+}
+
+bool S3IO::abortMultipart(IOChainContext & iocontext, const std::string &uploadId) {
+  Uri url(iocontext._uri);
+  url.addQueryParam("uploadId", uploadId);
+
+  DavixError * tmp_err=NULL;
+  DeleteRequest req(iocontext._context, url, &tmp_err);
+  checkDavixError(&tmp_err);
+
+  req.setParameters(iocontext._reqparams);
+  req.executeRequest(&tmp_err);
+  // an upload already gone is as good as aborted
+  if(req.getRequestCode() == 404){
+    DavixError::clearError(&tmp_err);
+    return false;
+  }
+  if(!tmp_err && httpcodeIsValid(req.getRequestCode()) == false){
+    httpcodeToDavixError(req.getRequestCode(), davix_scope_io_buff(),
+      "abort multi-part upload error: ", &tmp_err);
+  }
+  checkDavixError(&tmp_err);
+
+  DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Aborted multi-part upload {} towards {}", uploadId, iocontext._uri);
+  return true;
+}
+
+size_t S3IO::abortPendingUploads(IOChainContext & iocontext) {
+  std::set<std::string> uploadIds;
+
+  // the uploads known by the local journals, if any
+  const std::string &journalDir = iocontext._reqparams->getUploadJournalDir();
+  const std::vector<std::string> sources = UploadJournal::findSources(journalDir, iocontext._uri);
+  for(std::vector<std::string>::const_iterator it = sources.begin(); it != sources.end(); it++) {
+    UploadJournal journal(journalDir, iocontext._uri, *it);
+    if(journal.load()) {
+      uploadIds.insert(journal.getUploadId());
+    }
+  }
+
+  // all the uploads towards this key known by the server
+  const bool alternate = iocontext._reqparams->getAwsAlternate();
+  const std::string key = S3::extract_s3_path(iocontext._uri, alternate).substr(1);
+  Uri bucket(iocontext._uri);
+  bucket.setPath(alternate ? "/" + S3::extract_s3_bucket(iocontext._uri, true) + "/" : "/");
+
+  std::string keyMarker, uploadIdMarker;
+  while(true) {
+    Uri url(bucket);
+    url.addQueryParam("uploads", "");
+    url.addQueryParam("prefix", key);
+    if(!keyMarker.empty()) {
+      url.addQueryParam("key-marker", keyMarker);
+      url.addQueryParam("upload-id-marker", uploadIdMarker);
+    }
+
+    DavixError * tmp_err=NULL;
+    GetRequest req(iocontext._context, url, &tmp_err);
+    checkDavixError(&tmp_err);
+
+    req.setParameters(iocontext._reqparams);
+    req.executeRequest(&tmp_err);
+    if(!tmp_err && httpcodeIsValid(req.getRequestCode()) == false){
+      httpcodeToDavixError(req.getRequestCode(), davix_scope_io_buff(),
+        "list multi-part uploads error: ", &tmp_err);
+    }
+    checkDavixError(&tmp_err);
+
+    S3MultiPartListParser parser;
+    if(parser.parseChunk(req.getAnswerContent()) != 0) {
+      throw DavixException("S3::MultiPart", StatusCode::InvalidServerResponse, "Unable to parse server response for list multi-part uploads");
+    }
+
+    for(std::vector<S3MultiPartListParser::Upload>::const_iterator it = parser.getUploads().begin(); it != parser.getUploads().end(); it++) {
+      if(it->key == key) { // prefix match only
+        uploadIds.insert(it->uploadId);
+      }
+    }
+
+    if(!parser.isTruncated() || parser.getNextKeyMarker().empty() ||
+       (parser.getNextKeyMarker() == keyMarker && parser.getNextUploadIdMarker() == uploadIdMarker)) {
+      break;
+    }
+    keyMarker = parser.getNextKeyMarker();
+    uploadIdMarker = parser.getNextUploadIdMarker();
+  }
+
+  size_t aborted = 0;
+  for(std::set<std::string>::const_iterator it = uploadIds.begin(); it != uploadIds.end(); it++) {
+    if(abortMultipart(iocontext, *it)) {
+      aborted++;
+    }
+  }
+
+  for(std::vector<std::string>::const_iterator it = sources.begin(); it != sources.end(); it++) {
+    UploadJournal(journalDir, iocontext._uri, *it).remove();
+  }
+  return aborted;
+}
+
 static dav_size_t fillBufferWithProviderData(std::vector<char> &buffer, const dav_size_t maxChunkSize, ContentProvider &provider) {
     dav_size_t written = 0u;
     dav_size_t remaining = maxChunkSize;
 
     while(true) {
-      dav_ssize_t bytesRead = provider.pullBytes(buffer.data(), remaining);
+      dav_ssize_t bytesRead = provider.pullBytes(buffer.data() + written, remaining);
       if(bytesRead < 0) {
         throw DavixException(davix_scope_io_buff(), StatusCode::InvalidFileHandle, fmt::format("Error when reading from callback: {}", bytesRead));
       }
@@ -192,30 +345,78 @@ dav_ssize_t S3IO::writeFromProvider(IOChainContext & iocontext, ContentProvider
     CHAIN_FORWARD(writeFromProvider(iocontext, provider));
   }
 
-  DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Initiating multi-part upload towards {} to upload file with size {}", iocontext._uri, provider.getSize());
-  std::string uploadId = initiateMultipart(iocontext);
+  dav_size_t partSize = computeUploadPartSize(*iocontext._reqparams, provider.getSize(), S3_MIN_PART_SIZE, S3_MAX_PART_SIZE, S3_MAX_PARTS);
 
-  size_t remaining = provider.getSize();
-  const dav_size_t MAX_CHUNK_SIZE = 1024 * 1024 * 256; // 256 MB
+  // resume the upload left unfinished by a previous attempt
+  UploadJournal journal(iocontext._reqparams->getUploadJournalDir(), iocontext._uri, provider.getSourceFingerprint());
+  std::string uploadId;
+  std::map<size_t, S3MultiPartListParser::Part> storedParts;
+  if(journal.load() && journal.getObjectSize() == provider.getSize()) {
+    try {
+      storedParts = listParts(iocontext, journal.getUploadId());
+      uploadId = journal.getUploadId();
+      partSize = journal.getPartSize();
+      DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_CHAIN, "Resuming multi-part upload {} towards {}, {} parts already stored", uploadId, iocontext._uri, storedParts.size());
+    }
+    catch(DavixException &e) {
+      DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_CHAIN, "Unable to resume multi-part upload {} towards {}, restarting it: {}", journal.getUploadId(), iocontext._uri, e.what());
+    }
+  }
 
-  std::vector<char> buffer;
-  buffer.resize(std::min(MAX_CHUNK_SIZE, (dav_size_t) provider.getSize()) + 10);
+  // parts are read from the provider while the previous ones are being sent
+  PartUploader uploader([this, &iocontext, &uploadId, &journal](const char* data, dav_size_t size, size_t partNumber) {
+    std::string etag = writeChunk(iocontext, data, size, uploadId, partNumber);
+    journal.addPart(partNumber, etag);
+    return etag;
+  }, partSize, iocontext._reqparams->getUploadConcurrency());
+  if(provider.getSize() < 0) {
+    uploader.growPartSize(S3_MAX_PART_SIZE, S3_MAX_PARTS);
+  }
 
-  std::vector<std::string> etags;
+  PartReader reader(provider, uploader);
 
-  size_t partNumber = 0;
-  while(remaining > 0) {
-    size_t toRead = std::min( (dav_size_t) provider.getSize(), MAX_CHUNK_SIZE);
-    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "S3IO write: toRead from cb {}", toRead);
+  // Streams of unknown size which fit in a single part don't need the
+  // multi-part machinery, send them with a simple PUT
+  dav_size_t bytesRead = reader.next();
+  if(uploadId.empty() && provider.getSize() < 0 && bytesRead < reader.partSize() && !iocontext._uri.fragmentParamExists("forceMultiPart")) {
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Stream towards {} ended after {} bytes, using a single PUT", iocontext._uri, bytesRead);
+    BufferContentProvider single(reader.data(), bytesRead);
+    CHAIN_FORWARD(writeFromProvider(iocontext, single));
+  }
+
+  if(uploadId.empty()) {
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Initiating multi-part upload towards {} to upload file with size {}", iocontext._uri, provider.getSize());
+    uploadId = initiateMultipart(iocontext);
+  }
+  journal.start(uploadId, partSize, provider.getSize());
 
-    dav_size_t bytesRead = fillBufferWithProviderData(buffer, MAX_CHUNK_SIZE, provider);
-    if(bytesRead == 0) break; // EOF
+  dav_size_t total = 0;
 
+  size_t partNumber = 0;
+  while(bytesRead > 0 || partNumber == 0) {
     partNumber++;
-    etags.emplace_back(writeChunk(iocontext, buffer.data(), bytesRead, uploadId, partNumber));
-   }
 
-   commitChunks(iocontext, uploadId, etags);
+    std::map<size_t, S3MultiPartListParser::Part>::const_iterator stored = storedParts.find(partNumber);
+    if(stored != storedParts.end() && UploadJournal::partMatches(reader.data(), bytesRead, stored->second.etag, stored->second.size)) {
+      // already on the server, skip it
+      DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Part #{} already uploaded, skipping it", partNumber);
+      uploader.addCompleted(partNumber, stored->second.etag);
+      journal.addPart(partNumber, stored->second.etag);
+    }
+    else {
+      reader.submit(partNumber);
+    }
+    total += bytesRead;
+
+    if(bytesRead < reader.partSize()) break; // EOF
+    if(provider.getSize() >= 0 && total >= (dav_size_t) provider.getSize()) break; // all data sent
+    bytesRead = reader.next();
+  }
+
+  std::vector<std::string> etags = uploader.finish();
+  commitChunks(iocontext, uploadId, etags);
+  journal.remove();
+  return total;
 }
 
 DynafedUris S3IO::retrieveDynafedUris(IOChainContext & iocontext, const std::string &uploadId, const std::string &pluginId, size_t nchunks) {
@@ -253,11 +454,11 @@ void S3IO::performUgrS3MultiPart(IOChainContext & iocontext, const std::string &
         Uri uri(posturl);
         std::string uploadId = initiateMultipart(iocontext, posturl);
 
-        const dav_size_t MAX_CHUNK_SIZE = 1024 * 1024 * 256; // 256 MB
+        const dav_size_t partSize = std::max<dav_size_t>(1, computeUploadPartSize(*iocontext._reqparams, provider.getSize(), S3_MIN_PART_SIZE, S3_MAX_PART_SIZE, S3_MAX_PARTS));
         std::vector<char> buffer;
-        buffer.resize(std::min(MAX_CHUNK_SIZE, (dav_size_t) provider.getSize()) + 10);
+        buffer.resize(partSize);
 
-        size_t nchunks = (provider.getSize() / MAX_CHUNK_SIZE) + 2;
+        size_t nchunks = (provider.getSize() / partSize) + 2;
         DynafedUris uris = retrieveDynafedUris(iocontext, uploadId, pluginId, nchunks);
 
         if(uris.chunks.size() != nchunks) {
@@ -270,7 +471,7 @@ void S3IO::performUgrS3MultiPart(IOChainContext & iocontext, const std::string &
         uint64_t remaining = provider.getSize();
 
         while(remaining > 0) {
-          dav_size_t bytesRetrieved = fillBufferWithProviderData(buffer, MAX_CHUNK_SIZE, provider);
+          dav_size_t bytesRetrieved = fillBufferWithProviderData(buffer, partSize, provider);
           if(bytesRetrieved == 0) {
             break; // EOF
           }
@@ -23,6 +23,8 @@
 #define S3_IO_HPP
 
 #include <fileops/httpiochain.hpp>
+#include <xml/S3MultiPartListParser.hpp>
+#include <map>
 
 namespace Davix{
 
@@ -41,12 +43,21 @@ public:
 
   void performUgrS3MultiPart(IOChainContext & iocontext, const std::string &posturl, const std::string &pluginId, ContentProvider &provider, DavixError **err);
 
+  // Abort the unfinished multi-part uploads towards the object, returns how many were aborted
+  size_t abortPendingUploads(IOChainContext & iocontext);
+
 private:
 
   // Returns uploadId
   std::string initiateMultipart(IOChainContext & iocontext);
   std::string initiateMultipart(IOChainContext & iocontext, const Uri &url);
 
+  // Parts already stored for the given upload id, by part number
+  std::map<size_t, S3MultiPartListParser::Part> listParts(IOChainContext & iocontext, const std::string &uploadId);
+
+  // Abort the given upload, false if it was already gone
+  bool abortMultipart(IOChainContext & iocontext, const std::string &uploadId);
+
   DynafedUris retrieveDynafedUris(IOChainContext & iocontext, const std::string &uploadId, const std::string &pluginId, size_t nchunks);
 
   // Given the upload id, write the given chunk. Return object ETag,
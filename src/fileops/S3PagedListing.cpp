@@ -0,0 +1,222 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "S3PagedListing.hpp"
+#include <fileops/fileutils.hpp>
+#include <utils/davix_logger_internal.hpp>
+#include <xml/s3propparser.hpp>
+
+namespace Davix{
+
+// marker of the page following the one parsed, false at the end of the listing
+static bool nextPageMarker(const S3PropParser & parser, std::string & marker) {
+  // a marker not moving forward would list the same page forever
+  if(!parser.isTruncated() || parser.getNextMarker().empty() || parser.getNextMarker() == marker) {
+    return false;
+  }
+  marker = parser.getNextMarker();
+  return true;
+}
+
+bool s3FetchListingPage(Context & context, const RequestParams & params, const Uri & uri,
+                        S3PropParser & parser, std::string & marker) {
+  DavixError* tmp_err = NULL;
+
+  GetRequest req(context, uri, &tmp_err);
+  checkDavixError(&tmp_err);
+  req.setParameters(params);
+  req.executeRequest(&tmp_err);
+  checkDavixError(&tmp_err);
+  check_file_status(req, davix_scope_directory_listing_str());
+
+  std::vector<char> & body = req.getAnswerContentVec();
+  parser.parseChunk(body.data(), body.size());
+
+  DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_S3, "Listing page {}: {} entries, truncated: {}", uri, parser.getProperties().size(), parser.isTruncated());
+  return nextPageMarker(parser, marker);
+}
+
+S3PagedListing::S3PagedListing(Context & context, const RequestParams & params, const Uri & url,
+                               const PageUri & pageUri, const PageParser & pageParser, bool listingBuckets)
+: _context(context), _params(params), _url(url), _pageUri(pageUri), _pageParser(pageParser),
+  _listingBuckets(listingBuckets), _pageCount(0), _pageEntries(0), _end(false), _cancelled(false) {
+
+  if(_params.getS3ListingPrefetch()) {
+    _pool.reset(new TaskPool(1));
+    _pool->add([this]{ fetchPages(); });
+  }
+}
+
+S3PagedListing::~S3PagedListing() {
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _cancelled = true;
+    _cv.notify_all();
+  }
+  // wait for the request in flight
+  _pool.reset();
+}
+
+void S3PagedListing::startPage() {
+  DavixError* tmp_err = NULL;
+  const Uri uri = _pageUri(_marker);
+
+  _parser.reset(_pageParser());
+  _request.reset(new GetRequest(_context, uri, &tmp_err));
+  checkDavixError(&tmp_err);
+  _request->setParameters(_params);
+  _request->beginRequest(&tmp_err);
+  checkDavixError(&tmp_err);
+  check_file_status(*_request, davix_scope_directory_listing_str());
+
+  DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_S3, "Listing page {}", uri);
+  _block.resize(DAVIX_LISTING_BLOCK_SIZE);
+  _pageCount++;
+  _pageEntries = 0;
+}
+
+bool S3PagedListing::nextStreamed(FileProperties & entry, bool & first) {
+  while(true) {
+    if(!_request) {
+      if(_end) {
+        return false;
+      }
+      startPage();
+    }
+
+    std::deque<FileProperties> & props = _parser->getProperties();
+    if(!props.empty()) {
+      entry = std::move(props.front());
+      props.pop_front();
+      first = (_pageEntries++ == 0);
+      return true;
+    }
+
+    DavixError* tmp_err = NULL;
+    const dav_ssize_t ret = _request->readBlock(_block.data(), _block.size(), &tmp_err);
+    checkDavixError(&tmp_err);
+    if(ret > 0) {
+      _parser->parseChunk(_block.data(), ret);
+      continue;
+    }
+    if(ret < 0) {
+      throw DavixException(davix_scope_directory_listing_str(), StatusCode::UnknowError, "Unknow readBlock error");
+    }
+
+    // end of the page
+    if(_pageCount == 1 && _pageEntries == 0) {
+      throw DavixException(davix_scope_directory_listing_str(), StatusCode::ParsingError, "Invalid server response, not a S3 listing");
+    }
+    _end = !nextPageMarker(*_parser, _marker);
+    _request.reset();
+  }
+}
+
+void S3PagedListing::fetchPages() {
+  try {
+    std::string marker;
+    bool more = true;
+
+    while(more) {
+      std::unique_ptr<S3PropParser> parser(_pageParser());
+      more = s3FetchListingPage(_context, _params, _pageUri(marker), *parser, marker);
+
+      std::unique_lock<std::mutex> lock(_mtx);
+      _ready.push_back(std::deque<FileProperties>());
+      _ready.back().swap(parser->getProperties());
+      _end = !more;
+      _cv.notify_all();
+      if(_end) {
+        return;
+      }
+
+      // fetch the page after next only once the caller moved to the next one
+      _cv.wait(lock, [this]{ return _cancelled || _ready.empty(); });
+      if(_cancelled) {
+        return;
+      }
+    }
+  }
+  catch(...) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _error = std::current_exception();
+    _cv.notify_all();
+  }
+}
+
+bool S3PagedListing::nextPrefetched(FileProperties & entry, bool & first) {
+  while(_page.empty()) {
+    std::unique_lock<std::mutex> lock(_mtx);
+    _cv.wait(lock, [this]{ return _error || !_ready.empty() || _end; });
+
+    if(_ready.empty()) {
+      if(_error) {
+        std::rethrow_exception(_error);
+      }
+      return false;
+    }
+
+    _page.swap(_ready.front());
+    _ready.pop_front();
+    _pageCount++;
+    _pageEntries = 0;
+    _cv.notify_all();
+    lock.unlock();
+
+    if(_pageCount == 1 && _page.empty()) {
+      throw DavixException(davix_scope_directory_listing_str(), StatusCode::ParsingError, "Invalid server response, not a S3 listing");
+    }
+  }
+
+  entry = std::move(_page.front());
+  _page.pop_front();
+  first = (_pageEntries++ == 0);
+  return true;
+}
+
+bool S3PagedListing::next(std::string & name, StatInfo & info) {
+  FileProperties entry;
+  bool first = false;
+
+  while((_pool) ? nextPrefetched(entry, first) : nextStreamed(entry, first)) {
+    if(first && _pageCount == 1) {
+      if(S_ISDIR(entry.info.mode) == false) {
+        std::ostringstream ss;
+        ss << _url << " is not a S3 bucket";
+        throw DavixException(davix_scope_directory_listing_str(), StatusCode::IsNotADirectory, ss.str());
+      }
+
+      _bucketEntry = entry.filename;
+      if(!_listingBuckets) {
+        continue; // suppress the bucket name entry
+      }
+    }
+    else if(first && S_ISDIR(entry.info.mode) && entry.filename == _bucketEntry) {
+      continue; // every page starts with the bucket name
+    }
+
+    name.swap(entry.filename);
+    info = entry.info;
+    return true;
+  }
+  return false;
+}
+
+}
@@ -0,0 +1,123 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_S3_PAGED_LISTING_HPP
+#define DAVIX_S3_PAGED_LISTING_HPP
+
+#include <davix_internal.hpp>
+#include <fileops/TaskPool.hpp>
+#include <utils/davix_fileproperties.hpp>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace Davix{
+
+class S3PropParser;
+
+//------------------------------------------------------------------------------
+// Execute the listing request uri and parse its answer with parser. Returns
+// true if the listing continues in another page, starting after marker.
+//------------------------------------------------------------------------------
+bool s3FetchListingPage(Context & context, const RequestParams & params, const Uri & uri,
+                        S3PropParser & parser, std::string & marker);
+
+//------------------------------------------------------------------------------
+// S3 listing following the pages of the answer.
+//
+// Each page is parsed block by block as it is returned, the next one is only
+// requested once the current one is exhausted.
+//
+// With RequestParams::setS3ListingPrefetch, pages are fetched whole by a
+// background task instead, the next one as soon as the current one has been
+// received, so that its latency overlaps with the consumption of the current
+// page: at most two pages are held, the one being returned and the next one.
+//------------------------------------------------------------------------------
+class S3PagedListing : NonCopyable {
+public:
+  // request of the page following marker, empty for the first page
+  typedef std::function<Uri (const std::string & marker)> PageUri;
+  // parser of a page
+  typedef std::function<S3PropParser* ()> PageParser;
+
+  //----------------------------------------------------------------------------
+  // Start the listing. The first entry of the first page describes the bucket,
+  // it is only returned when listing the buckets of an account.
+  //----------------------------------------------------------------------------
+  S3PagedListing(Context & context, const RequestParams & params, const Uri & url,
+                 const PageUri & pageUri, const PageParser & pageParser, bool listingBuckets);
+
+  //----------------------------------------------------------------------------
+  // Stops fetching pages
+  //----------------------------------------------------------------------------
+  ~S3PagedListing();
+
+  //----------------------------------------------------------------------------
+  // Next entry of the listing, false at the end
+  //----------------------------------------------------------------------------
+  bool next(std::string & name, StatInfo & info);
+
+private:
+  //----------------------------------------------------------------------------
+  // Next entry of the pages, bucket entries included, first is set for the
+  // first entry of a page
+  //----------------------------------------------------------------------------
+  bool nextStreamed(FileProperties & entry, bool & first);
+  bool nextPrefetched(FileProperties & entry, bool & first);
+
+  void startPage();
+  void fetchPages();
+
+  Context & _context;
+  RequestParams _params;
+  Uri _url;
+  PageUri _pageUri;
+  PageParser _pageParser;
+  bool _listingBuckets;
+
+  size_t _pageCount;
+  size_t _pageEntries;
+  std::string _bucketEntry;
+  std::string _marker;
+  bool _end;
+
+  // page being streamed
+  std::unique_ptr<GetRequest> _request;
+  std::unique_ptr<S3PropParser> _parser;
+  std::vector<char> _block;
+
+  // pages fetched in the background
+  std::deque<FileProperties> _page;
+  std::mutex _mtx;
+  std::condition_variable _cv;
+  std::deque<std::deque<FileProperties> > _ready;
+  bool _cancelled;
+  std::exception_ptr _error;
+
+  std::unique_ptr<TaskPool> _pool;
+};
+
+}
+
+#endif // DAVIX_S3_PAGED_LISTING_HPP
@@ -0,0 +1,314 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "S3ParallelListing.hpp"
+#include <fileops/S3PagedListing.hpp>
+#include <utils/davix_logger_internal.hpp>
+#include <utils/davix_s3_utils.hpp>
+#include <xml/s3propparser.hpp>
+
+namespace Davix{
+
+static std::string listingPrefix(const Uri & url, const RequestParams & params) {
+  std::string prefix = Uri::unescapeString(S3::extract_s3_path(url, params.getAwsAlternate()));
+  if(prefix.empty() || prefix[prefix.size()-1] != '/') {
+    prefix += "/";
+  }
+  return prefix.substr(1);
+}
+
+S3ParallelListing::S3ParallelListing(Context & context, const RequestParams & params, const Uri & url)
+: _context(context), _params(params), _url(url),
+  _bucket(S3::extract_s3_bucket(url, params.getAwsAlternate())),
+  _prefix(listingPrefix(url, params)),
+  _ordered(params.getListingOrder() == ListingOrder::Ordered),
+  _maxBuffered(std::max<size_t>(1, 2 * params.getS3MaxKey())),
+  _current(0), _started(false), _discovered(false), _cancelled(false),
+  _pool(params.getMetadataConcurrency()) {
+
+}
+
+S3ParallelListing::~S3ParallelListing() {
+  std::lock_guard<std::mutex> lock(_mtx);
+  _cancelled = true;
+  _cv.notify_all();
+  // the pool, destroyed first, waits for the running tasks
+}
+
+bool S3ParallelListing::fetchPage(const std::string & prefix, bool delimiter, std::string & marker,
+                                  std::deque<FileProperties> & entries) {
+  const Uri uri = S3::s3ListingUri(_url, _params, prefix, delimiter, marker);
+  // like the sequential listing, entries keep their whole key: the common
+  // prefixes found by the discovery are the prefixes of the shards
+  S3PropParser parser((delimiter) ? S3ListingMode::Hierarchical : S3ListingMode::SemiHierarchical,
+                      (delimiter) ? std::string() : S3::extract_s3_path(_url, _params.getAwsAlternate()));
+
+  bool more = false;
+  try {
+    more = s3FetchListingPage(_context, _params, uri, parser, marker);
+  }
+  catch(DavixException & e) {
+    // delimited listings of an empty prefix are reported as "not a directory"
+    if(e.code() != StatusCode::IsNotADirectory) {
+      throw;
+    }
+    return false;
+  }
+
+  std::deque<FileProperties> & props = parser.getProperties();
+  // first entry -> bucket information
+  if(!props.empty() && props.front().filename == _bucket && S_ISDIR(props.front().info.mode)) {
+    props.pop_front();
+  }
+  entries.swap(props);
+  return more;
+}
+
+size_t S3ParallelListing::addShard(const std::string & prefix) {
+  _shards.push_back(Shard());
+  _shards.back().prefix = prefix;
+  _cv.notify_all();
+  return _shards.size() - 1;
+}
+
+void S3ParallelListing::fail(const std::exception_ptr & error) {
+  std::lock_guard<std::mutex> lock(_mtx);
+  if(!_error) {
+    _error = error;
+  }
+  _cancelled = true;
+  _cv.notify_all();
+}
+
+bool S3ParallelListing::mayWait(size_t index) const {
+  // a full shard waits for the caller, unless a shard returned before it has
+  // not started yet: it may need the thread of this one
+  if(!_ordered) {
+    return true;
+  }
+
+  for(size_t i = _current; i < index; i++) {
+    if(!_shards[i].started) {
+      return false;
+    }
+  }
+  return true;
+}
+
+size_t S3ParallelListing::firstPending(size_t index) const {
+  for(size_t i = _current; i < index; i++) {
+    if(!_shards[i].started) {
+      return i;
+    }
+  }
+  return index;
+}
+
+bool S3ParallelListing::push(std::unique_lock<std::mutex> & lock, size_t index, std::deque<FileProperties> & entries) {
+  while(!entries.empty()) {
+    _cv.wait(lock, [&]{ return _cancelled || _shards[index].entries.size() < _maxBuffered || !mayWait(index); });
+    if(_cancelled) {
+      return false;
+    }
+
+    if(_shards[index].entries.size() >= _maxBuffered) {
+      // a shard returned before this one waits for a thread, which may never
+      // come (all of them busy): list it from this one
+      const size_t pending = firstPending(index);
+      _shards[pending].started = true;
+      const std::string prefix = _shards[pending].prefix;
+      lock.unlock();
+      const bool listed = listPages(pending, prefix);
+      lock.lock();
+      if(!listed) {
+        return false;
+      }
+      continue;
+    }
+
+    std::deque<FileProperties> & dest = _shards[index].entries;
+    while(!entries.empty() && dest.size() < _maxBuffered) {
+      dest.push_back(std::move(entries.front()));
+      entries.pop_front();
+    }
+    _cv.notify_all();
+  }
+  return true;
+}
+
+void S3ParallelListing::discover() {
+  try {
+    std::string marker;
+    size_t keys = 0;
+    bool more = true;
+
+    while(more) {
+      std::deque<FileProperties> page;
+      more = fetchPage(_prefix, true, marker, page);
+
+      // keys and common prefixes, each sorted: merge them back in key order
+      std::deque<FileProperties> files;
+      std::vector<std::string> prefixes;
+      for(std::deque<FileProperties>::iterator it = page.begin(); it != page.end(); it++) {
+        if(S_ISDIR(it->info.mode)) {
+          prefixes.push_back(it->filename + "/");
+        }
+        else {
+          files.push_back(std::move(*it));
+        }
+      }
+      keys += files.size();
+
+      std::unique_lock<std::mutex> lock(_mtx);
+      std::vector<std::string>::iterator next_prefix = prefixes.begin();
+      while(!files.empty() || next_prefix != prefixes.end()) {
+        if(next_prefix != prefixes.end() && (files.empty() || *next_prefix < files.front().filename)) {
+          const size_t index = addShard(*next_prefix);
+          _pool.add([this, index]{ listShard(index); });
+          next_prefix++;
+          continue;
+        }
+
+        // keys directly under the listed path, in a shard of their own
+        if(_shards.empty() || !_shards.back().prefix.empty() || _shards.back().done) {
+          const size_t index = addShard(std::string());
+          _shards[index].started = true;
+        }
+
+        const size_t index = _shards.size() - 1;
+        std::deque<FileProperties> run;
+        while(!files.empty() && (next_prefix == prefixes.end() || files.front().filename < *next_prefix)) {
+          run.push_back(std::move(files.front()));
+          files.pop_front();
+        }
+        if(!push(lock, index, run)) {
+          return;
+        }
+        if(!files.empty() || next_prefix != prefixes.end()) {
+          _shards[index].done = true;
+        }
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(_mtx);
+    for(size_t i = 0; i < _shards.size(); i++) {
+      if(_shards[i].prefix.empty()) {
+        _shards[i].done = true;
+      }
+    }
+    _discovered = true;
+    _cv.notify_all();
+
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_S3, "Parallel listing of {}: {} keys and {} shards found under '{}'", _url, keys, _shards.size(), _prefix);
+  }
+  catch(...) {
+    fail(std::current_exception());
+  }
+}
+
+bool S3ParallelListing::listPages(size_t index, const std::string & prefix) {
+  std::string marker;
+  bool more = true;
+  while(more) {
+    std::deque<FileProperties> page;
+    more = fetchPage(prefix, false, marker, page);
+
+    std::unique_lock<std::mutex> lock(_mtx);
+    if(!push(lock, index, page)) {
+      return false;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(_mtx);
+  _shards[index].done = true;
+  _cv.notify_all();
+  return true;
+}
+
+void S3ParallelListing::listShard(size_t index) {
+  try {
+    std::string prefix;
+    {
+      std::lock_guard<std::mutex> lock(_mtx);
+      // listed already by a thread which could not wait for this one
+      if(_cancelled || _shards[index].started) {
+        return;
+      }
+      _shards[index].started = true;
+      prefix = _shards[index].prefix;
+      _cv.notify_all();
+    }
+
+    listPages(index, prefix);
+  }
+  catch(...) {
+    fail(std::current_exception());
+  }
+}
+
+bool S3ParallelListing::next(std::string & name, StatInfo & info) {
+  std::unique_lock<std::mutex> lock(_mtx);
+  if(!_started) {
+    _started = true;
+    _pool.add([this]{ discover(); });
+  }
+
+  while(true) {
+    if(_error) {
+      std::rethrow_exception(_error);
+    }
+
+    // skip the exhausted shards
+    while(_current < _shards.size() && _shards[_current].done && _shards[_current].entries.empty()) {
+      _current++;
+      _cv.notify_all();
+    }
+
+    Shard* shard = NULL;
+    if(_ordered) {
+      if(_current < _shards.size() && !_shards[_current].entries.empty()) {
+        shard = &_shards[_current];
+      }
+    }
+    else {
+      for(size_t i = _current; i < _shards.size() && shard == NULL; i++) {
+        if(!_shards[i].entries.empty()) {
+          shard = &_shards[i];
+        }
+      }
+    }
+
+    if(shard != NULL) {
+      FileProperties & front = shard->entries.front();
+      name.swap(front.filename);
+      info = front.info;
+      shard->entries.pop_front();
+      _cv.notify_all();
+      return true;
+    }
+
+    if(_discovered && _current >= _shards.size()) {
+      return false;
+    }
+    _cv.wait(lock);
+  }
+}
+
+}
@@ -0,0 +1,120 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_S3_PARALLEL_LISTING_HPP
+#define DAVIX_S3_PARALLEL_LISTING_HPP
+
+#include <davix_internal.hpp>
+#include <fileops/TaskPool.hpp>
+#include <utils/davix_fileproperties.hpp>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <vector>
+
+namespace Davix{
+
+//------------------------------------------------------------------------------
+// Recursive listing of the keys of a S3 bucket under a path, split in shards
+// listed concurrently.
+//
+// A delimited listing of the path discovers its common prefixes: each of them
+// is a shard, listed recursively page by page by the background tasks, while
+// the keys directly under the path form shards of their own. Shards cover
+// disjoint key ranges, so returning them one after the other keeps the keys
+// in order; unordered listings return any available entry instead.
+//
+// Each shard buffers a bounded number of entries ahead of the caller.
+//------------------------------------------------------------------------------
+class S3ParallelListing : NonCopyable {
+public:
+  S3ParallelListing(Context & context, const RequestParams & params, const Uri & url);
+
+  //----------------------------------------------------------------------------
+  // Stops the background listings
+  //----------------------------------------------------------------------------
+  ~S3ParallelListing();
+
+  //----------------------------------------------------------------------------
+  // Next entry of the listing, false at the end. Rethrows the error of a
+  // failed shard.
+  //----------------------------------------------------------------------------
+  bool next(std::string & name, StatInfo & info);
+
+private:
+  struct Shard {
+    Shard() : started(false), done(false) {}
+
+    std::string prefix; // empty for the keys found by the discovery
+    std::deque<FileProperties> entries;
+    bool started;
+    bool done;
+  };
+
+  void discover();
+  void listShard(size_t index);
+
+  //----------------------------------------------------------------------------
+  // List all the pages of a started shard, returns false once cancelled
+  //----------------------------------------------------------------------------
+  bool listPages(size_t index, const std::string & prefix);
+
+  //----------------------------------------------------------------------------
+  // Fetch a page of the listing of prefix, returns true if there are more
+  //----------------------------------------------------------------------------
+  bool fetchPage(const std::string & prefix, bool delimiter, std::string & marker,
+                 std::deque<FileProperties> & entries);
+
+  //----------------------------------------------------------------------------
+  // Append entries to a shard, waits while it is full. When waiting could
+  // block the caller, the shard it waits for is listed first from this
+  // thread. Returns false once cancelled.
+  //----------------------------------------------------------------------------
+  bool push(std::unique_lock<std::mutex> & lock, size_t index, std::deque<FileProperties> & entries);
+  bool mayWait(size_t index) const;
+  size_t firstPending(size_t index) const;
+
+  size_t addShard(const std::string & prefix);
+  void fail(const std::exception_ptr & error);
+
+  Context & _context;
+  RequestParams _params;
+  Uri _url;
+  std::string _bucket;
+  std::string _prefix;
+  bool _ordered;
+  size_t _maxBuffered;
+
+  std::mutex _mtx;
+  std::condition_variable _cv;
+  std::vector<Shard> _shards;
+  size_t _current;
+  bool _started;
+  bool _discovered;
+  bool _cancelled;
+  std::exception_ptr _error;
+
+  TaskPool _pool;
+};
+
+}
+
+#endif // DAVIX_S3_PARALLEL_LISTING_HPP
@@ -23,6 +23,9 @@
 #include <core/ContentProvider.hpp>
 #include <utils/davix_logger_internal.hpp>
 #include <utils/davix_swift_utils.hpp>
+#include <fileops/PartUploader.hpp>
+#include <fileops/UploadJournal.hpp>
+#include <set>
 
 
 namespace Davix{
@@ -35,7 +38,7 @@ static bool is_swift_operation(IOChainContext & context){
     return false;
 }
 
-static bool should_use_swift_multipart(IOChainContext & context, dav_size_t size) {
+static bool should_use_swift_multipart(IOChainContext & context, dav_ssize_t size) {
     bool is_swift = is_swift_operation(context);
 
     if (!is_swift) return false;
@@ -45,7 +48,10 @@ static bool should_use_swift_multipart(IOChainContext & context, dav_size_t size
         return true;
     }
 
-    return size > (1024 * 1024 * 512); // 512 MB
+    // size not known in advance: stream it segment by segment
+    if(size < 0) return true;
+
+    return (dav_size_t) size > context._reqparams->getMultipartThreshold();
 }
 
 SwiftIO::SwiftIO() {
@@ -56,34 +62,6 @@ SwiftIO::~SwiftIO() {
 
 }
 
-static dav_size_t fillBufferWithProviderData(std::vector<char> &buffer, const dav_size_t maxChunkSize, ContentProvider &provider) {
-    dav_size_t written = 0u;
-    dav_size_t remaining = maxChunkSize;
-
-    while(true) {
-        dav_ssize_t bytesRead = provider.pullBytes(buffer.data(), remaining);
-        if(bytesRead < 0) {
-            throw DavixException(davix_scope_io_buff(), StatusCode::InvalidFileHandle, fmt::format("Error when reading from callback: {}", bytesRead));
-        }
-
-        remaining -= bytesRead;
-        written += bytesRead;
-
-        if(bytesRead == 0) {
-            DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Reached data provider EOF, received 0 bytes, even though asked for {}", remaining);
-            break; // EOF
-        }
-
-        if(remaining == 0) {
-            DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Data provider buffer has been filled");
-            break; // buffer is full
-        }
-    }
-
-    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Retrieved {} bytes from data provider", written);
-    return written;
-}
-
 std::string SwiftIO::writeChunk(IOChainContext &iocontext, const char *buff, dav_size_t size, int partNumber) {
     Uri url(iocontext._uri);
     url.setPath(url.getPath() + "/" + std::to_string(partNumber));
@@ -108,20 +86,24 @@ std::string SwiftIO::writeChunk(IOChainContext &iocontext, const char *buff, dav
     if(!req.getAnswerHeader("Etag", etag)) {
         DavixError::setupError(&tmp_err, "Swift::MultiPart", StatusCode::InvalidServerResponse, "Unable to retrieve chunk Etag, necessary when committing chunks");
     }
+    checkDavixError(&tmp_err);
+
+    // the etag of a segment is the MD5 sum of its content
+    if(iocontext._reqparams->getVerifySegmentChecksums() && !UploadJournal::partMatches(buff, size, etag, size)) {
+        throw DavixException("Swift::MultiPart", StatusCode::InvalidServerResponse, fmt::format("Checksum mismatch for chunk #{}, server returned etag {}", partNumber, etag));
+    }
 
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "chunk #{} written successfully, etag: {}", partNumber, etag);
     return etag;
 }
 
 void SwiftIO::commitInlineChunks(IOChainContext & iocontext, const std::vector<Prop> &props, const size_t MaxManifestSegments){
-    Uri url(iocontext._uri);
-
     size_t iterNum = 0;
     size_t propBegin = 1;
     size_t propEnd = MaxManifestSegments;
 
     std::string lastEtag;
-    std::string path = url.getPath();
+    const std::string path = iocontext._uri.getPath();
 
     while(propBegin <= propEnd){
         // generate a multipart manifest in json
@@ -148,6 +130,7 @@ void SwiftIO::commitInlineChunks(IOChainContext & iocontext, const std::vector<P
 
         // upload the manifest
         DavixError * tmp_err=NULL;
+        Uri url(iocontext._uri);
         if(propBegin <= propEnd) {
             url.setPath(path + "-" + std::to_string(iterNum));
         } else{
@@ -215,35 +198,164 @@ dav_ssize_t SwiftIO::writeFromProvider(IOChainContext & iocontext, ContentProvid
         CHAIN_FORWARD(writeFromProvider(iocontext, provider));
     }
 
+    const dav_size_t MAX_SEGMENT_SIZE = 5ULL * 1024 * 1024 * 1024; // 5 GB
+    const size_t MAX_MANIFEST_SEGMENTS = 1000;
+
+    // size segments so that a single manifest is enough, unless configured otherwise
+    dav_size_t partSize = computeUploadPartSize(*iocontext._reqparams, provider.getSize(), 1, MAX_SEGMENT_SIZE, MAX_MANIFEST_SEGMENTS);
+
+    // resume the upload left unfinished by a previous attempt: Swift has no
+    // upload id, the segments recorded by the journal are skipped when the
+    // server still has them with an etag matching the local data
+    UploadJournal journal(iocontext._reqparams->getUploadJournalDir(), iocontext._uri, provider.getSourceFingerprint());
+    std::map<size_t, std::string> storedSegments;
+    const bool resuming = journal.load() && journal.getObjectSize() == provider.getSize();
+    if(resuming) {
+        storedSegments = journal.getParts();
+        partSize = journal.getPartSize();
+        DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_CHAIN, "Resuming large file upload towards {}, {} segments already stored", iocontext._uri, storedSegments.size());
+    }
+
+    // segments are read from the provider while the previous ones are being sent
+    PartUploader uploader([this, &iocontext, &journal](const char* data, dav_size_t size, size_t partNumber) {
+        std::string etag = writeChunk(iocontext, data, size, partNumber);
+        journal.addPart(partNumber, etag);
+        return etag;
+    }, partSize, iocontext._reqparams->getUploadConcurrency());
+    if(provider.getSize() < 0) {
+        uploader.growPartSize(MAX_SEGMENT_SIZE, MAX_MANIFEST_SEGMENTS);
+    }
+
+    PartReader reader(provider, uploader);
+
+    // Streams of unknown size which fit in a single segment don't need a
+    // manifest, send them with a simple PUT
+    dav_size_t bytesRead = reader.next();
+    if(!resuming && provider.getSize() < 0 && bytesRead < reader.partSize() && !iocontext._uri.fragmentParamExists("forceMultiPart")) {
+        DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Stream towards {} ended after {} bytes, using a single PUT", iocontext._uri, bytesRead);
+        BufferContentProvider single(reader.data(), bytesRead);
+        CHAIN_FORWARD(writeFromProvider(iocontext, single));
+    }
+
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Initiating large file upload towards {} to upload file with size {}", iocontext._uri, provider.getSize());
+    journal.start(iocontext._uri.getPath(), partSize, provider.getSize(), storedSegments);
 
-    size_t remaining = provider.getSize();
-    const dav_size_t MAX_CHUNK_SIZE = 1024 * 1024 * 256; // 256 MB
-    const size_t MAX_MANIFEST_SEGMENTS = 1000;
+    std::vector<dav_size_t> sizes;
+    dav_size_t total = 0;
 
-    std::vector<char> buffer;
-    buffer.resize(std::min(MAX_CHUNK_SIZE, (dav_size_t) provider.getSize()) + 10);
+    size_t partNumber = 0;
+
+    while(bytesRead > 0 || partNumber == 0) {
+        partNumber++;
+
+        std::string storedEtag;
+        if(storedSegments.count(partNumber) > 0 && storedSegmentMatches(iocontext, partNumber, reader.data(), bytesRead, storedEtag)) {
+            DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Segment #{} already uploaded, skipping it", partNumber);
+            uploader.addCompleted(partNumber, storedEtag);
+            journal.addPart(partNumber, storedEtag);
+        }
+        else {
+            reader.submit(partNumber);
+        }
+        sizes.push_back(bytesRead);
+        total += bytesRead;
+
+        if(bytesRead < reader.partSize()) break; // EOF
+        if(provider.getSize() >= 0 && total >= (dav_size_t) provider.getSize()) break; // all data sent
+        bytesRead = reader.next();
+    }
 
+    // the manifest needs the etags of all the segments
+    std::vector<std::string> etags = uploader.finish();
     std::vector<Prop> props;
+    props.reserve(etags.size());
+    for(size_t i = 0; i < etags.size(); i++) {
+        props.emplace_back(etags[i], sizes[i]);
+    }
 
-    size_t partNumber = 0;
+    try {
+        if(props.size() > MAX_MANIFEST_SEGMENTS){ // if segment number is larger than max_manifest_segments (by default 1000), use inline segments
+            commitInlineChunks(iocontext, props, MAX_MANIFEST_SEGMENTS);
+        } else{
+            commitChunks(iocontext, props);
+        }
+    }
+    catch(DavixException &e) {
+        // a segment recorded by the journal may be missing on the server,
+        // do not resume from it again
+        journal.remove();
+        throw;
+    }
 
-    while(remaining > 0) {
-        size_t toRead = std::min( (dav_size_t) provider.getSize(), MAX_CHUNK_SIZE);
-        DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "SwiftIO write: toRead from cb {}", toRead);
+    journal.remove();
+    return total;
+}
 
-        dav_size_t bytesRead = fillBufferWithProviderData(buffer, MAX_CHUNK_SIZE, provider);
-        if(bytesRead == 0) break; // EOF
+bool SwiftIO::storedSegmentMatches(IOChainContext & iocontext, size_t partNumber, const char* data, dav_size_t size, std::string & etag) {
+    Uri url(iocontext._uri);
+    url.setPath(url.getPath() + "/" + std::to_string(partNumber));
 
-        partNumber++;
-        props.emplace_back(writeChunk(iocontext, buffer.data(), bytesRead, partNumber), bytesRead);
+    DavixError * tmp_err=NULL;
+    HeadRequest req(iocontext._context, url, &tmp_err);
+    checkDavixError(&tmp_err);
+
+    req.setParameters(iocontext._reqparams);
+    req.executeRequest(&tmp_err);
+    if(tmp_err || httpcodeIsValid(req.getRequestCode()) == false || !req.getAnswerHeader("Etag", etag)) {
+        DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Segment #{} recorded by the journal is not on the server", partNumber);
+        DavixError::clearError(&tmp_err);
+        return false;
+    }
+
+    const dav_ssize_t storedSize = req.getAnswerSize();
+    return storedSize >= 0 && UploadJournal::partMatches(data, size, etag, storedSize);
+}
+
+size_t SwiftIO::abortPendingUploads(IOChainContext & iocontext) {
+    const std::string &journalDir = iocontext._reqparams->getUploadJournalDir();
+    const std::vector<std::string> sources = UploadJournal::findSources(journalDir, iocontext._uri);
+
+    // segments of all the journals, they are named after the destination only
+    std::set<size_t> segments;
+    for(std::vector<std::string>::const_iterator it = sources.begin(); it != sources.end(); it++) {
+        UploadJournal journal(journalDir, iocontext._uri, *it);
+        if(journal.load()) {
+            for(std::map<size_t, std::string>::const_iterator part = journal.getParts().begin(); part != journal.getParts().end(); part++) {
+                segments.insert(part->first);
+            }
+        }
+    }
+
+    // delete the segments stored so far
+    size_t deleted = 0;
+    for(std::set<size_t>::const_iterator it = segments.begin(); it != segments.end(); it++) {
+        Uri url(iocontext._uri);
+        url.setPath(url.getPath() + "/" + std::to_string(*it));
+
+        DavixError * tmp_err=NULL;
+        DeleteRequest req(iocontext._context, url, &tmp_err);
+        checkDavixError(&tmp_err);
+
+        req.setParameters(iocontext._reqparams);
+        req.executeRequest(&tmp_err);
+        if(req.getRequestCode() == 404){
+            // already gone
+            DavixError::clearError(&tmp_err);
+            continue;
+        }
+        if(!tmp_err && httpcodeIsValid(req.getRequestCode()) == false){
+            httpcodeToDavixError(req.getRequestCode(), davix_scope_io_buff(),
+                                 "delete segment error: ", &tmp_err);
+        }
+        checkDavixError(&tmp_err);
+        deleted++;
     }
 
-    if(props.size() > MAX_MANIFEST_SEGMENTS){ // if segment number is larger than max_manifest_segments (by default 1000), use inline segments
-        commitInlineChunks(iocontext, props, MAX_MANIFEST_SEGMENTS);
-    } else{
-        commitChunks(iocontext, props);
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Deleted {} segments of the unfinished uploads towards {}", deleted, iocontext._uri);
+    for(std::vector<std::string>::const_iterator it = sources.begin(); it != sources.end(); it++) {
+        UploadJournal(journalDir, iocontext._uri, *it).remove();
     }
+    return deleted;
 }
 
 }
@@ -26,7 +26,7 @@
 
 namespace Davix{
 
-typedef std::pair <std::string, int> Prop;
+typedef std::pair <std::string, dav_size_t> Prop;
 
 class SwiftIO : public HttpIOChain {
 public:
@@ -36,12 +36,20 @@ public:
     // write from content provider
     virtual dav_ssize_t writeFromProvider(IOChainContext & iocontext, ContentProvider &provider);
 
+    // Delete the segments of the unfinished uploads recorded by the local journals,
+    // returns the number of segments deleted
+    size_t abortPendingUploads(IOChainContext & iocontext);
+
 private:
 
     // Write the given chunk. Return object properties (etag + size_bytes),
     // necessary to commit upload.
     std::string writeChunk(IOChainContext & iocontext, const char* buff, dav_size_t size, int partNumber);
 
+    // Check that the segment partNumber stored on the server holds the given
+    // data, fill its etag if so
+    bool storedSegmentMatches(IOChainContext & iocontext, size_t partNumber, const char* data, dav_size_t size, std::string & etag);
+
 
     // Given the properties (etag + size_bytes) of the segments, commit chunks
     void commitChunks(IOChainContext & iocontext, const std::vector<Prop> &props);
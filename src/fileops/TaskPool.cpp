@@ -0,0 +1,117 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "TaskPool.hpp"
+
+namespace Davix{
+
+TaskPool::TaskPool(size_t maxThreads)
+: _maxThreads(std::max<size_t>(1, maxThreads)), _running(0), _closed(false) {
+
+}
+
+TaskPool::~TaskPool() {
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _queue.clear();
+  }
+  stop();
+}
+
+void TaskPool::add(const Task &task) {
+  std::lock_guard<std::mutex> lock(_mtx);
+  if(_error) {
+    return;
+  }
+
+  _queue.push_back(task);
+
+  // start a new worker only when all the existing ones are busy
+  if(_workers.size() < _maxThreads && _running + _queue.size() > _workers.size()) {
+    _workers.emplace_back(&TaskPool::worker, this);
+  }
+  _cv.notify_all();
+}
+
+void TaskPool::wait() {
+  {
+    std::unique_lock<std::mutex> lock(_mtx);
+    _cv.wait(lock, [this]{ return _queue.empty() && _running == 0; });
+  }
+  stop();
+
+  if(_error) {
+    std::rethrow_exception(_error);
+  }
+}
+
+void TaskPool::stop() {
+  {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _closed = true;
+    _cv.notify_all();
+  }
+
+  for(size_t i = 0; i < _workers.size(); i++) {
+    if(_workers[i].joinable()) {
+      _workers[i].join();
+    }
+  }
+  _workers.clear();
+
+  std::lock_guard<std::mutex> lock(_mtx);
+  _closed = false;
+}
+
+void TaskPool::worker() {
+  std::unique_lock<std::mutex> lock(_mtx);
+
+  while(true) {
+    _cv.wait(lock, [this]{ return _closed || !_queue.empty(); });
+    if(_queue.empty()) {
+      return;
+    }
+
+    Task task(std::move(_queue.front()));
+    _queue.pop_front();
+    _running++;
+    lock.unlock();
+
+    std::exception_ptr error;
+    try {
+      task();
+    }
+    catch(...) {
+      error = std::current_exception();
+    }
+
+    lock.lock();
+    _running--;
+    if(error) {
+      if(!_error) {
+        _error = error;
+      }
+      _queue.clear();
+    }
+    _cv.notify_all();
+  }
+}
+
+}
@@ -0,0 +1,81 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_TASK_POOL_HPP
+#define DAVIX_TASK_POOL_HPP
+
+#include <davix_internal.hpp>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Davix{
+
+//------------------------------------------------------------------------------
+// Runs independent tasks, e.g. metadata requests, on at most maxThreads
+// background threads. Threads are started on demand, when all the existing
+// ones are busy. A running task may add more tasks to the pool.
+//------------------------------------------------------------------------------
+class TaskPool : NonCopyable {
+public:
+  typedef std::function<void ()> Task;
+
+  TaskPool(size_t maxThreads);
+
+  //----------------------------------------------------------------------------
+  // Drops the tasks not yet started and waits for the running ones
+  //----------------------------------------------------------------------------
+  ~TaskPool();
+
+  //----------------------------------------------------------------------------
+  // Queue a task
+  //----------------------------------------------------------------------------
+  void add(const Task &task);
+
+  //----------------------------------------------------------------------------
+  // Wait until all the tasks, including the ones they added, are done.
+  // Rethrows the exception of the first failed task, the tasks not yet
+  // started at that point are dropped.
+  //----------------------------------------------------------------------------
+  void wait();
+
+private:
+  void worker();
+  void stop();
+
+  size_t _maxThreads;
+
+  std::mutex _mtx;
+  std::condition_variable _cv;
+  std::deque<Task> _queue;
+  size_t _running;
+  bool _closed;
+  std::exception_ptr _error;
+
+  std::vector<std::thread> _workers;
+};
+
+}
+
+#endif // DAVIX_TASK_POOL_HPP
@@ -0,0 +1,231 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "UploadJournal.hpp"
+#include <utils/davix_logger_internal.hpp>
+#include <utils/stringutils.hpp>
+#include <utils/davix_s3_utils.hpp>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <dirent.h>
+#include <openssl/md5.h>
+
+namespace Davix{
+
+static const std::string journalMagic("davix-upload-journal 2");
+static const std::string journalPrefix("davix-upload-");
+static const std::string journalSuffix(".journal");
+
+static std::string md5Hex(const std::string &str) {
+  unsigned char md[MD5_DIGEST_LENGTH];
+  MD5(reinterpret_cast<const unsigned char*>(str.c_str()), str.size(), md);
+  return S3::hexPrinter(md, MD5_DIGEST_LENGTH);
+}
+
+// journals of the uploads towards url start with this name
+static std::string journalNamePrefix(const std::string &url) {
+  return journalPrefix + md5Hex(url) + "-";
+}
+
+UploadJournal::UploadJournal(const std::string &dir, const Uri &uri, const std::string &source)
+: _url(uri.getString()), _source(source), _partSize(0), _objectSize(-1) {
+  if(!dir.empty() && !source.empty()) {
+    _path = dir + "/" + journalNamePrefix(_url) + md5Hex(_source) + journalSuffix;
+  }
+}
+
+std::vector<std::string> UploadJournal::findSources(const std::string &dir, const Uri &uri) {
+  std::vector<std::string> sources;
+  if(dir.empty()) {
+    return sources;
+  }
+
+  DIR* d = ::opendir(dir.c_str());
+  if(d == NULL) {
+    return sources;
+  }
+
+  const std::string prefix = journalNamePrefix(uri.getString());
+  struct dirent* entry;
+  while((entry = ::readdir(d)) != NULL) {
+    const std::string name(entry->d_name);
+    if(name.compare(0, prefix.size(), prefix) != 0 || name.size() < journalSuffix.size() ||
+       name.compare(name.size() - journalSuffix.size(), journalSuffix.size(), journalSuffix) != 0) {
+      continue;
+    }
+
+    std::ifstream in((dir + "/" + name).c_str());
+    std::string line;
+    while(std::getline(in, line)) {
+      if(line.compare(0, 7, "source ") == 0) {
+        sources.push_back(line.substr(7));
+        break;
+      }
+    }
+  }
+  ::closedir(d);
+  return sources;
+}
+
+bool UploadJournal::load() {
+  if(!enabled()) {
+    return false;
+  }
+
+  std::ifstream in(_path.c_str());
+  if(!in) {
+    return false;
+  }
+
+  std::string line;
+  if(!std::getline(in, line) || line != journalMagic) {
+    DAVIX_SLOG(DAVIX_LOG_WARNING, DAVIX_LOG_CHAIN, "Ignoring invalid upload journal {}", _path);
+    return false;
+  }
+
+  std::string url, source, uploadId;
+  bool hasSource = false;
+  dav_size_t partSize = 0;
+  dav_ssize_t objectSize = -1;
+  std::map<size_t, std::string> parts;
+
+  while(std::getline(in, line)) {
+    std::istringstream ss(line);
+    std::string key;
+    ss >> key;
+
+    if(key == "url") {
+      ss >> url;
+    }
+    else if(key == "source") {
+      // may be empty
+      source = line.substr(std::min(line.size(), key.size() + 1));
+      hasSource = true;
+    }
+    else if(key == "upload-id") {
+      ss >> uploadId;
+    }
+    else if(key == "part-size") {
+      ss >> partSize;
+    }
+    else if(key == "object-size") {
+      ss >> objectSize;
+    }
+    else if(key == "part") {
+      size_t partNumber = 0;
+      std::string etag;
+      // a line truncated by a crash is ignored
+      if(ss >> partNumber >> etag) {
+        parts[partNumber] = etag;
+      }
+    }
+  }
+
+  // the file name is a hash, make sure it is about the same object and source
+  if(url != _url || !hasSource || source != _source || uploadId.empty() || partSize == 0) {
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Upload journal {} does not match {}", _path, _url);
+    return false;
+  }
+
+  _uploadId = uploadId;
+  _partSize = partSize;
+  _objectSize = objectSize;
+  _parts.swap(parts);
+
+  DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, "Loaded upload journal {}: upload id {}, {} parts completed", _path, _uploadId, _parts.size());
+  return true;
+}
+
+void UploadJournal::start(const std::string &uploadId, dav_size_t partSize, dav_ssize_t objectSize,
+                          const std::map<size_t, std::string> &completed) {
+  if(!enabled()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(_mtx);
+  _uploadId = uploadId;
+  _partSize = partSize;
+  _objectSize = objectSize;
+  _parts = completed;
+
+  std::ofstream out(_path.c_str(), std::ios::trunc);
+  out << journalMagic << "\n";
+  out << "url " << _url << "\n";
+  out << "source " << _source << "\n";
+  out << "upload-id " << _uploadId << "\n";
+  out << "part-size " << _partSize << "\n";
+  out << "object-size " << _objectSize << "\n";
+  for(std::map<size_t, std::string>::const_iterator it = _parts.begin(); it != _parts.end(); it++) {
+    out << "part " << it->first << " " << it->second << "\n";
+  }
+  out.flush();
+
+  if(!out) {
+    throw DavixException(davix_scope_io_buff(), StatusCode::SystemError, fmt::format("Unable to write upload journal {}", _path));
+  }
+}
+
+void UploadJournal::addPart(size_t partNumber, const std::string &etag) {
+  if(!enabled()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(_mtx);
+  _parts[partNumber] = etag;
+
+  std::ofstream out(_path.c_str(), std::ios::app);
+  out << "part " << partNumber << " " << etag << "\n";
+  out.flush();
+
+  if(!out) {
+    throw DavixException(davix_scope_io_buff(), StatusCode::SystemError, fmt::format("Unable to write upload journal {}", _path));
+  }
+}
+
+bool UploadJournal::partMatches(const char* data, dav_size_t size, const std::string &etag, dav_size_t storedSize) {
+  if(size != storedSize) {
+    return false;
+  }
+
+  std::string digest(etag);
+  digest.erase(std::remove(digest.begin(), digest.end(), '"'), digest.end());
+  if(digest.size() != 2 * MD5_DIGEST_LENGTH || digest.find_first_not_of("0123456789abcdefABCDEF") != std::string::npos) {
+    return false; // not a MD5 sum, e.g. encrypted object, can't be verified
+  }
+
+  unsigned char md[MD5_DIGEST_LENGTH];
+  MD5(reinterpret_cast<const unsigned char*>(data), size, md);
+  return StrUtil::compare_ncase(S3::hexPrinter(md, MD5_DIGEST_LENGTH), digest) == 0;
+}
+
+void UploadJournal::remove() {
+  if(!enabled()) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(_mtx);
+  ::unlink(_path.c_str());
+  _parts.clear();
+  _uploadId.clear();
+}
+
+}
@@ -0,0 +1,107 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_UPLOAD_JOURNAL_HPP
+#define DAVIX_UPLOAD_JOURNAL_HPP
+
+#include <davix_internal.hpp>
+#include <map>
+#include <mutex>
+#include <vector>
+
+namespace Davix{
+
+//------------------------------------------------------------------------------
+// Local record of the progress of a multi-part upload, so that an upload
+// interrupted by an error can be resumed instead of started from scratch.
+//
+// The journal is a small text file named after digests of the destination URL
+// and of the fingerprint of the source, kept in the directory given by
+// RequestParams::setUploadJournalDir. It holds the upload id, the part size,
+// the object size and one line per completed part; it is removed once the
+// upload is committed or aborted.
+//------------------------------------------------------------------------------
+class UploadJournal : NonCopyable {
+public:
+  //----------------------------------------------------------------------------
+  // Journal of the upload towards uri of the contents identified by source,
+  // see ContentProvider::getSourceFingerprint. Disabled if dir is empty, or if
+  // source is: contents which can't be identified are never resumed.
+  //----------------------------------------------------------------------------
+  UploadJournal(const std::string &dir, const Uri &uri, const std::string &source);
+
+  //----------------------------------------------------------------------------
+  // Sources of the journals left in dir by the uploads towards uri
+  //----------------------------------------------------------------------------
+  static std::vector<std::string> findSources(const std::string &dir, const Uri &uri);
+
+  bool enabled() const { return !_path.empty(); }
+
+  //----------------------------------------------------------------------------
+  // Load the state left by a previous attempt, false if there is none
+  //----------------------------------------------------------------------------
+  bool load();
+
+  //----------------------------------------------------------------------------
+  // Start a new journal, keeping the parts already known as completed
+  //----------------------------------------------------------------------------
+  void start(const std::string &uploadId, dav_size_t partSize, dav_ssize_t objectSize,
+             const std::map<size_t, std::string> &completed = std::map<size_t, std::string>());
+
+  //----------------------------------------------------------------------------
+  // Record a completed part, may be called concurrently. Throws if the
+  // journal can't be written.
+  //----------------------------------------------------------------------------
+  void addPart(size_t partNumber, const std::string &etag);
+
+  //----------------------------------------------------------------------------
+  // Remove the journal
+  //----------------------------------------------------------------------------
+  void remove();
+
+  //----------------------------------------------------------------------------
+  // Check that data is the content of a part stored with the given etag and
+  // size. Etags which are not a plain MD5 sum can't be verified and never
+  // match.
+  //----------------------------------------------------------------------------
+  static bool partMatches(const char* data, dav_size_t size, const std::string &etag, dav_size_t storedSize);
+
+  const std::string & getPath() const { return _path; }
+  const std::string & getUploadId() const { return _uploadId; }
+  dav_size_t getPartSize() const { return _partSize; }
+  dav_ssize_t getObjectSize() const { return _objectSize; }
+  const std::map<size_t, std::string> & getParts() const { return _parts; }
+
+private:
+  std::string _path;
+  std::string _url;
+  std::string _source;
+
+  std::string _uploadId;
+  dav_size_t _partSize;
+  dav_ssize_t _objectSize;
+  std::map<size_t, std::string> _parts;
+
+  std::mutex _mtx;
+};
+
+}
+
+#endif // DAVIX_UPLOAD_JOURNAL_HPP
@@ -25,6 +25,7 @@
 #include "httpiovec.hpp"
 #include "davix_reliability_ops.hpp"
 #include "iobuffmap.hpp"
+#include "MetadataCacheOps.hpp"
 #include "AzureIO.hpp"
 #include "S3IO.hpp"
 #include "SwiftIO.hpp"
@@ -37,7 +38,7 @@ ChainFactory::ChainFactory(){}
 
 HttpIOChain& ChainFactory::instanceChain(const CreationFlags & flags, HttpIOChain & c){
     HttpIOChain* elem;
-    elem= c.add(new MetalinkOps())->add(new AutoRetryOps())->add(new S3MetaOps())->add(new SwiftMetaOps())->add(new AzureMetaOps())->add(new HttpMetaOps());
+    elem= c.add(new MetadataCacheOps())->add(new MetalinkOps())->add(new AutoRetryOps())->add(new S3MetaOps())->add(new SwiftMetaOps())->add(new AzureMetaOps())->add(new HttpMetaOps());
 
     // add posix to the chain if needed
     if(flags[CHAIN_POSIX] == true){
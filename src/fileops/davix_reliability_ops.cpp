@@ -71,6 +71,8 @@ ReturnType metalinkTryReplicas(HttpIOChain & chain, IOChainContext & io_context,
     for(std::vector<File>::iterator it = replicas.begin();it != replicas.end(); ++it){
         IOChainContext internal_context(io_context._context, it->getUri(), io_context._reqparams);
         internal_context.fdHandler = io_context.fdHandler;
+        internal_context._stats = io_context._stats;
+        internal_context._checksum = io_context._checksum;
 
         try{
             return fun(internal_context);
@@ -322,6 +324,7 @@ ReturnType autoRetryExecutor(HttpIOChain & chain, IOChainContext & io_context, E
             throw DavixException(davix_scope_io_buff(), StatusCode::UnknowError, fmt::format("Unrecoverable error from IOChain on {}", u));
         }
         ++retry;
+        IOCHAIN_STAT_ADD(io_context, retries, 1);
         sleep(retry_delay);
     }
 }
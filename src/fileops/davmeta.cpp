@@ -39,6 +39,8 @@
 
 #include <request/httprequest.hpp>
 #include <fileops/fileutils.hpp>
+#include <fileops/S3PagedListing.hpp>
+#include <fileops/S3ParallelListing.hpp>
 #include <utils/stringutils.hpp>
 #include "libs/alibxx/crypto/base64.hpp"
 #include <neon/neonrequest.hpp>
@@ -48,26 +50,49 @@ using namespace StrUtil;
 
 namespace Davix{
 
-static const std::string stat_listing("<?xml version=\"1.0\" encoding=\"utf-8\" ?><D:propfind xmlns:D=\"DAV:\" xmlns:L=\"LCGDM:\"><D:prop>"
-                                      "<D:displayname/><D:getlastmodified/><D:creationdate/><D:getcontentlength/><D:quota-used-bytes/>"
-                                      "<D:resourcetype><D:collection/></D:resourcetype><L:mode/>"
-                                      "<D:owner></D:owner><D:group></D:group>"
-                                      "</D:prop>"
-                                      "</D:propfind>");
-
 static const std::string quota_stat("<?xml version=\"1.0\" encoding=\"utf-8\" ?><D:propfind xmlns:D=\"DAV:\" xmlns:L=\"LCGDM:\"><D:prop>"
                                       "<D:quota-used-bytes/><D:quota-available-bytes/>"
                                       "</D:prop>"
                                       "</D:propfind>");
 
+// properties of a PROPFIND request, in request order
+static const struct {
+    unsigned int property;
+    const char* elements;
+} propfind_properties[] = {
+    { StatProperty::Mtime, "<D:getlastmodified/>" },
+    { StatProperty::Ctime, "<D:creationdate/>" },
+    { StatProperty::Size,  "<D:getcontentlength/><D:quota-used-bytes/>" },
+    { StatProperty::Type,  "<D:resourcetype><D:collection/></D:resourcetype>" },
+    { StatProperty::Mode,  "<L:mode/>" },
+    { StatProperty::Owner, "<D:owner/><D:group/>" },
+};
+
+std::string webdav_propfind_body(unsigned int properties){
+    std::string body("<?xml version=\"1.0\" encoding=\"utf-8\" ?><D:propfind xmlns:D=\"DAV:\" xmlns:L=\"LCGDM:\"><D:prop>");
+    for(size_t i = 0; i < sizeof(propfind_properties) / sizeof(propfind_properties[0]); ++i){
+        if(properties & propfind_properties[i].property){
+            body += propfind_properties[i].elements;
+        }
+    }
+    body += "</D:prop></D:propfind>";
+    return body;
+}
+
+// properties parsed and asked for, the type is always needed to tell collections apart
+static unsigned int webdav_stat_properties(const RequestParams* params){
+    return params->getStatProperties() | StatProperty::Type;
+}
+
 struct DirHandle{
 
-    DirHandle(HttpRequest* req, XMLPropParser * p): request(req), parser(p){}
+    DirHandle(HttpRequest* req, XMLPropParser * p): request(req), parser(p), buffer(DAVIX_LISTING_BLOCK_SIZE){}
 
     std::unique_ptr<HttpRequest> request;
     std::unique_ptr<Davix::XMLPropParser> parser;
 
-
+    // response block, reused by every read of the listing
+    std::vector<char> buffer;
 };
 
 /**
@@ -92,12 +117,13 @@ std::vector<char> req_webdav_propfind(HttpRequest* req, DavixError** err){
 int dav_stat_mapper_webdav(Context &context, const RequestParams* params, const Uri & url, struct StatInfo& st_info){
     int ret =-1;
 
-    DavPropXMLParser parser;
+    DavPropXMLParser parser(webdav_stat_properties(params));
     DavixError * tmp_err=NULL;
     HttpRequest req(context, url, &tmp_err);
 
     if( tmp_err == NULL){
         req.setParameters(params);
+        req.setRequestBody(webdav_propfind_body(webdav_stat_properties(params)));
 
         TRY_DAVIX{
             std::vector<char> body = req_webdav_propfind(&req, &tmp_err);
@@ -187,22 +213,47 @@ int dav_stat_mapper_http_get(Context& context, const RequestParams* params, cons
 }
 
 
-dav_ssize_t incremental_listdir_parsing(HttpRequest* req, XMLPropParser * parser, dav_size_t s_buff, const std::string & scope){
+//
+// Read and parse the next block of a listing response. Blocks are taken as
+// they arrive, an entry is available as soon as its closing element is
+// received; the socket is not read further until the entries are consumed.
+// Returns the number of bytes parsed, 0 at the end of the response.
+//
+dav_ssize_t incremental_listdir_parsing(DirHandle & handle, const std::string & scope){
     DavixError* tmp_err=NULL;
 
-    char buffer[s_buff+1];
-    const dav_ssize_t ret = req->readSegment(buffer, s_buff, &tmp_err);
+    std::vector<char> & buffer = handle.buffer;
+    const dav_ssize_t ret = handle.request->readBlock(&buffer[0], buffer.size(), &tmp_err);
     checkDavixError(&tmp_err);
-    if(ret >= 0){
-        buffer[ret]= '\0';
-        parser->parseChunk(buffer, ret);
-    }else{
-        throw DavixException(scope, StatusCode::UnknowError, "Unknow readSegment error");
+    if(ret > 0){
+        handle.parser->parseChunk(&buffer[0], ret);
+    }else if(ret < 0){
+        throw DavixException(scope, StatusCode::UnknowError, "Unknow readBlock error");
     }
 
     return ret;
 }
 
+//
+// Pull the next entry of a listing, parsing the response only as far as
+// needed. Returns false once the response is exhausted.
+//
+static bool listdir_next_entry(DirHandle & handle, const std::string & scope, std::string & name_entry, StatInfo & info){
+    std::deque<FileProperties> & props = handle.parser->getProperties();
+
+    while(props.empty()){
+        if(incremental_listdir_parsing(handle, scope) == 0){
+            return false; // end of the request, end of the story
+        }
+    }
+
+    FileProperties & front = props.front();
+    name_entry.swap(front.filename);
+    info = front.info;
+    props.pop_front(); // clean the current element
+    return true;
+}
+
 
 dav_ssize_t getStatInfo(Context & c, const Uri & url, const RequestParams * p,
                       struct StatInfo& st_info){
@@ -438,33 +489,7 @@ int internal_checksum(Context & c, const Uri & url, const RequestParams *p, std:
 
 bool wedav_get_next_property(std::unique_ptr<DirHandle> & handle, std::string & name_entry, StatInfo & info){
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, " -> wedav_get_next_property");
-    const size_t read_size = 2048;
-
-
-    HttpRequest& req = *(handle->request); // setup env again
-    XMLPropParser& parser = *(handle->parser);
-
-    size_t prop_size = parser.getProperties().size();
-    ssize_t s_resu = read_size;
-
-    while( prop_size == 0
-          && s_resu > 0){ // request not complete and current data too smalls
-        // continue the parsing until one more result
-       s_resu = incremental_listdir_parsing(&req, &parser, read_size, "WebDav::listing");
-
-       prop_size = parser.getProperties().size();
-    }
-
-
-    if(prop_size == 0){
-        return false; // end of the request, end of the story
-    }
-
-    FileProperties & front = parser.getProperties().front();
-    name_entry.swap(front.filename);
-    info = front.info;
-    parser.getProperties().pop_front(); // clean the current element
-    return true;
+    return listdir_next_entry(*handle, "WebDav::listing", name_entry, info);
 }
 
 
@@ -472,7 +497,7 @@ void webdav_start_listing_query(std::unique_ptr<DirHandle> & handle, Context & c
     dav_ssize_t s_resu;
 
     DavixError* tmp_err=NULL;
-    handle.reset(new DirHandle(new PropfindRequest(context, url, &tmp_err), new DavPropXMLParser()));
+    handle.reset(new DirHandle(new PropfindRequest(context, url, &tmp_err), new DavPropXMLParser(webdav_stat_properties(params))));
     checkDavixError(&tmp_err);
 
     HttpRequest & http_req = *(handle->request);
@@ -490,10 +515,10 @@ void webdav_start_listing_query(std::unique_ptr<DirHandle> & handle, Context & c
 
     size_t prop_size = 0;
     do{ // parse the begining of the request until the first property -> directory property
-       s_resu = incremental_listdir_parsing(&http_req, &parser, 2048, davix_scope_directory_listing_str());
+       s_resu = incremental_listdir_parsing(*handle, davix_scope_directory_listing_str());
 
        prop_size = parser.getProperties().size();
-       if(s_resu < 2048 && prop_size <1){ // verify request status : if req done + no data -> error
+       if(s_resu == 0 && prop_size <1){ // verify request status : if req done + no data -> error
            throw DavixException(davix_scope_directory_listing_str(), StatusCode::WebDavPropertiesParsingError, "bad server answer, not a valid WebDav PROPFIND answer");
        }
 
@@ -551,7 +576,8 @@ QuotaInfo & HttpMetaOps::quotaInfo(IOChainContext & iocontext, QuotaInfo &info)
 }
 
 bool HttpMetaOps::nextSubItem(IOChainContext &iocontext, std::string &entry_name, StatInfo &info){
-    return webdav_directory_listing(directoryItem, iocontext._context, iocontext._reqparams, iocontext._uri, stat_listing,
+    return webdav_directory_listing(directoryItem, iocontext._context, iocontext._reqparams, iocontext._uri,
+                             webdav_propfind_body(webdav_stat_properties(iocontext._reqparams)),
                              entry_name, info);
 }
 
@@ -660,8 +686,7 @@ bool is_a_container(Uri u) {
 
 bool s3_get_next_property(std::unique_ptr<DirHandle> & handle, std::string & name_entry, StatInfo & info);
 
-void swift_start_listing_query(std::unique_ptr<DirHandle> & handle, Context & context, const RequestParams* params, const Uri & url, const std::string & body){
-    (void) body;
+void swift_start_listing_query(std::unique_ptr<DirHandle> & handle, Context & context, const RequestParams* params, const Uri & url){
     dav_ssize_t s_resu;
     DavixError* tmp_err=NULL;
 
@@ -698,10 +723,10 @@ void swift_start_listing_query(std::unique_ptr<DirHandle> & handle, Context & co
 
     size_t prop_size = 0;
     do{ // first entry -> container information
-        s_resu = incremental_listdir_parsing(&http_req, &parser, 2048, davix_scope_directory_listing_str());
+        s_resu = incremental_listdir_parsing(*handle, davix_scope_directory_listing_str());
 
         prop_size = parser.getProperties().size();
-        if(s_resu < 2048 && prop_size <1){ // verify request status : if req done + no data -> error
+        if(s_resu == 0 && prop_size <1){ // verify request status : if req done + no data -> error
             throw DavixException(davix_scope_directory_listing_str(), StatusCode::ParsingError, "Invalid server response, not a Swift listing or the directory is empty");
         }
         if(timestamp_timeout < time(NULL)){
@@ -712,9 +737,9 @@ void swift_start_listing_query(std::unique_ptr<DirHandle> & handle, Context & co
 
 }
 
-bool swift_directory_listing(std::unique_ptr<DirHandle> & handle, Context & context, const RequestParams* params, const Uri & uri, const std::string & body, std::string & name_entry, StatInfo & info){
+bool swift_directory_listing(std::unique_ptr<DirHandle> & handle, Context & context, const RequestParams* params, const Uri & uri, std::string & name_entry, StatInfo & info){
     if(handle.get() == NULL){
-        swift_start_listing_query(handle, context, params, uri, body);
+        swift_start_listing_query(handle, context, params, uri);
     }
     return s3_get_next_property(handle, name_entry, info);
 }
@@ -722,7 +747,7 @@ bool swift_directory_listing(std::unique_ptr<DirHandle> & handle, Context & cont
 
 bool SwiftMetaOps::nextSubItem(IOChainContext &iocontext, std::string &entry_name, StatInfo &info){
     if(is_swift_operation(iocontext)){
-        return swift_directory_listing(directoryItem, iocontext._context, iocontext._reqparams, iocontext._uri, stat_listing,
+        return swift_directory_listing(directoryItem, iocontext._context, iocontext._reqparams, iocontext._uri,
                                     entry_name, info);
     }else{
         return HttpIOChain::nextSubItem(iocontext, entry_name, info);
@@ -939,7 +964,7 @@ void s3StatMapper(Context& context, const RequestParams* params, const Uri & uri
             size_t prop_size = 0;
             do{ // first entry
                TRY_DAVIX{
-                    s_resu = incremental_listdir_parsing(&http_req, &parser, 2048, scope);
+                    s_resu = incremental_listdir_parsing(handle, scope);
                }CATCH_DAVIX(&tmp_err)
 
                if(tmp_err && (tmp_err->getStatus() == StatusCode::IsNotADirectory)){
@@ -949,7 +974,7 @@ void s3StatMapper(Context& context, const RequestParams* params, const Uri & uri
                 }
 
                prop_size = parser.getProperties().size();
-               if(s_resu < 2048 && prop_size <1){ // verify request status : if req done + no data -> error
+               if(s_resu == 0 && prop_size <1){ // verify request status : if req done + no data -> error
                   throw DavixException(scope, StatusCode::ParsingError, "Invalid server response, not a S3 listing");
                }
                if(timestamp_timeout < time(NULL)){
@@ -999,121 +1024,74 @@ StatInfo & S3MetaOps::statInfo(IOChainContext & iocontext, StatInfo & st_info){
 
 bool s3_get_next_property(std::unique_ptr<DirHandle> & handle, std::string & name_entry, StatInfo & info){
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, " -> s3_get_next_property");
-    const size_t read_size = 2048;
-
-
-    HttpRequest& req = *(handle->request); // setup env again
-    XMLPropParser& parser = *(handle->parser);
-
-    size_t prop_size = parser.getProperties().size();
-    ssize_t s_resu = read_size;
-
-    while( prop_size == 0
-          && s_resu > 0){ // execute request only if no property are available
-
-        // continue the parsing until one more result
-       s_resu = incremental_listdir_parsing(&req, &parser, read_size, "S3::listing");
-       prop_size = parser.getProperties().size();
-    }
+    return listdir_next_entry(*handle, "S3::listing", name_entry, info);
+}
 
 
-    if(prop_size == 0){
-        return false; // end of the request, end of the story
+static Uri with_marker(Uri url, const std::string & marker){
+    if(!marker.empty()){
+        url.addQueryParam("marker", marker);
     }
-
-    FileProperties & front = parser.getProperties().front();
-    name_entry.swap(front.filename);
-    info = front.info;
-    parser.getProperties().pop_front(); // clean the current element
-    return true;
+    return url;
 }
 
-
-void s3_start_listing_query(std::unique_ptr<DirHandle> & handle, Context & context, const RequestParams* params, const Uri & url, const std::string & body){
-    (void) body;
-    dav_ssize_t s_resu;
-    DavixError* tmp_err=NULL;
-    bool listing_buckets;
+static S3PagedListing* s3_start_listing_query(Context & context, const RequestParams* params, const Uri & url){
+    S3PagedListing::PageUri page_uri;
+    S3PagedListing::PageParser page_parser;
+    const RequestParams p(params);
+    const S3ListingMode::S3ListingMode mode = params->getS3ListingMode();
 
     if(params->getProtocol() == RequestProtocol::Gcloud) {
-        Uri new_url = gcloud::getListingURI(url, params);
-
         std::string prefix = gcloud::extract_path(url);
         if(prefix != "/") prefix = "/" + prefix;
-        handle.reset(new DirHandle(new GetRequest(context, new_url, &tmp_err), new S3PropParser(params->getS3ListingMode(),  prefix)));
-    }
-    else if(params->getS3ListingMode() == S3ListingMode::Hierarchical){
-        Uri new_url = S3::s3UriTransformer(url, params, true);
-        handle.reset(new DirHandle(new GetRequest(context, new_url, &tmp_err), new S3PropParser(params->getS3ListingMode(), S3::extract_s3_path(url, params->getAwsAlternate()))));
+        page_uri = [url, p](const std::string & marker){ return with_marker(gcloud::getListingURI(url, p), marker); };
+        page_parser = [mode, prefix]{ return new S3PropParser(mode, prefix); };
     }
-    else if(params->getS3ListingMode() == S3ListingMode::SemiHierarchical){
-        Uri new_url = S3::s3UriTransformer(url, params, false);
-        handle.reset(new DirHandle(new GetRequest(context, new_url, &tmp_err), new S3PropParser(params->getS3ListingMode(), S3::extract_s3_path(url, params->getAwsAlternate()))));
+    else if(mode == S3ListingMode::Hierarchical || mode == S3ListingMode::SemiHierarchical){
+        const bool delimiter = (mode == S3ListingMode::Hierarchical);
+        const std::string prefix = S3::extract_s3_path(url, params->getAwsAlternate());
+        page_uri = [url, p, delimiter](const std::string & marker){ return with_marker(S3::s3UriTransformer(url, p, delimiter), marker); };
+        page_parser = [mode, prefix]{ return new S3PropParser(mode, prefix); };
     }
     else{
         if(is_a_bucket(url) == false){
            throw DavixException(davix_scope_directory_listing_str(), StatusCode::IsNotADirectory, "This is not a S3 bucket");
         }
-        handle.reset(new DirHandle(new GetRequest(context, url, &tmp_err), new S3PropParser()));
+        page_uri = [url](const std::string & marker){ return with_marker(url, marker); };
+        page_parser = []{ return new S3PropParser(); };
     }
-    checkDavixError(&tmp_err);
 
     // Check if we are listing available buckets
-    listing_buckets = (params->getAwsAlternate() && url.getPath() == "/");
-
-
-    const int operation_timeout = params->getOperationTimeout()->tv_sec;
-    HttpRequest & http_req = *(handle->request);
-    XMLPropParser & parser = *(handle->parser);
-
-    time_t timestamp_timeout = time(NULL) + ((operation_timeout)?(operation_timeout):180);
-
-    http_req.setParameters(params);
-
-    http_req.beginRequest(&tmp_err);
-    checkDavixError(&tmp_err);
-
-    check_file_status(http_req, davix_scope_directory_listing_str());
-
-    size_t prop_size = 0;
-    do{ // first entry -> bucket information
-       s_resu = incremental_listdir_parsing(&http_req, &parser, 2048, davix_scope_directory_listing_str());
-
-       prop_size = parser.getProperties().size();
-       if(s_resu < 2048 && prop_size <1){ // verify request status : if req done + no data -> error
-           throw DavixException(davix_scope_directory_listing_str(), StatusCode::ParsingError, "Invalid server response, not a S3 listing");
-       }
-       if(timestamp_timeout < time(NULL)){
-          throw DavixException(davix_scope_directory_listing_str(), StatusCode::OperationTimeout, "Operation timeout triggered while directory listing");
-       }
-
-    }while( prop_size < 1); // prop < 1 means not enough data
-
-    const StatInfo & info = parser.getProperties().at(0).info;
-    if( S_ISDIR(info.mode) == false){
-        std::ostringstream ss;
-        ss << url << " is not a S3 bucket";
-        throw DavixException(davix_scope_directory_listing_str(), StatusCode::IsNotADirectory, ss.str());
-    } else if (!listing_buckets) {
-            parser.getProperties().pop_front(); // suppress the bucket name entry
-    }
+    const bool listing_buckets = (params->getAwsAlternate() && url.getPath() == "/");
 
+    return new S3PagedListing(context, p, url, page_uri, page_parser, listing_buckets);
 }
 
 
-
-bool s3_directory_listing(std::unique_ptr<DirHandle> & handle, Context & context, const RequestParams* params, const Uri & uri, const std::string & body, std::string & name_entry, StatInfo & info){
-    if(handle.get() == NULL){
-        s3_start_listing_query(handle, context, params, uri, body);
+static bool is_s3_parallel_listing(IOChainContext & context){
+    const RequestParams & params = *context._reqparams;
+    if(!params.getS3ParallelListing() || params.getS3ListingMode() == S3ListingMode::Hierarchical){
+        return false;
     }
-    return s3_get_next_property(handle, name_entry, info);
+    return !(context._uri.getProtocol().compare(0, 6, "gcloud") ==0 || params.getProtocol() == RequestProtocol::Gcloud);
 }
 
-
 bool S3MetaOps::nextSubItem(IOChainContext &iocontext, std::string &entry_name, StatInfo &info){
+    if(is_s3_operation(iocontext) && is_s3_parallel_listing(iocontext)){
+        if(parallelListing.get() == NULL){
+            if(iocontext._reqparams->getS3ListingMode() == S3ListingMode::Flat && is_a_bucket(iocontext._uri) == false){
+                throw DavixException(davix_scope_directory_listing_str(), StatusCode::IsNotADirectory, "This is not a S3 bucket");
+            }
+            parallelListing.reset(new S3ParallelListing(iocontext._context, *iocontext._reqparams, iocontext._uri));
+        }
+        return parallelListing->next(entry_name, info);
+    }
+
     if(is_s3_operation(iocontext)){
-        return s3_directory_listing(directoryItem, iocontext._context, iocontext._reqparams, iocontext._uri, stat_listing,
-                                 entry_name, info);
+        if(pagedListing.get() == NULL){
+            pagedListing.reset(s3_start_listing_query(iocontext._context, iocontext._reqparams, iocontext._uri));
+        }
+        return pagedListing->next(entry_name, info);
     }else{
         return HttpIOChain::nextSubItem(iocontext, entry_name, info);
     }
@@ -1171,10 +1149,10 @@ void azureStatMapper(Context& context, const RequestParams* params, const Uri &
 
             size_t prop_size = 0;
             do{ // first entry -> container information
-                s_resu = incremental_listdir_parsing(&http_req, &parser, 2048, davix_scope_directory_listing_str());
+                s_resu = incremental_listdir_parsing(handle, davix_scope_directory_listing_str());
 
                 prop_size = parser.getProperties().size();
-                if(s_resu < 2048 && prop_size <1){ // verify request status : if req done + no data -> error
+                if(s_resu == 0 && prop_size <1){ // verify request status : if req done + no data -> error
                     throw DavixException(davix_scope_directory_listing_str(), StatusCode::IsNotADirectory, "The specified directory does not exist");
                 }
                 if(timestamp_timeout < time(NULL)){
@@ -1208,7 +1186,7 @@ StatInfo & AzureMetaOps::statInfo(IOChainContext & iocontext, StatInfo & st_info
     }
 }
 
-static void azure_start_listing_query(std::unique_ptr<DirHandle> & handle, Context & context, const RequestParams* params, const Uri & url, const std::string & body) {
+static void azure_start_listing_query(std::unique_ptr<DirHandle> & handle, Context & context, const RequestParams* params, const Uri & url) {
     DavixError* tmp_err=NULL;
     dav_ssize_t s_resu;
 
@@ -1229,10 +1207,10 @@ static void azure_start_listing_query(std::unique_ptr<DirHandle> & handle, Conte
 
     size_t prop_size = 0;
     do{ // first entry -> container information
-       s_resu = incremental_listdir_parsing(&http_req, &parser, 2048, davix_scope_directory_listing_str());
+       s_resu = incremental_listdir_parsing(*handle, davix_scope_directory_listing_str());
 
        prop_size = parser.getProperties().size();
-       if(s_resu < 2048 && prop_size <1){ // verify request status : if req done + no data -> error
+       if(s_resu == 0 && prop_size <1){ // verify request status : if req done + no data -> error
            throw DavixException(davix_scope_directory_listing_str(), StatusCode::IsNotADirectory, "The specified directory does not exist");
        }
        if(timestamp_timeout < time(NULL)){
@@ -1244,43 +1222,19 @@ static void azure_start_listing_query(std::unique_ptr<DirHandle> & handle, Conte
 
 bool azure_get_next_property(std::unique_ptr<DirHandle> & handle, std::string & name_entry, StatInfo & info) {
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CHAIN, " -> azure_get_next_property");
-    const size_t read_size = 2048;
-
-    HttpRequest& req = *(handle->request); // setup env again
-    XMLPropParser& parser = *(handle->parser);
-
-    size_t prop_size = parser.getProperties().size();
-    ssize_t s_resu = read_size;
-
-    while( prop_size == 0
-          && s_resu > 0){ // execute request only if no property are available
-
-        // continue the parsing until one more result
-       s_resu = incremental_listdir_parsing(&req, &parser, read_size, "S3::listing");
-       prop_size = parser.getProperties().size();
-    }
-
-    if(prop_size == 0){
-        return false; // end of the request, end of the story
-    }
-
-    FileProperties & front = parser.getProperties().front();
-    name_entry.swap(front.filename);
-    info = front.info;
-    parser.getProperties().pop_front(); // clean the current element
-    return true;
+    return listdir_next_entry(*handle, "Azure::listing", name_entry, info);
 }
 
-static bool azure_directory_listing(std::unique_ptr<DirHandle> & handle, Context & context, const RequestParams* params, const Uri & uri, const std::string & body, std::string & name_entry, StatInfo & info){
+static bool azure_directory_listing(std::unique_ptr<DirHandle> & handle, Context & context, const RequestParams* params, const Uri & uri, std::string & name_entry, StatInfo & info){
     if(handle.get() == NULL){
-        azure_start_listing_query(handle, context, params, uri, body);
+        azure_start_listing_query(handle, context, params, uri);
     }
     return azure_get_next_property(handle, name_entry, info);
 }
 
 bool AzureMetaOps::nextSubItem(IOChainContext &iocontext, std::string &entry_name, StatInfo &info) {
     if(is_azure_operation(iocontext)){
-        return azure_directory_listing(directoryItem, iocontext._context, iocontext._reqparams, iocontext._uri, stat_listing,
+        return azure_directory_listing(directoryItem, iocontext._context, iocontext._reqparams, iocontext._uri,
                                  entry_name, info);
     }else{
         return HttpIOChain::nextSubItem(iocontext, entry_name, info);
@@ -30,6 +30,8 @@
 namespace Davix{
 
 struct DirHandle;
+class S3PagedListing;
+class S3ParallelListing;
 
 ///
 /// \brief The HttpMetaOps class
@@ -88,7 +90,8 @@ public:
     virtual bool nextSubItem(IOChainContext &iocontext, std::string &entry_name, StatInfo &info);
 
 private:
-    std::unique_ptr<DirHandle> directoryItem;
+    std::unique_ptr<S3PagedListing> pagedListing;
+    std::unique_ptr<S3ParallelListing> parallelListing;
 
 };
 
@@ -143,6 +146,11 @@ private:
   */
 std::vector<char> req_webdav_propfind(HttpRequest* req, DavixError** err);
 
+/*
+  body of a PROPFIND request asking for the properties of a StatProperty mask
+  */
+std::string webdav_propfind_body(unsigned int properties);
+
 
 
 } // Davix
@@ -22,6 +22,9 @@
 #include <davix_internal.hpp>
 #include "fileutils.hpp"
 
+#include <cerrno>
+#include <cstdlib>
+
 namespace Davix {
 
 
@@ -58,6 +61,35 @@ void check_file_status(HttpRequest & req, const std::string & scope){
     }
 }
 
+
+dav_ssize_t parse_content_range_size(const std::string & content_range){
+    const std::string::size_type pos = content_range.find_last_of('/');
+    if(pos == std::string::npos || pos +1 >= content_range.size())
+        return -1;
+
+    const char* start = content_range.c_str() + pos +1;
+    char* end = NULL;
+    errno = 0;
+    const long long size = strtoll(start, &end, 10);
+    if(end == start || errno != 0 || size < 0)
+        return -1; // "*" or garbage
+    return static_cast<dav_ssize_t>(size);
+}
+
+
+dav_ssize_t get_answer_file_size(HttpRequest & req){
+    const int code = req.getRequestCode();
+    if(code == 206){
+        std::string range;
+        if(req.getAnswerHeader(ans_header_byte_range, range))
+            return parse_content_range_size(range);
+        return -1;
+    }
+    if(code == 200)
+        return req.getAnswerSize();
+    return -1;
+}
+
 void setup_offset_request(HttpRequest* req, const dav_off_t *start_len, const dav_size_t *size_read, const dav_size_t number_ops){
    std::ostringstream buffer;
 
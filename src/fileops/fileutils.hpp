@@ -40,6 +40,12 @@ int davixRequestToFileStatus(HttpRequest* req, const std::string & scope, DavixE
 
 void check_file_status(HttpRequest & req, const std::string & scope);
 
+// extract the complete length from a "bytes first-last/complete" Content-Range value, -1 if unknown
+dav_ssize_t parse_content_range_size(const std::string & content_range);
+
+// size of the remote file from the answer of a GET request, -1 if unknown
+dav_ssize_t get_answer_file_size(HttpRequest & req);
+
 // configure Range request
 void setup_offset_request(HttpRequest* req, const dav_off_t *start_len, const dav_size_t *size_read, const dav_size_t number_ops);
 
@@ -123,6 +123,10 @@ dav_ssize_t HttpIOChain::read(IOChainContext & iocontext, void *buf, dav_size_t
     CHAIN_FORWARD(read(iocontext, buf, count));
 }
 
+dav_ssize_t HttpIOChain::write(IOChainContext & iocontext, const void *buf, dav_size_t count){
+    CHAIN_FORWARD(write(iocontext, buf, count));
+}
+
 dav_off_t HttpIOChain::lseek(IOChainContext & iocontext, dav_off_t offset, int flags){
     CHAIN_FORWARD(lseek(iocontext, offset, flags));
 }
@@ -23,11 +23,13 @@
 #define HTTPIOCHAIN_HPP
 
 #include <davix_internal.hpp>
+#include <atomic>
 
 namespace Davix{
 
 class HttpIOChain;
 class ContentProvider;
+class ChecksumCalculator;
 
 #define CHAIN_FORWARD(X) \
         do{ \
@@ -48,9 +50,33 @@ struct FdHandler {
 };
 
 
+// I/O accounting, shared by all the operations of a POSIX file descriptor.
+// Counters may be updated from the background threads of an operation.
+struct IOChainStats {
+    IOChainStats() : bytes_read(0), bytes_written(0), requests(0), ranges_coalesced(0),
+        cache_hits(0), cache_misses(0), network_time_us(0), retries(0) { }
+
+    std::atomic<dav_size_t> bytes_read;
+    std::atomic<dav_size_t> bytes_written;
+    std::atomic<dav_size_t> requests;
+    std::atomic<dav_size_t> ranges_coalesced;
+    std::atomic<dav_size_t> cache_hits;
+    std::atomic<dav_size_t> cache_misses;
+    std::atomic<dav_size_t> network_time_us;
+    std::atomic<dav_size_t> retries;
+};
+
+#define IOCHAIN_STAT_ADD(iocontext, counter, value) \
+        do{ \
+        if((iocontext)._stats != NULL){ \
+            (iocontext)._stats->counter += (value); \
+        } \
+    }while(0)
+
+
 // parameter handler for any IO Chain operation
 struct IOChainContext{
-    IOChainContext(Context & c, const Uri & u, const RequestParams * p): _context(c), _uri(u), _reqparams(p), _end_time() {
+    IOChainContext(Context & c, const Uri & u, const RequestParams * p): _context(c), _uri(u), _reqparams(p), _end_time(), _stats(NULL), _open_stat(NULL), _remote_size(-1), _checksum(NULL) {
         if(_reqparams->getOperationTimeout()->tv_sec > 0){
             _end_time = Chrono::Clock(Chrono::Clock::Monolitic).now();
             _end_time += Chrono::Duration(_reqparams->getOperationTimeout()->tv_sec);
@@ -80,6 +106,18 @@ struct IOChainContext{
     // Keep track of how many bytes we've written to an fd, so as to avoid
     // writing the same bytes again in an event of retries / metalink recovery
     FdHandler fdHandler;
+
+    // optional I/O accounting, not owned
+    IOChainStats* _stats;
+
+    // optional caller-supplied file information, replaces the stat done at open, not owned
+    const StatInfo* _open_stat;
+
+    // size of the remote file as learned from the last GET answer, -1 if unknown
+    dav_ssize_t _remote_size;
+
+    // optional checksum fed with the data read by readFull and readToFd, not owned
+    ChecksumCalculator* _checksum;
 };
 
 // Davix IO chain
@@ -151,6 +189,9 @@ public:
     // sequential read of a file from begining to the end
     virtual dav_ssize_t read(IOChainContext & iocontext, void* buf, dav_size_t count);
 
+    // sequential write of a file from begining to the end
+    virtual dav_ssize_t write(IOChainContext & iocontext, const void* buf, dav_size_t count);
+
     // lseek prototype
     virtual dav_off_t lseek(IOChainContext & iocontext, dav_off_t offset, int flags);
 
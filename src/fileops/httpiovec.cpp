@@ -364,14 +364,14 @@ dav_ssize_t HttpIOVecOps::preadVec(IOChainContext & iocontext, const DavIOVecInp
     }
 
     IntervalTree<ElemChunk> tree = buildIntervalTree(input_vec, output_vec, count_vec);
+    SortedRanges sorted = partialMerging(tree, mergewindow);
+    IOCHAIN_STAT_ADD(iocontext, ranges_coalesced, count_vec - sorted.size());
 
     // a lot of servers do not support multirange... should we even try?
     if(count_vec == 1 || iocontext._uri.getFragmentParam("multirange") == "false") {
-        SortedRanges sorted = partialMerging(tree, mergewindow);
         return simulateMultirange(iocontext, tree, sorted, nconnections);
     }
 
-    SortedRanges sorted = partialMerging(tree, mergewindow);
     MultirangeResult res = performMultirange(iocontext, tree, sorted);
     if(res.res == MultirangeResult::SUCCESS || res.res == MultirangeResult::SUCCESS_BUT_NO_MULTIRANGE) {
         return res.size_bytes;
@@ -28,16 +28,18 @@
 #include <utils/davix_logger_internal.hpp>
 #include <fileops/httpiovec.hpp>
 #include <fileops/davmeta.hpp>
-#include <system_utils/env_utils.hpp>
+#include <utils/checksum_calculator.hpp>
 
 
 #include <sstream>
 #include <string>
+#include <thread>
 
 #include <cstring>
 #include <cstdio>
 #include <cstdlib>
 #include <cmath>
+#include <limits>
 
 
 
@@ -145,6 +147,7 @@ dav_ssize_t HttpIO::readFull(IOChainContext & iocontext, std::vector<char> & buf
     dav_ssize_t ret = -1, total=0;
 
     DAVIX_SCOPE_TRACE(DAVIX_LOG_CHAIN, fun_readFull);
+    const size_t initial_size = buffer.size();
 
     GetRequest req (iocontext._context, iocontext._uri, &tmp_err);
     if(!tmp_err){
@@ -165,6 +168,13 @@ dav_ssize_t HttpIO::readFull(IOChainContext & iocontext, std::vector<char> & buf
         }
     }
 
+    if(tmp_err){
+        // a retry reads the whole content again
+        buffer.resize(initial_size);
+    }else if(iocontext._checksum){
+        iocontext._checksum->update(buffer.data() + initial_size, total);
+    }
+
     checkDavixError(&tmp_err);
     return (ret>=0)?total:-1;
 }
@@ -183,6 +193,10 @@ dav_ssize_t HttpIO::pread(IOChainContext & iocontext, void *buf, dav_size_t coun
         req.setParameters(params);
         setup_offset_request(&req, &offset, &count,1);
         if(req.beginRequest(&tmp_err) ==0){
+            const dav_ssize_t remote_size = get_answer_file_size(req);
+            if(remote_size >= 0)
+                iocontext._remote_size = remote_size;
+
             if(req.getRequestCode() == 416 ){ // out of file, end of file
                 ret = 0; // end of file
                 DavixError::clearError(&tmp_err);
@@ -212,6 +226,56 @@ dav_ssize_t HttpIO::pread(IOChainContext & iocontext, void *buf, dav_size_t coun
 
 #define SSTR(message) static_cast<std::ostringstream&>(std::ostringstream().flush() << message).str()
 
+// copy the answer to fd, feeding the checksum on the way
+// like HttpRequest::readToFd, the checksum is fed with exactly the bytes
+// written to fd: returns their number even if an error interrupted the
+// transfer, so that a retry resumes from there
+static dav_ssize_t read_to_fd_with_checksum(HttpRequest & req, int fd, dav_size_t read_size, ChecksumCalculator & checksum, DavixError** err){
+    dav_ssize_t ret = 0, total = 0;
+    read_size = (read_size == 0)?(std::numeric_limits<dav_size_t>::max()):read_size;
+    std::vector<char> buffer(1024 * 1024);
+
+    while(read_size > 0 && (ret = req.readBlock(buffer.data(), std::min<dav_size_t>(buffer.size(), read_size), err)) > 0){
+        for(dav_ssize_t written = 0; written < ret; ){
+            dav_ssize_t w = ::write(fd, buffer.data() + written, ret - written);
+            if(w < 0 && errno == EINTR)
+                continue;
+            if(w < 0){
+                DavixError::setupError(err, davix_scope_http_request(), StatusCode::SystemError,
+                                       std::string("Impossible to write to fd: ").append(strerror(errno)));
+                checksum.update(buffer.data(), written);
+                total += written;
+                return (total > 0) ? total : -1;
+            }
+            written += w;
+        }
+
+        checksum.update(buffer.data(), ret);
+        read_size -= ret;
+        total += ret;
+    }
+
+    if(total > 0)
+        return total;
+    return ret;
+}
+
+// discard the first count bytes of the answer
+static bool skip_answer_bytes(HttpRequest & req, dav_size_t count, DavixError** err){
+    std::vector<char> buffer(std::min<dav_size_t>(count, 1024 * 1024));
+    while(count > 0){
+        const dav_ssize_t ret = req.readBlock(buffer.data(), std::min<dav_size_t>(buffer.size(), count), err);
+        if(ret <= 0){
+            if(ret == 0)
+                DavixError::setupError(err, davix_scope_http_request(), StatusCode::InvalidServerResponse,
+                                       "Answer shorter than the data already written to fd");
+            return false;
+        }
+        count -= ret;
+    }
+    return true;
+}
+
 dav_ssize_t HttpIO::readToFd(IOChainContext & iocontext, int fd, dav_size_t read_size){
     DavixError * tmp_err=NULL;
     dav_ssize_t ret = -1;
@@ -237,6 +301,12 @@ dav_ssize_t HttpIO::readToFd(IOChainContext & iocontext, int fd, dav_size_t read
             if(httpcodeIsValid(req.getRequestCode()) == false){
                 httpcodeToDavixError(req.getRequestCode(),davix_scope_io_buff(),"read error: ", &tmp_err);
                 ret = -1;
+            }else if(iocontext.fdHandler.bytes_written_to_fd > 0 && req.getRequestCode() != 206
+                     && !skip_answer_bytes(req, iocontext.fdHandler.bytes_written_to_fd, &tmp_err)){
+                // the range was ignored, the whole file is sent again
+                ret = -1;
+            }else if(iocontext._checksum){
+                ret= read_to_fd_with_checksum(req, fd, read_size, *iocontext._checksum, &tmp_err);
             }else{
                 ret= req.readToFd(fd, read_size, &tmp_err);
             }
@@ -279,16 +349,61 @@ dav_ssize_t HttpIO::writeFromProvider(IOChainContext & iocontext, ContentProvide
 ///
 
 
-struct IOBufferLocalFile{
-    IOBufferLocalFile(int fd, const std::string & filepath): _fd(fd), _filepath(filepath){}
-    virtual ~IOBufferLocalFile(){
-        DAVIX_SLOG(DAVIX_LOG_TRACE, DAVIX_LOG_CHAIN, "Delete tmp file {}", _filepath);
-        unlink(_filepath.c_str());
-        close(_fd);
+// Write-behind state of a POSIX file: written data is queued in a bounded
+// in-memory pipe and streamed to the server by a background upload, so
+// write() only blocks when the network can not keep up.
+struct IOBufferWriteBehind{
+    IOBufferWriteBehind(HttpIOChain & chain, IOChainContext & iocontext, dav_size_t buffer_size) :
+        _provider(buffer_size), _written(0), _error(), _worker()
+    {
+        DAVIX_SLOG(DAVIX_LOG_TRACE, DAVIX_LOG_CHAIN, "Start write-behind upload to {}, buffer size {}", iocontext._uri, buffer_size);
+        _worker = std::thread(&IOBufferWriteBehind::upload, this, std::ref(chain), std::ref(iocontext));
     }
 
-    int _fd;
-    std::string _filepath;
+    // dropped without commit: abort the upload instead of committing a truncated object
+    virtual ~IOBufferWriteBehind(){
+        if(_worker.joinable()){
+            _provider.cancel();
+            _worker.join();
+        }
+    }
+
+    void write(const void* buf, dav_size_t count){
+        if(_provider.push(static_cast<const char*>(buf), count) == false){
+            commit();
+            throw DavixException(davix_scope_io_buff(), StatusCode::InvalidFileHandle, "write-behind upload aborted");
+        }
+        _written += count;
+    }
+
+    // signal end of file, wait for the upload to complete and report its status
+    void commit(){
+        if(_worker.joinable()){
+            _provider.close();
+            _worker.join();
+        }
+        if(_error){
+            std::exception_ptr err = _error;
+            _error = std::exception_ptr();
+            std::rethrow_exception(err);
+        }
+    }
+
+    PipeContentProvider _provider;
+    dav_size_t _written; // offset of the next write
+    std::exception_ptr _error;
+    std::thread _worker;
+
+private:
+    void upload(HttpIOChain & chain, IOChainContext & iocontext){
+        try{
+            chain.writeFromProvider(iocontext, _provider);
+        }catch(...){
+            _error = std::current_exception();
+        }
+        // unblock any writer still waiting for room
+        _provider.cancel();
+    }
 };
 
 HttpIOBuffer::HttpIOBuffer() :
@@ -301,7 +416,10 @@ HttpIOBuffer::HttpIOBuffer() :
     _rwlock(),
     _read_pos(0),
     _read_endfile(false),
-    _read_req(NULL)
+    _read_req(NULL),
+    _create_on_commit(false),
+    _create_if_missing_on_commit(false),
+    _file_size_known(false)
 {
 
 }
@@ -310,36 +428,41 @@ HttpIOBuffer::~HttpIOBuffer(){
     delete _read_req;
 }
 
-IOBufferLocalFile* createLocalBuffer(){
-    std::string staging = EnvUtils::getEnv("DAVIX_STAGING_AREA", "/tmp");
-    staging += "/.davix_tmp_file_XXXXXX";
-
-    char buffer[1024];
-    strncpy(buffer, staging.c_str(), 1023);
-
-    int fd;
-    if( (fd = mkstemp(buffer)) < 0){
-        DAVIX_SLOG(DAVIX_LOG_TRACE, DAVIX_LOG_CHAIN, "Error during temporary file creation for HTTPIO {}: {}", buffer, strerror(errno));
-        return NULL;
-    }
-    return new IOBufferLocalFile(fd, buffer);
-}
-
 bool HttpIOBuffer::open(IOChainContext & iocontext, int flags){
     bool res = false;
     if(_opened)
         return true;
 
+    const bool exclusive_create = (flags & O_EXCL) && (flags & O_CREAT);
+    if(iocontext._open_stat == NULL && !exclusive_create
+            && iocontext._reqparams->getStatOnOpen() == false){
+        // existence and size are discovered by the first read
+        _file_size = 0;
+        _file_size_known = false;
+        _file_exist = true;
+        _opened = true;
+        const bool create = (flags & O_CREAT) && ((flags & O_RDWR) || (flags & O_WRONLY));
+        _create_on_commit = create && (flags & O_TRUNC);
+        _create_if_missing_on_commit = create && !(flags & O_TRUNC);
+        DAVIX_SLOG(DAVIX_LOG_TRACE, DAVIX_LOG_CHAIN, "File open {} without existence check", iocontext._uri);
+        return res;
+    }
+
     struct StatInfo infos;
 
     try{
-        _start->statInfo(iocontext, infos);
+        if(iocontext._open_stat){
+            infos = *iocontext._open_stat;
+        }else{
+            _start->statInfo(iocontext, infos);
+        }
 
         if( (flags & O_EXCL) && ( flags & O_CREAT)){
             throw DavixException(davix_scope_io_buff(),
                                    StatusCode::FileExist, "file exist and O_EXCL flag usedin open");
         }else{
             _file_size = infos.size;
+            _file_size_known = true;
             _file_exist = true;
             _opened = true;
         }
@@ -348,9 +471,10 @@ bool HttpIOBuffer::open(IOChainContext & iocontext, int flags){
                 &&  (flags & O_CREAT)
                 && ((flags & O_RDWR) || (flags  & O_WRONLY))){
             _file_size = 0;
+            _file_size_known = true;
             _file_exist = false;
             _opened = true;
-            _local.reset(createLocalBuffer());
+            _create_on_commit = true;
         }else{
             throw e;
         }
@@ -369,8 +493,13 @@ dav_ssize_t HttpIOBuffer::read(IOChainContext & iocontext, void *buf, dav_size_t
         resetIO(iocontext);
     if(_pos == _read_pos && isAdviseFullRead()){
         // try read ahead strategie
+        if(_read_req != NULL || _read_endfile)
+            IOCHAIN_STAT_ADD(iocontext, cache_hits, 1);
+        else
+            IOCHAIN_STAT_ADD(iocontext, cache_misses, 1);
         ret = readInternal(iocontext, buf, count);
     }else{ // fallback on partial read
+        IOCHAIN_STAT_ADD(iocontext, cache_misses, 1);
         ret = _start->pread(iocontext, buf, count, _pos);
     }
     if(ret > 0)
@@ -381,6 +510,33 @@ dav_ssize_t HttpIOBuffer::read(IOChainContext & iocontext, void *buf, dav_size_t
 }
 
 
+dav_ssize_t HttpIOBuffer::write(IOChainContext & iocontext, const void *buf, dav_size_t count){
+    std::lock_guard<std::recursive_mutex> l(_rwlock);
+
+    if(count == 0)
+        return 0;
+
+    if(_next.get() == NULL){
+        throw DavixException(davix_scope_io_buff(), StatusCode::OperationNonSupported, "I/O operation not supported");
+    }
+
+    // the upload is a stream, it can not go back nor skip bytes
+    const dav_off_t expected = (_writer.get() != NULL) ? static_cast<dav_off_t>(_writer->_written) : 0;
+    if(_pos != expected){
+        throw DavixException(davix_scope_io_buff(), StatusCode::InvalidArgument,
+                             fmt::format("Non-sequential write at offset {}, the upload is at offset {}", _pos, expected));
+    }
+
+    if(_writer.get() == NULL){
+        _writer.reset(new IOBufferWriteBehind(*_next, iocontext, iocontext._reqparams->getWriteBufferSize()));
+    }
+
+    _writer->write(buf, count);
+    _pos += count;
+    return count;
+}
+
+
 dav_ssize_t HttpIOBuffer::readInternal(IOChainContext & iocontext, void *buffer, dav_size_t size_read){
     dav_ssize_t ret = -1;
     DavixError * tmp_err=NULL;
@@ -394,12 +550,21 @@ dav_ssize_t HttpIOBuffer::readInternal(IOChainContext & iocontext, void *buffer,
             && tmp_err == NULL ){
         RequestParams params(iocontext._reqparams);
         _read_req->setParameters(params);
-        if(_read_req->beginRequest(&tmp_err) ==0
-            && (_read_req->getRequestCode() != 200)){
+        if(_read_req->beginRequest(&tmp_err) ==0){
+            if(_read_req->getRequestCode() != 200){
                 httpcodeToDavixError(_read_req->getRequestCode(),davix_scope_http_request(),", while  readding", &tmp_err);
                 delete _read_req;
                 _read_req = NULL;
-
+            }else{
+                const dav_ssize_t remote_size = get_answer_file_size(*_read_req);
+                if(remote_size >= 0){
+                    iocontext._remote_size = remote_size;
+                    if(!_file_size_known){
+                        _file_size = remote_size;
+                        _file_size_known = true;
+                    }
+                }
+            }
         }
         if(tmp_err){
             delete _read_req;
@@ -431,6 +596,22 @@ dav_ssize_t HttpIOBuffer::readInternal(IOChainContext & iocontext, void *buffer,
 
 
 
+dav_size_t HttpIOBuffer::fileSize(IOChainContext & iocontext){
+    if(!_file_size_known){
+        if(iocontext._remote_size >= 0){
+            _file_size = iocontext._remote_size;
+        }else{
+            // nothing read yet, fallback on a stat
+            struct StatInfo infos;
+            _start->statInfo(iocontext, infos);
+            _file_size = infos.size;
+        }
+        _file_size_known = true;
+    }
+    return _file_size;
+}
+
+
 void HttpIOBuffer::prefetchInfo(IOChainContext & iocontext, off_t offset, dav_size_t size_read, advise_t adv){
     (void) iocontext;
     (void) offset;
@@ -453,28 +634,45 @@ void HttpIOBuffer::resetIO(IOChainContext & iocontext){
 
 void HttpIOBuffer::commitLocal(IOChainContext & iocontext){
     std::lock_guard<std::recursive_mutex> l(_rwlock);
-    if(_local.get()){
-        struct stat st;
-        memset(&st,0, sizeof(struct stat));
-        fstat(_local->_fd, &st);
-        DAVIX_SLOG(DAVIX_LOG_TRACE, DAVIX_LOG_CHAIN, "Commit local file modifications, {} bytes", st.st_size);
-
-        FdContentProvider provider(_local->_fd, 0, st.st_size);
-        _start->writeFromProvider(iocontext, provider);
-        _local.reset();
+    if(_writer.get()){
+        DAVIX_SLOG(DAVIX_LOG_TRACE, DAVIX_LOG_CHAIN, "Commit write-behind upload, {} bytes", _writer->_provider.getConsumed());
+        std::unique_ptr<IOBufferWriteBehind> writer(std::move(_writer));
+        _create_on_commit = false;
+        _create_if_missing_on_commit = false;
+        writer->commit();
+    }else if(_create_if_missing_on_commit){
+        // existence never checked: create the file only if it is not there, a read answer proves it is
+        _create_if_missing_on_commit = false;
+        if(_file_size_known == false){
+            try{
+                StatInfo infos;
+                _start->statInfo(iocontext, infos);
+            }catch(DavixException & e){
+                if(e.code() != StatusCode::FileNotFound)
+                    throw;
+                DAVIX_SLOG(DAVIX_LOG_TRACE, DAVIX_LOG_CHAIN, "Commit creation of missing file");
+                BufferContentProvider provider(NULL, 0);
+                _next->writeFromProvider(iocontext, provider);
+            }
+        }
+    }else if(_create_on_commit){
+        // file created but never written: create it empty
+        DAVIX_SLOG(DAVIX_LOG_TRACE, DAVIX_LOG_CHAIN, "Commit empty file creation");
+        _create_on_commit = false;
+        BufferContentProvider provider(NULL, 0);
+        _next->writeFromProvider(iocontext, provider);
     }
 }
 
 
 dav_off_t HttpIOBuffer::lseek(IOChainContext & iocontext, dav_off_t offset, int flags){
-    (void) iocontext;
     std::lock_guard<std::recursive_mutex> l(_rwlock);
     switch(flags){
         case SEEK_CUR:
             _pos += offset;
             break;
         case SEEK_END:
-            _pos = ( _file_size += offset);
+            _pos = fileSize(iocontext) + offset;
             break;
         case SEEK_SET:
         default:
@@ -68,7 +68,7 @@ private:
 };
 
 
-struct IOBufferLocalFile;
+struct IOBufferWriteBehind;
 
 ///
 /// RW operation with buffering support and POSIX like interface
@@ -79,11 +79,15 @@ public:
 
     // open the file associated with the davix IOBuffMap
     // do a simple check if the file exist and try to anticipate the next ops
+    // the check is skipped if a StatInfo is supplied or disabled in the RequestParams
     virtual bool open(IOChainContext & iocontext, int flags);
 
     //
     virtual dav_ssize_t read(IOChainContext & iocontext, void* buf, dav_size_t count);
 
+    // sequential write, streamed to the server in the background
+    virtual dav_ssize_t write(IOChainContext & iocontext, const void* buf, dav_size_t count);
+
 
     // give information on the future operation for prefecting
     virtual void prefetchInfo(IOChainContext & iocontext, off_t offset, dav_size_t size_read, advise_t adv);
@@ -107,12 +111,15 @@ protected:
 
     // locker
     std::recursive_mutex _rwlock;
-    // write cache
-    std::unique_ptr<IOBufferLocalFile> _local;
+    // write-behind upload
+    std::unique_ptr<IOBufferWriteBehind> _writer;
 
     dav_off_t _read_pos; //curent read file offset
     bool _read_endfile;
     HttpRequest * _read_req;
+    bool _create_on_commit; // created by open(), upload even if nothing is written
+    bool _create_if_missing_on_commit; // O_CREAT without stat nor O_TRUNC, create on commit if the file does not exist
+    bool _file_size_known; // false until learned from a GET answer when open() skipped the stat
 
 private:
 
@@ -122,6 +129,8 @@ private:
 
     dav_ssize_t readInternal(IOChainContext & iocontext, void *buffer, dav_size_t size_read);
 
+    dav_size_t fileSize(IOChainContext & iocontext);
+
     HttpIOBuffer(const HttpIOBuffer & );
     HttpIOBuffer & operator=(const HttpIOBuffer & );
 };
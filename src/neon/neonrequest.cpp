@@ -36,6 +36,7 @@
 #include <utils/CompatibilityHacks.hpp>
 #include <backend/SessionFactory.hpp>
 #include <curl/StandaloneCurlRequest.hpp>
+#include <params/davix_request_params_internal.hpp>
 
 #include "../backend/StandaloneNeonRequest.hpp"
 
@@ -110,7 +111,8 @@ NeonRequest::NeonRequest(const BoundHooks &hooks, Context& context, const Uri &
     _redirects(0),
     _total_read_size(0),
     _headers_configured(false),
-    _accepted_202_retries(0) {
+    _accepted_202_retries(0),
+    _expect100_retried(false) {
 }
 
 
@@ -297,6 +299,7 @@ int NeonRequest::negotiateRequest(DavixError** err){
     while(end_status == NE_RETRY && _number_try <= auth_retry_limit) {
         DAVIX_SLOG(DAVIX_LOG_TRACE, DAVIX_LOG_HTTP, "NEON start internal request");
 
+        RequestParamsExplorer::countRequest(_params);
         Status st = _standalone_req->startRequest();
 
         if(!st.ok()) {
@@ -373,6 +376,13 @@ int NeonRequest::negotiateRequest(DavixError** err){
 
 
                 break;
+            case 417: // 100-continue expectation refused, retry once without it
+                if(!_content_provider || _expect100_retried) goto default_label;
+
+                clearAnswerContent();
+                _expect100_retried = true;
+                endRequest(NULL);
+                return startRequest(err);
             case 401: // authentification requested, do retry
             case 403:
                 clearAnswerContent();
@@ -571,6 +581,35 @@ dav_ssize_t NeonRequest::readBlock(char* buffer, dav_size_t max_size, DavixError
     return read_status;
 }
 
+bool NeonRequest::canSpliceToFd(int fd) const {
+    if(!_standalone_req || _early_termination || _vec_line.size() > 0) {
+        return false;
+    }
+
+    return _standalone_req->canSpliceToFd(fd);
+}
+
+dav_ssize_t NeonRequest::spliceBlockToFd(int fd, dav_size_t max_size, DavixError** err){
+    if(!_standalone_req) {
+        DavixError::setupError(err, davix_scope_http_request(), StatusCode::AlreadyRunning, "No request started");
+        return -1;
+    }
+
+    if(max_size ==0)
+        return 0;
+
+    // check timeout
+    if(checkTimeout(err) == true)
+        return -1;
+
+    Status st;
+    dav_ssize_t retval = _standalone_req->spliceToFd(fd, max_size, st);
+    if(!st.ok()) {
+        st.toDavixError(err);
+    }
+    return retval;
+}
+
 int NeonRequest::endRequest(DavixError** err){
     if(!_standalone_req) {
       DavixError::setupError(err, davix_scope_http_request(), StatusCode::InvalidArgument, "Request not started");
@@ -66,6 +66,13 @@ public:
     //--------------------------------------------------------------------------
     virtual dav_ssize_t readBlock(char* buffer, dav_size_t max_size,DavixError** err);
 
+    //--------------------------------------------------------------------------
+    // Zero-copy read members - move a block of max_size bytes (at max) of the
+    // response body into fd, when the backend supports it.
+    //--------------------------------------------------------------------------
+    virtual bool canSpliceToFd(int fd) const;
+    virtual dav_ssize_t spliceBlockToFd(int fd, dav_size_t max_size, DavixError** err);
+
     //--------------------------------------------------------------------------
     // Start request.
     //--------------------------------------------------------------------------
@@ -127,6 +134,8 @@ private:
 
     bool _headers_configured;
     int _accepted_202_retries;
+    // a 417 answer was retried without the 100-continue expectation
+    bool _expect100_retried;
 
     ////////////////////////////////////////////
     // Private Members
@@ -27,6 +27,7 @@
 #include <utils/davix_uri.hpp>
 #include <neon/neonrequest.hpp>
 #include <core/SessionPool.hpp>
+#include <backend/Continue100Cache.hpp>
 
 namespace Davix {
 
@@ -69,6 +70,11 @@ public:
     //--------------------------------------------------------------------------
     bool getSessionCaching() const;
 
+    //--------------------------------------------------------------------------
+    // Outcome of the 100-continue handshakes with each host
+    //--------------------------------------------------------------------------
+    Continue100Cache& getContinue100Cache() { return _continue100_cache; }
+
 private:
     //--------------------------------------------------------------------------
     // Neon session pool
@@ -89,6 +95,7 @@ private:
     mutable std::mutex _session_caching_mtx;
     bool _session_caching;
 
+    Continue100Cache _continue100_cache;
 };
 
 std::string create_map_keys_from_URL(const std::string & protocol, const std::string &host, unsigned int port);
@@ -25,6 +25,7 @@
 #include <params/davixrequestparams.hpp>
 #include <libs/time_utils.h>
 #include <utils/davix_gcloud_utils.hpp>
+#include <params/davix_request_params_internal.hpp>
 
 
 
@@ -91,6 +92,10 @@ struct RequestParamsInternal{
         _s3_listing_mode(S3ListingMode::Hierarchical),
         _s3_max_key_entries(10000),
         _swift_listing_mode(SwiftListingMode::Hierarchical),
+        _s3_parallel_listing(false),
+        _listing_order(ListingOrder::Ordered),
+        _s3_listing_prefetch(false),
+        _stat_properties(StatProperty::All),
         _ca_path(),
         _x509_data(),
         _idlogpass(),
@@ -119,13 +124,28 @@ struct RequestParamsInternal{
         retry_delay(),
         _copy_mode(CopyMode::Push),
         _support_100continue(true),
+        _continue100_timeout(),
         _accepted_retry(180), // wait for half an hour by default
-        _accepted_delay(10)
+        _accepted_delay(10),
+        _write_buffer_size(DAVIX_DEFAULT_WRITE_BUFFER_SIZE),
+        _stat_on_open(true),
+        _upload_concurrency(DAVIX_DEFAULT_UPLOAD_CONCURRENCY),
+        _metadata_concurrency(DAVIX_DEFAULT_METADATA_CONCURRENCY),
+        _upload_part_size(0),
+        _multipart_threshold(DAVIX_DEFAULT_MULTIPART_THRESHOLD),
+        _upload_journal_dir(),
+        _verify_segment_checksums(false),
+        _mmap_uploads(false),
+        _transfer_checksum(),
+        _request_counter(NULL)
     {
         timespec_clear(&connexion_timeout);
         timespec_clear(&ops_timeout);
         connexion_timeout.tv_sec = DAVIX_DEFAULT_CONN_TIMEOUT;
         ops_timeout.tv_sec = DAVIX_DEFAULT_OPS_TIMEOUT;
+        timespec_clear(&_continue100_timeout);
+        _continue100_timeout.tv_sec = DAVIX_DEFAULT_100CONTINUE_TIMEOUT / 1000;
+        _continue100_timeout.tv_nsec = (DAVIX_DEFAULT_100CONTINUE_TIMEOUT % 1000) * 1000000;
     }
 
     virtual ~RequestParamsInternal(){
@@ -143,6 +163,10 @@ struct RequestParamsInternal{
         _s3_listing_mode(param_private._s3_listing_mode),
         _s3_max_key_entries(param_private._s3_max_key_entries),
         _swift_listing_mode(param_private._swift_listing_mode),
+        _s3_parallel_listing(param_private._s3_parallel_listing),
+        _listing_order(param_private._listing_order),
+        _s3_listing_prefetch(param_private._s3_listing_prefetch),
+        _stat_properties(param_private._stat_properties),
         _ca_path(param_private._ca_path),
         _x509_data(param_private._x509_data),
         _idlogpass(param_private._idlogpass),
@@ -171,11 +195,24 @@ struct RequestParamsInternal{
         retry_delay(param_private.retry_delay),
         _copy_mode(param_private._copy_mode),
         _support_100continue(param_private._support_100continue),
+        _continue100_timeout(),
         _accepted_retry(param_private._accepted_retry),
-        _accepted_delay(param_private._accepted_delay) {
+        _accepted_delay(param_private._accepted_delay),
+        _write_buffer_size(param_private._write_buffer_size),
+        _stat_on_open(param_private._stat_on_open),
+        _upload_concurrency(param_private._upload_concurrency),
+        _metadata_concurrency(param_private._metadata_concurrency),
+        _upload_part_size(param_private._upload_part_size),
+        _multipart_threshold(param_private._multipart_threshold),
+        _upload_journal_dir(param_private._upload_journal_dir),
+        _verify_segment_checksums(param_private._verify_segment_checksums),
+        _mmap_uploads(param_private._mmap_uploads),
+        _transfer_checksum(param_private._transfer_checksum),
+        _request_counter(param_private._request_counter) {
 
         timespec_copy(&(connexion_timeout), &(param_private.connexion_timeout));
         timespec_copy(&(ops_timeout), &(param_private.ops_timeout));
+        timespec_copy(&(_continue100_timeout), &(param_private._continue100_timeout));
     }
     bool _ssl_check; // ssl CA check
     bool _redirection; // redirection support
@@ -190,6 +227,16 @@ struct RequestParamsInternal{
     // Max number of keys returned by a S3 list bucket request
     unsigned long _s3_max_key_entries;
 
+    // list recursive S3 listings in parallel, and in which order to return their entries
+    bool _s3_parallel_listing;
+    ListingOrder::ListingOrder _listing_order;
+
+    // fetch the pages of S3 listings ahead of the caller
+    bool _s3_listing_prefetch;
+
+    // properties kept by stats and listings
+    unsigned int _stat_properties;
+
     // CA management
     std::vector<std::string> _ca_path;
 
@@ -247,12 +294,48 @@ struct RequestParamsInternal{
     // whether server has support for 100-Continue
     bool _support_100continue;
 
+    // wait for the 100 (Continue) answer before sending the body anyway
+    struct timespec _continue100_timeout;
+
     // number of retries in case davix receives 202-Accepted
     int _accepted_retry;
 
     // delay in seconds between retries in case davix receives 202-Accepted
     int _accepted_delay;
 
+    // in-memory buffer size of POSIX write-behind uploads
+    dav_size_t _write_buffer_size;
+
+    // check existence and size of a file when it is opened
+    bool _stat_on_open;
+
+    // number of parts sent concurrently by multi-part uploads
+    unsigned int _upload_concurrency;
+
+    // number of concurrent requests of bulk metadata operations
+    unsigned int _metadata_concurrency;
+
+    // part size of multi-part uploads, 0 for automatic
+    dav_size_t _upload_part_size;
+
+    // object size above which multi-part uploads are used
+    dav_size_t _multipart_threshold;
+
+    // directory of the journals of resumable multi-part uploads, disabled if empty
+    std::string _upload_journal_dir;
+
+    // check the etag of uploaded Swift segments
+    bool _verify_segment_checksums;
+
+    // upload regular files from a memory mapping
+    bool _mmap_uploads;
+
+    // checksum algorithm verifying whole file transfers, disabled if empty
+    std::string _transfer_checksum;
+
+    // counter of the HTTP requests sent with these parameters, not owned
+    std::atomic<dav_size_t>* _request_counter;
+
     // method
     inline void regenerateStateUid(){
         _state_uid = get_requeste_uid();
@@ -263,6 +346,17 @@ private:
 };
 
 
+void RequestParamsExplorer::setRequestCounter(RequestParams & params, std::atomic<dav_size_t>* counter){
+    params.d_ptr->_request_counter = counter;
+}
+
+void RequestParamsExplorer::countRequest(const RequestParams & params){
+    if(params.d_ptr->_request_counter != NULL){
+        *(params.d_ptr->_request_counter) += 1;
+    }
+}
+
+
 RequestParams::RequestParams() :
     d_ptr(new RequestParamsInternal())
 {
@@ -465,6 +559,38 @@ unsigned long RequestParams::getS3MaxKey() const{
     return d_ptr->_s3_max_key_entries;
 }
 
+void RequestParams::setS3ParallelListing(const bool parallel){
+    d_ptr->_s3_parallel_listing = parallel;
+}
+
+bool RequestParams::getS3ParallelListing() const{
+    return d_ptr->_s3_parallel_listing;
+}
+
+void RequestParams::setS3ListingPrefetch(const bool prefetch){
+    d_ptr->_s3_listing_prefetch = prefetch;
+}
+
+bool RequestParams::getS3ListingPrefetch() const{
+    return d_ptr->_s3_listing_prefetch;
+}
+
+void RequestParams::setListingOrder(const ListingOrder::ListingOrder order){
+    d_ptr->_listing_order = order;
+}
+
+ListingOrder::ListingOrder RequestParams::getListingOrder() const{
+    return d_ptr->_listing_order;
+}
+
+void RequestParams::setStatProperties(const unsigned int properties){
+    d_ptr->_stat_properties = properties;
+}
+
+unsigned int RequestParams::getStatProperties() const{
+    return d_ptr->_stat_properties;
+}
+
 void RequestParams::addCertificateAuthorityPath(const std::string &path){
     d_ptr->regenerateStateUid();
     d_ptr->_ca_path.push_back(path);
@@ -609,6 +735,14 @@ bool RequestParams::get100ContinueSupport() const {
   return d_ptr->_support_100continue;
 }
 
+void RequestParams::set100ContinueTimeout(struct timespec *timeout) {
+  timespec_copy(&(d_ptr->_continue100_timeout), timeout);
+}
+
+const struct timespec* RequestParams::get100ContinueTimeout() const {
+  return &d_ptr->_continue100_timeout;
+}
+
 int RequestParams::getAcceptedRetry() const {
   return d_ptr->_accepted_retry;
 }
@@ -625,6 +759,86 @@ void RequestParams::setAcceptedRetryDelay(int delay) {
   d_ptr->_accepted_delay = delay;
 }
 
+void RequestParams::setWriteBufferSize(const dav_size_t size) {
+  d_ptr->_write_buffer_size = size;
+}
+
+dav_size_t RequestParams::getWriteBufferSize() const {
+  return d_ptr->_write_buffer_size;
+}
+
+void RequestParams::setStatOnOpen(const bool value) {
+  d_ptr->_stat_on_open = value;
+}
+
+bool RequestParams::getStatOnOpen() const {
+  return d_ptr->_stat_on_open;
+}
+
+void RequestParams::setUploadConcurrency(const unsigned int parts) {
+  d_ptr->_upload_concurrency = parts;
+}
+
+unsigned int RequestParams::getUploadConcurrency() const {
+  return d_ptr->_upload_concurrency;
+}
+
+void RequestParams::setMetadataConcurrency(const unsigned int requests) {
+  d_ptr->_metadata_concurrency = requests;
+}
+
+unsigned int RequestParams::getMetadataConcurrency() const {
+  return d_ptr->_metadata_concurrency;
+}
+
+void RequestParams::setUploadPartSize(const dav_size_t size) {
+  d_ptr->_upload_part_size = size;
+}
+
+dav_size_t RequestParams::getUploadPartSize() const {
+  return d_ptr->_upload_part_size;
+}
+
+void RequestParams::setMultipartThreshold(const dav_size_t size) {
+  d_ptr->_multipart_threshold = size;
+}
+
+dav_size_t RequestParams::getMultipartThreshold() const {
+  return d_ptr->_multipart_threshold;
+}
+
+void RequestParams::setUploadJournalDir(const std::string & dir) {
+  d_ptr->_upload_journal_dir = dir;
+}
+
+const std::string & RequestParams::getUploadJournalDir() const {
+  return d_ptr->_upload_journal_dir;
+}
+
+void RequestParams::setVerifySegmentChecksums(const bool verify) {
+  d_ptr->_verify_segment_checksums = verify;
+}
+
+bool RequestParams::getVerifySegmentChecksums() const {
+  return d_ptr->_verify_segment_checksums;
+}
+
+void RequestParams::setMmapUploads(const bool value) {
+  d_ptr->_mmap_uploads = value;
+}
+
+bool RequestParams::getMmapUploads() const {
+  return d_ptr->_mmap_uploads;
+}
+
+void RequestParams::setTransferChecksum(const std::string & algorithm) {
+  d_ptr->_transfer_checksum = algorithm;
+}
+
+const std::string & RequestParams::getTransferChecksum() const {
+  return d_ptr->_transfer_checksum;
+}
+
 // suppress useless warning
 #pragma GCC diagnostic ignored "-Wint-to-pointer-cast"
 void* RequestParams::getParmState() const{
@@ -58,6 +58,21 @@ static std::string help_msg(const std::string & cmd_path){
 }
 
 
+// read a stream which can only be consumed once
+static DataProviderFun streamProvider(int fd){
+    std::shared_ptr<bool> consumed = std::make_shared<bool>(false);
+    return [fd, consumed](void* buffer, dav_size_t max_size) -> dav_ssize_t {
+        if(max_size == 0){
+            return (*consumed)?(-1):0;
+        }
+        *consumed = true;
+
+        ssize_t ret;
+        while((ret = read(fd, buffer, max_size)) < 0 && errno == EINTR);
+        return (ret < 0)?(-errno):ret;
+    };
+}
+
 static int execute_put(Context& c, const Tool::OptParams & opts, int fd, DavixError** err){
         const std::string &  src_file = opts.input_file_path;
         const std::string &  dst_file = opts.vec_arg[1];
@@ -72,6 +87,11 @@ static int execute_put(Context& c, const Tool::OptParams & opts, int fd, DavixEr
                     f.put(&opts.params, fd, static_cast<dav_size_t>(st.st_size));
                     return 0;
             }
+            if( S_ISFIFO(st.st_mode) || S_ISCHR(st.st_mode) || S_ISSOCK(st.st_mode)){
+                    // pipes and terminals: stream the data, its size is unknown
+                    f.put(&opts.params, streamProvider(fd));
+                    return 0;
+            }
             throw DavixException(scope_put, StatusCode::SystemError, std::string(src_file).append("is not a valid regular file"));
       }CATCH_DAVIX(err);
       return -1;
@@ -27,6 +27,7 @@
 #include <tools/davix_op.hpp>
 #include <tools/davix_thread_pool.hpp>
 #include <utils/davix_logger_internal.hpp>
+#include <utils/davix_s3_utils.hpp>
 #include <cstdio>
 #include <fstream>
 
@@ -42,11 +43,6 @@ using namespace std;
 
 const std::string scope_main = "Davix::Tools::davix-rm";
 
-const std::string openTag_req = "<Delete>";
-const std::string closeTag_req = "</Delete>";
-const std::string openTags_entry = "<Object><Key>";
-const std::string closeTags_entry = "</Key></Object>";
-
 std::string  get_base_rm_options(){
     return "  Delete Options:\n"
            "\t-r NUMBER_OF_THREADS:     Remove contents recursively, also works on S3 objects for storage systems that supports multi-objects deletion.\n"
@@ -67,10 +63,9 @@ static int populateTaskQueue(Context& c, const Tool::OptParams & opts, std::stri
     DavixError* tmp_err=NULL;
     struct stat st;
     struct dirent* d;
-    int counter = 0;
     int entry_counter = 0;
-    std::string protocol, host;
-    std::string buffer(openTag_req);
+    std::string protocol;
+    std::vector<std::string> urls;
 
     if( (fd = pos.opendirpp(&opts.params, opts.vec_arg[0], &tmp_err)) == NULL){
         DavixError::propagateError(err, tmp_err);
@@ -78,13 +73,16 @@ static int populateTaskQueue(Context& c, const Tool::OptParams & opts, std::stri
     }
 
     if(opts.vec_arg[0].compare(2,1,"s") == 0){
-        protocol = "s3s://";
+        protocol = "s3s";
     }
     else{
-        protocol = "s3://";
+        protocol = "s3";
     }
 
-    host = protocol + Uri(uri).getHost();
+    // listed entries are keys of the bucket
+    Uri root(uri);
+    root.setProtocol(protocol);
+    root.setPath(opts.params.getAwsAlternate() ? "/" + S3::extract_s3_bucket(root, true) + "/" : std::string("/"));
 
     while( (d = pos.readdirpp(fd, &st, &tmp_err)) != NULL ){
         // for every entry
@@ -92,41 +90,29 @@ static int populateTaskQueue(Context& c, const Tool::OptParams & opts, std::stri
         //TODO: unless user has turned on rr mode, skip entries that end with a '/'?
         //that way we can provide a way to just delete files inside the directory and not the other directories
 
-        // format to xml and push to buffer string, for every n entries, create a DeleteOp(PostRequest)
-        std::string entry(d->d_name);
-
-        // for each entry, <Object><Key>entry</Key></Object>
-        buffer += openTags_entry + entry + closeTags_entry;
-        counter++;
+        // keys are listed unescaped, '%', '?' or '#' are part of them
+        urls.push_back(root.getString() + Uri::escapeString(d->d_name));
         entry_counter++;
 
         // although the S3 API supports up to 1000 keys per request, in practice this will most likely results in a 504 gateway timeout
-        if(counter == opts.s3_delete_per_request){ // default is set to 20, just to be safe
-            buffer += closeTag_req;
-
-
+        if(urls.size() == (size_t) opts.s3_delete_per_request){ // default is set to 20, just to be safe
             // push op to task queue
-            DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CORE, "Adding item to work queue, target is {}.", host);
+            DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CORE, "Adding item to work queue, target is {}.", root);
 
-            DeleteOp* op = new DeleteOp(opts, host, c, buffer);
+            DeleteOp* op = new DeleteOp(opts, root.getString(), c, urls);
             tq->pushOp(op);
-
-            counter = 0;
-            buffer.clear();
-            buffer = openTag_req;
+            urls.clear();
         }
 
         if(!opts.debug)
                 Tool::batchTransferMonitor(uri, "Multi-objects delete ", entry_counter, 0);
     }
-    // check if there is still anything in buffer for remainder entries
-    if(!buffer.empty()){
-        buffer += closeTag_req;
-
+    // remainder entries
+    if(!urls.empty()){
         // push op to task queue
-        DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CORE, "Adding item to work queue, target is {}.", host);
+        DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_CORE, "Adding item to work queue, target is {}.", root);
 
-        DeleteOp* op = new DeleteOp(opts, host, c, buffer);
+        DeleteOp* op = new DeleteOp(opts, root.getString(), c, urls);
         tq->pushOp(op);
     }
 
@@ -0,0 +1,126 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "checksum_calculator.hpp"
+#include <utils/stringutils.hpp>
+#include <openssl/md5.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace Davix {
+
+static std::string hex32(uint32_t value) {
+  char out[9];
+  snprintf(out, sizeof(out), "%08x", value);
+  return out;
+}
+
+class Adler32Calculator : public ChecksumCalculator {
+public:
+  Adler32Calculator(const std::string &algorithm) : ChecksumCalculator(algorithm), _value(Checksum::ADLER32_INIT) {}
+
+  void update(const char* data, size_t len) { _value = Checksum::adler32(_value, data, len); }
+  void reset() { _value = Checksum::ADLER32_INIT; }
+  std::string digest() const { return hex32(_value); }
+
+private:
+  uint32_t _value;
+};
+
+class Crc32cCalculator : public ChecksumCalculator {
+public:
+  Crc32cCalculator(const std::string &algorithm) : ChecksumCalculator(algorithm), _value(Checksum::CRC32C_INIT) {}
+
+  void update(const char* data, size_t len) { _value = Checksum::crc32c(_value, data, len); }
+  void reset() { _value = Checksum::CRC32C_INIT; }
+  std::string digest() const { return hex32(_value); }
+
+private:
+  uint32_t _value;
+};
+
+class Md5Calculator : public ChecksumCalculator {
+public:
+  Md5Calculator(const std::string &algorithm) : ChecksumCalculator(algorithm) { reset(); }
+
+  void update(const char* data, size_t len) { MD5_Update(&_ctx, data, len); }
+  void reset() { MD5_Init(&_ctx); }
+
+  std::string digest() const {
+    // finalize a copy, more data may come
+    MD5_CTX ctx = _ctx;
+    unsigned char md[MD5_DIGEST_LENGTH];
+    MD5_Final(md, &ctx);
+
+    std::string out;
+    for(size_t i = 0; i < MD5_DIGEST_LENGTH; i++) {
+      char byte[3];
+      snprintf(byte, sizeof(byte), "%02x", md[i]);
+      out.append(byte);
+    }
+    return out;
+  }
+
+private:
+  MD5_CTX _ctx;
+};
+
+ChecksumCalculator* ChecksumCalculator::create(const std::string &algorithm) {
+  if(StrUtil::compare_ncase(algorithm, "adler32") == 0) {
+    return new Adler32Calculator(algorithm);
+  }
+  if(StrUtil::compare_ncase(algorithm, "crc32c") == 0) {
+    return new Crc32cCalculator(algorithm);
+  }
+  if(StrUtil::compare_ncase(algorithm, "md5") == 0) {
+    return new Md5Calculator(algorithm);
+  }
+  return NULL;
+}
+
+bool ChecksumCalculator::matches(const std::string &remote) const {
+  const std::string local = digest();
+
+  std::string value(remote);
+  value.erase(std::remove(value.begin(), value.end(), '"'), value.end());
+
+  // raw MD5, e.g. decoded from Content-MD5
+  if(local.size() == 2 * MD5_DIGEST_LENGTH && value.size() == MD5_DIGEST_LENGTH) {
+    std::string hex;
+    for(size_t i = 0; i < value.size(); i++) {
+      char byte[3];
+      snprintf(byte, sizeof(byte), "%02x", (unsigned char) value[i]);
+      hex.append(byte);
+    }
+    value = hex;
+  }
+
+  // 32 bit checksums are sometimes reported without their leading zeros
+  if(local.size() == 8) {
+    char* end = NULL;
+    unsigned long remoteValue = strtoul(value.c_str(), &end, 16);
+    return !value.empty() && *end == '\0' && remoteValue == strtoul(local.c_str(), NULL, 16);
+  }
+
+  return StrUtil::compare_ncase(local, value) == 0;
+}
+
+}
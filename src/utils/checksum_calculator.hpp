@@ -0,0 +1,94 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_UTILS_CHECKSUM_CALCULATOR_HPP
+#define DAVIX_UTILS_CHECKSUM_CALCULATOR_HPP
+
+#include <davix_internal.hpp>
+#include <stdint.h>
+#include <string>
+
+namespace Davix {
+
+namespace Checksum {
+
+//------------------------------------------------------------------------------
+// Update a running adler32 / CRC32C with len bytes of data. Start from
+// ADLER32_INIT / CRC32C_INIT. Uses the SIMD / hardware implementation
+// supported by the CPU, see checksum_kernels.hpp.
+//------------------------------------------------------------------------------
+const uint32_t ADLER32_INIT = 1;
+const uint32_t CRC32C_INIT = 0;
+
+uint32_t adler32(uint32_t adler, const char* data, size_t len);
+uint32_t crc32c(uint32_t crc, const char* data, size_t len);
+
+}
+
+//------------------------------------------------------------------------------
+// Incremental checksum of a data stream, fed while the data goes through
+// the I/O path so that verifying a transfer does not need a second pass.
+//------------------------------------------------------------------------------
+class ChecksumCalculator : NonCopyable {
+public:
+  virtual ~ChecksumCalculator() {}
+
+  //----------------------------------------------------------------------------
+  // Create a calculator for the given algorithm: adler32, md5 or crc32c, case
+  // insensitive. Return NULL if the algorithm is not supported.
+  //----------------------------------------------------------------------------
+  static ChecksumCalculator* create(const std::string &algorithm);
+
+  //----------------------------------------------------------------------------
+  // Add len bytes of data to the checksum
+  //----------------------------------------------------------------------------
+  virtual void update(const char* data, size_t len) = 0;
+
+  //----------------------------------------------------------------------------
+  // Start over, e.g. when the data is sent again
+  //----------------------------------------------------------------------------
+  virtual void reset() = 0;
+
+  //----------------------------------------------------------------------------
+  // Checksum of the data so far, as lowercase hex digits
+  //----------------------------------------------------------------------------
+  virtual std::string digest() const = 0;
+
+  //----------------------------------------------------------------------------
+  // Algorithm name, as given to create()
+  //----------------------------------------------------------------------------
+  const std::string & getAlgorithm() const { return _algorithm; }
+
+  //----------------------------------------------------------------------------
+  // Compare a digest with the one reported by a server, which may use another
+  // encoding: raw MD5 bytes, missing leading zeros, uppercase hex digits.
+  //----------------------------------------------------------------------------
+  bool matches(const std::string &remote) const;
+
+protected:
+  ChecksumCalculator(const std::string &algorithm) : _algorithm(algorithm) {}
+
+private:
+  std::string _algorithm;
+};
+
+}
+
+#endif // DAVIX_UTILS_CHECKSUM_CALCULATOR_HPP
@@ -0,0 +1,437 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "checksum_kernels.hpp"
+#include "checksum_calculator.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define DAVIX_CHECKSUM_X86_KERNELS
+#include <immintrin.h>
+#endif
+
+namespace Davix {
+
+namespace Checksum {
+
+//------------------------------------------------------------------------------
+// adler32, as in RFC 1950
+//------------------------------------------------------------------------------
+static const uint32_t ADLER_BASE = 65521;
+
+// largest n such that 255n(n+1)/2 + (n+1)(BASE-1) fits in 32 bits, the
+// sums only need a modulo every NMAX bytes
+static const size_t ADLER_NMAX = 5552;
+
+uint32_t adler32Portable(uint32_t adler, const char* data, size_t len) {
+  const unsigned char* buf = reinterpret_cast<const unsigned char*>(data);
+  uint32_t a = adler & 0xffff;
+  uint32_t b = adler >> 16;
+
+  while(len > 0) {
+    size_t n = std::min(len, ADLER_NMAX);
+    len -= n;
+
+    while(n >= 8) {
+      a += buf[0]; b += a;
+      a += buf[1]; b += a;
+      a += buf[2]; b += a;
+      a += buf[3]; b += a;
+      a += buf[4]; b += a;
+      a += buf[5]; b += a;
+      a += buf[6]; b += a;
+      a += buf[7]; b += a;
+      buf += 8;
+      n -= 8;
+    }
+
+    while(n-- > 0) {
+      a += *buf++;
+      b += a;
+    }
+
+    a %= ADLER_BASE;
+    b %= ADLER_BASE;
+  }
+
+  return (b << 16) | a;
+}
+
+//------------------------------------------------------------------------------
+// CRC32C (Castagnoli, reflected polynomial 0x82f63b78)
+//------------------------------------------------------------------------------
+static const uint32_t CRC32C_POLY = 0x82f63b78;
+
+// interleaved hardware CRC32C works on three streams of these sizes
+static const size_t CRC32C_LONG = 8192;
+static const size_t CRC32C_SHORT = 256;
+
+// multiply a vector by a 32x32 matrix over GF(2)
+static uint32_t gf2MatrixTimes(const uint32_t* mat, uint32_t vec) {
+  uint32_t sum = 0;
+  while(vec) {
+    if(vec & 1) sum ^= *mat;
+    vec >>= 1;
+    mat++;
+  }
+  return sum;
+}
+
+static void gf2MatrixSquare(uint32_t* square, const uint32_t* mat) {
+  for(int n = 0; n < 32; n++) {
+    square[n] = gf2MatrixTimes(mat, mat[n]);
+  }
+}
+
+// operator appending len zero bytes to a CRC32C register, len must be a
+// power of two: the squarings below stop at its highest bit and ignore the
+// lower ones
+static void crc32cZerosOperator(uint32_t* even, size_t len) {
+  assert(len != 0 && (len & (len - 1)) == 0);
+  uint32_t odd[32];
+
+  // one zero bit
+  odd[0] = CRC32C_POLY;
+  uint32_t row = 1;
+  for(int n = 1; n < 32; n++) {
+    odd[n] = row;
+    row <<= 1;
+  }
+
+  gf2MatrixSquare(even, odd); // two zero bits
+  gf2MatrixSquare(odd, even); // four zero bits
+
+  // eight zero bits, then squares while len has bits left
+  do {
+    gf2MatrixSquare(even, odd);
+    len >>= 1;
+    if(len == 0) return;
+    gf2MatrixSquare(odd, even);
+    len >>= 1;
+  } while(len);
+
+  for(int n = 0; n < 32; n++) {
+    even[n] = odd[n];
+  }
+}
+
+struct Crc32cTables {
+  // slicing by 8
+  uint32_t table[8][256];
+
+  // shifts of a register by CRC32C_LONG / CRC32C_SHORT zero bytes
+  uint32_t longShift[4][256];
+  uint32_t shortShift[4][256];
+
+  Crc32cTables() {
+    for(uint32_t i = 0; i < 256; i++) {
+      uint32_t crc = i;
+      for(int k = 0; k < 8; k++) {
+        crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLY : crc >> 1;
+      }
+      table[0][i] = crc;
+    }
+
+    for(uint32_t i = 0; i < 256; i++) {
+      for(int t = 1; t < 8; t++) {
+        table[t][i] = (table[t - 1][i] >> 8) ^ table[0][table[t - 1][i] & 0xff];
+      }
+    }
+
+    fillShift(longShift, CRC32C_LONG);
+    fillShift(shortShift, CRC32C_SHORT);
+  }
+
+  static void fillShift(uint32_t shift[4][256], size_t len) {
+    uint32_t op[32];
+    crc32cZerosOperator(op, len);
+    for(uint32_t n = 0; n < 256; n++) {
+      shift[0][n] = gf2MatrixTimes(op, n);
+      shift[1][n] = gf2MatrixTimes(op, n << 8);
+      shift[2][n] = gf2MatrixTimes(op, n << 16);
+      shift[3][n] = gf2MatrixTimes(op, n << 24);
+    }
+  }
+};
+
+static const Crc32cTables crc32cTables;
+
+uint32_t crc32cPortable(uint32_t crc, const char* data, size_t len) {
+  const unsigned char* buf = reinterpret_cast<const unsigned char*>(data);
+  const uint32_t (*t)[256] = crc32cTables.table;
+  crc = ~crc;
+
+  while(len >= 8) {
+    uint32_t lo = crc ^ (buf[0] | (buf[1] << 8) | (buf[2] << 16) | ((uint32_t) buf[3] << 24));
+    uint32_t hi = buf[4] | (buf[5] << 8) | (buf[6] << 16) | ((uint32_t) buf[7] << 24);
+    crc = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+          t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
+    buf += 8;
+    len -= 8;
+  }
+
+  while(len-- > 0) {
+    crc = (crc >> 8) ^ t[0][(crc ^ *buf++) & 0xff];
+  }
+
+  return ~crc;
+}
+
+#ifdef DAVIX_CHECKSUM_X86_KERNELS
+
+//------------------------------------------------------------------------------
+// adler32 with SSSE3: 32 bytes per step, s1 from sums of absolute
+// differences, s2 from multiply-adds with the byte weights 32 .. 1
+//------------------------------------------------------------------------------
+__attribute__((target("ssse3")))
+static uint32_t adler32Ssse3(uint32_t adler, const char* data, size_t len) {
+  const unsigned char* buf = reinterpret_cast<const unsigned char*>(data);
+  uint32_t s1 = adler & 0xffff;
+  uint32_t s2 = adler >> 16;
+
+  const size_t BLOCK = 32;
+  size_t blocks = len / BLOCK;
+  len -= blocks * BLOCK;
+
+  const __m128i tap1 = _mm_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17);
+  const __m128i tap2 = _mm_setr_epi8(16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ones = _mm_set1_epi16(1);
+
+  while(blocks) {
+    size_t n = std::min(blocks, ADLER_NMAX / BLOCK);
+    blocks -= n;
+
+    // s1 of the previous blocks is added to s2 once per byte of each block
+    __m128i vps = _mm_set_epi32(0, 0, 0, s1 * n);
+    __m128i vs2 = _mm_set_epi32(0, 0, 0, s2);
+    __m128i vs1 = _mm_setzero_si128();
+
+    do {
+      const __m128i bytes1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf));
+      const __m128i bytes2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(buf + 16));
+
+      vps = _mm_add_epi32(vps, vs1);
+
+      vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(bytes1, zero));
+      vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(bytes1, tap1), ones));
+      vs1 = _mm_add_epi32(vs1, _mm_sad_epu8(bytes2, zero));
+      vs2 = _mm_add_epi32(vs2, _mm_madd_epi16(_mm_maddubs_epi16(bytes2, tap2), ones));
+
+      buf += BLOCK;
+    } while(--n);
+
+    vs2 = _mm_add_epi32(vs2, _mm_slli_epi32(vps, 5));
+
+    // horizontal sums
+    vs1 = _mm_add_epi32(vs1, _mm_shuffle_epi32(vs1, _MM_SHUFFLE(1, 0, 3, 2)));
+    s1 += _mm_cvtsi128_si32(vs1);
+    vs2 = _mm_add_epi32(vs2, _mm_shuffle_epi32(vs2, _MM_SHUFFLE(2, 3, 0, 1)));
+    vs2 = _mm_add_epi32(vs2, _mm_shuffle_epi32(vs2, _MM_SHUFFLE(1, 0, 3, 2)));
+    s2 = _mm_cvtsi128_si32(vs2);
+
+    s1 %= ADLER_BASE;
+    s2 %= ADLER_BASE;
+  }
+
+  return adler32Portable((s2 << 16) | s1, reinterpret_cast<const char*>(buf), len);
+}
+
+//------------------------------------------------------------------------------
+// adler32 with AVX2, same scheme as SSSE3 on 64 bytes per step
+//------------------------------------------------------------------------------
+__attribute__((target("avx2")))
+static uint32_t adler32Avx2(uint32_t adler, const char* data, size_t len) {
+  const unsigned char* buf = reinterpret_cast<const unsigned char*>(data);
+  uint32_t s1 = adler & 0xffff;
+  uint32_t s2 = adler >> 16;
+
+  const size_t BLOCK = 64;
+  size_t blocks = len / BLOCK;
+  len -= blocks * BLOCK;
+
+  const __m256i tap1 = _mm256_setr_epi8(64, 63, 62, 61, 60, 59, 58, 57, 56, 55, 54, 53, 52, 51, 50, 49,
+                                        48, 47, 46, 45, 44, 43, 42, 41, 40, 39, 38, 37, 36, 35, 34, 33);
+  const __m256i tap2 = _mm256_setr_epi8(32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17,
+                                        16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1);
+  const __m256i zero = _mm256_setzero_si256();
+  const __m256i ones = _mm256_set1_epi16(1);
+
+  while(blocks) {
+    size_t n = std::min(blocks, ADLER_NMAX / BLOCK);
+    blocks -= n;
+
+    __m256i vps = _mm256_set_epi32(0, 0, 0, 0, 0, 0, 0, s1 * n);
+    __m256i vs2 = _mm256_set_epi32(0, 0, 0, 0, 0, 0, 0, s2);
+    __m256i vs1 = _mm256_setzero_si256();
+
+    do {
+      const __m256i bytes1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buf));
+      const __m256i bytes2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(buf + 32));
+
+      vps = _mm256_add_epi32(vps, vs1);
+
+      vs1 = _mm256_add_epi32(vs1, _mm256_add_epi64(_mm256_sad_epu8(bytes1, zero), _mm256_sad_epu8(bytes2, zero)));
+      // the 16 bit products of a single tap can't overflow, sum them as 32 bit
+      vs2 = _mm256_add_epi32(vs2, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes1, tap1), ones));
+      vs2 = _mm256_add_epi32(vs2, _mm256_madd_epi16(_mm256_maddubs_epi16(bytes2, tap2), ones));
+
+      buf += BLOCK;
+    } while(--n);
+
+    vs2 = _mm256_add_epi32(vs2, _mm256_slli_epi32(vps, 6));
+
+    // horizontal sums, fold the upper half first
+    __m128i hs1 = _mm_add_epi32(_mm256_castsi256_si128(vs1), _mm256_extracti128_si256(vs1, 1));
+    hs1 = _mm_add_epi32(hs1, _mm_shuffle_epi32(hs1, _MM_SHUFFLE(1, 0, 3, 2)));
+    s1 += _mm_cvtsi128_si32(hs1);
+
+    __m128i hs2 = _mm_add_epi32(_mm256_castsi256_si128(vs2), _mm256_extracti128_si256(vs2, 1));
+    hs2 = _mm_add_epi32(hs2, _mm_shuffle_epi32(hs2, _MM_SHUFFLE(2, 3, 0, 1)));
+    hs2 = _mm_add_epi32(hs2, _mm_shuffle_epi32(hs2, _MM_SHUFFLE(1, 0, 3, 2)));
+    s2 = _mm_cvtsi128_si32(hs2);
+
+    s1 %= ADLER_BASE;
+    s2 %= ADLER_BASE;
+  }
+
+  return adler32Portable((s2 << 16) | s1, reinterpret_cast<const char*>(buf), len);
+}
+
+//------------------------------------------------------------------------------
+// CRC32C with the SSE4.2 crc32 instruction. The instruction has a latency of
+// three cycles but a throughput of one per cycle: three independent streams
+// are interleaved, then combined by shifting the registers over the bytes
+// that follow them.
+//------------------------------------------------------------------------------
+static inline uint32_t crc32cShift(const uint32_t shift[4][256], uint32_t crc) {
+  return shift[0][crc & 0xff] ^ shift[1][(crc >> 8) & 0xff] ^ shift[2][(crc >> 16) & 0xff] ^ shift[3][crc >> 24];
+}
+
+__attribute__((target("sse4.2")))
+static inline uint64_t crc32cWord(uint64_t crc, const unsigned char* p) {
+  uint64_t v;
+  memcpy(&v, p, sizeof(v));
+  return _mm_crc32_u64(crc, v);
+}
+
+__attribute__((target("sse4.2")))
+static const unsigned char* crc32cInterleaved(uint64_t &crc0, const unsigned char* next, size_t &len,
+                                              size_t stream, const uint32_t shift[4][256]) {
+  while(len >= 3 * stream) {
+    uint64_t crc1 = 0;
+    uint64_t crc2 = 0;
+    const unsigned char* end = next + stream;
+    do {
+      crc0 = crc32cWord(crc0, next);
+      crc1 = crc32cWord(crc1, next + stream);
+      crc2 = crc32cWord(crc2, next + 2 * stream);
+      next += 8;
+    } while(next < end);
+
+    crc0 = crc32cShift(shift, crc0) ^ crc1;
+    crc0 = crc32cShift(shift, crc0) ^ crc2;
+    next += 2 * stream;
+    len -= 3 * stream;
+  }
+  return next;
+}
+
+__attribute__((target("sse4.2")))
+static uint32_t crc32cSse42(uint32_t crc, const char* data, size_t len) {
+  const unsigned char* next = reinterpret_cast<const unsigned char*>(data);
+  uint64_t crc0 = ~crc;
+
+  // align to eight bytes
+  while(len && (reinterpret_cast<uintptr_t>(next) & 7) != 0) {
+    crc0 = _mm_crc32_u8(crc0, *next);
+    next++;
+    len--;
+  }
+
+  next = crc32cInterleaved(crc0, next, len, CRC32C_LONG, crc32cTables.longShift);
+  next = crc32cInterleaved(crc0, next, len, CRC32C_SHORT, crc32cTables.shortShift);
+
+  while(len >= 8) {
+    crc0 = crc32cWord(crc0, next);
+    next += 8;
+    len -= 8;
+  }
+
+  while(len) {
+    crc0 = _mm_crc32_u8(crc0, *next);
+    next++;
+    len--;
+  }
+
+  return ~static_cast<uint32_t>(crc0);
+}
+
+#endif // DAVIX_CHECKSUM_X86_KERNELS
+
+KernelList adler32Kernels() {
+  KernelList kernels;
+  kernels.push_back(std::make_pair(std::string("portable"), &adler32Portable));
+
+#ifdef DAVIX_CHECKSUM_X86_KERNELS
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("ssse3")) {
+    kernels.push_back(std::make_pair(std::string("ssse3"), &adler32Ssse3));
+  }
+  if(__builtin_cpu_supports("avx2")) {
+    kernels.push_back(std::make_pair(std::string("avx2"), &adler32Avx2));
+  }
+#endif
+
+  return kernels;
+}
+
+KernelList crc32cKernels() {
+  KernelList kernels;
+  kernels.push_back(std::make_pair(std::string("portable"), &crc32cPortable));
+
+#ifdef DAVIX_CHECKSUM_X86_KERNELS
+  __builtin_cpu_init();
+  if(__builtin_cpu_supports("sse4.2")) {
+    kernels.push_back(std::make_pair(std::string("sse4.2"), &crc32cSse42));
+  }
+#endif
+
+  return kernels;
+}
+
+//------------------------------------------------------------------------------
+// Runtime dispatch, resolved on first use
+//------------------------------------------------------------------------------
+uint32_t adler32(uint32_t adler, const char* data, size_t len) {
+  static const Kernel kernel = adler32Kernels().back().second;
+  return kernel(adler, data, len);
+}
+
+uint32_t crc32c(uint32_t crc, const char* data, size_t len) {
+  static const Kernel kernel = crc32cKernels().back().second;
+  return kernel(crc, data, len);
+}
+
+}
+
+}
@@ -0,0 +1,57 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef DAVIX_UTILS_CHECKSUM_KERNELS_HPP
+#define DAVIX_UTILS_CHECKSUM_KERNELS_HPP
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Davix {
+
+namespace Checksum {
+
+//------------------------------------------------------------------------------
+// Implementations of the 32 bit checksums. Checksum::adler32 and
+// Checksum::crc32c dispatch to the fastest one supported by the CPU, picked
+// once at first use.
+//------------------------------------------------------------------------------
+typedef uint32_t (*Kernel)(uint32_t value, const char* data, size_t len);
+typedef std::vector<std::pair<std::string, Kernel> > KernelList;
+
+//------------------------------------------------------------------------------
+// Portable implementations, available everywhere
+//------------------------------------------------------------------------------
+uint32_t adler32Portable(uint32_t adler, const char* data, size_t len);
+uint32_t crc32cPortable(uint32_t crc, const char* data, size_t len);
+
+//------------------------------------------------------------------------------
+// Kernels usable on this CPU, from the slowest to the fastest
+//------------------------------------------------------------------------------
+KernelList adler32Kernels();
+KernelList crc32cKernels();
+
+}
+
+}
+
+#endif // DAVIX_UTILS_CHECKSUM_KERNELS_HPP
@@ -445,10 +445,23 @@ Uri tokenizeRequest(const RequestParams & params, const std::string & method, co
 
 
 Uri s3UriTransformer(const Uri & original_url, const RequestParams & params, const bool addDelimiter){
-    std::string delimiter = "&delimiter=%2F";
-    std::string prefix = "?prefix=";
-    std::string maxKey = "&max-keys=";
+    std::string prefix;
 
+    if(!original_url.getPath().empty()){    // there is something after '/', grab it
+        prefix = extract_s3_path(original_url, params.getAwsAlternate());
+
+        // if prefix doesn't end with '/', add one to handle query on folder
+        if(prefix.compare(prefix.size()-1,1,"/") != 0)
+             prefix += "/";
+
+        prefix.erase(0,1);
+    }
+
+    return s3ListingUri(original_url, params, prefix, addDelimiter, std::string());
+}
+
+Uri s3ListingUri(const Uri & original_url, const RequestParams & params, const std::string & prefix,
+                 const bool addDelimiter, const std::string & marker){
     std::string protocol;
 
     const std::string url_string = original_url.getString();
@@ -473,23 +486,16 @@ Uri s3UriTransformer(const Uri & original_url, const RequestParams & params, con
         ss << extract_s3_bucket(original_url, params.getAwsAlternate()) << "/";
     }
 
-    if(!original_url.getPath().empty()){    // there is something after '/', grab it
-        std::string tmp = extract_s3_path(original_url, params.getAwsAlternate());
-
-        // if prefix doesn't end with '/', add one to handle query on folder
-        if(tmp.compare(tmp.size()-1,1,"/") != 0)
-             tmp += "/";
-
-        tmp.erase(0,1);
-        prefix +=  Uri::queryParamEscape(tmp);
-    }
-
-    ss << prefix << maxKey << params.getS3MaxKey();
+    ss << "?prefix=" << Uri::queryParamEscape(prefix) << "&max-keys=" << params.getS3MaxKey();
 
     // skip delimiter if where we want to list everything after a certain prefix,
     // useful in cases like GET Collection
     if(addDelimiter)
-        ss << delimiter;
+        ss << "&delimiter=%2F";
+
+    // resume a listing after the given key
+    if(!marker.empty())
+        ss << "&marker=" << Uri::queryParamEscape(marker);
 
     return Uri(ss.str());
 }
@@ -0,0 +1,102 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include "S3MultiPartListParser.hpp"
+#include <utils/stringutils.hpp>
+
+namespace Davix {
+
+S3MultiPartListParser::S3MultiPartListParser() : truncated(false) {
+
+}
+
+S3MultiPartListParser::~S3MultiPartListParser(){
+}
+
+
+int S3MultiPartListParser::parserStartElemCb(int parent, const char *nspace, const char *name, const char **atts){
+    (void) parent;
+    (void) nspace;
+    (void) atts;
+
+    const std::string elem(name);
+    if(elem == "Part") {
+        parts.push_back(Part());
+    }
+    else if(elem == "Upload") {
+        uploads.push_back(Upload());
+    }
+
+    cdata.clear();
+    return 1;
+}
+
+int S3MultiPartListParser::parserCdataCb(int state, const char *data, size_t len){
+    (void) state;
+
+    cdata.append(data, len);
+    return 0;
+}
+
+int S3MultiPartListParser::parserEndElemCb(int state, const char *nspace, const char *name){
+    (void) state;
+    (void) nspace;
+
+    const std::string elem(name);
+    std::string value;
+    value.swap(cdata);
+    StrUtil::trim(value);
+
+    if(elem == "IsTruncated") {
+        truncated = (value == "true");
+    }
+    else if(elem == "NextPartNumberMarker") {
+        nextPartNumberMarker = value;
+    }
+    else if(elem == "NextKeyMarker") {
+        nextKeyMarker = value;
+    }
+    else if(elem == "NextUploadIdMarker") {
+        nextUploadIdMarker = value;
+    }
+    else if(!parts.empty() && elem == "PartNumber") {
+        parts.back().partNumber = toType<size_t, std::string>()(value);
+    }
+    else if(!parts.empty() && elem == "ETag") {
+        parts.back().etag = value;
+    }
+    else if(!parts.empty() && elem == "Size") {
+        parts.back().size = toType<dav_size_t, std::string>()(value);
+    }
+    else if(!uploads.empty() && elem == "Key") {
+        uploads.back().key = value;
+    }
+    else if(!uploads.empty() && elem == "UploadId") {
+        uploads.back().uploadId = value;
+    }
+
+    return 0;
+}
+
+std::deque<FileProperties> & S3MultiPartListParser::getProperties(){
+    return unusedFileProps;
+}
+
+}
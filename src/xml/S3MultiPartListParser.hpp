@@ -0,0 +1,81 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#ifndef S3_MULTIPART_LIST_PARSER_HPP
+#define S3_MULTIPART_LIST_PARSER_HPP
+
+#include <davix_internal.hpp>
+#include <xml/davxmlparser.hpp>
+#include <utils/davix_fileproperties.hpp>
+
+namespace Davix{
+
+// Parser for the ListParts and ListMultipartUploads S3 responses
+class S3MultiPartListParser :  public XMLPropParser {
+public:
+    // an uploaded part, from ListParts
+    struct Part {
+        Part() : partNumber(0), size(0) {}
+
+        size_t partNumber;
+        std::string etag;
+        dav_size_t size;
+    };
+
+    // a pending multi-part upload, from ListMultipartUploads
+    struct Upload {
+        std::string key;
+        std::string uploadId;
+    };
+
+    S3MultiPartListParser();
+    virtual ~S3MultiPartListParser();
+
+    const std::vector<Part> & getParts() const { return parts; }
+    const std::vector<Upload> & getUploads() const { return uploads; }
+
+    // true if the listing continues on a next page
+    bool isTruncated() const { return truncated; }
+    const std::string & getNextPartNumberMarker() const { return nextPartNumberMarker; }
+    const std::string & getNextKeyMarker() const { return nextKeyMarker; }
+    const std::string & getNextUploadIdMarker() const { return nextUploadIdMarker; }
+
+    virtual std::deque<FileProperties> & getProperties(); // not used
+
+protected:
+    virtual int parserStartElemCb(int parent, const char *nspace, const char *name, const char **atts);
+    virtual int parserCdataCb(int state, const char *cdata, size_t len);
+    virtual int parserEndElemCb(int state, const char *nspace, const char *name);
+
+private:
+    std::vector<Part> parts;
+    std::vector<Upload> uploads;
+    bool truncated;
+    std::string nextPartNumberMarker;
+    std::string nextKeyMarker;
+    std::string nextUploadIdMarker;
+
+    std::string cdata;
+    std::deque<FileProperties> unusedFileProps;
+};
+
+}
+
+#endif
@@ -26,38 +26,61 @@
 #include <status/davixstatusrequest.hpp>
 #include "libs/datetime/datetime_utils.hpp"
 #include <utils/stringutils.hpp>
+#include <cstring>
+#include <limits>
 
 using namespace StrUtil;
 
 namespace Davix {
 
-const Xml::XmlPTree prop_node(Xml::ElementStart, "propstat");
-const Xml::XmlPTree prop_collection(Xml::ElementStart, "collection");
-static std::unique_ptr<Xml::XmlPTree> webDavTree;
-
-static std::once_flag _l_init;
+//------------------------------------------------------------------------------
+// Elements of a PROPFIND multistatus response, used as the parser state of
+// the element. An element is identified from the state of its parent and its
+// local name, elements outside of this tree are declined, pruning their whole
+// sub-tree from the parse.
+//------------------------------------------------------------------------------
+enum DavPropElement {
+    ElemUnknown = 0, // NE_XML_DECLINE
+    ElemMultistatus,
+    ElemResponse,
+    ElemHref,
+    ElemPropstat,
+    ElemStatus,
+    ElemProp,
+    ElemLastModified,
+    ElemCreationDate,
+    ElemQuotaUsedBytes,
+    ElemQuotaAvailableBytes,
+    ElemContentLength,
+    ElemOwner,
+    ElemGroup,
+    ElemMode,
+    ElemResourceType,
+    ElemCollection,
+    ElemMax
+};
 
 struct DavPropXMLParser::DavxPropXmlIntern{
-    DavxPropXmlIntern() : _stack(),
-        _props(), _current_props(), _last_response_status(500), _last_filename(){
-        _stack.reserve(10);
+    DavxPropXmlIntern() :
+        _props(), _current_props(), _last_response_status(500), _last_filename(), _properties(StatProperty::All){
         char_buffer.reserve(1024);
+        _last_filename.reserve(256);
     }
 
-    // node stack
-    std::vector<Xml::XmlPTree> _stack;
-
     // props
     std::deque<FileProperties> _props;
     FileProperties _current_props;
     int _last_response_status;
     std::string _last_filename;
 
-    // buffer
+    // StatProperty mask of the properties to parse
+    unsigned int _properties;
+
+    // cdata of the current leaf element, its capacity is kept across elements
     std::string char_buffer;
 
     inline void appendChars(const char *buff, size_t len){
-        char_buffer.append(std::string(buff, len));
+        char_buffer.append(buff, len);
     }
 
     inline void clear(){
@@ -76,7 +99,7 @@ struct DavPropXMLParser::DavxPropXmlIntern{
         DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " end of properties... ");
         if( _last_response_status > 100
             && _last_response_status < 400){
-            _props.push_back(_current_props);
+            _props.push_back(std::move(_current_props));
         }else{
            DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, "Bad status code ! properties dropped");
         }
@@ -85,12 +108,28 @@ struct DavPropXMLParser::DavxPropXmlIntern{
 };
 
 
-typedef void (*properties_cb)(DavPropXMLParser::DavxPropXmlIntern & par, const std::string & name);
+// value is trimmed and null terminated
+typedef void (*properties_cb)(DavPropXMLParser::DavxPropXmlIntern & par, const char* value, size_t len);
 
 
-static void check_last_modified(DavPropXMLParser::DavxPropXmlIntern & par, const std::string & name){
+// same rules as toType<unsigned long>, without going through a std::string
+static bool parse_unsigned(const char* value, size_t len, unsigned long & res){
+    char* end_str = NULL;
+    errno = 0;
+    res = strtoul(value, &end_str, 10);
+    const bool overflow = (res == ULONG_MAX && errno == ERANGE);
+    errno = 0;
+    if(len == 0 || overflow || *end_str != '\0')
+        return false;
+    if(res > static_cast<unsigned long>(std::numeric_limits<long>::max()) && memchr(value, '-', len) != NULL)
+        return false;
+    return true;
+}
+
+static void check_last_modified(DavPropXMLParser::DavxPropXmlIntern & par, const char* value, size_t len){
+    (void) len;
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " getlastmodified found -> parse it ");
-    time_t t = parse_standard_date(name.c_str());
+    time_t t = parse_standard_date(value);
     if(t == -1){
         DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_XML, " getlastmodified parsing error : corrupted value ... ignored");
         t = 0;
@@ -100,9 +139,10 @@ static void check_last_modified(DavPropXMLParser::DavxPropXmlIntern & par, const
 }
 
 
-static void check_creation_date(DavPropXMLParser::DavxPropXmlIntern & par, const std::string & name){
+static void check_creation_date(DavPropXMLParser::DavxPropXmlIntern & par, const char* value, size_t len){
+    (void) len;
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, "creationdate found -> parse it");
-    time_t t = parse_standard_date(name.c_str());
+    time_t t = parse_standard_date(value);
     if(t == -1){
         DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_XML, " creationdate parsing error : corrupted value ... ignored");
         t = 0;
@@ -111,51 +151,53 @@ static void check_creation_date(DavPropXMLParser::DavxPropXmlIntern & par, const
     par._current_props.info.ctime = t;
 }
 
-static void check_is_directory(DavPropXMLParser::DavxPropXmlIntern & par,  const std::string & name){
-   (void) name;
+static void check_is_directory(DavPropXMLParser::DavxPropXmlIntern & par, const char* value, size_t len){
+   (void) value;
+   (void) len;
    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " directory pattern found -> set flag IS_DIR");
    par._current_props.info.mode |=  S_IFDIR;
    par._current_props.info.mode &= ~(S_IFREG);
 }
 
 
-static void check_content_length(DavPropXMLParser::DavxPropXmlIntern & par,  const std::string & name){
+static void check_content_length(DavPropXMLParser::DavxPropXmlIntern & par, const char* value, size_t len){
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " content length found -> parse it");
-    try{
-        const unsigned long mysize = toType<unsigned long, std::string>()(name);
-        DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " content length found -> {}", mysize);
-        par._current_props.info.size = static_cast<off_t>(mysize);
-    }catch(...){
+    unsigned long mysize;
+    if(!parse_unsigned(value, len, mysize)){
         DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_XML, " Invalid content length value in dav response");
+        return;
     }
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " content length found -> {}", mysize);
+    par._current_props.info.size = static_cast<off_t>(mysize);
 }
 
-static void check_quota_used_bytes(DavPropXMLParser::DavxPropXmlIntern & par,  const std::string & name){
+static void check_quota_used_bytes(DavPropXMLParser::DavxPropXmlIntern & par, const char* value, size_t len){
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " quota used bytes found -> parse it");
-    try{
-        const unsigned long mysize = toType<unsigned long, std::string>()(name);
-        DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " quota used bytes found -> {}", mysize);
-        par._current_props.info.size = static_cast<off_t>(mysize);
-        par._current_props.quota.used_bytes = static_cast<off_t>(mysize);
-    }catch(...){
+    unsigned long mysize;
+    if(!parse_unsigned(value, len, mysize)){
         DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_XML, " Invalid quota used bytes in dav response");
+        return;
     }
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " quota used bytes found -> {}", mysize);
+    par._current_props.info.size = static_cast<off_t>(mysize);
+    par._current_props.quota.used_bytes = static_cast<off_t>(mysize);
 }
 
-static void check_quota_free_space(DavPropXMLParser::DavxPropXmlIntern & par,  const std::string & name){
+static void check_quota_free_space(DavPropXMLParser::DavxPropXmlIntern & par, const char* value, size_t len){
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " quota free space found -> parse it");
-    try{
-        const unsigned long mysize = toType<unsigned long, std::string>()(name);
-        DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " quota free space found -> {}", mysize);
-        par._current_props.quota.free_space = static_cast<off_t>(mysize);
-    }catch(...){
+    unsigned long mysize;
+    if(!parse_unsigned(value, len, mysize)){
         DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_XML, " Invalid quota free space in dav response");
+        return;
     }
+    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " quota free space found -> {}", mysize);
+    par._current_props.quota.free_space = static_cast<off_t>(mysize);
 }
 
-static void check_mode_ext(DavPropXMLParser::DavxPropXmlIntern & par, const std::string & name){
+static void check_mode_ext(DavPropXMLParser::DavxPropXmlIntern & par, const char* value, size_t len){
+    (void) len;
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, "mode_t extension for LCGDM found -> parse it");
-    const unsigned long mymode = strtoul(name.c_str(), NULL, 8);
+    const unsigned long mymode = strtoul(value, NULL, 8);
     if(mymode == ULONG_MAX){
         DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_XML, "Invalid mode_t value for the LCGDM extension");
         errno =0;
@@ -165,41 +207,32 @@ static void check_mode_ext(DavPropXMLParser::DavxPropXmlIntern & par, const std:
     par._current_props.info.mode = (mode_t) mymode;
 }
 
-static bool startswith(const std::string &str, const std::string &prefix) {
-  if(prefix.size() > str.size()) return false;
-
-  for(size_t i = 0; i < prefix.size(); i++) {
-    if(str[i] != prefix[i]) return false;
-  }
-  return true;
-}
-
-static void check_href(DavPropXMLParser::DavxPropXmlIntern & par,  const std::string & name){
-    std::string _href(name);
-    rtrim(_href, isSlash()); // remove trailing slash
-    std::string::reverse_iterator it = std::find(_href.rbegin(), _href.rend(), '/');
-    if( it == _href.rend()){
-        par._last_filename.assign(_href);
-    }else{
-        par._last_filename.assign(it.base(), _href.end());
-
-        if(startswith(name, "https://") || startswith(name, "http://") || startswith(name, "://") || startswith(name, "dav://") || startswith(name, "davs://")) {
-          par._last_filename = Uri::unescapeString(par._last_filename);
-        }
+static void check_href(DavPropXMLParser::DavxPropXmlIntern & par, const char* value, size_t len){
+    // last segment of the path, without trailing slashes
+    const char* end = value + len;
+    while(end > value && *(end-1) == '/')
+        --end;
+    const char* begin = end;
+    while(begin > value && *(begin-1) != '/')
+        --begin;
+
+    // hrefs are escaped, be they URLs or absolute paths. Names that are not
+    // validly escaped come from servers sending them raw, keep them as they are
+    par._last_filename.assign(begin, end);
+    if(begin != value){
+        std::string unescaped = Uri::unescapeString(par._last_filename);
+        if(!unescaped.empty())
+            par._last_filename.swap(unescaped);
     }
    DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " href/filename parsed -> {} ", par._last_filename.c_str() );
 }
 
-static void check_status(DavPropXMLParser::DavxPropXmlIntern & par, const std::string & name){
+static void check_status(DavPropXMLParser::DavxPropXmlIntern & par, const char* value, size_t len){
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " status found -> parse it");
-    std::string str_status(name);
-    ltrim(str_status, StrUtil::isSpace());
-    std::string::iterator it1, it2;
-    it1 = std::find(str_status.begin(), str_status.end(), ' ');
-    if( it1 != str_status.end()){
-        it2 = std::find(it1+1, str_status.end(), ' ');
-        std::string str_status_parsed(it1+1, it2);
-        unsigned long res = strtoul(str_status_parsed.c_str(), NULL, 10);
+    // "HTTP/1.1 200 OK"
+    const char* code = static_cast<const char*>(memchr(value, ' ', len));
+    if(code != NULL){
+        unsigned long res = (*(code+1) == ' ') ? 0 : strtoul(code+1, NULL, 10);
         if(res != ULONG_MAX){
            DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " status value : {}", res);
            par._last_response_status = res;
@@ -210,11 +243,10 @@ static void check_status(DavPropXMLParser::DavxPropXmlIntern & par, const std::s
     errno =0;
 }
 
-static void check_owner_uid(DavPropXMLParser::DavxPropXmlIntern & par, const std::string & value){
+static void check_owner_uid(DavPropXMLParser::DavxPropXmlIntern & par, const char* value, size_t len){
+    (void) len;
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " owner found -> parse it");
-    std::string str_owner(value);
-    ltrim(str_owner, StrUtil::isSpace());
-    unsigned long res = strtoul(str_owner.c_str(), NULL, 10);
+    unsigned long res = strtoul(value, NULL, 10);
     if(res != ULONG_MAX){
        DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " owner value : {}", res);
        par._current_props.info.owner = res;
@@ -223,11 +255,10 @@ static void check_owner_uid(DavPropXMLParser::DavxPropXmlIntern & par, const std
     DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_XML, "Invalid owner field value");
 }
 
-static void check_group_gid(DavPropXMLParser::DavxPropXmlIntern & par, const std::string & value){
+static void check_group_gid(DavPropXMLParser::DavxPropXmlIntern & par, const char* value, size_t len){
+    (void) len;
     DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " group found -> parse it");
-    std::string str_group(value);
-    ltrim(str_group, StrUtil::isSpace());
-    unsigned long res = strtoul(str_group.c_str(), NULL, 10);
+    unsigned long res = strtoul(value, NULL, 10);
     if(res != ULONG_MAX){
        DAVIX_SLOG(DAVIX_LOG_DEBUG, DAVIX_LOG_XML, " group value : {}", res);
        par._current_props.info.group = res;
@@ -236,38 +267,73 @@ static void check_group_gid(DavPropXMLParser::DavxPropXmlIntern & par, const std
     DAVIX_SLOG(DAVIX_LOG_VERBOSE, DAVIX_LOG_XML, "Invalid group field value");
 }
 
-void init_webdavTree(){
-
-    // Nodes list
-    webDavTree.reset(new Xml::XmlPTree(Xml::ElementStart, "multistatus"));
-    webDavTree->addChild(Xml::XmlPTree(Xml::ElementStart, "response"));
-    Xml::XmlPTree::iterator it = webDavTree->beginChildren();
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "href", Xml::XmlPTree::ChildrenList(),  (void*) &check_href));
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "propstat"));
-    it = (--it->endChildren());
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "status", Xml::XmlPTree::ChildrenList(), (void*) &check_status));
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "prop"));
-    it = (--it->endChildren());
-
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "getlastmodified", Xml::XmlPTree::ChildrenList(),  (void*) &check_last_modified));
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "creationdate", Xml::XmlPTree::ChildrenList(), (void*) &check_creation_date));
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "quota-used-bytes", Xml::XmlPTree::ChildrenList(), (void*) &check_quota_used_bytes));
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "quota-available-bytes", Xml::XmlPTree::ChildrenList(), (void*) &check_quota_free_space));
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "getcontentlength", Xml::XmlPTree::ChildrenList(), (void*) &check_content_length));
-
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "owner", Xml::XmlPTree::ChildrenList(), (void*) &check_owner_uid));
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "group", Xml::XmlPTree::ChildrenList(), (void*) &check_group_gid));
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "mode", Xml::XmlPTree::ChildrenList(), (void*) &check_mode_ext));
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "resourcetype"));
-
-    it = (--it->endChildren());
-    it->addChild(Xml::XmlPTree(Xml::ElementStart, "collection", Xml::XmlPTree::ChildrenList(), (void*) &check_is_directory));
+//------------------------------------------------------------------------------
+// Transitions of the parser: child element "name" of an element in state
+// "parent", namespaces are ignored. Leaf elements carry the callback
+// consuming their value.
+//------------------------------------------------------------------------------
+struct DavPropTransition {
+    DavPropElement parent;
+    const char* name;
+    size_t name_len;
+    DavPropElement elem;
+    properties_cb cb;
+    unsigned int property; // StatProperty of the element, 0 if always parsed
+};
+
+#define DAV_TRANSITION(parent, name, elem, cb, property) { parent, name, sizeof(name) - 1, elem, cb, property }
+
+static const DavPropTransition webDavTransitions[] = {
+    DAV_TRANSITION(ElemUnknown,      "multistatus",           ElemMultistatus,         NULL,                     0),
+    DAV_TRANSITION(ElemMultistatus,  "response",              ElemResponse,            NULL,                     0),
+    DAV_TRANSITION(ElemResponse,     "href",                  ElemHref,                &check_href,              0),
+    DAV_TRANSITION(ElemResponse,     "propstat",              ElemPropstat,            NULL,                     0),
+    DAV_TRANSITION(ElemPropstat,     "status",                ElemStatus,              &check_status,            0),
+    DAV_TRANSITION(ElemPropstat,     "prop",                  ElemProp,                NULL,                     0),
+    DAV_TRANSITION(ElemProp,         "getlastmodified",       ElemLastModified,        &check_last_modified,     StatProperty::Mtime),
+    DAV_TRANSITION(ElemProp,         "creationdate",          ElemCreationDate,        &check_creation_date,     StatProperty::Ctime),
+    DAV_TRANSITION(ElemProp,         "quota-used-bytes",      ElemQuotaUsedBytes,      &check_quota_used_bytes,  StatProperty::Size),
+    DAV_TRANSITION(ElemProp,         "quota-available-bytes", ElemQuotaAvailableBytes, &check_quota_free_space,  0),
+    DAV_TRANSITION(ElemProp,         "getcontentlength",      ElemContentLength,       &check_content_length,    StatProperty::Size),
+    DAV_TRANSITION(ElemProp,         "owner",                 ElemOwner,               &check_owner_uid,         StatProperty::Owner),
+    DAV_TRANSITION(ElemProp,         "group",                 ElemGroup,               &check_group_gid,         StatProperty::Owner),
+    DAV_TRANSITION(ElemProp,         "mode",                  ElemMode,                &check_mode_ext,          StatProperty::Mode),
+    DAV_TRANSITION(ElemProp,         "resourcetype",          ElemResourceType,        NULL,                     StatProperty::Type),
+    DAV_TRANSITION(ElemResourceType, "collection",            ElemCollection,          &check_is_directory,      0),
+};
+
+#undef DAV_TRANSITION
+
+static const size_t webDavTransitionsSize = sizeof(webDavTransitions) / sizeof(webDavTransitions[0]);
+
+// callback of each leaf element, and property it belongs to, indexed by state
+static properties_cb webDavCallbacks[ElemMax];
+static unsigned int webDavProperties[ElemMax];
+static std::once_flag _l_init;
+
+static void init_webdavCallbacks(){
+    for(size_t i = 0; i < webDavTransitionsSize; ++i){
+        webDavCallbacks[webDavTransitions[i].elem] = webDavTransitions[i].cb;
+        webDavProperties[webDavTransitions[i].elem] = webDavTransitions[i].property;
+    }
+}
+
+static DavPropElement findElement(int parent, const char* name){
+    const size_t name_len = strlen(name);
+    for(size_t i = 0; i < webDavTransitionsSize; ++i){
+        const DavPropTransition & t = webDavTransitions[i];
+        if(t.parent == parent && t.name_len == name_len && memcmp(t.name, name, name_len) == 0){
+            return t.elem;
+        }
+    }
+    return ElemUnknown;
 }
 
-DavPropXMLParser::DavPropXMLParser() :
+DavPropXMLParser::DavPropXMLParser(unsigned int properties) :
     d_ptr(new DavxPropXmlIntern())
 {
-    std::call_once(_l_init, init_webdavTree);
+    d_ptr->_properties = properties;
+    std::call_once(_l_init, init_webdavCallbacks);
 }
 
 DavPropXMLParser::~DavPropXMLParser(){
@@ -281,57 +347,62 @@ std::deque<FileProperties> & DavPropXMLParser::getProperties(){
 
 
 int DavPropXMLParser::parserStartElemCb(int parent, const char *nspace, const char *name, const char **atts){
-    (void) parent;
-    (void) name;
     (void) nspace;
     (void) atts;
-    // add elem to stack
-    Xml::XmlPTree node(Xml::ElementStart, name);
-    d_ptr->_stack.push_back(node);
+    const DavPropElement elem = findElement(parent, name);
+
+    // properties not requested are declined, with their sub-tree
+    if((webDavProperties[elem] & d_ptr->_properties) != webDavProperties[elem]){
+        return ElemUnknown;
+    }
+
+    if(webDavCallbacks[elem] != NULL){
+        d_ptr->clear();
+    }
 
     // if beginning of prop, add new element
-    if(node.compareNode(prop_node)){
+    if(elem == ElemPropstat){
         d_ptr->add_new_elem();
     }
-    return 1;
+    return elem;
 }
 
 
 int DavPropXMLParser::parserCdataCb(int state, const char *cdata, size_t len){
-    (void) state;
-    d_ptr->appendChars(cdata, len);
+    // only the value of leaf elements is of interest
+    if(webDavCallbacks[state] != NULL){
+        d_ptr->appendChars(cdata, len);
+    }
     return 0;
 }
 
 
 int DavPropXMLParser::parserEndElemCb(int state, const char *nspace, const char *name){
-    (void) state;
     (void) nspace;
-    Xml::XmlPTree node(Xml::ElementStart, name);
-
-    // find potential interesting data
-    std::vector<Xml::XmlPTree::ptr_type> chain;
-    if(d_ptr->char_buffer.size() != 0 || node.compareNode(prop_collection)){
-        chain = webDavTree->findChain(d_ptr->_stack);
-        if(chain.size() > 0){
-            properties_cb cb = ((properties_cb) chain.at(chain.size()-1)->getMeta());
-            if(cb){
-                StrUtil::trim(d_ptr->char_buffer);
-                cb(*d_ptr, d_ptr->char_buffer);
-            }
-        }
+    (void) name;
+    if(state <= ElemUnknown || state >= ElemMax)
+        throw DavixException(davix_scope_xml_parser(),StatusCode::ParsingError, "Corrupted Parser Stack, Invalid XML");
+
+    properties_cb cb = webDavCallbacks[state];
+    if(cb){
+        // trim the value in place
+        std::string & buffer = d_ptr->char_buffer;
+        size_t end = buffer.size();
+        while(end > 0 && isspace(static_cast<unsigned char>(buffer[end-1])))
+            --end;
+        buffer.resize(end);
+        size_t begin = 0;
+        while(begin < end && isspace(static_cast<unsigned char>(buffer[begin])))
+            ++begin;
+
+        cb(*d_ptr, buffer.c_str() + begin, end - begin);
+        d_ptr->clear();
     }
 
     // push props
-    if(node.compareNode(prop_node)){
+    if(state == ElemPropstat){
         d_ptr->store_new_elem();
     }
-
-    // cleaning work
-    if(d_ptr->_stack.size()  == 0)
-        throw DavixException(davix_scope_xml_parser(),StatusCode::ParsingError, "Corrupted Parser Stack, Invalid XML");
-    d_ptr->_stack.pop_back();
-    d_ptr->clear();
     return 0;
 }
 
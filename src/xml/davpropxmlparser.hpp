@@ -34,7 +34,8 @@ class DavPropXMLParser : public XMLPropParser
 {
 public:
     struct DavxPropXmlIntern;
-    DavPropXMLParser();
+    // only the properties of the StatProperty mask are parsed
+    DavPropXMLParser(unsigned int properties = StatProperty::All);
     virtual ~DavPropXMLParser();
 
     virtual std::deque<FileProperties> & getProperties();
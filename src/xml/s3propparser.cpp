@@ -37,6 +37,8 @@ const std::string prefix_prop = "Prefix";
 const std::string com_prefix_prop = "CommonPrefixes";
 const std::string listbucketresult_prop = "ListBucketResult";
 const std::string last_modified_prop = "LastModified";
+const std::string is_truncated_prop = "IsTruncated";
+const std::string next_marker_prop = "NextMarker";
 
 struct S3PropParser::Internal{
     std::string current;
@@ -50,6 +52,11 @@ struct S3PropParser::Internal{
     FileProperties property;
     S3ListingMode::S3ListingMode _s3_listing_mode;
 
+    // pagination of the listing
+    bool truncated;
+    std::string next_marker;
+    std::string last_key;
+
     int start_elem(const std::string &elem){
         // new tag, clean content;
         current.clear();
@@ -104,6 +111,7 @@ struct S3PropParser::Internal{
             DAVIX_SLOG(DAVIX_LOG_TRACE, DAVIX_LOG_XML, "new prefix {}", current.c_str());
             prefix = current;
             if(inside_com_prefix){  // all keys would have been processed by now, just common prefixes left, use as DIRs
+                last_key = std::max(last_key, current);
                 DAVIX_SLOG(DAVIX_LOG_TRACE, DAVIX_LOG_XML, "push new common prefix {}", current.c_str());
                 current = current.erase(current.size()-1,1);
                 property.filename = current.erase(0, prefix_to_remove.size());
@@ -116,6 +124,7 @@ struct S3PropParser::Internal{
 
         // new name new fileprop
         if( StrUtil::compare_ncase(name_prop, elem) ==0){
+            last_key = std::max(last_key, current);
 
             if(_s3_listing_mode == S3ListingMode::Flat) {  // flat mode
                 property.filename = current.erase(0,prefix.size());
@@ -158,6 +167,14 @@ struct S3PropParser::Internal{
             }
         }
 
+        if( StrUtil::compare_ncase(is_truncated_prop, elem) ==0){
+            truncated = (StrUtil::compare_ncase(current, "true") ==0);
+        }
+
+        if( StrUtil::compare_ncase(next_marker_prop, elem) ==0){
+            next_marker = current;
+        }
+
         // found bucket name
         // push it as first item to identify bucket
         if( StrUtil::compare_ncase(col_prop, elem) ==0){
@@ -252,5 +269,14 @@ std::deque<FileProperties> & S3PropParser::getProperties(){
     return d_ptr->props;
 }
 
+bool S3PropParser::isTruncated() const{
+    return d_ptr->truncated;
+}
+
+const std::string & S3PropParser::getNextMarker() const{
+    // NextMarker is only sent for delimited listings, continue after the last key otherwise
+    return (d_ptr->next_marker.empty()) ? d_ptr->last_key : d_ptr->next_marker;
+}
+
 
 }
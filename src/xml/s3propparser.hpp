@@ -42,6 +42,10 @@ public:
 
     virtual std::deque<FileProperties> & getProperties();
 
+    // true if the listing continues in another page, starting after getNextMarker()
+    bool isTruncated() const;
+    const std::string & getNextMarker() const;
+
 
 protected:
     virtual int parserStartElemCb(int parent, const char *nspace, const char *name, const char **atts);
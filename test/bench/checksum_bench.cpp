@@ -0,0 +1,61 @@
+// Micro-benchmark of the checksum kernels
+//
+// usage: davix-checksum-bench [size in MiB] [iterations]
+
+#include <utils/checksum_calculator.hpp>
+#include <utils/checksum_kernels.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <vector>
+
+using namespace Davix;
+
+static void report(const std::string &name, size_t bytes, std::chrono::steady_clock::duration elapsed, const std::string &result) {
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    std::cout << std::left << std::setw(20) << name
+              << std::right << std::setw(10) << std::fixed << std::setprecision(2) << (bytes / seconds / 1e9) << " GB/s"
+              << "   " << result << std::endl;
+}
+
+static void benchKernels(const std::string &algorithm, const Checksum::KernelList &kernels, uint32_t init,
+                         const std::vector<char> &data, int iterations) {
+    for(size_t k = 0; k < kernels.size(); k++) {
+        uint32_t value = init;
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        for(int i = 0; i < iterations; i++) {
+            value = kernels[k].second(init, data.data(), data.size());
+        }
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - start;
+
+        std::ostringstream hex;
+        hex << std::hex << std::setw(8) << std::setfill('0') << value;
+        report(algorithm + " " + kernels[k].first, data.size() * iterations, elapsed, hex.str());
+    }
+}
+
+int main(int argc, char** argv) {
+    const size_t size = ((argc > 1) ? atol(argv[1]) : 256) * 1024 * 1024;
+    const int iterations = (argc > 2) ? atoi(argv[2]) : 4;
+
+    std::vector<char> data(size);
+    for(size_t i = 0; i < size; i++) {
+        data[i] = static_cast<char>((i * 2654435761u) >> 24);
+    }
+
+    std::cout << "checksum of " << (size >> 20) << " MiB, " << iterations << " iterations" << std::endl;
+    benchKernels("adler32", Checksum::adler32Kernels(), Checksum::ADLER32_INIT, data, iterations);
+    benchKernels("crc32c", Checksum::crc32cKernels(), Checksum::CRC32C_INIT, data, iterations);
+
+    std::unique_ptr<ChecksumCalculator> md5(ChecksumCalculator::create("md5"));
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    for(int i = 0; i < iterations; i++) {
+        md5->reset();
+        md5->update(data.data(), data.size());
+    }
+    report("md5 openssl", size * iterations, std::chrono::steady_clock::now() - start, md5->digest());
+    return 0;
+}
@@ -178,6 +178,13 @@ ssize_t DrunkServer::Connection::write(const std::string &buf) {
   return write(buf.c_str(), buf.size());
 }
 
+//------------------------------------------------------------------------------
+// Shut down both directions, unblocks pending reads
+//------------------------------------------------------------------------------
+void DrunkServer::Connection::shutdown() {
+  ::shutdown(_fd, SHUT_RDWR);
+}
+
 //------------------------------------------------------------------------------
 // Run acceptor thread
 //------------------------------------------------------------------------------
@@ -85,6 +85,11 @@ public:
     //--------------------------------------------------------------------------
     ssize_t write(const std::string &buf);
 
+    //--------------------------------------------------------------------------
+    // Shut down both directions, unblocks pending reads
+    //--------------------------------------------------------------------------
+    void shutdown();
+
   private:
     int _fd;
   };
@@ -22,6 +22,9 @@
 #include "Interactors.hpp"
 #include "LineReader.hpp"
 #include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
 
 //------------------------------------------------------------------------------
 // Destructor
@@ -109,3 +112,137 @@ void SingleShotInteractor::main(ThreadAssistant &assistant) {
   std::cout << "Response written successfully" << std::endl;
   _is_ok = true;
 }
+
+//------------------------------------------------------------------------------
+// Header value, empty if missing
+//------------------------------------------------------------------------------
+std::string HttpExchangeRequest::header(const std::string &name) const {
+  std::map<std::string, std::string>::const_iterator it = headers.find(name);
+  if(it == headers.end()) {
+    return std::string();
+  }
+  return it->second;
+}
+
+//------------------------------------------------------------------------------
+// Constructor
+//------------------------------------------------------------------------------
+HandlerInteractor::HandlerInteractor(const Handler &handler) : _handler(handler) {}
+
+//------------------------------------------------------------------------------
+// Destructor, closes the connection
+//------------------------------------------------------------------------------
+HandlerInteractor::~HandlerInteractor() {
+  if(_conn) {
+    _conn->shutdown();
+  }
+  _thread.join();
+}
+
+static std::string trimLine(const std::string &line) {
+  size_t end = line.find_last_not_of("\r\n");
+  return (end == std::string::npos) ? std::string() : line.substr(0, end + 1);
+}
+
+//------------------------------------------------------------------------------
+// Read size bytes of body
+//------------------------------------------------------------------------------
+bool HandlerInteractor::readBody(size_t size, std::string &out) {
+  std::string chunk;
+  while(size > 0) {
+    ssize_t rc = _conn->read(chunk, std::min<size_t>(size, 65536));
+    if(rc <= 0) {
+      return false;
+    }
+    out += chunk;
+    size -= rc;
+  }
+  return true;
+}
+
+//------------------------------------------------------------------------------
+// Read a whole request, false once the connection is closed
+//------------------------------------------------------------------------------
+bool HandlerInteractor::readRequest(HttpExchangeRequest &req) {
+  std::string line;
+  if(_reader->consumeLine(line) <= 0) {
+    return false;
+  }
+
+  std::istringstream requestLine(trimLine(line));
+  requestLine >> req.method >> req.path;
+
+  while(true) {
+    if(_reader->consumeLine(line) <= 0) {
+      return false;
+    }
+    line = trimLine(line);
+    if(line.empty()) {
+      break;
+    }
+
+    size_t colon = line.find(':');
+    if(colon == std::string::npos) {
+      continue;
+    }
+    std::string name = line.substr(0, colon);
+    std::transform(name.begin(), name.end(), name.begin(), ::tolower);
+    size_t value = line.find_first_not_of(' ', colon + 1);
+    req.headers[name] = (value == std::string::npos) ? std::string() : line.substr(value);
+  }
+
+  if(req.header("expect") == "100-continue") {
+    _conn->write("HTTP/1.1 100 Continue\r\n\r\n");
+  }
+
+  if(req.header("transfer-encoding") == "chunked") {
+    while(true) {
+      if(_reader->consumeLine(line) <= 0) {
+        return false;
+      }
+      size_t size = strtoul(trimLine(line).c_str(), NULL, 16);
+      if(!readBody(size, req.body) || _reader->consumeLine(line) <= 0) {
+        return false;
+      }
+      if(size == 0) {
+        return true;
+      }
+    }
+  }
+
+  return readBody(strtoul(req.header("content-length").c_str(), NULL, 10), req.body);
+}
+
+//------------------------------------------------------------------------------
+// Run interacting thread
+//------------------------------------------------------------------------------
+void HandlerInteractor::main(ThreadAssistant &assistant) {
+  while(!assistant.terminationRequested()) {
+    HttpExchangeRequest req;
+    if(!readRequest(req)) {
+      return;
+    }
+
+    HttpExchangeResponse resp = _handler(req);
+
+    std::ostringstream ss;
+    ss << "HTTP/1.1 " << resp.code << " Status\r\n";
+    for(size_t i = 0; i < resp.headers.size(); i++) {
+      ss << resp.headers[i].first << ": " << resp.headers[i].second << "\r\n";
+    }
+    ss << "Content-Length: " << resp.body.size() << "\r\n\r\n";
+    if(req.method != "HEAD") {
+      ss << resp.body.substr(0, resp.truncateAt);
+    }
+
+    const std::string out = ss.str();
+    if(_conn->write(out) != (ssize_t) out.size()) {
+      return;
+    }
+    if(resp.truncateAt < resp.body.size()) {
+      _conn->shutdown();
+      return;
+    }
+    _is_ok = true;
+  }
+}
@@ -24,6 +24,10 @@
 
 #include "AssistedThread.hh"
 #include "DrunkServer.hpp"
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
 
 class LineReader;
 
@@ -93,4 +97,60 @@ protected:
   std::string _response;
 };
 
+//------------------------------------------------------------------------------
+// HTTP request as received by HandlerInteractor
+//------------------------------------------------------------------------------
+struct HttpExchangeRequest {
+  std::string method;
+  std::string path; // including the query
+  std::map<std::string, std::string> headers; // lowercase names
+  std::string body;
+
+  std::string header(const std::string &name) const;
+};
+
+//------------------------------------------------------------------------------
+// HTTP response sent by HandlerInteractor, HEAD responses only send the
+// Content-Length of the body. With truncateAt set, only that many bytes of
+// the body are sent before the connection is closed
+//------------------------------------------------------------------------------
+struct HttpExchangeResponse {
+  HttpExchangeResponse(int c = 200, const std::string &b = std::string()) : code(c), body(b), truncateAt(std::string::npos) {}
+
+  int code;
+  std::vector<std::pair<std::string, std::string> > headers;
+  std::string body;
+  size_t truncateAt;
+};
+
+//------------------------------------------------------------------------------
+// Handler interactor - answers every request of a keep-alive connection
+// through a callback, until the client closes it
+//------------------------------------------------------------------------------
+class HandlerInteractor : public BasicInteractor {
+public:
+  typedef std::function<HttpExchangeResponse (const HttpExchangeRequest &)> Handler;
+
+  //----------------------------------------------------------------------------
+  // Constructor
+  //----------------------------------------------------------------------------
+  HandlerInteractor(const Handler &handler);
+
+  //----------------------------------------------------------------------------
+  // Destructor, closes the connection
+  //----------------------------------------------------------------------------
+  virtual ~HandlerInteractor();
+
+  //----------------------------------------------------------------------------
+  // Run interacting thread
+  //----------------------------------------------------------------------------
+  void main(ThreadAssistant &assistant);
+
+private:
+  bool readRequest(HttpExchangeRequest &req);
+  bool readBody(size_t size, std::string &out);
+
+  Handler _handler;
+};
+
 #endif
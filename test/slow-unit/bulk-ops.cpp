@@ -0,0 +1,296 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <davix.hpp>
+#include "test-utils.hpp"
+
+#include <algorithm>
+
+using namespace Davix;
+
+static std::string davResponse(const std::string &href, dav_size_t size, bool collection = false) {
+  return SSTR("<D:response><D:href>" << href << "</D:href><D:propstat><D:prop>"
+    << "<D:getcontentlength>" << size << "</D:getcontentlength>"
+    << ((collection) ? "<D:resourcetype><D:collection/></D:resourcetype>" : "<D:resourcetype/>")
+    << "</D:prop><D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>");
+}
+
+static std::string davMultistatus(const std::string &responses) {
+  return "<?xml version=\"1.0\" encoding=\"utf-8\"?><D:multistatus xmlns:D=\"DAV:\">" + responses + "</D:multistatus>";
+}
+
+//------------------------------------------------------------------------------
+// WebDAV server holding the files of _files, with their sizes, and the
+// collections listed in _collections
+//------------------------------------------------------------------------------
+class BulkOps : public HttpHandlerFixture {
+public:
+  BulkOps() : _posix(&_context), _listingCode(207) {
+    _params.setProtocol(RequestProtocol::Webdav);
+    _params.setOperationRetry(0);
+    _handler = [this](const HttpExchangeRequest &req) {
+      if(req.method != "PROPFIND") {
+        return HttpExchangeResponse(405);
+      }
+
+      if(_collections.count(req.path) != 0) {
+        if(_listingCode != 207) {
+          return HttpExchangeResponse(_listingCode);
+        }
+
+        std::string responses = davResponse(req.path, 0, true);
+        for(std::map<std::string, dav_size_t>::iterator it = _files.begin(); it != _files.end(); it++) {
+          if(it->first.compare(0, req.path.size(), req.path) == 0) {
+            responses += davResponse(it->first, it->second);
+          }
+        }
+        return HttpExchangeResponse(207, davMultistatus(responses));
+      }
+
+      std::map<std::string, dav_size_t>::iterator it = _files.find(req.path);
+      if(it == _files.end()) {
+        return HttpExchangeResponse(404);
+      }
+      return HttpExchangeResponse(207, davMultistatus(davResponse(it->first, it->second)));
+    };
+  }
+
+  size_t countRequests(const std::string &method, const std::string &path) {
+    std::vector<std::string> requests = received();
+    return std::count(requests.begin(), requests.end(), method + " " + path);
+  }
+
+protected:
+  Context _context;
+  DavPosix _posix;
+  RequestParams _params;
+  std::map<std::string, dav_size_t> _files;
+  std::set<std::string> _collections;
+  int _listingCode;
+};
+
+TEST_F(BulkOps, StatGroupsByCollection) {
+  _collections.insert("/dir/");
+  _files["/dir/a"] = 1;
+  _files["/dir/b%20c"] = 2;
+  _files["/dir/50%25"] = 3;
+  _files["/dir/d"] = 4;
+  _files["/dir/unrelated"] = 5;
+  _files["/other/e"] = 6;
+
+  std::vector<std::string> urls;
+  urls.push_back(_base + "/dir/a");
+  urls.push_back(_base + "/dir/b%20c");
+  urls.push_back(_base + "/dir/50%25");
+  urls.push_back(_base + "/dir/d");
+  urls.push_back(_base + "/dir/missing");
+  urls.push_back(_base + "/other/e");
+
+  std::vector<StatInfo> infos;
+  std::vector<DavixError*> errors;
+  DavixError* err = NULL;
+  ASSERT_EQ(-1, _posix.stat_bulk(&_params, urls, infos, errors, &err));
+  ASSERT_EQ(err->getStatus(), StatusCode::PartialFailure);
+  DavixError::clearError(&err);
+
+  ASSERT_EQ(infos.size(), 6u);
+  for(size_t i = 0; i < 4; i++) {
+    ASSERT_TRUE(errors[i] == NULL);
+    ASSERT_EQ(infos[i].size, i + 1);
+  }
+  ASSERT_EQ(errors[4]->getStatus(), StatusCode::FileNotFound);
+  ASSERT_TRUE(errors[5] == NULL);
+  ASSERT_EQ(infos[5].size, 6u);
+  DavixError::clearError(&errors[4]);
+
+  // one listing of /dir/, the entry missing from it and the lone resource
+  // of /other/ are stat'ed one by one
+  ASSERT_EQ(countRequests("PROPFIND", "/dir/"), 1u);
+  ASSERT_EQ(countRequests("PROPFIND", "/dir/a"), 0u);
+  ASSERT_EQ(countRequests("PROPFIND", "/dir/missing"), 1u);
+  ASSERT_EQ(countRequests("PROPFIND", "/other/e"), 1u);
+  ASSERT_EQ(countReceived("PROPFIND"), 3u);
+}
+
+TEST_F(BulkOps, StatListingFailure) {
+  _collections.insert("/dir/");
+  _listingCode = 500;
+
+  std::vector<std::string> urls;
+  for(size_t i = 0; i < 5; i++) {
+    _files[SSTR("/dir/f" << i)] = i;
+    urls.push_back(SSTR(_base << "/dir/f" << i));
+  }
+
+  std::vector<StatInfo> infos;
+  std::vector<DavixError*> errors;
+  ASSERT_EQ(0, _posix.stat_bulk(&_params, urls, infos, errors, NULL));
+  for(size_t i = 0; i < 5; i++) {
+    ASSERT_EQ(infos[i].size, i);
+  }
+  ASSERT_EQ(countReceived("PROPFIND"), 6u);
+}
+
+TEST_F(BulkOps, StatLargeCollection) {
+  // the looked up files come last in a large listing, which is given up
+  _collections.insert("/dir/");
+  for(size_t i = 0; i < 1000; i++) {
+    _files[SSTR("/dir/a" << i)] = i;
+  }
+
+  std::vector<std::string> urls;
+  for(size_t i = 0; i < 4; i++) {
+    _files[SSTR("/dir/z" << i)] = 10 + i;
+    urls.push_back(SSTR(_base << "/dir/z" << i));
+  }
+
+  std::vector<StatInfo> infos;
+  std::vector<DavixError*> errors;
+  ASSERT_EQ(0, _posix.stat_bulk(&_params, urls, infos, errors, NULL));
+  for(size_t i = 0; i < 4; i++) {
+    ASSERT_EQ(infos[i].size, 10 + i);
+    ASSERT_EQ(countRequests("PROPFIND", SSTR("/dir/z" << i)), 1u);
+  }
+}
+
+//------------------------------------------------------------------------------
+// S3 server holding the objects of _objects, addressed path-style. Keys of
+// _unanswered are left out of the answers of multi-object deletes.
+//------------------------------------------------------------------------------
+class S3BulkOps : public BulkOps {
+public:
+  S3BulkOps() {
+    _params.setProtocol(RequestProtocol::AwsS3);
+    _params.setAwsAlternate(true);
+    _handler = [this](const HttpExchangeRequest &req) {
+      if(req.method == "DELETE") {
+        return HttpExchangeResponse((_objects.erase(req.path) != 0) ? 204 : 404);
+      }
+      if(req.method != "POST" || req.path.find("?delete") == std::string::npos) {
+        return HttpExchangeResponse(405);
+      }
+      return deleteObjects(req.path.substr(0, req.path.find('?')), req.body);
+    };
+  }
+
+  HttpExchangeResponse deleteObjects(const std::string &bucket, const std::string &body) {
+    std::ostringstream answer;
+    answer << "<?xml version=\"1.0\" encoding=\"UTF-8\"?><DeleteResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">";
+
+    size_t keys = 0;
+    std::string::size_type pos = 0;
+    while((pos = body.find("<Key>", pos)) != std::string::npos) {
+      pos += 5;
+      const std::string key = body.substr(pos, body.find("</Key>", pos) - pos);
+      keys++;
+
+      if(_unanswered.count(key) != 0) {
+        continue;
+      }
+      if(_objects.erase(bucket + key) != 0) {
+        answer << "<Deleted><Key>" << key << "</Key></Deleted>";
+      }
+      else {
+        answer << "<Error><Key>" << key << "</Key><Code>NoSuchKey</Code><Message>The specified key does not exist.</Message></Error>";
+      }
+    }
+    answer << "</DeleteResult>";
+
+    _batches.push_back(keys);
+    return HttpExchangeResponse(200, answer.str());
+  }
+
+protected:
+  std::set<std::string> _objects;
+  std::set<std::string> _unanswered;
+  std::vector<size_t> _batches;
+};
+
+TEST_F(S3BulkOps, DeleteGroupsByBucket) {
+  std::vector<std::string> urls;
+  for(size_t i = 0; i < 1500; i++) {
+    _objects.insert(SSTR("/b1/dir/k" << i));
+    urls.push_back(SSTR(_base << "/b1/dir/k" << i));
+  }
+  _objects.insert("/b2/a");
+  _objects.insert("/b2/b");
+  urls.push_back(_base + "/b2/a");
+  urls.push_back(_base + "/b1/missing");
+  urls.push_back(_base + "/b2/b");
+
+  std::vector<DavixError*> errors;
+  DavixError* err = NULL;
+  ASSERT_EQ(-1, _posix.unlink_bulk(&_params, urls, errors, &err));
+  ASSERT_EQ(err->getStatus(), StatusCode::PartialFailure);
+  DavixError::clearError(&err);
+
+  ASSERT_EQ(errors.size(), urls.size());
+  for(size_t i = 0; i < urls.size(); i++) {
+    if(i == 1501) {
+      ASSERT_EQ(errors[i]->getStatus(), StatusCode::FileNotFound);
+      DavixError::clearError(&errors[i]);
+    }
+    ASSERT_TRUE(errors[i] == NULL) << urls[i];
+  }
+  ASSERT_TRUE(_objects.empty());
+
+  // batches of at most 1000 keys per bucket, no single deletes
+  std::sort(_batches.begin(), _batches.end());
+  ASSERT_EQ(_batches, std::vector<size_t>({2, 501, 1000}));
+  ASSERT_EQ(countReceived("DELETE"), 0u);
+}
+
+TEST_F(S3BulkOps, DeleteRetriesMissingKeys) {
+  std::vector<std::string> urls;
+  const char* keys[] = { "a", "b", "c", "d" };
+  for(size_t i = 0; i < 4; i++) {
+    _objects.insert(SSTR("/b1/" << keys[i]));
+    urls.push_back(SSTR(_base << "/b1/" << keys[i]));
+  }
+  _unanswered.insert("b");
+  _unanswered.insert("d");
+
+  std::vector<DavixError*> errors;
+  ASSERT_EQ(0, _posix.unlink_bulk(&_params, urls, errors, NULL));
+  ASSERT_TRUE(_objects.empty());
+
+  // only the keys left out of the answer are deleted one by one
+  ASSERT_EQ(countReceived("POST"), 1u);
+  ASSERT_EQ(countReceived("DELETE"), 2u);
+  ASSERT_EQ(countRequests("DELETE", "/b1/b"), 1u);
+  ASSERT_EQ(countRequests("DELETE", "/b1/d"), 1u);
+}
+
+TEST_F(S3BulkOps, DeleteEscapedKeys) {
+  // keys are given escaped in urls, and sent as they are in the requests
+  const char* keys[] = { "a b", "50%25", "what?", "#1", "dir/x y%z" };
+  std::vector<std::string> urls;
+  for(size_t i = 0; i < 5; i++) {
+    _objects.insert(SSTR("/b1/" << keys[i]));
+    urls.push_back(SSTR(_base << "/b1/" << Uri::escapeString(keys[i])));
+  }
+
+  std::vector<DavixError*> errors;
+  ASSERT_EQ(0, _posix.unlink_bulk(&_params, urls, errors, NULL));
+  ASSERT_TRUE(_objects.empty());
+  ASSERT_EQ(countReceived("POST"), 1u);
+  ASSERT_EQ(countReceived("DELETE"), 0u);
+}
@@ -0,0 +1,147 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <davix.hpp>
+#include "test-utils.hpp"
+
+using namespace Davix;
+
+class FdStatisticsTest : public HttpHandlerFixture {
+public:
+  FdStatisticsTest() {
+    for(size_t i = 0; i < 10000; i++) {
+      _contents.push_back('a' + (i % 26));
+    }
+
+    // /file supports single byte ranges, /moved redirects to it
+    _handler = [this](const HttpExchangeRequest &req) {
+      if(req.path == "/moved") {
+        HttpExchangeResponse resp(302);
+        resp.headers.push_back(std::make_pair("Location", _base + "/file"));
+        return resp;
+      }
+      if(req.path != "/file") {
+        return HttpExchangeResponse(404);
+      }
+
+      unsigned long first = 0, last = 0;
+      const std::string range = req.header("range");
+      if(req.method != "GET" || range.find(',') != std::string::npos ||
+         sscanf(range.c_str(), "bytes=%lu-%lu", &first, &last) != 2) {
+        return HttpExchangeResponse(200, _contents);
+      }
+
+      last = std::min<unsigned long>(last, _contents.size() - 1);
+      HttpExchangeResponse resp(206, _contents.substr(first, last - first + 1));
+      resp.headers.push_back(std::make_pair("Content-Range", SSTR("bytes " << first << "-" << last << "/" << _contents.size())));
+      return resp;
+    };
+  }
+
+  FdStatistics statistics(DAVIX_FD* fd) {
+    FdStatistics stats;
+    DavixError* err = NULL;
+    EXPECT_EQ(0, _posix.fstatistics(fd, &stats, &err));
+    EXPECT_EQ(NULL, err);
+    return stats;
+  }
+
+protected:
+  Context _context;
+  DavPosix _posix{&_context};
+  std::string _contents;
+};
+
+TEST_F(FdStatisticsTest, CountsEveryRequestSent) {
+  DavixError* err = NULL;
+  DAVIX_FD* fd = _posix.open(NULL, _base + "/file", O_RDONLY, &err);
+  ASSERT_TRUE(fd != NULL);
+
+  // the stat done by open
+  FdStatistics stats = statistics(fd);
+  ASSERT_EQ(1u, received().size());
+  ASSERT_EQ(1u, stats.requests);
+
+  char buffer[100];
+  ASSERT_EQ(100, _posix.pread(fd, buffer, sizeof(buffer), 500, &err));
+  ASSERT_EQ(std::string(buffer, 100), _contents.substr(500, 100));
+
+  // neighbouring ranges, merged into a single one
+  DavIOVecInput in[3];
+  DavIOVecOuput out[3];
+  char vec_buffers[3][10];
+  for(int i = 0; i < 3; i++) {
+    in[i].diov_buffer = vec_buffers[i];
+    in[i].diov_offset = 1000 + i * 20;
+    in[i].diov_size = 10;
+  }
+  ASSERT_GE(_posix.preadVec(fd, in, out, 3, &err), 30);
+  for(int i = 0; i < 3; i++) {
+    ASSERT_EQ(10u, out[i].diov_size);
+    ASSERT_EQ(std::string(vec_buffers[i], 10), _contents.substr(1000 + i * 20, 10));
+  }
+
+  stats = statistics(fd);
+  ASSERT_EQ(received().size(), stats.requests);
+  ASSERT_EQ(3u, stats.requests);
+  ASSERT_EQ(2u, stats.ranges_coalesced);
+  ASSERT_GE(stats.bytes_read, 130u);
+  ASSERT_EQ(0u, stats.retries);
+
+  ASSERT_EQ(0, _posix.close(fd, &err));
+}
+
+TEST_F(FdStatisticsTest, CountsRedirections) {
+  DavixError* err = NULL;
+  DAVIX_FD* fd = _posix.open(NULL, _base + "/moved", O_RDONLY, &err);
+  ASSERT_TRUE(fd != NULL);
+
+  char buffer[10];
+  ASSERT_EQ(10, _posix.pread(fd, buffer, sizeof(buffer), 0, &err));
+
+  // each hop of a redirection is a request of its own
+  FdStatistics stats = statistics(fd);
+  ASSERT_EQ(received().size(), stats.requests);
+  ASSERT_GE(stats.requests, 3u);
+
+  ASSERT_EQ(0, _posix.close(fd, &err));
+}
+
+TEST_F(FdStatisticsTest, FileDescriptorsCountSeparately) {
+  DavixError* err = NULL;
+  StatInfo info;
+  info.size = _contents.size();
+  DAVIX_FD* fd1 = _posix.open(NULL, _base + "/file", O_RDONLY, info, &err);
+  DAVIX_FD* fd2 = _posix.open(NULL, _base + "/file", O_RDONLY, info, &err);
+  ASSERT_TRUE(fd1 != NULL && fd2 != NULL);
+
+  char buffer[10];
+  ASSERT_EQ(10, _posix.pread(fd1, buffer, sizeof(buffer), 0, &err));
+  ASSERT_EQ(10, _posix.pread(fd1, buffer, sizeof(buffer), 5000, &err));
+  ASSERT_EQ(10, _posix.pread(fd2, buffer, sizeof(buffer), 0, &err));
+
+  // no stat with the caller supplied information
+  ASSERT_EQ(2u, statistics(fd1).requests);
+  ASSERT_EQ(1u, statistics(fd2).requests);
+
+  ASSERT_EQ(0, _posix.close(fd1, &err));
+  ASSERT_EQ(0, _posix.close(fd2, &err));
+}
@@ -0,0 +1,148 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <davix.hpp>
+#include "test-utils.hpp"
+
+using namespace Davix;
+
+class Listing : public HttpHandlerFixture {
+public:
+  Listing() : _posix(&_context) {}
+
+  // names listed through readdirpp, with their sizes
+  std::vector<std::pair<std::string, dav_size_t> > readdir(const std::string &url) {
+    std::vector<std::pair<std::string, dav_size_t> > entries;
+    DavixError* err = NULL;
+    DAVIX_DIR* dir = _posix.opendirpp(&_params, url, &err);
+    EXPECT_TRUE(dir != NULL) << ((err) ? err->getErrMsg() : std::string());
+    if(dir == NULL) {
+      DavixError::clearError(&err);
+      return entries;
+    }
+
+    struct stat st;
+    struct dirent* ent;
+    while((ent = _posix.readdirpp(dir, &st, &err)) != NULL) {
+      entries.push_back(std::make_pair(std::string(ent->d_name), (dav_size_t) st.st_size));
+    }
+    EXPECT_TRUE(err == NULL) << ((err) ? err->getErrMsg() : std::string());
+    DavixError::clearError(&err);
+    _posix.closedirpp(dir, NULL);
+    return entries;
+  }
+
+protected:
+  Context _context;
+  DavPosix _posix;
+  RequestParams _params;
+};
+
+TEST_F(Listing, WebDavAcrossBlocks) {
+  // a listing spanning many read blocks, entries of varying lengths make
+  // the boundaries fall inside element names and cdata
+  std::ostringstream ss;
+  ss << "<?xml version=\"1.0\" encoding=\"utf-8\"?><D:multistatus xmlns:D=\"DAV:\">"
+     << "<D:response><D:href>/dir/</D:href><D:propstat><D:prop>"
+     << "<D:resourcetype><D:collection/></D:resourcetype></D:prop>"
+     << "<D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>";
+  for(size_t i = 0; i < 2000; i++) {
+    ss << "<D:response><D:href>/dir/file-" << i << std::string(i % 13, 'x') << "</D:href>"
+       << "<D:propstat><D:prop><D:getcontentlength>" << i * 1000 + 1 << "</D:getcontentlength>"
+       << "<D:resourcetype/></D:prop><D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>";
+  }
+  ss << "</D:multistatus>";
+  const std::string body = ss.str();
+  ASSERT_GT(body.size(), 256u * 1024u);
+
+  _handler = [body](const HttpExchangeRequest &req) {
+    if(req.method != "PROPFIND" || req.path != "/dir/") {
+      return HttpExchangeResponse(404);
+    }
+    return HttpExchangeResponse(207, body);
+  };
+
+  std::vector<std::pair<std::string, dav_size_t> > entries = readdir(_base + "/dir/");
+  ASSERT_EQ(entries.size(), 2000u);
+  for(size_t i = 0; i < entries.size(); i++) {
+    ASSERT_EQ(entries[i].first, SSTR("file-" << i << std::string(i % 13, 'x')));
+    ASSERT_EQ(entries[i].second, i * 1000 + 1);
+  }
+}
+
+TEST_F(Listing, WebDavEscapedHrefs) {
+  // hrefs given as URLs or absolute paths are unescaped alike, names sent
+  // raw by the server are kept
+  _handler = [](const HttpExchangeRequest &req) {
+    if(req.method != "PROPFIND" || req.path != "/dir/") {
+      return HttpExchangeResponse(404);
+    }
+    return HttpExchangeResponse(207,
+      "<?xml version=\"1.0\" encoding=\"utf-8\"?><D:multistatus xmlns:D=\"DAV:\">"
+      "<D:response><D:href>/dir/</D:href><D:propstat><D:prop>"
+      "<D:resourcetype><D:collection/></D:resourcetype></D:prop>"
+      "<D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>"
+      "<D:response><D:href>/dir/a%20b</D:href><D:propstat><D:prop><D:getcontentlength>1</D:getcontentlength>"
+      "<D:resourcetype/></D:prop><D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>"
+      "<D:response><D:href>http://localhost:22222/dir/50%25</D:href><D:propstat><D:prop><D:getcontentlength>2</D:getcontentlength>"
+      "<D:resourcetype/></D:prop><D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>"
+      "<D:response><D:href>/dir/100%</D:href><D:propstat><D:prop><D:getcontentlength>3</D:getcontentlength>"
+      "<D:resourcetype/></D:prop><D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>"
+      "</D:multistatus>");
+  };
+
+  std::vector<std::pair<std::string, dav_size_t> > entries = readdir(_base + "/dir/");
+  ASSERT_EQ(entries.size(), 3u);
+  ASSERT_EQ(entries[0], std::make_pair(std::string("a b"), (dav_size_t) 1));
+  ASSERT_EQ(entries[1], std::make_pair(std::string("50%"), (dav_size_t) 2));
+  ASSERT_EQ(entries[2], std::make_pair(std::string("100%"), (dav_size_t) 3));
+}
+
+TEST_F(Listing, CompactListingProperties) {
+  // only the properties kept by the listing are asked for
+  std::string propfind;
+  _handler = [&propfind](const HttpExchangeRequest &req) {
+    if(req.method != "PROPFIND" || req.path != "/dir/") {
+      return HttpExchangeResponse(404);
+    }
+    propfind = req.body;
+    return HttpExchangeResponse(207,
+      "<?xml version=\"1.0\" encoding=\"utf-8\"?><D:multistatus xmlns:D=\"DAV:\">"
+      "<D:response><D:href>/dir/</D:href><D:propstat><D:prop>"
+      "<D:resourcetype><D:collection/></D:resourcetype></D:prop>"
+      "<D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>"
+      "<D:response><D:href>/dir/a</D:href><D:propstat><D:prop><D:getcontentlength>7</D:getcontentlength>"
+      "<D:resourcetype/></D:prop><D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>"
+      "</D:multistatus>");
+  };
+
+  DavFile file(_context, Uri(_base + "/dir/"));
+  CompactListing entries(StatProperty::Size);
+  ASSERT_EQ(file.listCollection(&_params, entries), 1u);
+  ASSERT_EQ(std::string(entries.name(0)), "a");
+  ASSERT_EQ(entries.info(0).size, 7u);
+
+  ASSERT_NE(propfind.find("<D:getcontentlength/>"), std::string::npos);
+  ASSERT_EQ(propfind.find("<D:getlastmodified/>"), std::string::npos);
+  ASSERT_EQ(propfind.find("<L:mode/>"), std::string::npos);
+  // the params given are left alone
+  ASSERT_EQ(_params.getStatProperties(), (unsigned int) StatProperty::All);
+}
@@ -0,0 +1,119 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <davix.hpp>
+#include "test-utils.hpp"
+
+using namespace Davix;
+
+class MapRegion : public HttpHandlerFixture {
+public:
+  MapRegion() {
+    for(size_t i = 0; i < 10000; i++) {
+      _contents.push_back('a' + (i % 26));
+    }
+
+    // a file served with single byte ranges
+    _handler = [this](const HttpExchangeRequest &req) {
+      if(req.path != "/file") {
+        return HttpExchangeResponse(404);
+      }
+
+      unsigned long first = 0, last = 0;
+      const std::string range = req.header("range");
+      if(req.method != "GET" || sscanf(range.c_str(), "bytes=%lu-%lu", &first, &last) != 2) {
+        return HttpExchangeResponse(200, _contents);
+      }
+      if(first >= _contents.size()) {
+        return HttpExchangeResponse(416);
+      }
+
+      last = std::min<unsigned long>(last, _contents.size() - 1);
+      HttpExchangeResponse resp(206, _contents.substr(first, last - first + 1));
+      resp.headers.push_back(std::make_pair("Content-Range", SSTR("bytes " << first << "-" << last << "/" << _contents.size())));
+      return resp;
+    };
+  }
+
+protected:
+  std::string _contents;
+};
+
+TEST_F(MapRegion, ClampedToEndOfFile) {
+  Context context;
+  DavFile file(context, Uri(_base + "/file"));
+
+  // length 0: up to the end of the file, found by a stat
+  DavFile::MappedRegion region = file.mapRegion(NULL, 1000, 0, 4096);
+  ASSERT_EQ(region.size(), 9000u);
+  ASSERT_EQ(region.offset(), 1000);
+  ASSERT_EQ(region.pageSize(), 4096u);
+  ASSERT_EQ(countReceived("GET"), 0u);
+
+  ASSERT_FALSE(region.isMaterialized(0, 1));
+  const char* data = region.materialize(8990, 10);
+  ASSERT_EQ(std::string(data, 10), _contents.substr(9990, 10));
+  ASSERT_EQ(countReceived("GET"), 1u);
+
+  // only the last page was fetched
+  ASSERT_TRUE(region.isMaterialized(8192, 808));
+  ASSERT_FALSE(region.isMaterialized(0, 1));
+
+  region.materialize(0, 9000);
+  ASSERT_EQ(std::string(region.data(), 9000), _contents.substr(1000));
+  ASSERT_EQ(countReceived("GET"), 2u);
+
+  ASSERT_THROW(region.materialize(8999, 2), DavixException);
+}
+
+TEST_F(MapRegion, ExplicitLength) {
+  Context context;
+  DavFile file(context, Uri(_base + "/file"));
+
+  // no stat needed
+  DavFile::MappedRegion region = file.mapRegion(NULL, 100, 200, 4096);
+  ASSERT_EQ(region.size(), 200u);
+  ASSERT_TRUE(received().empty());
+
+  const char* data = region.materialize(0, 200);
+  ASSERT_EQ(std::string(data, 200), _contents.substr(100, 200));
+
+  // a region crossing the end of the file reads zeros after it
+  DavFile::MappedRegion tail = file.mapRegion(NULL, 8192, 4096, 4096);
+  data = tail.materialize(0, 4096);
+  ASSERT_EQ(std::string(data, 1808), _contents.substr(8192));
+  ASSERT_EQ(std::string(data + 1808, 4096 - 1808), std::string(4096 - 1808, '\0'));
+}
+
+TEST_F(MapRegion, OffsetPastEndOfFile) {
+  Context context;
+  DavFile file(context, Uri(_base + "/file"));
+
+  try {
+    file.mapRegion(NULL, 10000, 0, 0);
+    FAIL();
+  }
+  catch(DavixException &e) {
+    ASSERT_EQ(e.code(), StatusCode::InvalidArgument);
+  }
+
+  ASSERT_THROW(file.mapRegion(NULL, -1, 10, 0), DavixException);
+}
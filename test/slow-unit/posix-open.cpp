@@ -0,0 +1,101 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <davix.hpp>
+#include "test-utils.hpp"
+
+using namespace Davix;
+
+class PosixOpen : public HttpHandlerFixture {
+public:
+  PosixOpen() : _posix(&_context) {
+    _files["/existing"] = "content";
+    _params.setStatOnOpen(false);
+
+    // a store of whole files
+    _handler = [this](const HttpExchangeRequest &req) {
+      if(req.method == "PUT") {
+        _files[req.path] = req.body;
+        return HttpExchangeResponse(201);
+      }
+
+      std::map<std::string, std::string>::const_iterator it = _files.find(req.path);
+      if(it == _files.end()) {
+        return HttpExchangeResponse(404);
+      }
+      return HttpExchangeResponse(200, it->second);
+    };
+  }
+
+protected:
+  Context _context;
+  DavPosix _posix;
+  RequestParams _params;
+  std::map<std::string, std::string> _files;
+};
+
+TEST_F(PosixOpen, CreateWithoutWrite) {
+  DavixError* err = NULL;
+  DAVIX_FD* fd = _posix.open(&_params, _base + "/new", O_WRONLY | O_CREAT, &err);
+  ASSERT_TRUE(fd != NULL);
+  ASSERT_TRUE(received().empty());
+
+  // the existence is checked when closing, the file is created empty
+  ASSERT_EQ(0, _posix.close(fd, &err));
+  ASSERT_EQ(1u, countReceived("PUT"));
+  ASSERT_EQ(1u, _files.count("/new"));
+  ASSERT_EQ("", _files["/new"]);
+}
+
+TEST_F(PosixOpen, CreateKeepsExistingFile) {
+  DavixError* err = NULL;
+  DAVIX_FD* fd = _posix.open(&_params, _base + "/existing", O_WRONLY | O_CREAT, &err);
+  ASSERT_TRUE(fd != NULL);
+
+  ASSERT_EQ(0, _posix.close(fd, &err));
+  ASSERT_EQ(0u, countReceived("PUT"));
+  ASSERT_EQ("content", _files["/existing"]);
+}
+
+TEST_F(PosixOpen, CreateAfterRead) {
+  DavixError* err = NULL;
+  DAVIX_FD* fd = _posix.open(&_params, _base + "/existing", O_RDWR | O_CREAT, &err);
+  ASSERT_TRUE(fd != NULL);
+
+  char buffer[7];
+  ASSERT_EQ(7, _posix.read(fd, buffer, sizeof(buffer), &err));
+
+  // the read proved the file exists, nothing left to check
+  const size_t requests = received().size();
+  ASSERT_EQ(0, _posix.close(fd, &err));
+  ASSERT_EQ(requests, received().size());
+  ASSERT_EQ("content", _files["/existing"]);
+}
+
+TEST_F(PosixOpen, TruncateWithoutWrite) {
+  DavixError* err = NULL;
+  DAVIX_FD* fd = _posix.open(&_params, _base + "/existing", O_WRONLY | O_CREAT | O_TRUNC, &err);
+  ASSERT_TRUE(fd != NULL);
+
+  ASSERT_EQ(0, _posix.close(fd, &err));
+  ASSERT_EQ(1u, countReceived("PUT"));
+  ASSERT_EQ("", _files["/existing"]);
+}
@@ -0,0 +1,126 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <davix.hpp>
+#include "test-utils.hpp"
+
+using namespace Davix;
+
+class PosixWrite : public HttpHandlerFixture {
+public:
+  PosixWrite() : _posix(&_context), _putCode(201) {
+    for(size_t i = 0; i < 1024 * 1024; i++) {
+      _contents.push_back('a' + (i % 23));
+    }
+    _params.setStatOnOpen(false);
+    _params.setWriteBufferSize(64 * 1024);
+
+    // a store of whole files
+    _handler = [this](const HttpExchangeRequest &req) {
+      if(req.method != "PUT") {
+        return HttpExchangeResponse(405);
+      }
+      if(_putCode < 300) {
+        _files[req.path] = req.body;
+      }
+      return HttpExchangeResponse(_putCode);
+    };
+  }
+
+  // write _contents in blocks of size, true if all writes succeed
+  bool writeAll(DAVIX_FD* fd, size_t size) {
+    DavixError* err = NULL;
+    for(size_t pos = 0; pos < _contents.size(); pos += size) {
+      const size_t count = std::min(size, _contents.size() - pos);
+      if(_posix.write(fd, _contents.data() + pos, count, &err) != (ssize_t) count) {
+        DavixError::clearError(&err);
+        return false;
+      }
+    }
+    return true;
+  }
+
+protected:
+  Context _context;
+  DavPosix _posix;
+  RequestParams _params;
+  std::string _contents;
+  std::map<std::string, std::string> _files;
+  int _putCode;
+};
+
+TEST_F(PosixWrite, WriteClose) {
+  DavixError* err = NULL;
+  DAVIX_FD* fd = _posix.open(&_params, _base + "/new", O_WRONLY | O_CREAT, &err);
+  ASSERT_TRUE(fd != NULL);
+  ASSERT_TRUE(writeAll(fd, 10000));
+
+  ASSERT_EQ(0, _posix.close(fd, &err)) << ((err) ? err->getErrMsg() : std::string());
+  ASSERT_EQ(1u, countReceived("PUT"));
+  ASSERT_TRUE(_files["/new"] == _contents);
+}
+
+TEST_F(PosixWrite, CloseReportsUploadError) {
+  _putCode = 403;
+
+  DavixError* err = NULL;
+  DAVIX_FD* fd = _posix.open(&_params, _base + "/new", O_WRONLY | O_CREAT, &err);
+  ASSERT_TRUE(fd != NULL);
+  writeAll(fd, 10000);
+
+  // the upload fails once all the data is sent
+  ASSERT_EQ(-1, _posix.close(fd, &err));
+  ASSERT_TRUE(err != NULL);
+  ASSERT_EQ(err->getStatus(), StatusCode::PermissionRefused);
+  DavixError::clearError(&err);
+  ASSERT_EQ(0u, _files.count("/new"));
+}
+
+TEST_F(PosixWrite, NonSequentialWrite) {
+  DavixError* err = NULL;
+  DAVIX_FD* fd = _posix.open(&_params, _base + "/new", O_WRONLY | O_CREAT, &err);
+  ASSERT_TRUE(fd != NULL);
+  ASSERT_EQ(3, _posix.write(fd, "abc", 3, &err));
+
+  // going back is refused, the upload goes on from where it was
+  ASSERT_EQ(0, _posix.lseek(fd, 0, SEEK_SET, &err));
+  ASSERT_LT(_posix.write(fd, "xyz", 3, &err), 0);
+  ASSERT_EQ(err->getStatus(), StatusCode::InvalidArgument);
+  DavixError::clearError(&err);
+
+  ASSERT_EQ(3, _posix.lseek(fd, 3, SEEK_SET, &err));
+  ASSERT_EQ(3, _posix.write(fd, "def", 3, &err));
+  ASSERT_EQ(0, _posix.close(fd, &err));
+  ASSERT_EQ("abcdef", _files["/new"]);
+}
+
+TEST_F(PosixWrite, ExpectationRefusedRetriedOnce) {
+  // a refused 100-continue expectation is retried once, with either backend
+  _putCode = 417;
+  const char* backends[] = { "0", "1" };
+  for(size_t i = 0; i < 2; i++) {
+    setenv("DAVIX_USE_LIBCURL", backends[i], 1);
+    DavFile file(_context, Uri(_base + "/refused"));
+    ASSERT_THROW(file.put(&_params, _contents.data(), _contents.size()), DavixException);
+    ASSERT_EQ(2u * (i + 1), countReceived("PUT")) << "DAVIX_USE_LIBCURL=" << backends[i];
+  }
+  unsetenv("DAVIX_USE_LIBCURL");
+}
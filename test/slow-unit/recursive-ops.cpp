@@ -0,0 +1,196 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <davix.hpp>
+#include "test-utils.hpp"
+
+#include <algorithm>
+
+using namespace Davix;
+
+static std::string davResponse(const std::string &href, bool collection) {
+  return SSTR("<D:response><D:href>" << href << "</D:href><D:propstat><D:prop>"
+    << ((collection) ? "<D:resourcetype><D:collection/></D:resourcetype>" : "<D:getcontentlength>1</D:getcontentlength><D:resourcetype/>")
+    << "</D:prop><D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>");
+}
+
+//------------------------------------------------------------------------------
+// WebDAV server holding the collections of _collections and the files of
+// _files, by escaped path. Non-empty collections cannot be deleted, stats of
+// the paths of _forbidden are refused.
+//------------------------------------------------------------------------------
+class RecursiveOps : public HttpHandlerFixture {
+public:
+  RecursiveOps() : _posix(&_context) {
+    _params.setProtocol(RequestProtocol::Webdav);
+    _params.setOperationRetry(0);
+    _collections.insert("/");
+
+    _handler = [this](const HttpExchangeRequest &req) {
+      const bool collection = (_collections.count(req.path) != 0);
+      // files are found with a trailing slash too
+      const std::string file = (req.path.size() > 1 && *req.path.rbegin() == '/') ? req.path.substr(0, req.path.size() - 1) : req.path;
+      if(req.method == "PROPFIND") {
+        if(_forbidden.count(req.path) != 0) {
+          return HttpExchangeResponse(403);
+        }
+        if(!collection && _files.count(file) == 0) {
+          return HttpExchangeResponse(404);
+        }
+
+        std::string responses = davResponse((collection) ? req.path : file, collection);
+        if(collection && req.header("depth") == "1") {
+          std::vector<std::string> entries = children(req.path);
+          for(size_t i = 0; i < entries.size(); i++) {
+            responses += davResponse(entries[i], _collections.count(entries[i]) != 0);
+          }
+        }
+        return HttpExchangeResponse(207, "<?xml version=\"1.0\" encoding=\"utf-8\"?><D:multistatus xmlns:D=\"DAV:\">" + responses + "</D:multistatus>");
+      }
+
+      if(req.method == "MKCOL") {
+        if(collection || _files.count(file) != 0) {
+          return HttpExchangeResponse(405);
+        }
+        const std::string parent = req.path.substr(0, req.path.rfind('/', req.path.size() - 2) + 1);
+        if(_collections.count(parent) == 0) {
+          return HttpExchangeResponse(409);
+        }
+        _collections.insert(req.path);
+        return HttpExchangeResponse(201);
+      }
+
+      if(req.method == "DELETE") {
+        if(collection) {
+          if(!children(req.path).empty()) {
+            return HttpExchangeResponse(403);
+          }
+          _collections.erase(req.path);
+          return HttpExchangeResponse(204);
+        }
+        return HttpExchangeResponse((_files.erase(req.path) != 0) ? 204 : 404);
+      }
+      return HttpExchangeResponse(405);
+    };
+  }
+
+  // direct entries of a collection
+  std::vector<std::string> children(const std::string &path) {
+    std::vector<std::string> entries;
+    for(int i = 0; i < 2; i++) {
+      const std::set<std::string> &resources = (i == 0) ? _collections : _files;
+      for(std::set<std::string>::const_iterator it = resources.begin(); it != resources.end(); it++) {
+        if(it->size() > path.size() && it->compare(0, path.size(), path) == 0 &&
+           it->find('/', path.size()) >= it->size() - 1) {
+          entries.push_back(*it);
+        }
+      }
+    }
+    return entries;
+  }
+
+  size_t countRequests(const std::string &method, const std::string &path) {
+    std::vector<std::string> requests = received();
+    return std::count(requests.begin(), requests.end(), method + " " + path);
+  }
+
+protected:
+  Context _context;
+  DavPosix _posix;
+  RequestParams _params;
+  std::set<std::string> _collections;
+  std::set<std::string> _files;
+  std::set<std::string> _forbidden;
+};
+
+TEST_F(RecursiveOps, DeleteTree) {
+  const char* collections[] = { "/top/", "/top/d1/", "/top/d1/d2/", "/top/d3/", "/keep/" };
+  const char* files[] = { "/top/a", "/top/50%2525", "/top/d1/b%20c", "/top/d1/d2/e", "/top/d1/d2/f", "/keep/g" };
+  _collections.insert(collections, collections + 5);
+  _files.insert(files, files + 6);
+  _params.setMetadataConcurrency(4);
+
+  DavixError* err = NULL;
+  ASSERT_EQ(0, _posix.rmdir_recursive(&_params, _base + "/top/", &err)) << ((err) ? err->getErrMsg() : std::string());
+
+  ASSERT_EQ(_collections, std::set<std::string>({ "/", "/keep/" }));
+  ASSERT_EQ(_files, std::set<std::string>({ "/keep/g" }));
+
+  // the refused DELETE of the whole tree, then one per resource
+  ASSERT_EQ(countRequests("DELETE", "/top/"), 2u);
+  ASSERT_EQ(countRequests("DELETE", "/top/50%2525"), 1u);
+  ASSERT_EQ(countReceived("DELETE"), 10u);
+}
+
+TEST_F(RecursiveOps, DeleteFile) {
+  _files.insert("/a");
+
+  DavixError* err = NULL;
+  ASSERT_EQ(0, _posix.rmdir_recursive(&_params, _base + "/a", &err));
+  ASSERT_TRUE(_files.empty());
+  ASSERT_EQ(countReceived("PROPFIND"), 0u);
+
+  ASSERT_NE(0, _posix.rmdir_recursive(&_params, _base + "/a", &err));
+  ASSERT_EQ(err->getStatus(), StatusCode::FileNotFound);
+  DavixError::clearError(&err);
+}
+
+TEST_F(RecursiveOps, MakeParentsBisection) {
+  const char* collections[] = { "/a/", "/a/b/", "/a/b/c/" };
+  _collections.insert(collections, collections + 3);
+
+  DavixError* err = NULL;
+  ASSERT_EQ(0, _posix.mkdir_parents(&_params, _base + "/a/b/c/d/e/f/g", 0755, &err)) << ((err) ? err->getErrMsg() : std::string());
+  ASSERT_EQ(_collections.count("/a/b/c/d/e/f/g/"), 1u);
+
+  // 8 collections on the path, the existing ones are not created again
+  ASSERT_LE(countReceived("PROPFIND"), 3u);
+  ASSERT_EQ(countReceived("MKCOL"), 4u);
+  ASSERT_EQ(countRequests("MKCOL", "/a/b/c/d/"), 1u);
+
+  ASSERT_EQ(0, _posix.mkdir_parents(&_params, _base + "/a/b/c/d/e/f/g", 0755, &err));
+  ASSERT_EQ(countReceived("MKCOL"), 4u);
+
+  _files.insert("/a/file");
+  ASSERT_NE(0, _posix.mkdir_parents(&_params, _base + "/a/file/x/y", 0755, &err));
+  ASSERT_EQ(err->getStatus(), StatusCode::IsNotADirectory);
+  DavixError::clearError(&err);
+}
+
+TEST_F(RecursiveOps, MakeParentsForbiddenAncestor) {
+  const char* collections[] = { "/a/", "/a/b/", "/a/b/c/" };
+  _collections.insert(collections, collections + 3);
+  _forbidden.insert("/a/");
+  _forbidden.insert("/a/b/");
+
+  // the bisection starts at /a/b/, the path is walked up from the leaf
+  DavixError* err = NULL;
+  ASSERT_EQ(0, _posix.mkdir_parents(&_params, _base + "/a/b/c/d/", 0755, &err)) << ((err) ? err->getErrMsg() : std::string());
+  ASSERT_EQ(countRequests("PROPFIND", "/a/b/"), 1u);
+  ASSERT_EQ(countReceived("MKCOL"), 1u);
+  ASSERT_EQ(_collections.count("/a/b/c/d/"), 1u);
+
+  // up to an unreadable collection, taken as existing
+  ASSERT_EQ(0, _posix.mkdir_parents(&_params, _base + "/a/b/x/y/", 0755, &err)) << ((err) ? err->getErrMsg() : std::string());
+  ASSERT_EQ(countReceived("MKCOL"), 3u);
+  ASSERT_EQ(countRequests("MKCOL", "/a/b/x/"), 1u);
+  ASSERT_EQ(_collections.count("/a/b/x/y/"), 1u);
+}
@@ -0,0 +1,278 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <davix.hpp>
+#include "test-utils.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <thread>
+
+using namespace Davix;
+
+static std::map<std::string, std::string> parseQuery(const std::string &path) {
+  std::map<std::string, std::string> query;
+  const std::string::size_type pos = path.find('?');
+  if(pos == std::string::npos) {
+    return query;
+  }
+
+  std::istringstream ss(path.substr(pos + 1));
+  std::string param;
+  while(std::getline(ss, param, '&')) {
+    const std::string::size_type eq = param.find('=');
+    if(eq == std::string::npos) {
+      query[param] = std::string();
+    }
+    else {
+      query[param.substr(0, eq)] = Uri::unescapeString(param.substr(eq + 1));
+    }
+  }
+  return query;
+}
+
+//------------------------------------------------------------------------------
+// S3 server holding the keys of _keys in bucket "bucket", addressed path-style
+//------------------------------------------------------------------------------
+class S3Listing : public HttpHandlerFixture {
+public:
+  S3Listing() : _posix(&_context), _pages(0), _failingPage(0) {
+    _handler = [this](const HttpExchangeRequest &req) { return listBucket(req); };
+
+    _params.setProtocol(RequestProtocol::AwsS3);
+    _params.setAwsAlternate(true);
+    _params.setOperationRetry(0);
+    _params.setS3MaxKey(3);
+  }
+
+  HttpExchangeResponse listBucket(const HttpExchangeRequest &req) {
+    if(req.method != "GET" || req.path.compare(0, 9, "/bucket/?") != 0) {
+      return HttpExchangeResponse(404);
+    }
+
+    std::map<std::string, std::string> query = parseQuery(req.path);
+    const std::string prefix = query["prefix"];
+    const std::string delimiter = query["delimiter"];
+    const std::string marker = query["marker"];
+    const size_t maxKeys = (query.count("max-keys") != 0) ? atoi(query["max-keys"].c_str()) : 1000;
+    if(++_pages == _failingPage) {
+      return HttpExchangeResponse(500);
+    }
+
+    std::ostringstream contents, prefixes;
+    std::string last;
+    size_t count = 0;
+    bool truncated = false;
+
+    for(std::set<std::string>::iterator it = _keys.upper_bound(marker); it != _keys.end(); it++) {
+      if(it->compare(0, prefix.size(), prefix) != 0) {
+        continue;
+      }
+
+      std::string common;
+      const std::string::size_type sep = (delimiter.empty()) ? std::string::npos : it->find(delimiter, prefix.size());
+      if(sep != std::string::npos) {
+        // a common prefix returned as marker is not listed again
+        common = it->substr(0, sep + delimiter.size());
+        if(common == last || common == marker) {
+          continue;
+        }
+      }
+
+      if(count == maxKeys) {
+        truncated = true;
+        break;
+      }
+      count++;
+
+      if(!common.empty()) {
+        prefixes << "<CommonPrefixes><Prefix>" << common << "</Prefix></CommonPrefixes>";
+        last = common;
+      }
+      else {
+        contents << "<Contents><Key>" << *it << "</Key><LastModified>2019-01-01T00:00:00.000Z</LastModified>"
+                 << "<Size>" << it->size() << "</Size></Contents>";
+        last = *it;
+      }
+    }
+
+    std::ostringstream body;
+    body << "<?xml version=\"1.0\" encoding=\"UTF-8\"?><ListBucketResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+         << "<Name>bucket</Name><Prefix>" << prefix << "</Prefix><Marker>" << marker << "</Marker>"
+         << "<MaxKeys>" << maxKeys << "</MaxKeys><IsTruncated>" << ((truncated) ? "true" : "false") << "</IsTruncated>";
+    if(truncated) {
+      body << "<NextMarker>" << last << "</NextMarker>";
+    }
+    body << contents.str() << prefixes.str() << "</ListBucketResult>";
+    return HttpExchangeResponse(200, body.str());
+  }
+
+  // names listed through readdirpp
+  std::vector<std::string> readdir(const std::string &url, const RequestParams &params) {
+    std::vector<std::string> names;
+    DavixError* err = NULL;
+    DAVIX_DIR* dir = _posix.opendirpp(&params, url, &err);
+    EXPECT_TRUE(dir != NULL) << ((err) ? err->getErrMsg() : std::string());
+    if(dir == NULL) {
+      DavixError::clearError(&err);
+      return names;
+    }
+
+    struct stat st;
+    struct dirent* ent;
+    while((ent = _posix.readdirpp(dir, &st, &err)) != NULL) {
+      names.push_back(ent->d_name);
+    }
+    EXPECT_TRUE(err == NULL) << ((err) ? err->getErrMsg() : std::string());
+    DavixError::clearError(&err);
+    _posix.closedirpp(dir, NULL);
+    return names;
+  }
+
+  // listing of url, sequential then parallel, which must agree
+  std::vector<std::string> compareListings(const std::string &url, S3ListingMode::S3ListingMode mode, unsigned int concurrency) {
+    RequestParams params(_params);
+    params.setS3ListingMode(mode);
+    params.setListingOrder(ListingOrder::Ordered);
+    std::vector<std::string> sequential = readdir(url, params);
+
+    params.setS3ParallelListing(true);
+    params.setMetadataConcurrency(concurrency);
+    std::vector<std::string> parallel = readdir(url, params);
+    EXPECT_EQ(sequential, parallel);
+    return sequential;
+  }
+
+protected:
+  Context _context;
+  DavPosix _posix;
+  RequestParams _params;
+  std::set<std::string> _keys;
+  // pages listed so far, the one numbered _failingPage fails
+  size_t _pages;
+  size_t _failingPage;
+};
+
+TEST_F(S3Listing, ParallelMatchesSequential) {
+  const char* keys[] = { "top", "dir/a", "dir/b", "dir/sub/c", "dir/sub/d", "dir/sub/deeper/e", "dir/t1", "dir/t2",
+                         "dir/t3", "dir/u/f", "dir/v", "other/g" };
+  _keys.insert(keys, keys + sizeof(keys) / sizeof(keys[0]));
+
+  for(unsigned int concurrency = 1; concurrency <= 4; concurrency += 3) {
+    std::vector<std::string> names = compareListings(_base + "/bucket/dir/", S3ListingMode::SemiHierarchical, concurrency);
+    ASSERT_EQ(names.size(), 10u);
+    ASSERT_EQ(names.front(), "dir/a");
+
+    names = compareListings(_base + "/bucket/", S3ListingMode::SemiHierarchical, concurrency);
+    ASSERT_EQ(names.size(), 12u);
+    ASSERT_EQ(names.back(), "top");
+
+    names = compareListings(_base + "/bucket/dir/sub", S3ListingMode::SemiHierarchical, concurrency);
+    ASSERT_EQ(names.size(), 3u);
+  }
+}
+
+TEST_F(S3Listing, ParallelSingleThreadBounded) {
+  // a shard found first, then many keys directly under the listed path
+  _keys.insert("dir/a/x");
+  for(size_t i = 0; i < 100; i++) {
+    _keys.insert(SSTR("dir/k" << std::setw(3) << std::setfill('0') << i));
+  }
+
+  RequestParams params(_params);
+  params.setS3ListingMode(S3ListingMode::SemiHierarchical);
+  params.setListingOrder(ListingOrder::Ordered);
+  params.setS3ParallelListing(true);
+  params.setMetadataConcurrency(1);
+
+  DavixError* err = NULL;
+  DAVIX_DIR* dir = _posix.opendirpp(&params, _base + "/bucket/dir/", &err);
+  ASSERT_TRUE(dir != NULL);
+  struct stat st;
+  struct dirent* ent = _posix.readdirpp(dir, &st, &err);
+  ASSERT_TRUE(ent != NULL);
+  ASSERT_STREQ(ent->d_name, "dir/a/x");
+
+  // the only thread lists the first shard instead of buffering the
+  // discovery of the keys while that shard waits for it
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  ASSERT_LT(countReceived("GET"), 10u);
+
+  size_t count = 1;
+  while((ent = _posix.readdirpp(dir, &st, &err)) != NULL) {
+    ASSERT_EQ(std::string(ent->d_name), SSTR("dir/k" << std::setw(3) << std::setfill('0') << count - 1));
+    count++;
+  }
+  ASSERT_TRUE(err == NULL);
+  ASSERT_EQ(count, 101u);
+  _posix.closedirpp(dir, NULL);
+}
+
+TEST_F(S3Listing, PagesFollowMarkers) {
+  for(size_t i = 0; i < 10; i++) {
+    _keys.insert(SSTR("k" << i));
+  }
+
+  // every page starts with the bucket entry, which is never returned
+  for(int prefetch = 0; prefetch < 2; prefetch++) {
+    RequestParams params(_params);
+    params.setS3ListingMode(S3ListingMode::SemiHierarchical);
+    params.setS3ListingPrefetch(prefetch != 0);
+
+    const size_t requests = countReceived("GET");
+    std::vector<std::string> names = readdir(_base + "/bucket/", params);
+    ASSERT_EQ(names.size(), 10u);
+    for(size_t i = 0; i < names.size(); i++) {
+      ASSERT_EQ(names[i], SSTR("k" << i));
+    }
+    ASSERT_EQ(countReceived("GET") - requests, 4u);
+  }
+
+  std::vector<std::string> requests = received();
+  ASSERT_EQ(std::count_if(requests.begin(), requests.end(),
+    [](const std::string &req) { return req.find("marker=k5") != std::string::npos; }), 2);
+}
+
+TEST_F(S3Listing, PrefetchError) {
+  for(size_t i = 0; i < 10; i++) {
+    _keys.insert(SSTR("k" << i));
+  }
+  _failingPage = 2;
+
+  RequestParams params(_params);
+  params.setS3ListingMode(S3ListingMode::SemiHierarchical);
+  params.setS3ListingPrefetch(true);
+
+  DavixError* err = NULL;
+  DAVIX_DIR* dir = _posix.opendirpp(&params, _base + "/bucket/", &err);
+  ASSERT_TRUE(dir != NULL);
+
+  // the first page is returned, then the failure of the second one
+  struct stat st;
+  size_t count = 0;
+  while(_posix.readdirpp(dir, &st, &err) != NULL) {
+    count++;
+  }
+  ASSERT_EQ(count, 3u);
+  ASSERT_TRUE(err != NULL);
+  DavixError::clearError(&err);
+  _posix.closedirpp(dir, NULL);
+}
@@ -22,6 +22,7 @@
 #include <gtest/gtest.h>
 #include <backend/StandaloneNeonRequest.hpp>
 #include <neon/neonsessionfactory.hpp>
+#include <core/ContentProvider.hpp>
 #include "../drunk-server/DrunkServer.hpp"
 #include "../drunk-server/LineReader.hpp"
 #include "../drunk-server/Interactors.hpp"
@@ -94,6 +95,185 @@ TEST_F(Standalone_Neon_Request, BasicSanity) {
   ASSERT_FALSE(request->isRecycledSession());
 }
 
+TEST_F(Standalone_Neon_Request, SpliceToFd) {
+  _uri = Uri("http://localhost:22222/chickens");
+
+  // larger than the neon socket buffer, so part of it is spliced from the socket
+  std::string body(10000, 'x');
+
+  SingleShotInteractor inter(
+    SSTR("GET /chickens HTTP/1.1\r\n"  <<
+          getDefaultUserAgent()        <<
+          "Keep-Alive: \r\n"           <<
+          "Connection: Keep-Alive\r\n" <<
+          "TE: trailers\r\n"           <<
+          "Host: localhost:22222\r\n"  <<
+          "\r\n"),
+
+    SSTR("HTTP/1.1 200 OK\r\n"                       <<
+         "Date: Mon, 07 Oct 2019 14:02:25 GMT\r\n"   <<
+         "Content-Length: 10000\r\n"                 <<
+         "\r\n"                                      <<
+         body)
+  );
+
+  _drunk_server->autoAcceptNext(&inter);
+
+  std::unique_ptr<StandaloneRequest> request = makeStandaloneNeonReq();
+  ASSERT_TRUE(request->startRequest().ok());
+  ASSERT_EQ(request->getStatusCode(), 200);
+
+  int fds[2];
+  ASSERT_EQ(pipe(fds), 0);
+  ASSERT_TRUE(request->canSpliceToFd(fds[1]));
+
+  sleep(1); // yes this is a hack to be replaced
+
+  Status st;
+  dav_ssize_t total = 0, ret;
+  while((ret = request->spliceToFd(fds[1], 2048, st)) > 0) {
+    total += ret;
+  }
+
+  ASSERT_TRUE(st.ok());
+  ASSERT_EQ(total, 10000);
+
+  std::string received(10000, '\0');
+  for(size_t pos = 0; pos < received.size(); ) {
+    ret = read(fds[0], &received[pos], received.size() - pos);
+    ASSERT_GT(ret, 0);
+    pos += ret;
+  }
+  ASSERT_EQ(received, body);
+
+  close(fds[0]);
+  close(fds[1]);
+
+  ASSERT_TRUE(request->endRequest().ok());
+  ASSERT_TRUE(inter.ok());
+}
+
+TEST_F(Standalone_Neon_Request, ChunkedUpload) {
+  _uri = Uri("http://localhost:22222/chickens");
+  _verb = "PUT";
+
+  // size unknown in advance: the body goes out with chunked transfer-encoding
+  PipeContentProvider provider(1024);
+  ASSERT_TRUE(provider.push("I like turtles", 14));
+  provider.close();
+
+  SingleShotInteractor inter(
+    SSTR("PUT /chickens HTTP/1.1\r\n"      <<
+          getDefaultUserAgent()            <<
+          "Keep-Alive: \r\n"               <<
+          "Connection: Keep-Alive\r\n"     <<
+          "TE: trailers\r\n"               <<
+          "Host: localhost:22222\r\n"      <<
+          "Transfer-Encoding: chunked\r\n" <<
+          "\r\n"                           <<
+          "e\r\n"                          <<
+          "I like turtles\r\n"             <<
+          "0\r\n"                          <<
+          "\r\n"),
+
+    SSTR("HTTP/1.1 201 Created\r\n"                 <<
+         "Date: Mon, 07 Oct 2019 14:02:25 GMT\r\n"   <<
+         "Content-Length: 0\r\n"                    <<
+         "\r\n")
+  );
+
+  _drunk_server->autoAcceptNext(&inter);
+
+  std::unique_ptr<StandaloneNeonRequest> request(
+    new StandaloneNeonRequest(_factory.getNeon(), true, _boundHooks, _uri, _verb, _params, _headers, _flags, &provider, _deadline)
+  );
+
+  ASSERT_TRUE(request->startRequest().ok());
+  // the server only answers when the request, body included, matched
+  ASSERT_EQ(request->getStatusCode(), 201);
+  ASSERT_TRUE(request->endRequest().ok());
+}
+
+TEST_F(Standalone_Neon_Request, Expect100EarlyFailure) {
+  _uri = Uri("http://localhost:22222/chickens");
+  _verb = "PUT";
+  _flags = RequestFlag::SupportContinue100;
+
+  BufferContentProvider provider("I like turtles", 14);
+
+  // the server refuses the upload from its headers, the body is never sent
+  SingleShotInteractor inter(
+    SSTR("PUT /chickens HTTP/1.1\r\n"      <<
+          getDefaultUserAgent()            <<
+          "Keep-Alive: \r\n"               <<
+          "Connection: Keep-Alive\r\n"     <<
+          "TE: trailers\r\n"               <<
+          "Host: localhost:22222\r\n"      <<
+          "Content-Length: 14\r\n"         <<
+          "Expect: 100-continue\r\n"       <<
+          "\r\n"),
+
+    SSTR("HTTP/1.1 403 Forbidden\r\n"               <<
+         "Date: Mon, 07 Oct 2019 14:02:25 GMT\r\n"   <<
+         "Content-Length: 0\r\n"                    <<
+         "\r\n")
+  );
+
+  _drunk_server->autoAcceptNext(&inter);
+
+  std::unique_ptr<StandaloneNeonRequest> request(
+    new StandaloneNeonRequest(_factory.getNeon(), true, _boundHooks, _uri, _verb, _params, _headers, _flags, &provider, _deadline)
+  );
+
+  ASSERT_TRUE(request->startRequest().ok());
+  ASSERT_EQ(request->getStatusCode(), 403);
+  ASSERT_TRUE(request->endRequest().ok());
+  ASSERT_EQ(_factory.getNeon().getContinue100Cache().get(_uri), Continue100Cache::Supported);
+}
+
+TEST_F(Standalone_Neon_Request, Expect100NoAnswer) {
+  _uri = Uri("http://localhost:22222/chickens");
+  _verb = "PUT";
+  _flags = RequestFlag::SupportContinue100;
+
+  struct timespec wait = { 0, 100 * 1000 * 1000 };
+  _params.set100ContinueTimeout(&wait);
+
+  BufferContentProvider provider("I like turtles\r\n", 16);
+
+  // the server ignores the expectation: the body follows after the wait
+  SingleShotInteractor inter(
+    SSTR("PUT /chickens HTTP/1.1\r\n"      <<
+          getDefaultUserAgent()            <<
+          "Keep-Alive: \r\n"               <<
+          "Connection: Keep-Alive\r\n"     <<
+          "TE: trailers\r\n"               <<
+          "Host: localhost:22222\r\n"      <<
+          "Content-Length: 16\r\n"         <<
+          "Expect: 100-continue\r\n"       <<
+          "\r\n"                           <<
+          "I like turtles\r\n"),
+
+    SSTR("HTTP/1.1 201 Created\r\n"                 <<
+         "Date: Mon, 07 Oct 2019 14:02:25 GMT\r\n"   <<
+         "Content-Length: 0\r\n"                    <<
+         "\r\n")
+  );
+
+  _drunk_server->autoAcceptNext(&inter);
+
+  std::unique_ptr<StandaloneNeonRequest> request(
+    new StandaloneNeonRequest(_factory.getNeon(), true, _boundHooks, _uri, _verb, _params, _headers, _flags, &provider, _deadline)
+  );
+
+  ASSERT_TRUE(request->startRequest().ok());
+  ASSERT_EQ(request->getStatusCode(), 201);
+  ASSERT_TRUE(request->endRequest().ok());
+
+  // later uploads to this host skip the handshake
+  ASSERT_EQ(_factory.getNeon().getContinue100Cache().get(_uri), Continue100Cache::NoAnswer);
+}
+
 TEST_F(Standalone_Curl_Request, BasicSanity) {
   _headers.push_back(HeaderLine("I like", "Turtles"));
   _uri = Uri("http://localhost:22222/chickens");
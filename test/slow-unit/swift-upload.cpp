@@ -0,0 +1,263 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <davix.hpp>
+#include "test-utils.hpp"
+#include <fileops/UploadJournal.hpp>
+#include <utils/davix_s3_utils.hpp>
+#include <openssl/md5.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <fstream>
+#include <set>
+
+using namespace Davix;
+
+static const dav_size_t MiB = 1024 * 1024;
+
+static std::string md5(const std::string &data) {
+  unsigned char md[MD5_DIGEST_LENGTH];
+  MD5(reinterpret_cast<const unsigned char*>(data.c_str()), data.size(), md);
+  return S3::hexPrinter(md, MD5_DIGEST_LENGTH);
+}
+
+class SwiftUpload : public HttpHandlerFixture {
+public:
+  SwiftUpload() : _journalDir("/tmp/davix-tests-swift-journal"), _localPath("/tmp/davix-tests-swift-upload") {
+    ::mkdir(_journalDir.c_str(), 0700);
+    for(size_t i = 0; i < 3 * MiB + 100; i++) {
+      _contents.push_back('a' + (i % 26));
+    }
+    std::ofstream(_localPath.c_str()) << _contents;
+
+    _params.setProtocol(RequestProtocol::Swift);
+    _params.setUploadPartSize(MiB);
+    _params.setMultipartThreshold(MiB);
+    _params.setUploadConcurrency(1);
+    _params.setUploadJournalDir(_journalDir);
+
+    // segments stored in memory, the etag is their MD5 sum
+    _handler = [this](const HttpExchangeRequest &req) {
+      if(req.method == "PUT" && req.path.find("multipart-manifest=put") != std::string::npos) {
+        _manifest = req.body;
+        HttpExchangeResponse resp(201);
+        resp.headers.push_back(std::make_pair("Etag", "\"" + md5(req.body) + "\""));
+        return resp;
+      }
+      if(req.method == "PUT") {
+        if(_failing.count(req.path) > 0) {
+          return HttpExchangeResponse(403);
+        }
+        _segments[req.path] = req.body;
+        HttpExchangeResponse resp(201);
+        resp.headers.push_back(std::make_pair("Etag", _etag ? _etag(req.body) : md5(req.body)));
+        return resp;
+      }
+
+      std::map<std::string, std::string>::iterator it = _segments.find(req.path);
+      if(it == _segments.end()) {
+        return HttpExchangeResponse(404);
+      }
+      if(req.method == "DELETE") {
+        _segments.erase(it);
+        return HttpExchangeResponse(204);
+      }
+      HttpExchangeResponse resp(200, it->second);
+      resp.headers.push_back(std::make_pair("Etag", md5(it->second)));
+      return resp;
+    };
+  }
+
+  ~SwiftUpload() {
+    ::unlink(_localPath.c_str());
+    DavFile(_context, Uri(_base + "/cont/obj")).abortPendingUploads(&_params);
+    ::rmdir(_journalDir.c_str());
+  }
+
+  void upload() {
+    int fd = ::open(_localPath.c_str(), O_RDONLY);
+    ASSERT_GE(fd, 0);
+    try {
+      DavFile(_context, Uri(_base + "/cont/obj")).put(&_params, fd, _contents.size());
+    }
+    catch(...) {
+      ::close(fd);
+      throw;
+    }
+    ::close(fd);
+  }
+
+protected:
+  Context _context;
+  RequestParams _params;
+  std::string _journalDir;
+  std::string _localPath;
+  std::string _contents;
+
+  std::map<std::string, std::string> _segments;
+  std::set<std::string> _failing;
+  std::string _manifest;
+  std::function<std::string (const std::string &)> _etag;
+};
+
+TEST_F(SwiftUpload, ResumeChecksStoredSegments) {
+  _failing.insert("/cont/obj/3");
+  ASSERT_THROW(upload(), DavixException);
+  ASSERT_EQ(_segments.size(), 2u);
+  ASSERT_EQ(UploadJournal::findSources(_journalDir, Uri(_base + "/cont/obj")).size(), 1u);
+
+  // segment #1 disappeared from the server, it is sent again
+  _failing.clear();
+  _segments.erase("/cont/obj/1");
+  const size_t putsBefore = countReceived("PUT");
+  upload();
+
+  std::vector<std::string> requests = received();
+  ASSERT_NE(std::find(requests.begin(), requests.end(), "HEAD /cont/obj/1"), requests.end());
+  ASSERT_NE(std::find(requests.begin(), requests.end(), "HEAD /cont/obj/2"), requests.end());
+
+  // segments 1, 3 and 4, and the manifest
+  ASSERT_EQ(countReceived("PUT") - putsBefore, 4u);
+  ASSERT_EQ(_segments["/cont/obj/1"], _contents.substr(0, MiB));
+  ASSERT_EQ(_segments["/cont/obj/4"], _contents.substr(3 * MiB));
+  ASSERT_NE(_manifest.find(md5(_contents.substr(MiB, MiB))), std::string::npos);
+  ASSERT_TRUE(UploadJournal::findSources(_journalDir, Uri(_base + "/cont/obj")).empty());
+}
+
+TEST_F(SwiftUpload, ResumeOnlyFromSameSource) {
+  _failing.insert("/cont/obj/3");
+  ASSERT_THROW(upload(), DavixException);
+
+  // the local file changed: nothing is resumed
+  _failing.clear();
+  _contents[10] = '#';
+  _contents.push_back('z');
+  std::ofstream(_localPath.c_str()) << _contents;
+  const size_t headsBefore = countReceived("HEAD");
+  upload();
+
+  ASSERT_EQ(countReceived("HEAD"), headsBefore);
+  ASSERT_EQ(_segments["/cont/obj/1"], _contents.substr(0, MiB));
+}
+
+TEST_F(SwiftUpload, AbortPendingUploads) {
+  _failing.insert("/cont/obj/3");
+  ASSERT_THROW(upload(), DavixException);
+  ASSERT_EQ(_segments.size(), 2u);
+
+  // one of the segments is already gone
+  _segments.erase("/cont/obj/2");
+  DavFile file(_context, Uri(_base + "/cont/obj"));
+  ASSERT_EQ(file.abortPendingUploads(&_params), 1u);
+  ASSERT_TRUE(_segments.empty());
+  ASSERT_EQ(countReceived("DELETE"), 2u);
+
+  ASSERT_EQ(file.abortPendingUploads(&_params), 0u);
+}
+
+TEST_F(SwiftUpload, VerifySegmentChecksums) {
+  _params.setVerifySegmentChecksums(true);
+  _params.setUploadJournalDir("");
+  upload();
+  ASSERT_EQ(_segments.size(), 4u);
+  ASSERT_FALSE(_manifest.empty());
+
+  // a corrupted segment
+  _manifest.clear();
+  _etag = [](const std::string &data) { return "\"" + md5(data + "x") + "\""; };
+  ASSERT_THROW(upload(), DavixException);
+  ASSERT_TRUE(_manifest.empty());
+
+  // an etag which is not a MD5 sum can't be verified
+  _etag = [](const std::string &data) { return "\"opaque-" + std::to_string(data.size()) + "\""; };
+  ASSERT_THROW(upload(), DavixException);
+  ASSERT_TRUE(_manifest.empty());
+
+  // without verification, any etag goes
+  _params.setVerifySegmentChecksums(false);
+  upload();
+  ASSERT_NE(_manifest.find("opaque-"), std::string::npos);
+}
+
+TEST_F(SwiftUpload, MmapUploads) {
+  _params.setUploadJournalDir("");
+  _params.setUploadConcurrency(3);
+  _params.setMmapUploads(true);
+  upload();
+
+  ASSERT_EQ(_segments.size(), 4u);
+  for(size_t i = 0; i < 4; i++) {
+    ASSERT_EQ(_segments["/cont/obj/" + std::to_string(i + 1)], _contents.substr(i * MiB, MiB));
+  }
+}
+
+TEST_F(SwiftUpload, NoResumeWithoutSource) {
+  // contents given by a callback can't be identified, no journal is kept
+  _failing.insert("/cont/obj/3");
+  size_t pos = 0;
+  DataProviderFun callback = [this, &pos](void* buffer, dav_size_t size) -> dav_ssize_t {
+    if(size == 0) {
+      pos = 0;
+      return 0;
+    }
+    const size_t count = std::min<size_t>(size, _contents.size() - pos);
+    memcpy(buffer, _contents.data() + pos, count);
+    pos += count;
+    return count;
+  };
+  ASSERT_THROW(DavFile(_context, Uri(_base + "/cont/obj")).put(&_params, callback, _contents.size()), DavixException);
+  ASSERT_EQ(_segments.size(), 2u);
+  ASSERT_TRUE(UploadJournal::findSources(_journalDir, Uri(_base + "/cont/obj")).empty());
+}
+
+TEST_F(SwiftUpload, ChainedManifests) {
+  // a stream of tiny segments needs more than the 1000 segments of a
+  // manifest: the first 1000 go to a manifest of their own, referenced by
+  // the manifest of the object
+  _params.setUploadJournalDir("");
+  _params.setUploadPartSize(4);
+  size_t pos = 0;
+  DataProviderFun callback = [this, &pos](void* buffer, dav_size_t size) -> dav_ssize_t {
+    if(size == 0) {
+      pos = 0;
+      return 0;
+    }
+    const size_t count = std::min<size_t>(size, _contents.size() - pos);
+    memcpy(buffer, _contents.data() + pos, count);
+    pos += count;
+    return count;
+  };
+  DavFile(_context, Uri(_base + "/cont/obj")).put(&_params, callback);
+
+  ASSERT_EQ(_segments.size(), 1002u);
+  std::vector<std::string> requests = received();
+  ASSERT_EQ(std::count(requests.begin(), requests.end(), "PUT /cont/obj-0?multipart-manifest=put"), 1);
+  ASSERT_EQ(std::count(requests.begin(), requests.end(), "PUT /cont/obj?multipart-manifest=put"), 1);
+  ASSERT_EQ(countReceived("PUT"), 1004u);
+
+  // the manifest of the object starts with the first one
+  ASSERT_EQ(_manifest.find("{\"path\":\"/cont/obj-0\",\"etag\":\""), 1u);
+  ASSERT_NE(_manifest.find("\"path\":\"/cont/obj/1001\""), std::string::npos);
+  ASSERT_NE(_manifest.find("\"path\":\"/cont/obj/1002\""), std::string::npos);
+  ASSERT_EQ(_manifest.find("\"path\":\"/cont/obj/1000\""), std::string::npos);
+}
@@ -23,6 +23,7 @@
 #define DAVIX_TEST_UTILS_HPP
 
 #include "../drunk-server/DrunkServer.hpp"
+#include "../drunk-server/Interactors.hpp"
 
 #include <gtest/gtest.h>
 #include <backend/StandaloneNeonRequest.hpp>
@@ -83,4 +84,64 @@ protected:
 
 };
 
+//------------------------------------------------------------------------------
+// Fixture serving every connection on port 22222 through a handler, for
+// tests driving the library through its public interfaces
+//------------------------------------------------------------------------------
+class HttpHandlerFixture : public ::testing::Test {
+public:
+  HttpHandlerFixture() : _server(new DrunkServer(22222)), _base("http://localhost:22222") {
+    // one interactor per connection the library may open
+    for(size_t i = 0; i < 64; i++) {
+      _interactors.emplace_back(new HandlerInteractor([this](const HttpExchangeRequest &req) { return dispatch(req); }));
+      _server->autoAcceptNext(_interactors.back().get());
+    }
+  }
+
+  ~HttpHandlerFixture() {
+    _interactors.clear();
+  }
+
+  //----------------------------------------------------------------------------
+  // Requests received so far, as "METHOD path"
+  //----------------------------------------------------------------------------
+  std::vector<std::string> received() {
+    std::lock_guard<std::mutex> lock(_mtx);
+    return _received;
+  }
+
+  //----------------------------------------------------------------------------
+  // Number of requests received so far with the given method
+  //----------------------------------------------------------------------------
+  size_t countReceived(const std::string &method) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    size_t count = 0;
+    for(size_t i = 0; i < _received.size(); i++) {
+      if(_received[i].compare(0, method.size() + 1, method + " ") == 0) {
+        count++;
+      }
+    }
+    return count;
+  }
+
+protected:
+  HttpExchangeResponse dispatch(const HttpExchangeRequest &req) {
+    std::lock_guard<std::mutex> lock(_mtx);
+    _received.push_back(req.method + " " + req.path);
+    if(!_handler) {
+      return HttpExchangeResponse(500);
+    }
+    return _handler(req);
+  }
+
+  std::unique_ptr<DrunkServer> _server;
+  std::vector<std::unique_ptr<HandlerInteractor> > _interactors;
+  std::string _base;
+
+  // called with _mtx held, requests are served one at a time
+  HandlerInteractor::Handler _handler;
+  std::mutex _mtx;
+  std::vector<std::string> _received;
+};
+
 #endif
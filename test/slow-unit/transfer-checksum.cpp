@@ -0,0 +1,127 @@
+/*
+ * This File is part of Davix, The IO library for HTTP based protocols
+ * Copyright (C) CERN 2019
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+*/
+
+#include <gtest/gtest.h>
+#include <davix.hpp>
+#include <utils/checksum_calculator.hpp>
+#include "test-utils.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+using namespace Davix;
+
+class TransferChecksum : public HttpHandlerFixture {
+public:
+  TransferChecksum() : _cuts(1), _honorRange(true) {
+    for(size_t i = 0; i < 3 * 1024 * 1024; i++) {
+      _contents.push_back((char) ((i * 7 + i / 4096) % 251));
+    }
+
+    std::unique_ptr<ChecksumCalculator> adler(ChecksumCalculator::create("adler32"));
+    adler->update(_contents.data(), _contents.size());
+    _digest = adler->digest();
+
+    // the first GETs are cut after 1.5 MiB
+    _handler = [this](const HttpExchangeRequest &req) {
+      if(req.path != "/file") {
+        return HttpExchangeResponse(404);
+      }
+
+      if(req.method == "HEAD") {
+        HttpExchangeResponse resp(200, _contents);
+        resp.headers.push_back(std::make_pair("Digest", "adler32=" + _digest));
+        return resp;
+      }
+
+      unsigned long first = 0;
+      const std::string range = req.header("range");
+      HttpExchangeResponse resp(200, _contents);
+      if(_honorRange && sscanf(range.c_str(), "bytes=%lu-", &first) == 1) {
+        resp = HttpExchangeResponse(206, _contents.substr(first));
+        resp.headers.push_back(std::make_pair("Content-Range", SSTR("bytes " << first << "-" << _contents.size() - 1 << "/" << _contents.size())));
+      }
+
+      if(_cuts > 0) {
+        _cuts--;
+        resp.truncateAt = 1536 * 1024;
+      }
+      return resp;
+    };
+
+    _params.setTransferChecksum("adler32");
+  }
+
+  std::string getToFd() {
+    char path[] = "/tmp/davix-tests-transfer-checksum-XXXXXX";
+    int fd = mkstemp(path);
+    EXPECT_GE(fd, 0);
+    ::unlink(path);
+
+    Context context;
+    DavFile file(context, Uri(_base + "/file"));
+    DavixError* err = NULL;
+    dav_ssize_t ret = file.getToFd(&_params, fd, 0, &err);
+    EXPECT_TRUE(err == NULL) << ((err) ? err->getErrMsg() : std::string());
+    EXPECT_GT(ret, 0);
+    DavixError::clearError(&err);
+
+    std::string out(_contents.size() + 1, '\0');
+    ssize_t size = ::pread(fd, &out[0], out.size(), 0);
+    ::close(fd);
+    out.resize((size > 0) ? size : 0);
+    return out;
+  }
+
+protected:
+  std::string _contents;
+  std::string _digest;
+  RequestParams _params;
+  int _cuts;
+  bool _honorRange;
+};
+
+TEST_F(TransferChecksum, GetToFdResumes) {
+  ASSERT_TRUE(getToFd() == _contents);
+  ASSERT_EQ(countReceived("GET"), 2u);
+}
+
+TEST_F(TransferChecksum, GetToFdRangeIgnored) {
+  // the whole file is sent again, what was written already is skipped
+  _honorRange = false;
+  ASSERT_TRUE(getToFd() == _contents);
+  ASSERT_EQ(countReceived("GET"), 2u);
+}
+
+TEST_F(TransferChecksum, GetFullCut) {
+  Context context;
+  DavFile file(context, Uri(_base + "/file"));
+
+  // nothing of the failed transfer is kept, neither in the buffer nor in
+  // the checksum of a next attempt
+  std::vector<char> buffer(10, 'x');
+  ASSERT_THROW(file.get(&_params, buffer), DavixException);
+  ASSERT_TRUE(std::string(buffer.begin(), buffer.end()) == std::string(10, 'x'));
+
+  buffer.clear();
+  ASSERT_EQ(file.get(&_params, buffer), (dav_ssize_t) _contents.size());
+  ASSERT_TRUE(std::string(buffer.begin(), buffer.end()) == _contents);
+  ASSERT_EQ(countReceived("GET"), 2u);
+}
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <utils/checksum_calculator.hpp>
+#include <utils/checksum_kernels.hpp>
+#include <core/ContentProvider.hpp>
+
+#include <memory>
+
+using namespace Davix;
+
+TEST(Checksum, KnownValues) {
+  ASSERT_EQ(Checksum::adler32(Checksum::ADLER32_INIT, "Wikipedia", 9), 0x11e60398u);
+  ASSERT_EQ(Checksum::adler32(Checksum::ADLER32_INIT, "", 0), 1u);
+  ASSERT_EQ(Checksum::crc32c(Checksum::CRC32C_INIT, "123456789", 9), 0xe3069283u);
+  ASSERT_EQ(Checksum::crc32c(Checksum::CRC32C_INIT, "", 0), 0u);
+
+  std::unique_ptr<ChecksumCalculator> md5(ChecksumCalculator::create("MD5"));
+  ASSERT_TRUE(md5.get() != NULL);
+  ASSERT_EQ(md5->digest(), "d41d8cd98f00b204e9800998ecf8427e");
+  md5->update("abc", 3);
+  ASSERT_EQ(md5->digest(), "900150983cd24fb0d6963f7d28e17f72");
+
+  ASSERT_TRUE(ChecksumCalculator::create("sha3") == NULL);
+}
+
+TEST(Checksum, Incremental) {
+  // long enough to cross the adler32 modulo interval and the CRC32C blocks
+  std::string data;
+  for(size_t i = 0; i < 100000; i++) {
+    data.push_back(static_cast<char>((i * 7919) % 251));
+  }
+
+  const char* algorithms[] = { "adler32", "crc32c", "md5" };
+  for(size_t a = 0; a < 3; a++) {
+    std::unique_ptr<ChecksumCalculator> whole(ChecksumCalculator::create(algorithms[a]));
+    std::unique_ptr<ChecksumCalculator> pieces(ChecksumCalculator::create(algorithms[a]));
+    whole->update(data.data(), data.size());
+
+    for(size_t pos = 0, len = 1; pos < data.size(); pos += len, len = len * 3 + 1) {
+      pieces->update(data.data() + pos, std::min(len, data.size() - pos));
+    }
+    ASSERT_EQ(whole->digest(), pieces->digest()) << algorithms[a];
+
+    pieces->reset();
+    pieces->update(data.data(), data.size());
+    ASSERT_EQ(whole->digest(), pieces->digest()) << algorithms[a];
+  }
+}
+
+TEST(Checksum, Kernels) {
+  // all bytes 0xff is the worst case for the adler32 sums
+  std::string data(100000, '\xff');
+  for(size_t i = 0; i < data.size(); i += 3) {
+    data[i] = static_cast<char>((i * 7919) % 251);
+  }
+
+  Checksum::KernelList adler = Checksum::adler32Kernels();
+  Checksum::KernelList crc = Checksum::crc32cKernels();
+  ASSERT_EQ(adler.front().first, "portable");
+  ASSERT_EQ(crc.front().first, "portable");
+
+  // unaligned starts, lengths around the block sizes of the kernels
+  const size_t offsets[] = { 0, 1, 7 };
+  const size_t lengths[] = { 0, 1, 31, 32, 33, 5552, 5553, 3 * 256 + 5, 3 * 8192, 3 * 8192 + 17, 99000 };
+
+  for(size_t o = 0; o < 3; o++) {
+    for(size_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+      const char* buf = data.data() + offsets[o];
+      const uint32_t expectedAdler = Checksum::adler32Portable(0x12345678 % 65521, buf, lengths[l]);
+      const uint32_t expectedCrc = Checksum::crc32cPortable(0xdeadbeef, buf, lengths[l]);
+
+      for(size_t k = 1; k < adler.size(); k++) {
+        ASSERT_EQ(adler[k].second(0x12345678 % 65521, buf, lengths[l]), expectedAdler) << adler[k].first << " " << lengths[l];
+      }
+      for(size_t k = 1; k < crc.size(); k++) {
+        ASSERT_EQ(crc[k].second(0xdeadbeef, buf, lengths[l]), expectedCrc) << crc[k].first << " " << lengths[l];
+      }
+    }
+  }
+}
+
+TEST(Checksum, Matches) {
+  std::unique_ptr<ChecksumCalculator> adler(ChecksumCalculator::create("adler32"));
+  adler->update("a", 1);
+  ASSERT_EQ(adler->digest(), "00620062");
+  ASSERT_TRUE(adler->matches("00620062"));
+  ASSERT_TRUE(adler->matches("620062"));
+  ASSERT_TRUE(adler->matches("\"00620062\""));
+  ASSERT_FALSE(adler->matches("00620063"));
+  ASSERT_FALSE(adler->matches(""));
+  ASSERT_FALSE(adler->matches("0062zz62"));
+
+  std::unique_ptr<ChecksumCalculator> md5(ChecksumCalculator::create("md5"));
+  md5->update("abc", 3);
+  ASSERT_TRUE(md5->matches("900150983CD24FB0D6963F7D28E17F72"));
+  ASSERT_TRUE(md5->matches(std::string("\x90\x01\x50\x98\x3c\xd2\x4f\xb0\xd6\x96\x3f\x7d\x28\xe1\x7f\x72", 16)));
+  ASSERT_FALSE(md5->matches("d41d8cd98f00b204e9800998ecf8427e"));
+}
+
+TEST(Checksum, ContentProvider) {
+  std::string contents("123456789");
+  BufferContentProvider buffer(contents.data(), contents.size());
+  std::unique_ptr<ChecksumCalculator> crc(ChecksumCalculator::create("crc32c"));
+  ChecksumContentProvider provider(buffer, *crc);
+
+  ASSERT_TRUE(provider.ok());
+  ASSERT_EQ(provider.getSize(), 9);
+  ASSERT_TRUE(provider.getContiguousData() == NULL);
+
+  char target[16];
+  ASSERT_EQ(provider.pullBytes(target, 4), 4);
+
+  // data sent again after a rewind is only counted once
+  ASSERT_TRUE(provider.rewind());
+  ASSERT_EQ(provider.pullBytes(target, 5), 5);
+  ASSERT_EQ(provider.pullBytes(target, 16), 4);
+  ASSERT_EQ(provider.pullBytes(target, 16), 0);
+  ASSERT_EQ(crc->digest(), "e3069283");
+}
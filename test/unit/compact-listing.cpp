@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include <davix.hpp>
+
+using namespace Davix;
+
+static StatInfo makeInfo(bool directory, dav_size_t size, time_t mtime) {
+  StatInfo info;
+  info.mode = 0750 | ((directory) ? S_IFDIR : S_IFREG);
+  info.size = size;
+  info.mtime = mtime;
+  info.ctime = mtime - 10;
+  info.owner = 12;
+  info.group = 34;
+  return info;
+}
+
+TEST(CompactListing, AllProperties) {
+  CompactListing listing;
+  ASSERT_TRUE(listing.empty());
+  ASSERT_EQ((unsigned int) StatProperty::All, listing.properties());
+
+  listing.push_back("dir", makeInfo(true, 0, 1000));
+  listing.push_back("", makeInfo(false, 5, 2000));
+  listing.push_back("file.root", makeInfo(false, 123456789012ULL, 3000));
+  ASSERT_EQ(3u, listing.size());
+
+  ASSERT_STREQ("dir", listing.name(0));
+  ASSERT_EQ(3u, listing.nameSize(0));
+  ASSERT_STREQ("", listing.name(1));
+  ASSERT_EQ(0u, listing.nameSize(1));
+  ASSERT_STREQ("file.root", listing.name(2));
+  ASSERT_EQ(9u, listing.nameSize(2));
+
+  ASSERT_TRUE(listing.isDirectory(0));
+  ASSERT_FALSE(listing.isDirectory(2));
+  ASSERT_EQ(123456789012ULL, listing.fileSize(2));
+
+  StatInfo info = listing.info(2);
+  ASSERT_EQ((mode_t) (0750 | S_IFREG), info.mode);
+  ASSERT_EQ(3000, info.mtime);
+  ASSERT_EQ(2990, info.ctime);
+  ASSERT_EQ(12u, info.owner);
+  ASSERT_EQ(34u, info.group);
+
+  ASSERT_THROW(listing.name(3), DavixException);
+
+  CompactListing copy(listing);
+  listing.clear();
+  ASSERT_TRUE(listing.empty());
+  ASSERT_EQ(3u, copy.size());
+  ASSERT_STREQ("file.root", copy.name(2));
+}
+
+TEST(CompactListing, SelectedProperties) {
+  CompactListing listing(StatProperty::Type | StatProperty::Size);
+  listing.reserve(2, 16);
+  listing.push_back("a", makeInfo(true, 0, 1000));
+  listing.push_back("b", makeInfo(false, 42, 2000));
+
+  ASSERT_TRUE(listing.isDirectory(0));
+  ASSERT_EQ(42u, listing.fileSize(1));
+
+  // properties outside of the mask are not kept
+  ASSERT_EQ(0, listing.mtime(1));
+  ASSERT_EQ(0u, listing.owner(1));
+  ASSERT_EQ((mode_t) (0777 | S_IFDIR), listing.info(0).mode);
+  ASSERT_EQ((mode_t) (0777 | S_IFREG), listing.info(1).mode);
+
+  CompactListing names(0);
+  names.push_back("c", makeInfo(true, 7, 1000));
+  ASSERT_STREQ("c", names.name(0));
+  ASSERT_FALSE(names.isDirectory(0));
+  ASSERT_EQ(0u, names.fileSize(0));
+}
@@ -4,6 +4,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <thread>
 
 using namespace Davix;
 
@@ -225,6 +226,85 @@ TEST(ContentProvider, FdExcessiveLen) {
   ASSERT_EQ(::close(fd), 0);
 }
 
+TEST(ContentProvider, Mmap) {
+  ASSERT_TRUE(makeTemporaryFile("/tmp/davix-tests-tmp-file", "123456789"));
+  int fd = ::open("/tmp/davix-tests-tmp-file", O_RDONLY);
+
+  MmapContentProvider provider(fd, 2, 5);
+  ASSERT_TRUE(provider.ok());
+  ASSERT_EQ(provider.getSize(), 5);
+  ASSERT_EQ(std::string(provider.getContiguousData(), 5), "34567");
+
+  char buffer[1024];
+
+  // Read and rewind 3 times
+  for(size_t i = 0; i < 3; i++) {
+    ASSERT_EQ(provider.pullBytes(buffer, 3), 3);
+    ASSERT_EQ(std::string(buffer, 3), "345");
+
+    ASSERT_EQ(provider.pullBytes(buffer, 100), 2);
+    ASSERT_EQ(std::string(buffer, 2), "67");
+
+    ASSERT_EQ(provider.pullBytes(buffer, 1), 0);
+    ASSERT_TRUE(provider.rewind());
+  }
+
+  // the mapping outlives the file descriptor
+  ASSERT_EQ(::close(fd), 0);
+  ASSERT_EQ(provider.pullBytes(buffer, 100), 5);
+  ASSERT_EQ(std::string(buffer, 5), "34567");
+}
+
+TEST(ContentProvider, MmapInvalid) {
+  ASSERT_TRUE(makeTemporaryFile("/tmp/davix-tests-tmp-file", "123456789"));
+  int fd = ::open("/tmp/davix-tests-tmp-file", O_RDONLY);
+
+  MmapContentProvider outOfRange(fd, 9);
+  ASSERT_FALSE(outOfRange.ok());
+  ASSERT_EQ(outOfRange.getErrc(), ERANGE);
+  ASSERT_TRUE(outOfRange.getContiguousData() == NULL);
+  ASSERT_EQ(::close(fd), 0);
+
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  MmapContentProvider pipeProvider(fds[0]);
+  ASSERT_FALSE(pipeProvider.ok());
+  char buffer[16];
+  ASSERT_LT(pipeProvider.pullBytes(buffer, 16), 0);
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
+TEST(ContentProvider, SourceFingerprint) {
+  ASSERT_TRUE(makeTemporaryFile("/tmp/davix-tests-tmp-file", "123456789"));
+  int fd = ::open("/tmp/davix-tests-tmp-file", O_RDONLY);
+
+  FdContentProvider fdProvider(fd);
+  MmapContentProvider mmapProvider(fd);
+  const std::string fingerprint = fdProvider.getSourceFingerprint();
+  ASSERT_FALSE(fingerprint.empty());
+  ASSERT_EQ(fingerprint, mmapProvider.getSourceFingerprint());
+  ASSERT_NE(fingerprint, FdContentProvider(fd, 2).getSourceFingerprint());
+  ASSERT_EQ(::close(fd), 0);
+
+  // a modified file is another source
+  ASSERT_TRUE(makeTemporaryFile("/tmp/davix-tests-tmp-file", "1234567890"));
+  fd = ::open("/tmp/davix-tests-tmp-file", O_RDONLY);
+  ASSERT_NE(fingerprint, FdContentProvider(fd).getSourceFingerprint());
+  ASSERT_EQ(::close(fd), 0);
+
+  // sources which can't be identified
+  std::string sourceBuffer("123456789");
+  BufferContentProvider bufferProvider(sourceBuffer.c_str(), sourceBuffer.size());
+  ASSERT_TRUE(bufferProvider.getSourceFingerprint().empty());
+
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  ASSERT_TRUE(FdContentProvider(fds[0], 0, 10).getSourceFingerprint().empty());
+  ::close(fds[0]);
+  ::close(fds[1]);
+}
+
 TEST(ContentProvider, Buffer) {
   std::string sourceBuffer("123456789");
   char buffer[1024];
@@ -272,4 +352,76 @@ TEST(ContentProvider, OwnedBuffer) {
 
   ASSERT_EQ(provider.pullBytes(buffer, 3), 3);
   ASSERT_EQ(std::string(buffer, 3), "tes");
-}
\ No newline at end of file
+}
+TEST(ContentProvider, CallbackUnknownSize) {
+  std::string data("123456789");
+  size_t offset = 0;
+  CallbackContentProvider provider([&](void* buffer, dav_size_t max_size) -> dav_ssize_t {
+    if(max_size == 0) {
+      return (offset == 0) ? 0 : -1; // replays are refused
+    }
+
+    size_t count = std::min<size_t>(max_size, data.size() - offset);
+    memcpy(buffer, data.data() + offset, count);
+    offset += count;
+    return count;
+  });
+
+  char buffer[1024];
+  ASSERT_EQ(provider.getSize(), -1);
+  ASSERT_TRUE(provider.rewind());
+
+  ASSERT_EQ(provider.pullBytes(buffer, 5), 5);
+  ASSERT_EQ(provider.pullBytes(buffer, 100), 4);
+  ASSERT_EQ(std::string(buffer, 4), "6789");
+  ASSERT_EQ(provider.pullBytes(buffer, 100), 0);
+
+  ASSERT_FALSE(provider.rewind());
+  ASSERT_FALSE(provider.ok());
+}
+
+TEST(ContentProvider, Pipe) {
+  PipeContentProvider provider(4);
+  ASSERT_TRUE(provider.ok());
+  ASSERT_EQ(provider.getSize(), -1);
+  ASSERT_TRUE(provider.rewind());
+
+  // producer pushes more than the pipe can hold at once
+  std::thread producer([&provider]() {
+    ASSERT_TRUE(provider.push("1234567", 7));
+    ASSERT_TRUE(provider.push("89", 2));
+    provider.close();
+  });
+
+  std::string contents;
+  char buffer[1024];
+  ssize_t ret;
+  while( (ret = provider.pullBytes(buffer, 3)) > 0) {
+    ASSERT_LE(ret, 3);
+    contents.append(buffer, ret);
+  }
+
+  producer.join();
+  ASSERT_EQ(ret, 0);
+  ASSERT_EQ(contents, "123456789");
+  ASSERT_EQ(provider.getConsumed(), 9u);
+  ASSERT_FALSE(provider.rewind());
+  ASSERT_EQ(provider.pullBytes(buffer, 3), 0);
+}
+
+TEST(ContentProvider, PipeCancel) {
+  PipeContentProvider provider(2);
+
+  std::thread producer([&provider]() {
+    ASSERT_FALSE(provider.push("123456", 6));
+  });
+
+  char buffer[1024];
+  ASSERT_EQ(provider.pullBytes(buffer, 1), 1);
+  ASSERT_EQ(buffer[0], '1');
+  provider.cancel();
+  producer.join();
+
+  ASSERT_EQ(provider.pullBytes(buffer, 1), -ECANCELED);
+  ASSERT_FALSE(provider.ok());
+}
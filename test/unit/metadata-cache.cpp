@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <core/MetadataCache.hpp>
+
+using namespace Davix;
+
+static StatInfo makeInfo(dav_size_t size) {
+  StatInfo info;
+  info.size = size;
+  return info;
+}
+
+TEST(MetadataCache, Keys) {
+  ASSERT_EQ(MetadataCache::makeKey(Uri("dav://Example.ORG/a%20b/c/")), "http://example.org:80/a b/c");
+  ASSERT_EQ(MetadataCache::makeKey(Uri("http://example.org:80/a%20b/c")), "http://example.org:80/a b/c");
+  ASSERT_EQ(MetadataCache::makeKey(Uri("davs://example.org")), "https://example.org:443/");
+  ASSERT_EQ(MetadataCache::makeKey(Uri("s3://bucket.example.org/obj?x=1")), "http://bucket.example.org:80/obj?x=1");
+  ASSERT_EQ(MetadataCache::makeKey(Uri("not a url")), "");
+
+  ASSERT_EQ(MetadataCache::makeChildKey("http://example.org:80/a", "b c/"), "http://example.org:80/a/b c");
+  ASSERT_EQ(MetadataCache::makeChildKey("http://example.org:80/", "b"), "http://example.org:80/b");
+
+  // names with a '%' are kept as they are, and match the key of their uri
+  ASSERT_EQ(MetadataCache::makeChildKey("http://example.org:80/a", "50%25"), "http://example.org:80/a/50%25");
+  ASSERT_EQ(MetadataCache::makeChildKey("http://example.org:80/a", "50%25"), MetadataCache::makeKey(Uri("http://example.org/a/50%2525")));
+  ASSERT_NE(MetadataCache::makeChildKey("http://example.org:80/a", "50%25"), MetadataCache::makeKey(Uri("http://example.org/a/50%25")));
+
+  ASSERT_EQ(MetadataCache::makeParentKey("http://example.org:80/a/b"), "http://example.org:80/a");
+  ASSERT_EQ(MetadataCache::makeParentKey("http://example.org:80/a"), "http://example.org:80/");
+  ASSERT_EQ(MetadataCache::makeParentKey("http://example.org:80/"), "");
+  ASSERT_EQ(MetadataCache::makeParentKey("http://example.org:80/a?x=1"), "");
+}
+
+TEST(MetadataCache, Disabled) {
+  MetadataCache cache;
+  StatInfo info;
+
+  cache.insert("http://example.org:80/a", makeInfo(1));
+  ASSERT_FALSE(cache.find("http://example.org:80/a", info));
+  ASSERT_EQ(cache.size(), 0u);
+
+  cache.setTTL(60);
+  cache.insert("http://example.org:80/a", makeInfo(1));
+  ASSERT_TRUE(cache.find("http://example.org:80/a", info));
+  ASSERT_EQ(info.size, 1u);
+
+  cache.setTTL(0);
+  ASSERT_EQ(cache.size(), 0u);
+}
+
+TEST(MetadataCache, Erase) {
+  MetadataCache cache;
+  cache.setTTL(60);
+  StatInfo info;
+
+  cache.insert("http://example.org:80/a", makeInfo(1));
+  cache.insert("http://example.org:80/a/b", makeInfo(2));
+  cache.insert("http://example.org:80/a/b/c", makeInfo(3));
+  cache.insert("http://example.org:80/ab", makeInfo(4));
+
+  cache.erase("http://example.org:80/a/b/c");
+  ASSERT_FALSE(cache.find("http://example.org:80/a/b/c", info));
+  ASSERT_TRUE(cache.find("http://example.org:80/a/b", info));
+
+  cache.insert("http://example.org:80/a/b/c", makeInfo(3));
+  cache.erase("http://example.org:80/a", true);
+  ASSERT_FALSE(cache.find("http://example.org:80/a", info));
+  ASSERT_FALSE(cache.find("http://example.org:80/a/b", info));
+  ASSERT_FALSE(cache.find("http://example.org:80/a/b/c", info));
+  ASSERT_TRUE(cache.find("http://example.org:80/ab", info));
+  ASSERT_EQ(info.size, 4u);
+}
+
+TEST(MetadataCache, LeastRecentlyUsed) {
+  MetadataCache cache(DAVIX_METADATA_CACHE_SHARDS * 4);
+  cache.setTTL(60);
+  StatInfo info;
+
+  const std::string first = "http://example.org:80/0";
+  cache.insert(first, makeInfo(0));
+  for(size_t i = 1; i < 1000; i++) {
+    // keep the first entry in use
+    ASSERT_TRUE(cache.find(first, info));
+    cache.insert(fmt::format("http://example.org:80/{}", i), makeInfo(i));
+  }
+
+  ASSERT_LE(cache.size(), DAVIX_METADATA_CACHE_SHARDS * 4u);
+  ASSERT_TRUE(cache.find(first, info));
+  ASSERT_TRUE(cache.find("http://example.org:80/999", info));
+  ASSERT_EQ(info.size, 999u);
+  ASSERT_FALSE(cache.find("http://example.org:80/1", info));
+}
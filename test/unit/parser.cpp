@@ -224,6 +224,15 @@ TEST(headerParser, generateRange){
     ASSERT_LE(2, ranges.size());
 }
 
+TEST(headerParser, contentRangeSize){
+    ASSERT_EQ(1000, parse_content_range_size("bytes 0-99/1000"));
+    ASSERT_EQ(0, parse_content_range_size("bytes */0"));
+    ASSERT_EQ(-1, parse_content_range_size("bytes 0-99/*"));
+    ASSERT_EQ(-1, parse_content_range_size("bytes 0-99"));
+    ASSERT_EQ(-1, parse_content_range_size("bytes 0-99/"));
+    ASSERT_EQ(5368709120LL, parse_content_range_size("bytes 42-43/5368709120"));
+}
+
 
 // URL parser
 TEST(UriTests, testRelativeUri){
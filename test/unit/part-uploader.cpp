@@ -0,0 +1,258 @@
+#include <gtest/gtest.h>
+#include <fileops/PartUploader.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+using namespace Davix;
+
+TEST(PartUploader, OrderedResults) {
+  std::atomic<int> inFlight(0);
+  std::atomic<int> maxInFlight(0);
+
+  PartUploader uploader([&](const char* data, dav_size_t size, size_t partNumber) {
+    int current = ++inFlight;
+    int seen = maxInFlight;
+    while(current > seen && !maxInFlight.compare_exchange_weak(seen, current)) { }
+
+    // later parts complete first
+    std::this_thread::sleep_for(std::chrono::milliseconds(5 * (10 - partNumber)));
+    --inFlight;
+    return std::to_string(partNumber) + ":" + std::string(data, size);
+  }, 4, 3);
+
+  for(size_t i = 1; i <= 8; i++) {
+    std::vector<char> buffer = uploader.acquireBuffer();
+    ASSERT_EQ(buffer.size(), 4u);
+    ::memcpy(buffer.data(), "abcd", 4);
+    uploader.submit(std::move(buffer), i % 4 + 1, i);
+  }
+
+  std::vector<std::string> results = uploader.finish();
+  ASSERT_EQ(results.size(), 8u);
+  ASSERT_EQ(results[0], "1:ab");
+  ASSERT_EQ(results[2], "3:abcd");
+  ASSERT_EQ(results[3], "4:a");
+  ASSERT_EQ(results[7], "8:a");
+  ASSERT_LE(maxInFlight, 3);
+}
+
+TEST(PartUploader, Failure) {
+  std::atomic<int> calls(0);
+
+  PartUploader uploader([&](const char*, dav_size_t, size_t partNumber) -> std::string {
+    calls++;
+    if(partNumber == 2) {
+      throw DavixException("test", StatusCode::InvalidServerResponse, "part failed");
+    }
+    return "etag";
+  }, 16, 1);
+
+  bool thrown = false;
+  try {
+    for(size_t i = 1; i <= 100; i++) {
+      std::vector<char> buffer = uploader.acquireBuffer();
+      uploader.submit(std::move(buffer), 16, i);
+    }
+    uploader.finish();
+  }
+  catch(DavixException &e) {
+    thrown = true;
+    ASSERT_EQ(e.code(), StatusCode::InvalidServerResponse);
+  }
+
+  ASSERT_TRUE(thrown);
+  // at most one part in flight and one waiting when the failure is noticed
+  ASSERT_LE(calls, 4);
+}
+
+TEST(PartUploader, PartSize) {
+  const dav_size_t MiB = 1024 * 1024;
+  const dav_size_t maxPart = 5ULL * 1024 * MiB;
+  RequestParams params;
+
+  // small objects use the minimal part size, or a single part
+  ASSERT_EQ(computeUploadPartSize(params, 100 * MiB, 5 * MiB, maxPart, 10000), 8 * MiB);
+  ASSERT_EQ(computeUploadPartSize(params, 3 * MiB, 5 * MiB, maxPart, 10000), 3 * MiB);
+  ASSERT_EQ(computeUploadPartSize(params, 0, 5 * MiB, maxPart, 10000), 0u);
+
+  // large objects must fit within the part count limit
+  dav_size_t partSize = computeUploadPartSize(params, 200000 * MiB, 5 * MiB, maxPart, 10000);
+  ASSERT_EQ(partSize, 20 * MiB);
+  partSize = computeUploadPartSize(params, 100000 * MiB + 1, 5 * MiB, maxPart, 10000);
+  ASSERT_EQ(partSize, 11 * MiB);
+  ASSERT_LE((100000 * MiB + 1 + partSize - 1) / partSize, 10000u);
+
+  // unknown size, starts small
+  ASSERT_EQ(computeUploadPartSize(params, -1, 5 * MiB, maxPart, 10000), 8 * MiB);
+
+  // explicit size, clamped to the protocol limit
+  params.setUploadPartSize(32 * MiB);
+  ASSERT_EQ(computeUploadPartSize(params, 1000 * MiB, 5 * MiB, maxPart, 10000), 32 * MiB);
+  ASSERT_EQ(computeUploadPartSize(params, -1, 5 * MiB, 16 * MiB, 10000), 16 * MiB);
+
+  // explicit size, raised to fit within the part count limit
+  partSize = computeUploadPartSize(params, 1000000 * MiB, 5 * MiB, maxPart, 10000);
+  ASSERT_EQ(partSize, 100 * MiB);
+  ASSERT_EQ(computeUploadPartSize(params, 1000000 * MiB, 5 * MiB, maxPart, 1000000), 32 * MiB);
+
+  // explicit size below the protocol minimum
+  params.setUploadPartSize(MiB);
+  ASSERT_THROW(computeUploadPartSize(params, 100 * MiB, 5 * MiB, maxPart, 10000), DavixException);
+  ASSERT_EQ(computeUploadPartSize(params, 100 * MiB, 1, maxPart, 10000), MiB);
+  params.setUploadPartSize(5 * MiB);
+  ASSERT_EQ(computeUploadPartSize(params, 100 * MiB, 5 * MiB, maxPart, 10000), 5 * MiB);
+}
+
+TEST(PartUploader, PartSizeGrowth) {
+  const dav_size_t MiB = 1024 * 1024;
+  PartUploader uploader([](const char*, dav_size_t, size_t) { return std::string(); }, 8 * MiB, 1);
+  uploader.setMemoryBudget(0);
+  ASSERT_EQ(uploader.getPartSize(10000), 8 * MiB);
+
+  uploader.growPartSize(5ULL * 1024 * MiB, 10000);
+  ASSERT_EQ(uploader.getPartSize(1), 8 * MiB);
+  ASSERT_EQ(uploader.getPartSize(5000), 8 * MiB);
+  ASSERT_EQ(uploader.getPartSize(5001), 32 * MiB);
+  ASSERT_EQ(uploader.getPartSize(7500), 32 * MiB);
+  ASSERT_EQ(uploader.getPartSize(7501), 128 * MiB);
+  ASSERT_EQ(uploader.getPartSize(10000), 5ULL * 1024 * MiB);
+
+  // parts never shrink, and 10000 of them hold more than 1 TiB
+  dav_size_t total = 0;
+  for(size_t i = 1; i <= 10000; i++) {
+    ASSERT_LE(uploader.getPartSize(i), uploader.getPartSize(i + 1));
+    total += uploader.getPartSize(i);
+  }
+  ASSERT_GT(total, 1024 * 1024 * MiB);
+}
+
+TEST(PartUploader, MemoryBudget) {
+  const dav_size_t MiB = 1024 * 1024;
+  PartUploader uploader([](const char*, dav_size_t, size_t) { return std::string(); }, 8 * MiB, 4);
+  uploader.growPartSize(5ULL * 1024 * MiB, 10000);
+
+  // parts grow up to the budget only
+  uploader.setMemoryBudget(64 * MiB);
+  ASSERT_EQ(uploader.getPartSize(5001), 32 * MiB);
+  ASSERT_EQ(uploader.getPartSize(10000), 64 * MiB);
+
+  // but never shrink below the initial size
+  uploader.setMemoryBudget(MiB);
+  ASSERT_EQ(uploader.getPartSize(10000), 8 * MiB);
+}
+
+TEST(PartUploader, MemoryBudgetBuffers) {
+  std::string contents;
+  for(size_t i = 0; i < 160; i++) {
+    contents.push_back('a' + (i % 26));
+  }
+  PipeContentProvider provider(256);
+  provider.push(contents.data(), contents.size());
+  provider.close();
+
+  std::atomic<int> running(0), peak(0);
+  PartUploader uploader([&](const char* data, dav_size_t size, size_t) {
+    const int current = ++running;
+    int previous = peak.load();
+    while(current > previous && !peak.compare_exchange_weak(previous, current));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    running--;
+    return std::string(data, size);
+  }, 16, 4);
+
+  // room for a single buffer of 16 bytes: parts are read and sent in turn
+  uploader.setMemoryBudget(20);
+  PartReader reader(provider, uploader);
+
+  size_t partNumber = 0;
+  while(reader.next() > 0) {
+    reader.submit(++partNumber);
+  }
+
+  std::vector<std::string> results = uploader.finish();
+  ASSERT_EQ(results.size(), 10u);
+  ASSERT_EQ(results[9], contents.substr(144));
+  ASSERT_EQ(peak.load(), 1);
+}
+
+TEST(PartUploader, ReaderGrowingParts) {
+  PipeContentProvider provider(64);
+  provider.push("0123456789abcdefghij", 20);
+  provider.close();
+
+  PartUploader uploader([&](const char* data, dav_size_t size, size_t) {
+    return std::string(data, size);
+  }, 1, 2);
+  uploader.growPartSize(16, 4);
+
+  PartReader reader(provider, uploader);
+
+  size_t partNumber = 0;
+  while(reader.next() > 0) {
+    reader.submit(++partNumber);
+    if(reader.partSize() > 4) {
+      ASSERT_EQ(partNumber, 4u);
+    }
+  }
+
+  std::vector<std::string> results = uploader.finish();
+  ASSERT_EQ(results.size(), 4u);
+  ASSERT_EQ(results[0], "0");
+  ASSERT_EQ(results[1], "1");
+  ASSERT_EQ(results[2], "2345");
+  ASSERT_EQ(results[3], "6789abcdefghij");
+}
+
+TEST(PartUploader, ReaderSlices) {
+  const std::string contents("0123456789");
+  std::vector<const char*> sent(4);
+
+  PartUploader uploader([&](const char* data, dav_size_t size, size_t partNumber) {
+    sent[partNumber - 1] = data;
+    return std::string(data, size);
+  }, 4, 2);
+
+  // contents in memory are sent in place
+  BufferContentProvider provider(contents.data(), contents.size());
+  PartReader reader(provider, uploader);
+
+  size_t partNumber = 0;
+  while(reader.next() > 0) {
+    reader.submit(++partNumber);
+  }
+
+  std::vector<std::string> results = uploader.finish();
+  ASSERT_EQ(results.size(), 3u);
+  ASSERT_EQ(results[0], "0123");
+  ASSERT_EQ(results[2], "89");
+  ASSERT_EQ(sent[0], contents.data());
+  ASSERT_EQ(sent[1], contents.data() + 4);
+  ASSERT_EQ(sent[2], contents.data() + 8);
+}
+
+TEST(PartUploader, ReaderBuffers) {
+  PipeContentProvider provider(64);
+  provider.push("0123456789", 10);
+  provider.close();
+
+  PartUploader uploader([&](const char* data, dav_size_t size, size_t) {
+    return std::string(data, size);
+  }, 4, 2);
+
+  // contents which can only be pulled are copied into part buffers
+  PartReader reader(provider, uploader);
+
+  size_t partNumber = 0;
+  while(reader.next() > 0) {
+    reader.submit(++partNumber);
+  }
+
+  std::vector<std::string> results = uploader.finish();
+  ASSERT_EQ(results.size(), 3u);
+  ASSERT_EQ(results[0], "0123");
+  ASSERT_EQ(results[1], "4567");
+  ASSERT_EQ(results[2], "89");
+}
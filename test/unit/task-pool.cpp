@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+#include <fileops/TaskPool.hpp>
+
+#include <atomic>
+#include <chrono>
+
+using namespace Davix;
+
+TEST(TaskPool, BoundedConcurrency) {
+  std::atomic<int> inFlight(0);
+  std::atomic<int> maxInFlight(0);
+  std::atomic<int> done(0);
+
+  TaskPool pool(3);
+  std::function<void (int)> task = [&](int depth) {
+    int current = ++inFlight;
+    int seen = maxInFlight;
+    while(current > seen && !maxInFlight.compare_exchange_weak(seen, current)) { }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    // tasks may queue more tasks
+    if(depth > 0) {
+      pool.add([&task, depth]{ task(depth - 1); });
+    }
+    --inFlight;
+    done++;
+  };
+
+  for(int i = 0; i < 10; i++) {
+    pool.add([&task]{ task(2); });
+  }
+  pool.wait();
+
+  ASSERT_EQ(done, 30);
+  ASSERT_LE(maxInFlight, 3);
+}
+
+TEST(TaskPool, Failure) {
+  std::atomic<int> calls(0);
+
+  TaskPool pool(1);
+  for(int i = 0; i < 100; i++) {
+    pool.add([&calls, i]{
+      calls++;
+      if(i == 1) {
+        throw DavixException("test", StatusCode::InvalidServerResponse, "task failed");
+      }
+    });
+  }
+
+  bool thrown = false;
+  try {
+    pool.wait();
+  }
+  catch(DavixException &e) {
+    thrown = true;
+    ASSERT_EQ(e.code(), StatusCode::InvalidServerResponse);
+  }
+
+  ASSERT_TRUE(thrown);
+  ASSERT_EQ(calls, 2);
+}
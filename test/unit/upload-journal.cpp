@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include <fileops/UploadJournal.hpp>
+
+#include <algorithm>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace Davix;
+
+TEST(UploadJournal, Disabled) {
+  UploadJournal journal("", Uri("https://example.org/bucket/file"), "1:2:100:1000:0+100");
+  ASSERT_FALSE(journal.enabled());
+  ASSERT_FALSE(journal.load());
+  journal.start("id", 100, 1000);
+  journal.addPart(1, "etag");
+  journal.remove();
+
+  // contents without a fingerprint, e.g. a pipe, can't be resumed
+  UploadJournal unidentified("/tmp", Uri("https://example.org/bucket/file"), "");
+  ASSERT_FALSE(unidentified.enabled());
+  unidentified.start("id", 100, 1000);
+  ASSERT_TRUE(UploadJournal::findSources("/tmp", Uri("https://example.org/bucket/file")).empty());
+}
+
+TEST(UploadJournal, Resume) {
+  const Uri uri("https://example.org/bucket/file");
+  const std::string source("1:2:100:1000:0+100");
+  {
+    UploadJournal journal("/tmp", uri, source);
+    ASSERT_TRUE(journal.enabled());
+    journal.remove();
+    ASSERT_FALSE(journal.load());
+
+    journal.start("upload-1", 8388608, 50000000);
+    journal.addPart(2, "\"etag-2\"");
+    journal.addPart(1, "\"etag-1\"");
+  }
+
+  UploadJournal journal("/tmp", uri, source);
+  ASSERT_TRUE(journal.load());
+  ASSERT_EQ(journal.getUploadId(), "upload-1");
+  ASSERT_EQ(journal.getPartSize(), 8388608u);
+  ASSERT_EQ(journal.getObjectSize(), 50000000);
+  ASSERT_EQ(journal.getParts().size(), 2u);
+  ASSERT_EQ(journal.getParts().at(1), "\"etag-1\"");
+
+  // another object never shares a journal
+  UploadJournal other("/tmp", Uri("https://example.org/bucket/file2"), source);
+  ASSERT_NE(other.getPath(), journal.getPath());
+  ASSERT_FALSE(other.load());
+
+  journal.remove();
+  ASSERT_NE(access(journal.getPath().c_str(), F_OK), 0);
+  ASSERT_FALSE(UploadJournal("/tmp", uri, source).load());
+}
+
+TEST(UploadJournal, PartMatches) {
+  const std::string data("hello world");
+  // md5 of "hello world"
+  ASSERT_TRUE(UploadJournal::partMatches(data.c_str(), data.size(), "\"5eb63bbbe01eeed093cb22bb8f5acdc3\"", data.size()));
+  ASSERT_TRUE(UploadJournal::partMatches(data.c_str(), data.size(), "5EB63BBBE01EEED093CB22BB8F5ACDC3", data.size()));
+  ASSERT_FALSE(UploadJournal::partMatches(data.c_str(), data.size(), "\"5eb63bbbe01eeed093cb22bb8f5acdc4\"", data.size()));
+  ASSERT_FALSE(UploadJournal::partMatches(data.c_str(), data.size(), "\"5eb63bbbe01eeed093cb22bb8f5acdc3\"", data.size() + 1));
+
+  // not a md5 sum, can't be verified
+  ASSERT_FALSE(UploadJournal::partMatches(data.c_str(), data.size(), "\"opaque-etag-1\"", data.size()));
+  ASSERT_FALSE(UploadJournal::partMatches(data.c_str(), data.size(), "\"5eb63bbbe01eeed093cb22bb8f5acdc3-2\"", data.size()));
+}
+
+TEST(UploadJournal, Sources) {
+  const Uri uri("https://example.org/bucket/source-file");
+  UploadJournal first("/tmp", uri, "1:2:100:1000:0+100");
+  UploadJournal second("/tmp", uri, "1:2:100:2000:0+100");
+  ASSERT_NE(first.getPath(), second.getPath());
+
+  // the name of the journal does not depend on the build
+  ASSERT_EQ(first.getPath(),
+            "/tmp/davix-upload-dc96dcab7bb187d063de94511ac383ba-83a2e0d4625f5bb95f05533f141e0a53.journal");
+
+  first.start("upload-1", 10, 100);
+  second.start("upload-2", 10, 100);
+  first.addPart(1, "etag-1");
+
+  std::vector<std::string> sources = UploadJournal::findSources("/tmp", uri);
+  std::sort(sources.begin(), sources.end());
+  ASSERT_EQ(sources.size(), 2u);
+  ASSERT_EQ(sources[0], "1:2:100:1000:0+100");
+  ASSERT_EQ(sources[1], "1:2:100:2000:0+100");
+  ASSERT_TRUE(UploadJournal::findSources("/tmp", Uri("https://example.org/bucket/other")).empty());
+  ASSERT_TRUE(UploadJournal::findSources("", uri).empty());
+
+  // each source resumes its own upload only
+  UploadJournal resumed("/tmp", uri, sources[0]);
+  ASSERT_TRUE(resumed.load());
+  ASSERT_EQ(resumed.getUploadId(), "upload-1");
+  ASSERT_EQ(resumed.getParts().size(), 1u);
+  ASSERT_FALSE(UploadJournal("/tmp", uri, "1:2:100:3000:0+100").load());
+
+  first.remove();
+  second.remove();
+  ASSERT_TRUE(UploadJournal::findSources("/tmp", uri).empty());
+}
+
+TEST(UploadJournal, WriteError) {
+  const std::string dir("/tmp/davix-tests-journal-dir");
+  ::mkdir(dir.c_str(), 0700);
+
+  UploadJournal journal(dir, Uri("https://example.org/bucket/file"), "1:2:100:1000:0+100");
+  journal.start("upload-1", 10, 100);
+  journal.addPart(1, "etag-1");
+
+  // the journal can't be updated any more
+  journal.remove();
+  ASSERT_EQ(::rmdir(dir.c_str()), 0);
+  ASSERT_THROW(journal.addPart(2, "etag-2"), DavixException);
+  ASSERT_THROW(journal.start("upload-2", 10, 100), DavixException);
+}
@@ -8,6 +8,8 @@
 #include <gtest/gtest.h>
 #include <core/SessionPool.hpp>
 #include <curl/HeaderlineParser.hpp>
+#include <fileops/RecursiveOps.hpp>
+#include <fileops/BulkStat.hpp>
 
 using namespace std;
 using namespace Davix;
@@ -93,6 +95,49 @@ TEST(testS3, test_hash_s3){
 
 }
 
+TEST(testS3, listingUri){
+    RequestParams params;
+    params.setS3MaxKey(100);
+
+    Uri u = S3::s3UriTransformer(Uri("s3s://bucket.example.org/dir"), params, true);
+    ASSERT_EQ("s3s://bucket.example.org/?prefix=dir%2F&max-keys=100&delimiter=%2F", u.getString());
+
+    params.setAwsAlternate(true);
+    u = S3::s3ListingUri(Uri("s3://example.org:9000/bucket/dir/"), params, "a b/", false, "a b/c");
+    ASSERT_EQ("s3://example.org:9000/bucket/?prefix=a%20b%2F&max-keys=100&marker=a%20b%2Fc", u.getString());
+}
+
+TEST(testCollectionPath, path){
+    std::vector<Uri> path = collectionPath(Uri("https://example.org:8443/a//b%20c/d?x=1"));
+    ASSERT_EQ(path.size(), 4u);
+    ASSERT_EQ(path[0].getString(), "https://example.org:8443/?x=1");
+    ASSERT_EQ(path[1].getPath(), "/a/");
+    ASSERT_EQ(path[2].getPath(), "/a/b%20c/");
+    ASSERT_EQ(path[3].getPath(), "/a/b%20c/d/");
+
+    path = collectionPath(Uri("http://example.org/"));
+    ASSERT_EQ(path.size(), 1u);
+    ASSERT_EQ(path[0].getPath(), "/");
+}
+
+TEST(testBulkStat, splitParent){
+    Uri parent;
+    std::string name;
+    ASSERT_TRUE(bulkStatSplitParent(Uri("https://example.org:8443/a/b%20c/50%25//"), parent, name));
+    ASSERT_EQ(parent.getString(), "https://example.org:8443/a/b%20c/");
+    ASSERT_EQ(name, "50%");
+
+    ASSERT_TRUE(bulkStatSplitParent(Uri("http://example.org/file"), parent, name));
+    ASSERT_EQ(parent.getPath(), "/");
+    ASSERT_EQ(name, "file");
+
+    // nothing to look up in a listing
+    ASSERT_FALSE(bulkStatSplitParent(Uri("http://example.org/"), parent, name));
+    ASSERT_FALSE(bulkStatSplitParent(Uri("http://example.org/dir/file?version=2"), parent, name));
+    ASSERT_FALSE(bulkStatSplitParent(Uri("http://example.org/dir/file#part"), parent, name));
+    ASSERT_FALSE(bulkStatSplitParent(Uri("not a uri"), parent, name));
+}
+
 TEST(testStringMode, test_mode){
     mode_t m = 0755;
     string m_str = Tool::string_from_mode(m);
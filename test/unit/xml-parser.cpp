@@ -9,7 +9,11 @@
 #include <xml/davpropxmlparser.hpp>
 #include <xml/metalinkparser.hpp>
 #include <xml/s3propparser.hpp>
+#include <xml/s3deleteparser.hpp>
+#include <fileops/BulkDelete.hpp>
+#include <fileops/davmeta.hpp>
 #include <xml/S3MultiPartInitiationParser.hpp>
+#include <xml/S3MultiPartListParser.hpp>
 #include <xml/swiftpropparser.hpp>
 #include <status/davixstatusrequest.hpp>
 #include <string.h>
@@ -339,6 +343,62 @@ const std::string s3_multipart_initiation_response = "<?xml version=\"1.0\" enco
 "   <UploadId>EXAMPLEJZ6e0YupT2h66iePQCc9IEbYbDUy4RTpMeoSMLPRp8Z5o1u8feSRonpvnWsKKG35tI2LB9VDPiCgTy.Gq2VxQLYjrue4Nq.NBdqI-</UploadId>"
 "</InitiateMultipartUploadResult>  ";
 
+const std::string s3_list_parts_response = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<ListPartsResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+"  <Bucket>example-bucket</Bucket>"
+"  <Key>example-object</Key>"
+"  <UploadId>XXBsb2FkIElEIGZvciBlbHZpbmcncyVcdS1tb3ZpZS5tMnRzEEEwbG9hZA</UploadId>"
+"  <PartNumberMarker>1</PartNumberMarker>"
+"  <NextPartNumberMarker>3</NextPartNumberMarker>"
+"  <MaxParts>2</MaxParts>"
+"  <IsTruncated>true</IsTruncated>"
+"  <Part>"
+"    <PartNumber>2</PartNumber>"
+"    <LastModified>2010-11-10T20:48:34.000Z</LastModified>"
+"    <ETag>\"7778aef83f66abc1fa1e8477f296d394\"</ETag>"
+"    <Size>10485760</Size>"
+"  </Part>"
+"  <Part>"
+"    <PartNumber>3</PartNumber>"
+"    <LastModified>2010-11-10T20:48:33.000Z</LastModified>"
+"    <ETag>\"aaaa18db4cc2f85cedef654fccc4a4x8\"</ETag>"
+"    <Size>10485761</Size>"
+"  </Part>"
+"</ListPartsResult>";
+
+const std::string s3_list_uploads_response = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<ListMultipartUploadsResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+"  <Bucket>bucket</Bucket>"
+"  <KeyMarker></KeyMarker>"
+"  <UploadIdMarker></UploadIdMarker>"
+"  <NextKeyMarker>my-movie.m2ts</NextKeyMarker>"
+"  <NextUploadIdMarker>YW55IGlkZWEgd2h5IGVsdmluZydzIHVwbG9hZCBmYWlsZWQ</NextUploadIdMarker>"
+"  <MaxUploads>3</MaxUploads>"
+"  <IsTruncated>false</IsTruncated>"
+"  <Upload>"
+"    <Key>my-divisor</Key>"
+"    <UploadId>XMgbGlrZSBlbHZpbmcncyBub3QgaGF2aW5nIG11Y2ggbHVjaw</UploadId>"
+"    <StorageClass>REDUCED_REDUNDANCY</StorageClass>"
+"  </Upload>"
+"  <Upload>"
+"    <Key>my-movie.m2ts</Key>"
+"    <UploadId>VXBsb2FkIElEIGZvciBlbHZpbmcncyBteS1tb3ZpZS5tMnRzIHVwbG9hZA</UploadId>"
+"    <StorageClass>STANDARD</StorageClass>"
+"  </Upload>"
+"</ListMultipartUploadsResult>";
+
+const std::string s3_delete_response = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+"<DeleteResult xmlns=\"http://s3.amazonaws.com/doc/2006-03-01/\">"
+"  <Deleted>"
+"    <Key>sample1.txt</Key>"
+"  </Deleted>"
+"  <Error>"
+"    <Key>a &amp; b.txt</Key>"
+"    <Code>AccessDenied</Code>"
+"    <Message>Access Denied</Message>"
+"  </Error>"
+"</DeleteResult>";
+
 const std::string swift_xml_response = "<?xml version=\"1.0\" encoding=\"UTF-8\"?><container name=\"backups\"><subdir name=\"photos/animals/\"><name>photos/animals/</name></subdir><object><name>photos/me.jpg</name><hash>b249a153f8f38b51e92916bbc6ea57ad</hash><bytes>2906</bytes><content_type>image/jpeg</content_type><last_modified>2015-12-03T17:31:28.187370</last_modified></object><subdir name=\"photos/plants/\"><name>photos/plants/</name></subdir></container>";
 
 TEST(XmlParserInstance, createParser){
@@ -439,6 +499,175 @@ TEST(XmlParserInstance,parserNonWebdav){
 }
 
 
+TEST(XmlParserInstance, parseNestedUnknownProperties){
+    const char* content =
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+        "<D:multistatus xmlns:D=\"DAV:\" xmlns:lp3=\"LCGDM:\">"
+        "<D:response><D:href>http://example.org/data/my%20file/</D:href>"
+        "<D:propstat><D:prop>"
+        "<D:lockdiscovery><D:activelock><D:owner>12</D:owner></D:activelock></D:lockdiscovery>"
+        "<D:getcontentlength>\n  4096  \n</D:getcontentlength>"
+        "<lp3:owner> 34</lp3:owner>"
+        "</D:prop><D:status>HTTP/1.1 200 OK</D:status></D:propstat>"
+        "<D:propstat><D:prop><D:getcontentlength>1</D:getcontentlength></D:prop>"
+        "<D:status>HTTP/1.1 404 Not Found</D:status></D:propstat>"
+        "</D:response>"
+        "<D:response><D:href>/data/other</D:href>"
+        "<D:propstat><D:prop><D:getcontentlength>-1</D:getcontentlength>"
+        "<D:resourcetype><D:collection/></D:resourcetype></D:prop>"
+        "<D:status>HTTP/1.1 200 OK</D:status></D:propstat>"
+        "</D:response>"
+        "</D:multistatus>";
+
+    Davix::DavPropXMLParser parser;
+    ASSERT_EQ(0, parser.parseChunk(content, strlen(content)));
+    parser.parseChunk(NULL, 0);
+    ASSERT_EQ(2u, parser.getProperties().size());
+
+    Davix::FileProperties f = parser.getProperties().at(0);
+    ASSERT_EQ("my file", f.filename);
+    ASSERT_EQ(4096, f.info.size);
+    ASSERT_EQ(34u, f.info.owner);
+    ASSERT_TRUE(S_ISREG(f.info.mode));
+
+    f = parser.getProperties().at(1);
+    ASSERT_EQ("other", f.filename);
+    ASSERT_EQ(0, f.info.size);
+    ASSERT_TRUE(S_ISDIR(f.info.mode));
+}
+
+
+TEST(XmlParserInstance, parseEscapedHrefs){
+    const char* content =
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+        "<D:multistatus xmlns:D=\"DAV:\">"
+        "<D:response><D:href>https://example.org/data/a%20b</D:href>"
+        "<D:propstat><D:prop><D:getcontentlength>1</D:getcontentlength></D:prop>"
+        "<D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>"
+        "<D:response><D:href>/data/50%25/</D:href>"
+        "<D:propstat><D:prop><D:resourcetype><D:collection/></D:resourcetype></D:prop>"
+        "<D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>"
+        "<D:response><D:href>/data/100%</D:href>"
+        "<D:propstat><D:prop><D:getcontentlength>3</D:getcontentlength></D:prop>"
+        "<D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response>"
+        "</D:multistatus>";
+
+    Davix::DavPropXMLParser parser;
+    ASSERT_EQ(0, parser.parseChunk(content, strlen(content)));
+    parser.parseChunk(NULL, 0);
+    ASSERT_EQ(3u, parser.getProperties().size());
+
+    // URLs and absolute paths are unescaped alike, raw names are kept
+    ASSERT_EQ("a b", parser.getProperties().at(0).filename);
+    ASSERT_EQ("50%", parser.getProperties().at(1).filename);
+    ASSERT_EQ("100%", parser.getProperties().at(2).filename);
+}
+
+TEST(XmlParserInstance, parseSplitBlocks){
+    // listings are parsed block by block as they arrive, with boundaries
+    // falling anywhere in the document
+    const std::string content =
+        "<?xml version=\"1.0\" encoding=\"utf-8\"?>"
+        "<D:multistatus xmlns:D=\"DAV:\">"
+        "<D:response><D:href>/data/dir/</D:href>"
+        "<D:propstat><D:prop><D:resourcetype><D:collection/></D:resourcetype></D:prop>"
+        "<D:status>HTTP/1.1 200 OK</D:status></D:propstat>"
+        "</D:response>"
+        "<D:response><D:href>/data/dir/file</D:href>"
+        "<D:propstat><D:prop><D:getcontentlength>123456</D:getcontentlength></D:prop>"
+        "<D:status>HTTP/1.1 200 OK</D:status></D:propstat>"
+        "</D:response>"
+        "</D:multistatus>";
+
+    // inside an element name, then inside cdata
+    const size_t element = content.find("getcontentlength>") + 7;
+    const size_t cdata = content.find("123456") + 3;
+
+    Davix::DavPropXMLParser parser;
+    ASSERT_EQ(0, parser.parseChunk(content.data(), element));
+    ASSERT_EQ(1u, parser.getProperties().size());
+    ASSERT_EQ(0, parser.parseChunk(content.data() + element, cdata - element));
+    ASSERT_EQ(1u, parser.getProperties().size());
+    ASSERT_EQ(0, parser.parseChunk(content.data() + cdata, content.size() - cdata));
+    parser.parseChunk(NULL, 0);
+    ASSERT_EQ(2u, parser.getProperties().size());
+    ASSERT_EQ("dir", parser.getProperties().at(0).filename);
+    ASSERT_TRUE(S_ISDIR(parser.getProperties().at(0).info.mode));
+    ASSERT_EQ("file", parser.getProperties().at(1).filename);
+    ASSERT_EQ(123456, parser.getProperties().at(1).info.size);
+
+    // one byte at a time
+    Davix::DavPropXMLParser bytes;
+    for(size_t i = 0; i < content.size(); i++) {
+        ASSERT_EQ(0, bytes.parseChunk(content.data() + i, 1));
+    }
+    bytes.parseChunk(NULL, 0);
+    ASSERT_EQ(2u, bytes.getProperties().size());
+    ASSERT_EQ("file", bytes.getProperties().at(1).filename);
+    ASSERT_EQ(123456, bytes.getProperties().at(1).info.size);
+}
+
+
+TEST(XmlParserInstance, parseSelectedProperties){
+    Davix::DavPropXMLParser parser(Davix::StatProperty::Type | Davix::StatProperty::Size);
+    ASSERT_EQ(0, parser.parseChunk(simple_stat_propfind_content, strlen(simple_stat_propfind_content)));
+    parser.parseChunk(NULL, 0);
+    ASSERT_EQ(1u, parser.getProperties().size());
+
+    Davix::FileProperties f = parser.getProperties().at(0);
+    ASSERT_STREQ("dteam", f.filename.c_str());
+    ASSERT_TRUE(S_ISDIR(f.info.mode));
+    ASSERT_EQ(0, f.info.mtime);
+    ASSERT_EQ(0, f.info.ctime);
+
+    // collections are not seen without the type
+    Davix::DavPropXMLParser untyped(Davix::StatProperty::Mtime);
+    ASSERT_EQ(0, untyped.parseChunk(simple_stat_propfind_content, strlen(simple_stat_propfind_content)));
+    untyped.parseChunk(NULL, 0);
+    ASSERT_EQ(1u, untyped.getProperties().size());
+    ASSERT_FALSE(S_ISDIR(untyped.getProperties().at(0).info.mode));
+    ASSERT_NE(0, untyped.getProperties().at(0).info.mtime);
+}
+
+
+TEST(XmlParserInstance, propfindBody){
+    ASSERT_EQ("<?xml version=\"1.0\" encoding=\"utf-8\" ?><D:propfind xmlns:D=\"DAV:\" xmlns:L=\"LCGDM:\"><D:prop>"
+              "<D:getcontentlength/><D:quota-used-bytes/><D:resourcetype><D:collection/></D:resourcetype>"
+              "</D:prop></D:propfind>",
+              Davix::webdav_propfind_body(Davix::StatProperty::Type | Davix::StatProperty::Size));
+
+    const std::string all = Davix::webdav_propfind_body(Davix::StatProperty::All);
+    const char* elements[] = { "<D:getlastmodified/>", "<D:creationdate/>", "<D:getcontentlength/>", "<D:quota-used-bytes/>",
+                               "<D:resourcetype>", "<L:mode/>", "<D:owner/>", "<D:group/>" };
+    for(size_t i = 0; i < sizeof(elements) / sizeof(elements[0]); ++i){
+        ASSERT_NE(std::string::npos, all.find(elements[i])) << elements[i];
+    }
+    ASSERT_EQ(std::string::npos, Davix::webdav_propfind_body(Davix::StatProperty::Mtime).find("getcontentlength"));
+    ASSERT_EQ(std::string::npos, Davix::webdav_propfind_body(Davix::StatProperty::Mtime).find("quota-used-bytes"));
+}
+
+
+TEST(XmlParserInstance, parseCollectionSize){
+    const std::string content = "<?xml version=\"1.0\" encoding=\"utf-8\"?><D:multistatus xmlns:D=\"DAV:\">"
+        "<D:response><D:href>/dteam/</D:href><D:propstat><D:prop>"
+        "<D:getcontentlength/><D:quota-used-bytes>123456</D:quota-used-bytes>"
+        "<D:resourcetype><D:collection/></D:resourcetype></D:prop>"
+        "<D:status>HTTP/1.1 200 OK</D:status></D:propstat></D:response></D:multistatus>";
+
+    // the size of a collection is its used quota
+    Davix::DavPropXMLParser parser(Davix::StatProperty::Type | Davix::StatProperty::Size);
+    ASSERT_EQ(0, parser.parseChunk(content.c_str(), content.size()));
+    ASSERT_EQ(1u, parser.getProperties().size());
+    ASSERT_TRUE(S_ISDIR(parser.getProperties().at(0).info.mode));
+    ASSERT_EQ(123456, parser.getProperties().at(0).info.size);
+
+    Davix::DavPropXMLParser unsized(Davix::StatProperty::Type);
+    ASSERT_EQ(0, unsized.parseChunk(content.c_str(), content.size()));
+    ASSERT_EQ(1u, unsized.getProperties().size());
+    ASSERT_EQ(0, unsized.getProperties().at(0).info.size);
+}
+
+
 TEST(XmlPaserInstance, destroyPartial){
     davix_set_log_level(DAVIX_LOG_ALL);
     Davix::DavPropXMLParser* parser = new Davix::DavPropXMLParser();
@@ -605,6 +834,66 @@ TEST(XmlMultiPartUploadInitiationResponse, BasicSanity) {
     ASSERT_EQ(parser.getUploadId(), "EXAMPLEJZ6e0YupT2h66iePQCc9IEbYbDUy4RTpMeoSMLPRp8Z5o1u8feSRonpvnWsKKG35tI2LB9VDPiCgTy.Gq2VxQLYjrue4Nq.NBdqI-");
 }
 
+TEST(XmlMultiPartList, ListParts) {
+    using namespace Davix;
+
+    S3MultiPartListParser parser;
+    ASSERT_EQ(parser.parseChunk(s3_list_parts_response), 0);
+    ASSERT_TRUE(parser.isTruncated());
+    ASSERT_EQ(parser.getNextPartNumberMarker(), "3");
+    ASSERT_TRUE(parser.getUploads().empty());
+
+    ASSERT_EQ(parser.getParts().size(), 2u);
+    ASSERT_EQ(parser.getParts()[0].partNumber, 2u);
+    ASSERT_EQ(parser.getParts()[0].etag, "\"7778aef83f66abc1fa1e8477f296d394\"");
+    ASSERT_EQ(parser.getParts()[0].size, 10485760u);
+    ASSERT_EQ(parser.getParts()[1].partNumber, 3u);
+    ASSERT_EQ(parser.getParts()[1].size, 10485761u);
+}
+
+TEST(XmlMultiPartList, ListUploads) {
+    using namespace Davix;
+
+    S3MultiPartListParser parser;
+    ASSERT_EQ(parser.parseChunk(s3_list_uploads_response), 0);
+    ASSERT_FALSE(parser.isTruncated());
+    ASSERT_TRUE(parser.getParts().empty());
+
+    ASSERT_EQ(parser.getUploads().size(), 2u);
+    ASSERT_EQ(parser.getUploads()[0].key, "my-divisor");
+    ASSERT_EQ(parser.getUploads()[0].uploadId, "XMgbGlrZSBlbHZpbmcncyBub3QgaGF2aW5nIG11Y2ggbHVjaw");
+    ASSERT_EQ(parser.getUploads()[1].key, "my-movie.m2ts");
+    ASSERT_EQ(parser.getNextKeyMarker(), "my-movie.m2ts");
+}
+
+TEST(XmlS3Delete, DeleteResult) {
+    using namespace Davix;
+
+    S3DeleteParser parser;
+    ASSERT_EQ(parser.parseChunk(s3_delete_response), 0);
+    ASSERT_EQ(parser.getDeleteStatus().size(), 2u);
+
+    ASSERT_EQ(parser.getDeleteStatus()[0].filename, "sample1.txt");
+    ASSERT_FALSE(parser.getDeleteStatus()[0].error);
+    ASSERT_EQ(s3DeleteStatusCode(parser.getDeleteStatus()[0]), StatusCode::OK);
+
+    ASSERT_EQ(parser.getDeleteStatus()[1].filename, "a & b.txt");
+    ASSERT_TRUE(parser.getDeleteStatus()[1].error);
+    ASSERT_EQ(parser.getDeleteStatus()[1].message, "Access Denied");
+    ASSERT_EQ(s3DeleteStatusCode(parser.getDeleteStatus()[1]), StatusCode::PermissionRefused);
+}
+
+TEST(XmlS3Delete, RequestBody) {
+    using namespace Davix;
+
+    std::vector<std::string> keys;
+    keys.push_back("dir/sample1.txt");
+    keys.push_back("a & <b>.txt");
+
+    ASSERT_EQ(s3DeleteRequestBody(keys), "<?xml version=\"1.0\" encoding=\"UTF-8\"?><Delete><Quiet>false</Quiet>"
+              "<Object><Key>dir/sample1.txt</Key></Object><Object><Key>a &amp; &lt;b&gt;.txt</Key></Object></Delete>");
+}
+
 TEST(XmlSwiftParsing, TestListingDir) {
     using namespace Davix;
 